@@ -22,6 +22,7 @@
 #include <SLAnimPlayback.h>
 #include <SLGLDepthBuffer.h>
 #include <SLGLProgramManager.h>
+#include <SLGLProgramBinaryCache.h>
 #include <SLGLShader.h>
 #include <SLGLTexture.h>
 #include <SLInterface.h>
@@ -399,7 +400,9 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                     SLfloat optFlowTime    = CVTracked::optFlowTimesMS.average();
                     SLfloat poseTime       = CVTracked::poseTimesMS.average();
 #endif
+                    SLfloat updateNodeTime = s->updateNodesTimesMS().average();
                     SLfloat updateAnimTime = s->updateAnimTimesMS().average();
+                    SLfloat updateSkinTime = s->updateSkinTimesMS().average();
                     SLfloat updateAABBTime = s->updateAABBTimesMS().average();
                     SLfloat updateDODTime  = s->updateDODTimesMS().average();
                     SLfloat shadowMapTime  = sv->shadowMapTimeMS().average();
@@ -419,7 +422,9 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                     SLfloat optFlowTimePC    = Utils::clamp(optFlowTime / ft * 100.0f, 0.0f, 100.0f);
                     SLfloat poseTimePC       = Utils::clamp(poseTime / ft * 100.0f, 0.0f, 100.0f);
 #endif
+                    SLfloat updateNodeTimePC = Utils::clamp(updateNodeTime / ft * 100.0f, 0.0f, 100.0f);
 					SLfloat updateAnimTimePC = Utils::clamp(updateAnimTime / ft * 100.0f, 0.0f, 100.0f);
+                    SLfloat updateSkinTimePC = Utils::clamp(updateSkinTime / ft * 100.0f, 0.0f, 100.0f);
                     SLfloat updateAABBTimePC = Utils::clamp(updateAABBTime / ft * 100.0f, 0.0f, 100.0f);
                     SLfloat updateDODTimePC  = Utils::clamp(updateDODTime / ft * 100.0f, 0.0f, 100.0f);
                     SLfloat shadowMapTimePC  = Utils::clamp(shadowMapTime / ft * 100.0f, 0.0f, 100.0f);
@@ -429,11 +434,15 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
 
                     sprintf(m + strlen(m), "Renderer   : OpenGL\n");
                     sprintf(m + strlen(m), "Load time  : %5.1f ms\n", s->loadTimeMS());
+                    sprintf(m + strlen(m), "Prog. bins : %d loaded, %d saved\n", SLGLProgramBinaryCache::numLoaded, SLGLProgramBinaryCache::numSaved);
                     sprintf(m + strlen(m), "Window size: %d x %d\n", sv->viewportW(), sv->viewportH());
                     sprintf(m + strlen(m), "Drawcalls  : %d\n", SLGLVertexArray::totalDrawCalls);
                     sprintf(m + strlen(m), " Shadow    : %d\n", SLShadowMap::drawCalls);
                     sprintf(m + strlen(m), " Render    : %d\n", SLGLVertexArray::totalDrawCalls - SLShadowMap::drawCalls);
+                    sprintf(m + strlen(m), " Instances : %d\n", SLGLVertexArray::totalInstancesRendered);
+                    sprintf(m + strlen(m), "SM cached  : %d views\n", SLShadowMap::cachedViews);
                     sprintf(m + strlen(m), "Primitives : %d\n", SLGLVertexArray::totalPrimitivesRendered);
+                    sprintf(m + strlen(m), "GL uniforms: %d calls\n", SLGLProgram::totalGLCalls);
                     sprintf(m + strlen(m), "FPS        : %5.1f\n", s->fps());
                     sprintf(m + strlen(m), "Frame time : %5.1f ms (100%%)\n", ft);
 #ifndef SL_EMSCRIPTEN
@@ -443,11 +452,13 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
 #ifdef SL_USE_ENTITIES
                     sprintf(m + strlen(m), "  EntityWM : %5.1f ms (%3d%%)\n", updateDODTime, (SLint)updateDODTimePC);
 #endif
+                    sprintf(m + strlen(m), "  Nodes    : %5.1f ms (%3d%%)\n", updateNodeTime, (SLint)updateNodeTimePC);
                     if (!s->animManager().allAnimNames().empty())
                     {
                         sprintf(m + strlen(m), "  Anim.    : %5.1f ms (%3d%%)\n", updateAnimTime, (SLint)updateAnimTimePC);
-                        sprintf(m + strlen(m), "  AABB     : %5.1f ms (%3d%%)\n", updateAABBTime, (SLint)updateAABBTimePC);
+                        sprintf(m + strlen(m), "  Skinning : %5.1f ms (%3d%%)\n", updateSkinTime, (SLint)updateSkinTimePC);
                     }
+                    sprintf(m + strlen(m), "  AABB     : %5.1f ms (%3d%%)\n", updateAABBTime, (SLint)updateAABBTimePC);
 					
 #ifndef SL_EMSCRIPTEN
                     if (vt != VT_NONE && tracker != nullptr && trackedNode != nullptr)
@@ -494,6 +505,8 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                     sprintf(m + strlen(m), "Frame Time :%0.3f sec.\n", renderSec);
                     sprintf(m + strlen(m), "Rays per ms:%0.0f\n", rt->raysPerMS());
                     sprintf(m + strlen(m), "AA Pixels  :%d (%d%%)\n", SLRay::subsampledPixels, (int)((float)SLRay::subsampledPixels / (float)rayPrimaries * 100.0f));
+                    if (rt->doIncremental())
+                        sprintf(m + strlen(m), "Traced pix.:%d (%d%%)\n", rt->numTracedPixels(), (int)((float)rt->numTracedPixels() / (float)rayPrimaries * 100.0f));
                     sprintf(m + strlen(m), "Threads    :%d\n", rt->numThreads());
                     sprintf(m + strlen(m), "----------------------------\n");
                     sprintf(m + strlen(m), "Total rays :%9d (%3d%%)\n", rayTotal, 100);
@@ -540,6 +553,8 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                     sprintf(m + strlen(m), "Frame Time :%0.2f sec.\n", pt->renderSec());
                     sprintf(m + strlen(m), "Rays per ms:%0.0f\n", pt->raysPerMS());
                     sprintf(m + strlen(m), "Samples/pix:%d\n", pt->aaSamples());
+                    if (pt->doDenoise())
+                        sprintf(m + strlen(m), "Denoiser   :%0.0f ms\n", pt->denoiserMS());
                     sprintf(m + strlen(m), "Threads    :%d\n", pt->numThreads());
                     sprintf(m + strlen(m), "---------------------------\n");
                     sprintf(m + strlen(m), "Total rays :%8d (%3d%%)\n", rayTotal, 100);
@@ -606,9 +621,15 @@ void AppDemoGui::build(SLScene* s, SLSceneView* sv)
                 sprintf(m + strlen(m), "- Blend Nodes :%5d (%3d%%)\n", stats3D.numNodesBlended, numBlendedPC);
                 sprintf(m + strlen(m), "- Overdrawn N.:%5d (%3d%%)\n", numOverdrawnNodes, numOverdrawnPC);
                 sprintf(m + strlen(m), "- Vis. Nodes  :%5d (%3d%%)\n", numVisibleNodes, numVisiblePC);
-                sprintf(m + strlen(m), "- WM Updates  :%5d\n", SLNode::numWMUpdates);
+                sprintf(m + strlen(m), "- WM Updates  :%5d\n", SLNode::numWMUpdates.load());
                 sprintf(m + strlen(m), "No. of Meshes :%5u\n", stats3D.numMeshes);
                 sprintf(m + strlen(m), "No. of Tri.   :%5u\n", stats3D.numTriangles);
+                if (stats3D.numMeshesOptimized)
+                {
+                    sprintf(m + strlen(m), "- Opt. Meshes :%5u\n", stats3D.numMeshesOptimized);
+                    sprintf(m + strlen(m), "- ACMR        :%5.2f > %4.2f\n", stats3D.acmrBefore(), stats3D.acmrAfter());
+                    sprintf(m + strlen(m), "- Opt. MB     :%6.2f > %5.2f\n", (SLfloat)stats3D.numBytesBeforeOpt / 1E6f, (SLfloat)stats3D.numBytesAfterOpt / 1E6f);
+                }
                 sprintf(m + strlen(m), "CPU MB Total  :%6.2f (100%%)\n", cpuMBTotal);
                 sprintf(m + strlen(m), "-   MB Tex.   :%6.2f (%3d%%)\n", cpuMBTexture, cpuMBTexturePC);
                 sprintf(m + strlen(m), "-   MB Meshes :%6.2f (%3d%%)\n", cpuMBMeshes, cpuMBMeshesPC);
@@ -2117,6 +2138,9 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
             if (ImGui::MenuItem("Do Alpha Sorting", "J", sv->doAlphaSorting()))
                 sv->doAlphaSorting(!sv->doAlphaSorting());
 
+            if (ImGui::MenuItem("Do Instancing", nullptr, sv->doInstancing()))
+                sv->doInstancing(!sv->doInstancing());
+
             if (ImGui::MenuItem("Do Depth Test", "T", sv->doDepthTest()))
                 sv->doDepthTest(!sv->doDepthTest());
 
@@ -2336,6 +2360,23 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
                     if (ImGui::MenuItem("Force Relocation", nullptr, featureTracker->forceRelocation()))
                         featureTracker->forceRelocation(!featureTracker->forceRelocation());
 
+                    if (ImGui::MenuItem("Projection Guided Matching", nullptr, featureTracker->projectionMatching()))
+                        featureTracker->projectionMatching(!featureTracker->projectionMatching());
+
+                    if (ImGui::BeginMenu("Matcher"))
+                    {
+                        CVFeatureMatcherType mType = featureTracker->matcherType();
+
+                        if (ImGui::MenuItem("Brute Force", nullptr, mType == FMT_BRUTE_FORCE))
+                            featureTracker->matcherType(FMT_BRUTE_FORCE);
+                        if (ImGui::MenuItem("Multi-Probe LSH", nullptr, mType == FMT_LSH))
+                            featureTracker->matcherType(FMT_LSH);
+                        if (ImGui::MenuItem("Hierarchical Clustering", nullptr, mType == FMT_HIERARCHICAL))
+                            featureTracker->matcherType(FMT_HIERARCHICAL);
+
+                        ImGui::EndMenu();
+                    }
+
                     if (ImGui::BeginMenu("Detector/Descriptor", featureTracker != nullptr))
                     {
                         CVDetectDescribeType type = featureTracker->type();
@@ -2508,6 +2549,9 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
                     sv->doWaitOnIdle(!rt->doContinuous());
                 }
 
+                if (ImGui::MenuItem("Incremental", nullptr, rt->doIncremental(), rt->doContinuous()))
+                    rt->doIncremental(!rt->doIncremental());
+
                 if (ImGui::MenuItem("Fresnel Reflection", nullptr, rt->doFresnel()))
                 {
                     rt->doFresnel(!rt->doFresnel());
@@ -2536,6 +2580,16 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
                     ImGui::EndMenu();
                 }
 
+                if (ImGui::BeginMenu("Anti-Aliasing Ray Budget"))
+                {
+                    if (ImGui::MenuItem("1 Ray per Pixel", nullptr, rt->aaRayBudget() == 1.0f)) rt->aaRayBudget(1.0f);
+                    if (ImGui::MenuItem("2 Rays per Pixel", nullptr, rt->aaRayBudget() == 2.0f)) rt->aaRayBudget(2.0f);
+                    if (ImGui::MenuItem("4 Rays per Pixel", nullptr, rt->aaRayBudget() == 4.0f)) rt->aaRayBudget(4.0f);
+                    if (ImGui::MenuItem("Unlimited", nullptr, rt->aaRayBudget() == 0.0f)) rt->aaRayBudget(0.0f);
+
+                    ImGui::EndMenu();
+                }
+
                 if (ImGui::MenuItem("Save Rendered Image"))
                     rt->saveImage();
 
@@ -2660,6 +2714,18 @@ void AppDemoGui::buildMenuBar(SLScene* s, SLSceneView* sv)
                     sv->startPathtracing(5, 10);
                 }
 
+                if (ImGui::MenuItem("Denoiser", nullptr, pt->doDenoise()))
+                {
+                    pt->doDenoise(!pt->doDenoise());
+                    sv->startPathtracing(5, pt->aaSamples());
+                }
+
+                if (ImGui::MenuItem("Log Denoiser Comparison", nullptr, pt->doDenoiseCompare(), pt->doDenoise()))
+                {
+                    pt->doDenoiseCompare(!pt->doDenoiseCompare());
+                    sv->startPathtracing(5, pt->aaSamples());
+                }
+
                 if (ImGui::MenuItem("Save Rendered Image"))
                     pt->saveImage();
 
@@ -4911,19 +4977,6 @@ void AppDemoGui::downloadModelAndLoadScene(SLScene*     s,
     assert(s->assetManager() && "No asset manager assigned to scene!");
     SLAssetManager* am = s->assetManager();
 
-    auto progressCallback = [](size_t curr, size_t filesize)
-    {
-        if (filesize > 0)
-        {
-            int transferredPC = (int)((float)curr / (float)filesize * 100.0f);
-            AppDemo::jobProgressNum(transferredPC);
-        }
-        else
-            cout << "Bytes transferred: " << curr << endl;
-
-        return 0; // Return Non-Zero to cancel
-    };
-
     auto downloadJobHTTP = [=]()
     {
         PROFILE_FUNCTION();
@@ -4931,7 +4984,23 @@ void AppDemoGui::downloadModelAndLoadScene(SLScene*     s,
         AppDemo::jobProgressMsg(jobMsg);
         AppDemo::jobProgressMax(100);
         string fileToDownload = urlFolder + downloadFilename;
-        if (HttpUtils::download(fileToDownload, dstFolder, progressCallback) != 0)
+        int    filesize       = HttpUtils::length(fileToDownload);
+
+        auto progressCallback = [filesize](size_t filesDone, size_t numFiles, int64_t bytes)
+        {
+            if (filesize > 0)
+            {
+                int transferredPC = (int)((float)bytes / (float)filesize * 100.0f);
+                AppDemo::jobProgressNum(std::min(transferredPC, 100));
+            }
+            else
+                cout << "Bytes transferred: " << bytes << endl;
+
+            return 0; // Return Non-Zero to cancel
+        };
+
+        // The mirror resumes an interrupted download of the file at the next try
+        if (HttpUtils::mirror(fileToDownload, dstFolder, "", "", 1, progressCallback) != 0)
         {
             SL_LOG("*** Nothing downloaded from: %s ***", fileToDownload.c_str());
             SL_LOG("*** PLEASE RETRY DOWNLOAD ***", fileToDownload.c_str());
@@ -726,6 +726,19 @@ SLNode* createTorchFire(SLAssetManager* am,
     return torchFire;
 }
 //-----------------------------------------------------------------------------
+//! Returns the settings for the LOD generation of the big erleb-AR models
+/*! The simplified levels get cached in the config directory, so that they
+ are only generated at the first load of a model.
+ */
+SLNodeLODSettings cityLODSettings()
+{
+    SLNodeLODSettings settings;
+    settings.cacheDir = AppDemo::configPath + "lods/";
+    if (!Utils::dirExists(settings.cacheDir))
+        Utils::makeDirRecurse(settings.cacheDir);
+    return settings;
+}
+//-----------------------------------------------------------------------------
 //! appDemoLoadScene builds a scene from source code.
 /*! appDemoLoadScene builds a scene from source code. Such a function must be
  passed as a void*-pointer to slCreateScene. It will be called from within
@@ -4010,6 +4023,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
 
         // Import the main model
         SLAssimpImporter importer;
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          bern = importer.load(s->animManager(),
                                      am,
                                      dataPath + "erleb-AR/models/bern/bern-christoffel.gltf",
@@ -4169,6 +4183,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
         AppDemo::devLoc.sunLightNode(sunLight);
 
         SLAssimpImporter importer;
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          bfh = importer.load(s->animManager(),
                                     am,
                                     dataPath + "erleb-AR/models/biel/Biel-BFH-Rolex.gltf",
@@ -4290,6 +4305,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
 
         // Load main model
         SLAssimpImporter importer; //(LV_diagnostic);
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          thtAndTmp = importer.load(s->animManager(),
                                           am,
                                           datDir + "augst-thtL2-tmpL1.gltf",
@@ -4436,6 +4452,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
 
         // Load main model
         SLAssimpImporter importer; //(LV_diagnostic);
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          thtAndTmp = importer.load(s->animManager(),
                                           am,
                                           datDir + "augst-thtL1-tmpL2.gltf",
@@ -4583,6 +4600,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
 
         // Load main model
         SLAssimpImporter importer; //(LV_diagnostic);
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          thtAndTmp = importer.load(s->animManager(),
                                           am,
                                           datDir + "augst-thtL1L2-tmpL1L2.gltf",
@@ -4763,6 +4781,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
         AppDemo::devLoc.sunLightNode(sunLight);
 
         SLAssimpImporter importer;
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          amphiTheatre = importer.load(s->animManager(),
                                              am,
                                              dataPath + "erleb-AR/models/avenches/avenches-amphitheater.gltf",
@@ -4887,6 +4906,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
         AppDemo::devLoc.sunLightNode(sunLight);
 
         SLAssimpImporter importer;
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          cigognier = importer.load(s->animManager(),
                                           am,
                                           dataPath + "erleb-AR/models/avenches/avenches-cigognier.gltf",
@@ -5007,6 +5027,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
         AppDemo::devLoc.sunLightNode(sunLight);
 
         SLAssimpImporter importer;
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          theatre = importer.load(s->animManager(),
                                         am,
                                         dataPath + "erleb-AR/models/avenches/avenches-theater.gltf",
@@ -5128,6 +5149,7 @@ resolution shadows near the camera and lower resolution shadows further away.");
 
         // Import main model
         SLAssimpImporter importer;
+        importer.generateLODs(true, cityLODSettings());
         SLNode*          sutzK18 = importer.load(s->animManager(),
                                         am,
                                         dataPath + "erleb-AR/models/sutzKirchrain18/Sutz-Kirchrain18.gltf",
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <Utils.h>
+#include <WAISlamBenchmark.h>
+
+//-----------------------------------------------------------------------------
+static void printUsage()
+{
+    std::cout << "Usage:\n"
+              << "  app-WAI-SlamBenchmark --voc <vocabulary> [options] <sequence dirs...>\n"
+              << "  app-WAI-SlamBenchmark --compare <base.json> <new.json> [--threshold <percent>]\n"
+              << "Options:\n"
+              << "  --out <name>        base name of the result files <name>.json and <name>.csv (default: benchmark)\n"
+              << "  --width <pix>       frames are scaled to this width (0: original size, default: 640)\n"
+              << "  --features <n>      number of ORB features (default: 1000)\n"
+              << "  --levels <n>        number of pyramid levels (default: 8)\n"
+              << "  --max-frames <n>    max. number of frames per sequence (default: all)\n"
+              << "  --threaded          run local mapping and loop closing in their own threads (not reproducible)\n"
+              << "A sequence directory is a SENSRecorder output directory (containing camera.txt) or a\n"
+              << "directory containing such directories.\n";
+}
+//-----------------------------------------------------------------------------
+//! collect the recorded sequences in dir (the dir itself or its sub directories)
+static void findSequences(const std::string& dir, std::vector<std::string>& sequences)
+{
+    std::string unified = Utils::unifySlashes(dir);
+    if (Utils::fileExists(unified + "camera.txt"))
+    {
+        sequences.push_back(unified);
+        return;
+    }
+
+    for (const std::string& subDir : Utils::getDirNamesInDir(unified))
+    {
+        std::string unifiedSubDir = Utils::unifySlashes(subDir);
+        if (Utils::fileExists(unifiedSubDir + "camera.txt"))
+            sequences.push_back(unifiedSubDir);
+    }
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    WAIBenchmarkSettings     settings;
+    std::string              outName = "benchmark";
+    std::vector<std::string> sequences;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--compare" && i + 2 < argc)
+            {
+                std::string baseFile  = argv[++i];
+                std::string newFile   = argv[++i];
+                float       threshold = 5.0f;
+                if (i + 2 < argc && std::string(argv[i + 1]) == "--threshold")
+                {
+                    threshold = std::stof(argv[i + 2]);
+                    i += 2;
+                }
+                int numRegressions = WAISlamBenchmark::compare(baseFile, newFile, threshold);
+                return numRegressions == 0 ? 0 : 1;
+            }
+            else if (arg == "--voc" && i + 1 < argc)
+                settings.vocabularyFile = argv[++i];
+            else if (arg == "--out" && i + 1 < argc)
+                outName = argv[++i];
+            else if (arg == "--width" && i + 1 < argc)
+                settings.imageWidth = std::stoi(argv[++i]);
+            else if (arg == "--features" && i + 1 < argc)
+                settings.nFeatures = std::stoi(argv[++i]);
+            else if (arg == "--levels" && i + 1 < argc)
+                settings.nLevels = std::stoi(argv[++i]);
+            else if (arg == "--max-frames" && i + 1 < argc)
+                settings.maxFrames = std::stoi(argv[++i]);
+            else if (arg == "--threaded")
+                settings.serial = false;
+            else if (arg.rfind("--", 0) == 0)
+            {
+                printUsage();
+                return 2;
+            }
+            else
+                findSequences(arg, sequences);
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cout << "Invalid argument: " << e.what() << "\n";
+        printUsage();
+        return 2;
+    }
+
+    if (settings.vocabularyFile.empty() || sequences.empty())
+    {
+        printUsage();
+        return 2;
+    }
+
+    WAISlamBenchmark benchmark(settings);
+    if (!benchmark.isValid())
+    {
+        std::cout << "Could not load vocabulary " << settings.vocabularyFile << "\n";
+        return 2;
+    }
+
+    std::vector<WAIBenchmarkResult> results;
+    for (const std::string& sequence : sequences)
+    {
+        WAIBenchmarkResult result;
+        if (benchmark.runSequence(sequence, result))
+            results.push_back(result);
+        else
+            std::cout << "Skipped sequence " << sequence << "\n";
+    }
+
+    WAISlamBenchmark::writeJson(outName + ".json", settings, results);
+    WAISlamBenchmark::writeCsv(outName + ".csv", results);
+
+    return results.empty() ? 1 : 0;
+}
+//-----------------------------------------------------------------------------
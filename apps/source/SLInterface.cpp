@@ -211,7 +211,7 @@ void slTerminate()
     // Deletes all remaining sceneviews the current scene instance
     AppDemo::deleteAppAndScene();
 
-    // For more info on PROFILING read Utils/lib-utils/source/Profilerrumentor.h
+    // For more info on PROFILING read Utils/lib-utils/source/Profiler.h
 #if PROFILING
     SLstring filePathName = PROFILER_TRACE_FILE_PATH;
 
@@ -219,11 +219,10 @@ void slTerminate()
     END_PROFILING_SESSION();
     SL_LOG("After END_PROFILING_SESSION");
 
-    Profiler::instance().endSession();
-
     if (Utils::fileExists(filePathName))
     {
         SL_LOG("Profile written : %s", filePathName.c_str());
+        SL_LOG("Chrome trace    : %s", Profiler::instance().chromeTraceFilePath().c_str());
         /*
         //ZipUtils::zip("/Users/hudrima1/Library/Application Support/SLProject/DEVELOPMENT-map_20200529-154142_avenches_aamphitheater_FAST_ORBS_2000.json");
 
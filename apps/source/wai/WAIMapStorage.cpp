@@ -807,7 +807,7 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
                                              keyPtsUndist.size(),
                                              keyPtsUndist,
                                              featureDescriptors,
-                                             voc,
+                                             nullptr,
                                              nScaleLevels,
                                              scaleFactor,
                                              vScaleFactor,
@@ -851,6 +851,9 @@ bool WAIMapStorage::loadMapBinary(WAIMap*           waiMap,
         bestCovisibleWeightsMap[newKf->mnId]     = bestCovisibleWeights;
     }
 
+    // compute the bag of words of all keyframes at once (stored bow vectors are kept)
+    WAIKeyFrame::ComputeBoW(keyFrames, voc);
+
     // set parent keyframe pointers into keyframes
     for (WAIKeyFrame* kf : keyFrames)
     {
@@ -1216,7 +1219,7 @@ bool WAIMapStorage::loadMap(WAIMap*           waiMap,
                                              keyPtsUndist.size(),
                                              keyPtsUndist,
                                              featureDescriptors,
-                                             voc,
+                                             nullptr,
                                              nScaleLevels,
                                              scaleFactor,
                                              vScaleFactor,
@@ -1266,6 +1269,9 @@ bool WAIMapStorage::loadMap(WAIMap*           waiMap,
         }
     }
 
+    // compute the bag of words of all keyframes at once (stored bow vectors are kept)
+    WAIKeyFrame::ComputeBoW(keyFrames, voc);
+
     // set parent keyframe pointers into keyframes
     for (WAIKeyFrame* kf : keyFrames)
     {
@@ -0,0 +1,515 @@
+#include "WAISlamBenchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <opencv2/imgproc.hpp>
+#include <json.hpp>
+#include <Utils.h>
+#include <HighResTimer.h>
+#include <orb_slam/ORBextractor.h>
+#include <SENSSimulator.h>
+#include <SENSCalibration.h>
+#include <SENSUtils.h>
+
+#define WAIBENCHMARK_INFO(...) Utils::log("WAIBenchmark", __VA_ARGS__)
+#define WAIBENCHMARK_WARN(...) Utils::log("WAIBenchmark", __VA_ARGS__)
+
+using json = nlohmann::json;
+
+//-----------------------------------------------------------------------------
+WAISlamBenchmark::WAISlamBenchmark(const WAIBenchmarkSettings& settings)
+  : _settings(settings)
+{
+    try
+    {
+        _voc = new WAIOrbVocabulary();
+        _voc->loadFromFile(_settings.vocabularyFile);
+    }
+    catch (std::exception& e)
+    {
+        WAIBENCHMARK_WARN("%s", e.what());
+        delete _voc;
+        _voc = nullptr;
+    }
+}
+//-----------------------------------------------------------------------------
+WAISlamBenchmark::~WAISlamBenchmark()
+{
+    delete _voc;
+}
+//-----------------------------------------------------------------------------
+bool WAISlamBenchmark::runSequence(const std::string& sequenceDir, WAIBenchmarkResult& result)
+{
+    std::string dir = Utils::unifySlashes(sequenceDir);
+    result          = WAIBenchmarkResult();
+    result.name     = Utils::getFileName(dir.substr(0, dir.size() - 1));
+
+    if (!_voc)
+        return false;
+
+    SENSSimulator        simulator(dir);
+    SENSSimulatedCamera* camera = simulator.getCameraSensorPtr();
+    if (!camera)
+    {
+        WAIBENCHMARK_WARN("No camera recording found in %s", dir.c_str());
+        return false;
+    }
+
+    // every recorded frame is processed exactly once, independent of the processing time
+    simulator.setReplayMode(SENSSimMode::LOCK_STEP);
+
+    const SENSCameraConfig cameraConfig = camera->config();
+    camera->start(cameraConfig.deviceId, cameraConfig.streamConfig);
+
+    std::unique_ptr<ORB_SLAM2::ORBextractor> trackingExtractor;
+    std::unique_ptr<ORB_SLAM2::ORBextractor> initializationExtractor;
+    std::unique_ptr<WAISlam>                 slam;
+
+    double sumExtractionMS = 0.0, sumTrackingMS = 0.0, sumLocalMappingMS = 0.0, sumLoopClosingMS = 0.0, sumTotalMS = 0.0;
+    int    numFramesSinceInit = 0;
+
+    cv::Mat imageGray;
+    while (SENSFrameBasePtr sensFrame = camera->latestFrame())
+    {
+        if (_settings.maxFrames > 0 && result.numFrames >= _settings.maxFrames)
+            break;
+
+        cv::cvtColor(sensFrame->imgBGR, imageGray, cv::COLOR_BGR2GRAY);
+        if (_settings.imageWidth > 0 && imageGray.cols != _settings.imageWidth)
+        {
+            float scale = (float)_settings.imageWidth / (float)imageGray.cols;
+            cv::resize(imageGray, imageGray, cv::Size(), scale, scale);
+        }
+
+        // the calibration depends on the size of the first frame
+        if (!slam)
+        {
+            std::unique_ptr<SENSCalibration> calib;
+            if (Utils::fileExists(dir + _settings.calibFileName))
+                calib = std::make_unique<SENSCalibration>(dir, _settings.calibFileName, false);
+            else
+            {
+                float fovHDeg = _settings.fovDegGuess;
+                if (cameraConfig.streamConfig.focalLengthPix > 0)
+                    fovHDeg = SENS::calcFOVDegFromFocalLengthPix(cameraConfig.streamConfig.focalLengthPix,
+                                                                 cameraConfig.streamConfig.widthPix);
+                calib = std::make_unique<SENSCalibration>(sensFrame->imgBGR.size(),
+                                                          fovHDeg,
+                                                          false,
+                                                          false,
+                                                          SENSCameraType::BACKFACING,
+                                                          Utils::ComputerInfos::get());
+            }
+            calib->adaptForNewResolution(imageGray.size(), false);
+
+            trackingExtractor       = std::make_unique<ORB_SLAM2::ORBextractor>(_settings.nFeatures,
+                                                                          _settings.scaleFactor,
+                                                                          _settings.nLevels,
+                                                                          _settings.iniThFAST,
+                                                                          _settings.minThFAST);
+            initializationExtractor = std::make_unique<ORB_SLAM2::ORBextractor>(2 * _settings.nFeatures,
+                                                                                _settings.scaleFactor,
+                                                                                _settings.nLevels,
+                                                                                _settings.iniThFAST,
+                                                                                _settings.minThFAST);
+            WAISlam::Params params;
+            params.serial = _settings.serial;
+
+            slam = std::make_unique<WAISlam>(calib->cameraMat(),
+                                             calib->distortion(),
+                                             _voc,
+                                             initializationExtractor.get(),
+                                             trackingExtractor.get(),
+                                             trackingExtractor.get(),
+                                             nullptr,
+                                             params);
+        }
+
+        // process synchronously (WAISlam::update would queue the frame for the pose update thread)
+        HighResTimer t;
+        WAIFrame     frame;
+        slam->createFrame(frame, imageGray);
+        slam->updatePose(frame);
+
+        WAIBenchmarkFrame f;
+        f.index   = result.numFrames;
+        f.timeUs  = std::chrono::time_point_cast<SENSMicroseconds>(sensFrame->timePt).time_since_epoch().count();
+        f.totalMS = t.elapsedTimeInMilliSec();
+        f.timings = slam->getLastStageTimings();
+        f.state   = slam->getTrackingState();
+
+        WAIFrame* lastFrame = slam->getLastFramePtr();
+        if (lastFrame && (f.state == WAITrackingState::TrackingOK || f.state == WAITrackingState::TrackingStart) && !lastFrame->mTcw.empty())
+        {
+            cv::Mat camPos = lastFrame->GetCameraCenter();
+            f.hasPose      = true;
+            f.camPos       = cv::Point3d(camPos.at<float>(0), camPos.at<float>(1), camPos.at<float>(2));
+        }
+
+        if (f.hasPose)
+        {
+            result.numTracked++;
+            if (result.initFrameIndex < 0)
+                result.initFrameIndex = f.index;
+        }
+        if (result.initFrameIndex >= 0)
+        {
+            numFramesSinceInit++;
+            if (f.state == WAITrackingState::TrackingLost)
+                result.numLost++;
+        }
+
+        sumExtractionMS += f.timings.extractionMS;
+        sumTrackingMS += f.timings.trackingMS;
+        sumLocalMappingMS += f.timings.localMappingMS;
+        sumLoopClosingMS += f.timings.loopClosingMS;
+        sumTotalMS += f.totalMS;
+        result.maxTotalMS = std::max(result.maxTotalMS, f.totalMS);
+
+        result.frames.push_back(f);
+        result.numFrames++;
+    }
+
+    camera->stop();
+
+    if (result.numFrames)
+    {
+        result.avgExtractionMS   = (float)(sumExtractionMS / result.numFrames);
+        result.avgTrackingMS     = (float)(sumTrackingMS / result.numFrames);
+        result.avgLocalMappingMS = (float)(sumLocalMappingMS / result.numFrames);
+        result.avgLoopClosingMS  = (float)(sumLoopClosingMS / result.numFrames);
+        result.avgTotalMS        = (float)(sumTotalMS / result.numFrames);
+        result.fps               = sumTotalMS > 0.0 ? (float)(1000.0 * result.numFrames / sumTotalMS) : 0.0f;
+    }
+    if (numFramesSinceInit)
+        result.trackingLostRatio = (float)result.numLost / (float)numFramesSinceInit;
+    if (slam)
+    {
+        result.numKeyFrames      = slam->getKeyFrameCount();
+        result.numMapPoints      = slam->getMapPointCount();
+        result.avgBowTransformMS = _voc->transformTimeMS();
+    }
+
+    evaluateTrajectory(dir + _settings.referenceFileName, result);
+
+    WAIBENCHMARK_INFO("%s: %d frames, %.1f fps, lost ratio %.3f, ATE %.4f",
+                      result.name.c_str(),
+                      result.numFrames,
+                      result.fps,
+                      result.trackingLostRatio,
+                      result.ateRMSE);
+    return result.numFrames > 0;
+}
+//-----------------------------------------------------------------------------
+void WAISlamBenchmark::evaluateTrajectory(const std::string& referenceFileName, WAIBenchmarkResult& result)
+{
+    std::vector<std::pair<long long, cv::Point3d>> reference;
+    if (!loadReference(referenceFileName, reference) || reference.empty())
+        return;
+
+    // associate every estimated pose with the closest reference pose in time
+    const long long          maxTimeDiffUs = 20000;
+    std::vector<cv::Point3d> est, ref;
+    for (const WAIBenchmarkFrame& f : result.frames)
+    {
+        if (!f.hasPose)
+            continue;
+
+        auto it = std::lower_bound(reference.begin(),
+                                   reference.end(),
+                                   f.timeUs,
+                                   [](const std::pair<long long, cv::Point3d>& r, long long t) { return r.first < t; });
+
+        auto best = reference.end();
+        if (it != reference.end())
+            best = it;
+        if (it != reference.begin() && (best == reference.end() || f.timeUs - (it - 1)->first < best->first - f.timeUs))
+            best = it - 1;
+
+        if (best != reference.end() && std::abs(best->first - f.timeUs) <= maxTimeDiffUs)
+        {
+            est.push_back(f.camPos);
+            ref.push_back(best->second);
+        }
+    }
+
+    result.numRefMatches = (int)est.size();
+    if (est.size() >= 3)
+        result.ateRMSE = absoluteTrajectoryError(est, ref, result.ateScale);
+}
+//-----------------------------------------------------------------------------
+bool WAISlamBenchmark::loadReference(const std::string&                               fileName,
+                                     std::vector<std::pair<long long, cv::Point3d>>& reference)
+{
+    std::ifstream file(fileName);
+    if (!file.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ss(line);
+        long long          timeUs;
+        cv::Point3d        p;
+        if (ss >> timeUs >> p.x >> p.y >> p.z)
+            reference.emplace_back(timeUs, p);
+    }
+
+    std::sort(reference.begin(),
+              reference.end(),
+              [](const std::pair<long long, cv::Point3d>& a, const std::pair<long long, cv::Point3d>& b) { return a.first < b.first; });
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+ Monocular SLAM has an arbitrary scale, so the estimated positions are aligned
+ to the reference with a similarity transform (Umeyama 1991) before the RMSE
+ of the position differences is computed.
+ */
+double WAISlamBenchmark::absoluteTrajectoryError(const std::vector<cv::Point3d>& estimated,
+                                                 const std::vector<cv::Point3d>& reference,
+                                                 double&                         scale)
+{
+    size_t n = std::min(estimated.size(), reference.size());
+    if (n < 3)
+        return -1.0;
+
+    cv::Point3d meanEst(0, 0, 0), meanRef(0, 0, 0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        meanEst += estimated[i];
+        meanRef += reference[i];
+    }
+    meanEst *= 1.0 / (double)n;
+    meanRef *= 1.0 / (double)n;
+
+    cv::Matx33d sigma = cv::Matx33d::zeros();
+    double      varEst = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        cv::Vec3d e(estimated[i] - meanEst);
+        cv::Vec3d r(reference[i] - meanRef);
+        sigma += r * e.t();
+        varEst += e.dot(e);
+    }
+    sigma *= 1.0 / (double)n;
+    varEst /= (double)n;
+    if (varEst <= 0.0)
+        return -1.0;
+
+    cv::Mat w, u, vt;
+    cv::SVD::compute(cv::Mat(sigma), w, u, vt);
+    cv::Matx33d U(u), Vt(vt);
+    cv::Matx33d S = cv::Matx33d::eye();
+    if (cv::determinant(U) * cv::determinant(Vt) < 0.0)
+        S(2, 2) = -1.0;
+
+    cv::Matx33d R = U * S * Vt;
+    scale         = (w.at<double>(0) * S(0, 0) + w.at<double>(1) * S(1, 1) + w.at<double>(2) * S(2, 2)) / varEst;
+    cv::Vec3d t   = cv::Vec3d(meanRef) - scale * (R * cv::Vec3d(meanEst));
+
+    double sumSqErr = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        cv::Vec3d aligned = scale * (R * cv::Vec3d(estimated[i])) + t;
+        cv::Vec3d diff    = aligned - cv::Vec3d(reference[i]);
+        sumSqErr += diff.dot(diff);
+    }
+
+    return std::sqrt(sumSqErr / (double)n);
+}
+//-----------------------------------------------------------------------------
+bool WAISlamBenchmark::writeJson(const std::string&                     fileName,
+                                 const WAIBenchmarkSettings&            settings,
+                                 const std::vector<WAIBenchmarkResult>& results)
+{
+    json j;
+    j["settings"] = {{"vocabularyFile", Utils::getFileName(settings.vocabularyFile)},
+                     {"nFeatures", settings.nFeatures},
+                     {"scaleFactor", settings.scaleFactor},
+                     {"nLevels", settings.nLevels},
+                     {"iniThFAST", settings.iniThFAST},
+                     {"minThFAST", settings.minThFAST},
+                     {"imageWidth", settings.imageWidth},
+                     {"serial", settings.serial},
+                     {"maxFrames", settings.maxFrames}};
+
+    j["sequences"] = json::array();
+    for (const WAIBenchmarkResult& r : results)
+    {
+        j["sequences"].push_back({{"name", r.name},
+                                  {"numFrames", r.numFrames},
+                                  {"numTracked", r.numTracked},
+                                  {"numLost", r.numLost},
+                                  {"initFrameIndex", r.initFrameIndex},
+                                  {"trackingLostRatio", r.trackingLostRatio},
+                                  {"fps", r.fps},
+                                  {"avgExtractionMS", r.avgExtractionMS},
+                                  {"avgTrackingMS", r.avgTrackingMS},
+                                  {"avgLocalMappingMS", r.avgLocalMappingMS},
+                                  {"avgLoopClosingMS", r.avgLoopClosingMS},
+                                  {"avgBowTransformMS", r.avgBowTransformMS},
+                                  {"avgTotalMS", r.avgTotalMS},
+                                  {"maxTotalMS", r.maxTotalMS},
+                                  {"numKeyFrames", r.numKeyFrames},
+                                  {"numMapPoints", r.numMapPoints},
+                                  {"numRefMatches", r.numRefMatches},
+                                  {"ateRMSE", r.ateRMSE},
+                                  {"ateScale", r.ateScale}});
+    }
+
+    std::ofstream file(fileName);
+    if (!file.is_open())
+    {
+        WAIBENCHMARK_WARN("Could not write %s", fileName.c_str());
+        return false;
+    }
+    file << std::setw(4) << j << std::endl;
+    return true;
+}
+//-----------------------------------------------------------------------------
+bool WAISlamBenchmark::writeCsv(const std::string&                     fileName,
+                                const std::vector<WAIBenchmarkResult>& results)
+{
+    std::ofstream file(fileName);
+    if (!file.is_open())
+    {
+        WAIBENCHMARK_WARN("Could not write %s", fileName.c_str());
+        return false;
+    }
+
+    file << "sequence,frame,timeUs,state,extractionMS,trackingMS,localMappingMS,loopClosingMS,totalMS,hasPose,x,y,z\n";
+    for (const WAIBenchmarkResult& r : results)
+    {
+        for (const WAIBenchmarkFrame& f : r.frames)
+        {
+            file << r.name << ","
+                 << f.index << ","
+                 << f.timeUs << ","
+                 << (int)f.state << ","
+                 << f.timings.extractionMS << ","
+                 << f.timings.trackingMS << ","
+                 << f.timings.localMappingMS << ","
+                 << f.timings.loopClosingMS << ","
+                 << f.totalMS << ","
+                 << (f.hasPose ? 1 : 0) << ","
+                 << f.camPos.x << ","
+                 << f.camPos.y << ","
+                 << f.camPos.z << "\n";
+        }
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+ Timings and the trajectory error are regressions if they increase by more than
+ thresholdPercent. The tracking lost ratio is a regression if it increases by
+ more than thresholdPercent percentage points and fps if it drops by more than
+ thresholdPercent.
+ */
+int WAISlamBenchmark::compare(const std::string& baseFileName,
+                              const std::string& newFileName,
+                              float              thresholdPercent)
+{
+    json          base, next;
+    std::ifstream baseFile(baseFileName), newFile(newFileName);
+    if (!baseFile.is_open() || !newFile.is_open())
+    {
+        WAIBENCHMARK_WARN("Could not open %s or %s", baseFileName.c_str(), newFileName.c_str());
+        return -1;
+    }
+
+    try
+    {
+        baseFile >> base;
+        newFile >> next;
+    }
+    catch (std::exception& e)
+    {
+        WAIBENCHMARK_WARN("Could not parse result files: %s", e.what());
+        return -1;
+    }
+
+    if (base["settings"] != next["settings"])
+        std::cout << "Warning: the runs were made with different settings\n";
+
+    enum CompareType
+    {
+        CT_LowerIsBetter,
+        CT_HigherIsBetter,
+        CT_Ratio
+    };
+    const std::vector<std::pair<std::string, CompareType>> metrics = {{"avgExtractionMS", CT_LowerIsBetter},
+                                                                      {"avgTrackingMS", CT_LowerIsBetter},
+                                                                      {"avgLocalMappingMS", CT_LowerIsBetter},
+                                                                      {"avgLoopClosingMS", CT_LowerIsBetter},
+                                                                      {"avgBowTransformMS", CT_LowerIsBetter},
+                                                                      {"avgTotalMS", CT_LowerIsBetter},
+                                                                      {"fps", CT_HigherIsBetter},
+                                                                      {"trackingLostRatio", CT_Ratio},
+                                                                      {"ateRMSE", CT_LowerIsBetter}};
+
+    int numRegressions = 0;
+    std::cout << std::left << std::setw(24) << "sequence" << std::setw(20) << "metric"
+              << std::right << std::setw(12) << "base" << std::setw(12) << "new" << std::setw(10) << "change" << "\n";
+
+    for (const json& baseSeq : base["sequences"])
+    {
+        const std::string name = baseSeq["name"];
+        auto              it   = std::find_if(next["sequences"].begin(),
+                                       next["sequences"].end(),
+                                       [&](const json& s) { return s["name"] == name; });
+        if (it == next["sequences"].end())
+        {
+            std::cout << std::left << std::setw(24) << name << "missing in " << newFileName << "\n";
+            numRegressions++;
+            continue;
+        }
+
+        for (const auto& metric : metrics)
+        {
+            // metric added after one of the runs
+            if (!baseSeq.contains(metric.first) || !it->contains(metric.first))
+                continue;
+
+            double baseVal = baseSeq[metric.first].get<double>();
+            double newVal  = (*it)[metric.first].get<double>();
+
+            // no trajectory error available
+            if (metric.first == "ateRMSE" && (baseVal < 0.0 || newVal < 0.0))
+                continue;
+
+            double change; // in percent (percentage points for ratios), positive means worse
+            if (metric.second == CT_Ratio)
+                change = 100.0 * (newVal - baseVal);
+            else if (baseVal != 0.0)
+                change = 100.0 * (newVal - baseVal) / std::abs(baseVal);
+            else
+                change = newVal != 0.0 ? 100.0 : 0.0;
+            if (metric.second == CT_HigherIsBetter)
+                change = -change;
+
+            bool isRegression = change > thresholdPercent;
+            if (isRegression)
+                numRegressions++;
+
+            std::cout << std::left << std::setw(24) << name << std::setw(20) << metric.first
+                      << std::right << std::fixed << std::setprecision(3)
+                      << std::setw(12) << baseVal << std::setw(12) << newVal
+                      << std::setprecision(1) << std::setw(9) << change << "%"
+                      << (isRegression ? "  REGRESSION" : "") << "\n";
+        }
+    }
+
+    std::cout << numRegressions << " regression(s) above " << thresholdPercent << "%\n";
+    return numRegressions;
+}
+//-----------------------------------------------------------------------------
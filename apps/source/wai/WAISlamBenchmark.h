@@ -0,0 +1,117 @@
+#ifndef WAI_SLAM_BENCHMARK_H
+#define WAI_SLAM_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <opencv2/core.hpp>
+#include <WAISlam.h>
+#include <WAIOrbVocabulary.h>
+
+//-----------------------------------------------------------------------------
+//! Settings of a benchmark run (runs that are compared should use the same settings)
+struct WAIBenchmarkSettings
+{
+    std::string vocabularyFile;
+    int         nFeatures   = 1000; // NO. of features
+    float       scaleFactor = 1.2f; // Scale factor for pyramid construction
+    int         nLevels     = 8;    // NO. of pyramid levels
+    int         iniThFAST   = 20;   // Init threshold for FAST corner detector
+    int         minThFAST   = 7;    // Min. threshold for FAST corner detector
+    // frames are scaled to this width before processing (0: original size)
+    int imageWidth = 640;
+    // run local mapping and loop closing in the tracking thread (needed for reproducible results)
+    bool serial = true;
+    // max. number of frames processed per sequence (0: all)
+    int maxFrames = 0;
+    // horizontal field of view used if there is no calibration file and no focal length in the camera config
+    float       fovDegGuess       = 65.0f;
+    std::string calibFileName     = "calibration.xml";
+    std::string referenceFileName = "reference.txt";
+};
+//-----------------------------------------------------------------------------
+//! Measurements of one processed frame
+struct WAIBenchmarkFrame
+{
+    int                   index   = 0;
+    long long             timeUs  = 0;
+    WAITrackingState      state   = WAITrackingState::None;
+    float                 totalMS = 0.0f;
+    WAISlam::StageTimings timings;
+    bool                  hasPose = false;
+    cv::Point3d           camPos; // camera position in world coordinates (valid if hasPose)
+};
+//-----------------------------------------------------------------------------
+//! Summary of the benchmark of one recorded sequence
+struct WAIBenchmarkResult
+{
+    std::string name;
+    int         numFrames         = 0;
+    int         numTracked        = 0;
+    int         numLost           = 0;
+    int         initFrameIndex    = -1;   // index of first frame with a valid pose
+    float       trackingLostRatio = 1.0f; // lost frames / frames after initialization
+    float       fps               = 0.0f; // processed frames per second (without video decoding)
+    float       avgExtractionMS   = 0.0f;
+    float       avgTrackingMS     = 0.0f;
+    float       avgLocalMappingMS = 0.0f;
+    float       avgLoopClosingMS  = 0.0f;
+    float       avgBowTransformMS = 0.0f; // vocabulary transform per frame (part of tracking and local mapping)
+    float       avgTotalMS        = 0.0f;
+    float       maxTotalMS        = 0.0f;
+    int         numKeyFrames      = 0;
+    int         numMapPoints      = 0;
+    int         numRefMatches     = 0;    // estimated poses that could be associated with a reference pose
+    double      ateRMSE           = -1.0; // absolute trajectory error after similarity alignment (-1: no reference)
+    double      ateScale          = 0.0;  // scale of the similarity alignment
+
+    std::vector<WAIBenchmarkFrame> frames;
+};
+//-----------------------------------------------------------------------------
+/*!
+ Headless benchmark of WAISlam over sequences that were recorded with SENSRecorder.
+ The sequences are replayed with SENSSimulator in lock-step mode, so every recorded
+ frame is processed exactly once. With settings.serial local mapping and loop closing
+ run in the tracking thread and the results are reproducible.
+ Optionally a sequence directory may contain a calibration file and a reference
+ trajectory ("<timeUs> <x> <y> <z> [...]" per line) to compute the absolute trajectory error.
+ */
+class WAISlamBenchmark
+{
+public:
+    explicit WAISlamBenchmark(const WAIBenchmarkSettings& settings);
+    ~WAISlamBenchmark();
+
+    //! returns false if the vocabulary could not be loaded
+    bool isValid() const { return _voc != nullptr; }
+    //! run WAISlam over all frames of a recorded sequence
+    bool runSequence(const std::string& sequenceDir, WAIBenchmarkResult& result);
+
+    //! write settings and per sequence summaries as JSON
+    static bool writeJson(const std::string&                     fileName,
+                          const WAIBenchmarkSettings&            settings,
+                          const std::vector<WAIBenchmarkResult>& results);
+    //! write per frame measurements of all sequences as CSV
+    static bool writeCsv(const std::string&                     fileName,
+                         const std::vector<WAIBenchmarkResult>& results);
+    //! compare two JSON result files. Prints a table and returns the number of regressions above thresholdPercent (-1 on error)
+    static int compare(const std::string& baseFileName,
+                       const std::string& newFileName,
+                       float              thresholdPercent);
+
+    //! load reference camera positions sorted by time
+    static bool loadReference(const std::string&                               fileName,
+                              std::vector<std::pair<long long, cv::Point3d>>& reference);
+    //! RMSE of the estimated positions after similarity alignment (Umeyama) to the reference positions
+    static double absoluteTrajectoryError(const std::vector<cv::Point3d>& estimated,
+                                          const std::vector<cv::Point3d>& reference,
+                                          double&                         scale);
+
+private:
+    void evaluateTrajectory(const std::string& referenceFileName, WAIBenchmarkResult& result);
+
+    WAIBenchmarkSettings _settings;
+    WAIOrbVocabulary*    _voc = nullptr;
+};
+//-----------------------------------------------------------------------------
+#endif // WAI_SLAM_BENCHMARK_H
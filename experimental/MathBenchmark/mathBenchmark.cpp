@@ -0,0 +1,319 @@
+// Checks the SIMD specializations of SLMat4f (see SLMathSimd.h) against scalar
+// reference implementations and measures both. The references are the
+// formulas of the SLMat4 template, the inverse is compared with SLMat4<double>.
+// Returns 1 if a result differs more than the tolerance.
+// Usage: app-MathBenchmark [numElements] [numRepetitions]
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <SLMat4.h>
+#include <Utils.h>
+
+//-----------------------------------------------------------------------------
+static double msSince(std::chrono::high_resolution_clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+}
+//-----------------------------------------------------------------------------
+//! Scalar reference of SLMat4::multiply (this * A)
+static SLMat4f refMultiply(const SLMat4f& M, const SLMat4f& A)
+{
+    const SLfloat* m = M.m();
+    const SLfloat* a = A.m();
+    SLfloat        r[16];
+    for (int c = 0; c < 4; ++c)
+        for (int row = 0; row < 4; ++row)
+            r[4 * c + row] = m[row] * a[4 * c] + m[4 + row] * a[4 * c + 1] +
+                             m[8 + row] * a[4 * c + 2] + m[12 + row] * a[4 * c + 3];
+    return SLMat4f(r);
+}
+//-----------------------------------------------------------------------------
+//! Scalar reference of SLMat4::multVec for SLVec3 with perspective division
+static SLVec3f refMultVec(const SLMat4f& M, const SLVec3f& v)
+{
+    const SLfloat* m = M.m();
+    SLfloat        W = 1 / (m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15]);
+    return SLVec3f((m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12]) * W,
+                   (m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13]) * W,
+                   (m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14]) * W);
+}
+//-----------------------------------------------------------------------------
+//! Scalar reference of SLMat4::multVec for SLVec4
+static SLVec4f refMultVec(const SLMat4f& M, const SLVec4f& v)
+{
+    const SLfloat* m = M.m();
+    return SLVec4f(m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12] * v.w,
+                   m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13] * v.w,
+                   m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14] * v.w,
+                   m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15] * v.w);
+}
+//-----------------------------------------------------------------------------
+//! Scalar reference of SLMat4::transformAABB with the 8 corners
+static void refTransformAABB(const SLMat4f& M,
+                             const SLVec3f& mn,
+                             const SLVec3f& mx,
+                             SLVec3f&       minWS,
+                             SLVec3f&       maxWS)
+{
+    minWS = maxWS = refMultVec(M, mn);
+    for (int i = 1; i < 8; ++i)
+    {
+        SLVec3f c = refMultVec(M,
+                               SLVec3f(i & 1 ? mx.x : mn.x,
+                                       i & 2 ? mx.y : mn.y,
+                                       i & 4 ? mx.z : mn.z));
+        minWS.setMin(c);
+        maxWS.setMax(c);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns a random affine matrix with rotation, non uniform scale & translation
+static SLMat4f randomMatrix()
+{
+    SLMat4f m;
+    m.translate(Utils::random(-10.0f, 10.0f),
+                Utils::random(-10.0f, 10.0f),
+                Utils::random(-10.0f, 10.0f));
+    m.rotate(Utils::random(0.0f, 360.0f),
+             Utils::random(-1.0f, 1.0f),
+             Utils::random(-1.0f, 1.0f),
+             Utils::random(0.1f, 1.0f));
+    m.scale(Utils::random(0.2f, 5.0f),
+            Utils::random(0.2f, 5.0f),
+            Utils::random(0.2f, 5.0f));
+    return m;
+}
+//-----------------------------------------------------------------------------
+//! Returns a random perspective projection times a random affine matrix
+static SLMat4f randomProjection()
+{
+    SLMat4f p;
+    p.perspective(Utils::random(20.0f, 90.0f), Utils::random(0.5f, 2.0f), 0.1f, 100.0f);
+    return p * randomMatrix();
+}
+//-----------------------------------------------------------------------------
+static SLVec3f randomVec3()
+{
+    return SLVec3f(Utils::random(-10.0f, 10.0f),
+                   Utils::random(-10.0f, 10.0f),
+                   Utils::random(-10.0f, 10.0f));
+}
+//-----------------------------------------------------------------------------
+//! Returns the largest difference relative to the magnitude of the reference
+static SLfloat relDiff(const SLfloat* a, const SLfloat* ref, int n)
+{
+    SLfloat d = 0;
+    for (int i = 0; i < n; ++i)
+        d = std::max(d, std::abs(a[i] - ref[i]) / std::max(1.0f, std::abs(ref[i])));
+    return d;
+}
+//-----------------------------------------------------------------------------
+//! Prints the result of one check and returns true if it passed
+static bool check(const char* name, SLfloat maxDiff, SLfloat tolerance)
+{
+    bool passed = maxDiff <= tolerance;
+    printf("%-28s max. rel. diff.: %.2e %s\n", name, maxDiff, passed ? "ok" : "FAILED");
+    return passed;
+}
+//-----------------------------------------------------------------------------
+//! Prints the timing of a scalar and a SIMD kernel
+static void printTiming(const char* name, double scalarMS, double simdMS)
+{
+    printf("%-28s scalar: %8.2f ms, SIMD: %8.2f ms, speedup: %5.2fx\n",
+           name,
+           scalarMS,
+           simdMS,
+           scalarMS / simdMS);
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    SLuint num  = argc > 1 ? (SLuint)std::stoi(argv[1]) : 100000;
+    SLuint reps = argc > 2 ? (SLuint)std::stoi(argv[2]) : 20;
+
+#if defined(SL_SIMD_SSE)
+    printf("SIMD: SSE\n");
+#elif defined(SL_SIMD_NEON)
+    printf("SIMD: NEON\n");
+#else
+    printf("SIMD: none (scalar template code)\n");
+#endif
+
+    vector<SLMat4f> mats(num), projs(num);
+    vector<SLVec3f> p3(num), minOS(num), maxOS(num);
+    vector<SLVec4f> p4(num);
+    for (SLuint i = 0; i < num; ++i)
+    {
+        mats[i]  = randomMatrix();
+        projs[i] = randomProjection();
+        p3[i]    = randomVec3();
+        SLVec3f v(randomVec3());
+        p4[i].set(v.x, v.y, v.z, Utils::random(0.5f, 2.0f));
+        SLVec3f a(randomVec3()), b(randomVec3());
+        minOS[i].set(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+        maxOS[i].set(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    }
+
+    /////////////////////////////////////////////
+    // Equivalence of the SIMD and scalar results
+    /////////////////////////////////////////////
+
+    bool    passed = true;
+    SLfloat dMul = 0, dInv = 0, dVec3 = 0, dVec4 = 0, dVecs3 = 0, dVecs4 = 0, dAABB = 0, dAABBP = 0;
+
+    vector<SLVec3f> r3(num), mnWS(num), mxWS(num);
+    vector<SLVec4f> r4(num);
+    mats[0].multVecs(p3.data(), r3.data(), num);
+    mats[0].multVecs(p4.data(), r4.data(), num);
+    mats[0].transformAABBs(minOS.data(), maxOS.data(), mnWS.data(), mxWS.data(), num);
+
+    for (SLuint i = 0; i < num; ++i)
+    {
+        const SLMat4f& A = mats[i];
+        const SLMat4f& B = mats[(i + 1) % num];
+
+        SLMat4f AB = A * B, refAB = refMultiply(A, B);
+        dMul       = std::max(dMul, relDiff(AB.m(), refAB.m(), 16));
+
+        SLMat4<double> Ad(A.m()[0], A.m()[4], A.m()[8], A.m()[12], A.m()[1], A.m()[5], A.m()[9], A.m()[13], A.m()[2], A.m()[6], A.m()[10], A.m()[14], A.m()[3], A.m()[7], A.m()[11], A.m()[15]);
+        SLMat4<double> refInvD = Ad.inverted();
+        SLfloat        refInv[16];
+        for (int k = 0; k < 16; ++k)
+            refInv[k] = (SLfloat)refInvD.m()[k];
+        dInv = std::max(dInv, relDiff(A.inverted().m(), refInv, 16));
+
+        SLVec3f v3 = projs[i] * p3[i], refV3 = refMultVec(projs[i], p3[i]);
+        dVec3      = std::max(dVec3, relDiff(&v3.x, &refV3.x, 3));
+
+        SLVec4f v4 = A * p4[i], refV4 = refMultVec(A, p4[i]);
+        dVec4      = std::max(dVec4, relDiff(&v4.x, &refV4.x, 4));
+
+        refV3  = refMultVec(mats[0], p3[i]);
+        dVecs3 = std::max(dVecs3, relDiff(&r3[i].x, &refV3.x, 3));
+        refV4  = refMultVec(mats[0], p4[i]);
+        dVecs4 = std::max(dVecs4, relDiff(&r4[i].x, &refV4.x, 4));
+
+        SLVec3f refMin, refMax;
+        refTransformAABB(mats[0], minOS[i], maxOS[i], refMin, refMax);
+        dAABB = std::max(dAABB, relDiff(&mnWS[i].x, &refMin.x, 3));
+        dAABB = std::max(dAABB, relDiff(&mxWS[i].x, &refMax.x, 3));
+
+        SLVec3f mn, mx;
+        A.transformAABB(minOS[i], maxOS[i], mn, mx);
+        refTransformAABB(A, minOS[i], maxOS[i], refMin, refMax);
+        dAABB = std::max(dAABB, relDiff(&mn.x, &refMin.x, 3));
+        dAABB = std::max(dAABB, relDiff(&mx.x, &refMax.x, 3));
+
+        // Points in front of the camera for a well defined projection
+        SLVec3f pMin(-1, -1, -20), pMax(1, 1, -10);
+        SLMat4f P;
+        P.perspective(60, 1.5f, 0.1f, 100.0f);
+        P.multiply(SLMat4f(0, 0, -(SLfloat)(i % 7)));
+        P.transformAABB(pMin, pMax, mn, mx);
+        refTransformAABB(P, pMin, pMax, refMin, refMax);
+        dAABBP = std::max(dAABBP, relDiff(&mn.x, &refMin.x, 3));
+        dAABBP = std::max(dAABBP, relDiff(&mx.x, &refMax.x, 3));
+    }
+
+    passed &= check("SLMat4f * SLMat4f", dMul, 1e-6f);
+    passed &= check("SLMat4f::inverted", dInv, 1e-4f);
+    passed &= check("SLMat4f * SLVec3f", dVec3, 1e-6f);
+    passed &= check("SLMat4f * SLVec4f", dVec4, 1e-6f);
+    passed &= check("SLMat4f::multVecs SLVec3f", dVecs3, 1e-6f);
+    passed &= check("SLMat4f::multVecs SLVec4f", dVecs4, 1e-6f);
+    passed &= check("SLMat4f::transformAABB(s)", dAABB, 1e-5f);
+    passed &= check("transformAABB projective", dAABBP, 1e-5f);
+
+    ////////////////////
+    // Microbenchmarks
+    ////////////////////
+
+    printf("\n%u elements, %u repetitions\n", num, reps);
+    vector<SLMat4f> res(num);
+    SLfloat         sink = 0;
+    double          scalarMS, simdMS;
+
+    auto t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            res[i] = refMultiply(mats[i], mats[(i + r + 1) % num]);
+    scalarMS = msSince(t);
+    sink += res[num / 2].m(0);
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            res[i] = mats[i] * mats[(i + r + 1) % num];
+    simdMS = msSince(t);
+    sink += res[num / 2].m(0);
+    printTiming("SLMat4f * SLMat4f", scalarMS, simdMS);
+
+    SLMat4<double> invD;
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+        {
+            const SLfloat* m = mats[i].m();
+            invD.setMatrix(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+            sink += (SLfloat)invD.inverted().m(0);
+        }
+    scalarMS = msSince(t);
+    t        = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            res[i] = mats[i].inverted();
+    simdMS = msSince(t);
+    sink += res[num / 2].m(0);
+    printTiming("SLMat4f::inverted (double)", scalarMS, simdMS);
+
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            r3[i] = refMultVec(mats[r % num], p3[i]);
+    scalarMS = msSince(t);
+    sink += r3[num / 2].x;
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            r3[i] = mats[r % num] * p3[i];
+    simdMS = msSince(t);
+    sink += r3[num / 2].x;
+    printTiming("SLMat4f * SLVec3f", scalarMS, simdMS);
+
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        mats[r % num].multVecs(p3.data(), r3.data(), num);
+    simdMS = msSince(t);
+    sink += r3[num / 2].x;
+    printTiming("SLMat4f::multVecs SLVec3f", scalarMS, simdMS);
+
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            r4[i] = refMultVec(mats[r % num], p4[i]);
+    scalarMS = msSince(t);
+    sink += r4[num / 2].x;
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        mats[r % num].multVecs(p4.data(), r4.data(), num);
+    simdMS = msSince(t);
+    sink += r4[num / 2].x;
+    printTiming("SLMat4f::multVecs SLVec4f", scalarMS, simdMS);
+
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        for (SLuint i = 0; i < num; ++i)
+            refTransformAABB(mats[r % num], minOS[i], maxOS[i], mnWS[i], mxWS[i]);
+    scalarMS = msSince(t);
+    sink += mnWS[num / 2].x;
+    t = std::chrono::high_resolution_clock::now();
+    for (SLuint r = 0; r < reps; ++r)
+        mats[r % num].transformAABBs(minOS.data(), maxOS.data(), mnWS.data(), mxWS.data(), num);
+    simdMS = msSince(t);
+    sink += mnWS[num / 2].x;
+    printTiming("SLMat4f::transformAABBs", scalarMS, simdMS);
+
+    printf("(checksum %g)\n", sink);
+    return passed ? 0 : 1;
+}
+//-----------------------------------------------------------------------------
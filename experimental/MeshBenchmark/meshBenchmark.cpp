@@ -0,0 +1,239 @@
+// Compares the parallel SLMesh::calcNormals, calcTangents and
+// computeHardEdgesIndices with the former serial scatter and libigl versions.
+// Usage: app-MeshBenchmark [numTriangles] [repetitions]
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <tuple>
+#include <SLMesh.h>
+#include <Utils.h>
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Weverything"
+#include <igl/remove_duplicate_vertices.h>
+#include <igl/per_face_normals.h>
+#include <igl/unique_edge_map.h>
+#pragma clang diagnostic pop
+
+//-----------------------------------------------------------------------------
+/*! Creates a UV sphere with about numTriangles triangles. The top is
+flattened so that the mesh gets a ring of hard edges.
+ */
+static void createSphere(SLMesh* m, SLuint numTriangles)
+{
+    SLuint stacks = std::max(4u, (SLuint)sqrt((SLfloat)numTriangles / 4.0f));
+    SLuint slices = 2 * stacks;
+
+    for (SLuint r = 0; r <= stacks; ++r)
+    {
+        for (SLuint s = 0; s <= slices; ++s)
+        {
+            SLfloat theta = Utils::PI * (SLfloat)r / (SLfloat)stacks;
+            SLfloat phi   = Utils::TWOPI * (SLfloat)s / (SLfloat)slices;
+            m->P.push_back(SLVec3f(sin(theta) * cos(phi),
+                                   std::min(0.5f, cos(theta)),
+                                   sin(theta) * sin(phi)));
+            m->UV[0].push_back(SLVec2f((SLfloat)s / (SLfloat)slices,
+                                       (SLfloat)r / (SLfloat)stacks));
+        }
+    }
+
+    for (SLuint r = 0; r < stacks; ++r)
+    {
+        for (SLuint s = 0; s < slices; ++s)
+        {
+            SLuint a = r * (slices + 1) + s, b = a + 1;
+            SLuint c = a + slices + 1, d = c + 1;
+            m->I32.insert(m->I32.end(), {a, c, b, b, c, d});
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+//! Former serial SLMesh::calcNormals with scattered adds
+static void legacyCalcNormals(SLMesh* m)
+{
+    m->N.assign(m->P.size(), SLVec3f::ZERO);
+    for (size_t i = 0; i < m->I32.size(); i += 3)
+    {
+        SLVec3f e1, e2, n;
+        e1.sub(m->P[m->I32[i + 1]], m->P[m->I32[i + 2]]);
+        e2.sub(m->P[m->I32[i + 1]], m->P[m->I32[i]]);
+        n.cross(e1, e2);
+        m->N[m->I32[i]] += n;
+        m->N[m->I32[i + 1]] += n;
+        m->N[m->I32[i + 2]] += n;
+    }
+    for (auto& n : m->N)
+        n.normalize();
+}
+//-----------------------------------------------------------------------------
+//! Former serial SLMesh::calcTangents with scattered adds
+static void legacyCalcTangents(SLMesh* m)
+{
+    SLVVec3f T1(m->P.size(), SLVec3f::ZERO);
+    SLVVec3f T2(m->P.size(), SLVec3f::ZERO);
+    m->T.resize(m->P.size());
+
+    for (size_t i = 0; i < m->I32.size(); i += 3)
+    {
+        SLuint  iVA = m->I32[i], iVB = m->I32[i + 1], iVC = m->I32[i + 2];
+        SLVec3f e1  = m->P[iVB] - m->P[iVA];
+        SLVec3f e2  = m->P[iVC] - m->P[iVA];
+        SLfloat s1  = m->UV[0][iVB].x - m->UV[0][iVA].x;
+        SLfloat s2  = m->UV[0][iVC].x - m->UV[0][iVA].x;
+        SLfloat t1  = m->UV[0][iVB].y - m->UV[0][iVA].y;
+        SLfloat t2  = m->UV[0][iVC].y - m->UV[0][iVA].y;
+        SLfloat r   = 1.0F / (s1 * t2 - s2 * t1);
+        SLVec3f sdir((e1 * t2 - e2 * t1) * r);
+        SLVec3f tdir((e2 * s1 - e1 * s2) * r);
+        T1[iVA] += sdir;
+        T1[iVB] += sdir;
+        T1[iVC] += sdir;
+        T2[iVA] += tdir;
+        T2[iVB] += tdir;
+        T2[iVC] += tdir;
+    }
+
+    for (size_t i = 0; i < m->P.size(); ++i)
+    {
+        m->T[i] = T1[i] - m->N[i] * m->N[i].dot(T1[i]);
+        m->T[i].normalize();
+        SLVec3f bitangent;
+        bitangent.cross(m->N[i], T1[i]);
+        m->T[i].w = (bitangent.dot(T2[i]) < 0.0f) ? -1.0f : 1.0f;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Former SLMesh::computeHardEdgesIndices with libigl
+static void legacyHardEdges(SLMesh* m, SLfloat angleDEG, SLfloat epsilon)
+{
+    SLfloat         angleRAD = angleDEG * Utils::DEG2RAD;
+    Eigen::MatrixXf V, newV, faceN;
+    Eigen::MatrixXi F, newF, edges, edgeMap, uniqueEdges;
+    Eigen::VectorXi SVI, SVJ;
+    vector<vector<int>> uE2E;
+
+    V.resize((Eigen::Index)m->P.size(), 3);
+    for (size_t i = 0; i < m->P.size(); i++)
+        V.row((Eigen::Index)i) << m->P[i].x, m->P[i].y, m->P[i].z;
+    F.resize((Eigen::Index)m->I32.size() / 3, 3);
+    for (size_t j = 0, i = 0; i < m->I32.size(); j++, i += 3)
+        F.row((Eigen::Index)j) << m->I32[i], m->I32[i + 1], m->I32[i + 2];
+
+    igl::remove_duplicate_vertices(V, F, epsilon, newV, SVI, SVJ, newF);
+    igl::per_face_normals(newV, newF, faceN);
+    igl::unique_edge_map(newF, edges, uniqueEdges, edgeMap, uE2E);
+
+    m->IE32.clear();
+    for (size_t u = 0; u < uE2E.size(); u++)
+    {
+        bool sharp = uE2E[u].size() == 1;
+        for (size_t i = 0; i < uE2E[u].size(); i++)
+        {
+            for (size_t j = i + 1; j < uE2E[u].size(); j++)
+            {
+                const int                  fi  = uE2E[u][i] % newF.rows();
+                const int                  fj  = uE2E[u][j] % newF.rows();
+                Eigen::Matrix<float, 1, 3> ni  = faceN.row(fi);
+                Eigen::Matrix<float, 1, 3> nj  = faceN.row(fj);
+                Eigen::Matrix<float, 1, 3> ev  = (newV.row(edges(uE2E[u][i], 1)) - newV.row(edges(uE2E[u][i], 0))).normalized();
+                float                      dij = Utils::PI - atan2((ni.cross(nj)).dot(ev), ni.dot(nj));
+                sharp                          = std::abs(dij - Utils::PI) > angleRAD;
+            }
+        }
+        if (sharp)
+        {
+            m->IE32.push_back((SLuint)SVI[uniqueEdges((Eigen::Index)u, 0)]);
+            m->IE32.push_back((SLuint)SVI[uniqueEdges((Eigen::Index)u, 1)]);
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+typedef std::tuple<long, long, long> Point3l;
+//-----------------------------------------------------------------------------
+//! Set of the hard edges by their quantized end positions
+static std::set<std::pair<Point3l, Point3l>> edgeSet(SLMesh* m, SLfloat epsilon)
+{
+    auto quantize = [&](SLuint v)
+    {
+        return Point3l(std::lround(m->P[v].x / epsilon),
+                       std::lround(m->P[v].y / epsilon),
+                       std::lround(m->P[v].z / epsilon));
+    };
+
+    std::set<std::pair<Point3l, Point3l>> edges;
+    for (size_t i = 0; i + 1 < m->IE32.size(); i += 2)
+    {
+        Point3l a = quantize(m->IE32[i]), b = quantize(m->IE32[i + 1]);
+        if (b < a) std::swap(a, b);
+        edges.insert(std::make_pair(a, b));
+    }
+    return edges;
+}
+//-----------------------------------------------------------------------------
+static double msSince(std::chrono::high_resolution_clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+}
+//-----------------------------------------------------------------------------
+//! Returns the average time in ms of reps calls of func
+template<typename F>
+static double timeMS(int reps, F func)
+{
+    auto t = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < reps; ++i) func();
+    return msSince(t) / reps;
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    SLuint  numTriangles = argc > 1 ? (SLuint)std::stoul(argv[1]) : 2000000;
+    int     reps         = argc > 2 ? std::stoi(argv[2]) : 3;
+    SLfloat angleDEG     = 30.0f;
+    SLfloat epsilon      = 0.001f;
+
+    SLMesh mesh(nullptr, "BenchmarkSphere");
+    createSphere(&mesh, numTriangles);
+    printf("Mesh: %zu triangles, %zu vertices, threads: %u\n",
+           mesh.I32.size() / 3,
+           mesh.P.size(),
+           Utils::maxThreads());
+
+    double  legacyNormalsMS = timeMS(reps, [&]() { legacyCalcNormals(&mesh); });
+    SLVVec3f legacyN        = mesh.N;
+    double  normalsMS       = timeMS(reps, [&]() { mesh.calcNormals(); });
+
+    SLfloat maxDiffN = 0.0f;
+    for (size_t i = 0; i < mesh.N.size(); ++i)
+        maxDiffN = std::max(maxDiffN, (mesh.N[i] - legacyN[i]).length());
+
+    double   legacyTangentsMS = timeMS(reps, [&]() { legacyCalcTangents(&mesh); });
+    SLVVec4f legacyT          = mesh.T;
+    double   tangentsMS       = timeMS(reps, [&]() { mesh.calcTangents(); });
+
+    SLfloat maxDiffT = 0.0f;
+    for (size_t i = 0; i < mesh.T.size(); ++i)
+        if (std::isfinite(legacyT[i].x))
+            maxDiffT = std::max(maxDiffT, (mesh.T[i] - legacyT[i]).length());
+
+    double legacyEdgesMS = timeMS(reps, [&]() { legacyHardEdges(&mesh, angleDEG, epsilon); });
+    auto   legacyEdges   = edgeSet(&mesh, epsilon);
+    double edgesMS       = timeMS(reps, [&]()
+                            {
+                                mesh.IE32.clear();
+                                mesh.computeHardEdgesIndices(angleDEG, epsilon);
+                            });
+    auto   edges         = edgeSet(&mesh, epsilon);
+    size_t numCommon     = 0;
+    for (auto& e : edges)
+        numCommon += legacyEdges.count(e);
+
+    printf("%-14s %12s %12s %9s  %s\n", "", "legacy [ms]", "new [ms]", "speedup", "difference");
+    printf("%-14s %12.1f %12.1f %8.2fx  max. %g\n", "Normals", legacyNormalsMS, normalsMS, legacyNormalsMS / normalsMS, maxDiffN);
+    printf("%-14s %12.1f %12.1f %8.2fx  max. %g\n", "Tangents", legacyTangentsMS, tangentsMS, legacyTangentsMS / tangentsMS, maxDiffT);
+    printf("%-14s %12.1f %12.1f %8.2fx  %zu/%zu edges in common\n", "Hard edges", legacyEdgesMS, edgesMS, legacyEdgesMS / edgesMS, numCommon, legacyEdges.size());
+    return 0;
+}
+//-----------------------------------------------------------------------------
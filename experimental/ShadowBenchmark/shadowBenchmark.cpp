@@ -0,0 +1,250 @@
+// Compares the closest hit traversal SLNode::hitRec with the any hit traversal
+// SLNode::hitAnyRec for the shadow rays of the ray tracing soft shadow scene.
+// Usage: app-ShadowBenchmark [width] [height] [sphereDepth]
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <SLAssetManager.h>
+#include <SLLightRect.h>
+#include <SLLightSpot.h>
+#include <SLMaterial.h>
+#include <SLRay.h>
+#include <SLRectangle.h>
+#include <SLScene.h>
+#include <SLSphere.h>
+#include <Utils.h>
+
+//-----------------------------------------------------------------------------
+//! Same recursive sphere group as in the ray tracing demo scenes
+static SLNode* sphereGroupRT(SLAssetManager* am,
+                             SLint           depth,
+                             SLfloat         x,
+                             SLfloat         y,
+                             SLfloat         z,
+                             SLfloat         scale,
+                             SLuint          resolution,
+                             SLMaterial*     matGlass,
+                             SLMaterial*     matRed)
+{
+    if (depth == 0)
+    {
+        SLNode* sphNode = new SLNode(new SLSphere(am, 0.5f * scale, resolution, resolution, "RedSphere", matRed));
+        sphNode->translate(x, y, z, TS_object);
+        return sphNode;
+    }
+
+    depth--;
+    SLNode* sGroup = new SLNode(new SLSphere(am, 0.5f * scale, resolution, resolution, "GlassSphere", matGlass));
+    sGroup->translate(x, y, z, TS_object);
+    SLuint newRes = (SLuint)std::max((SLint)resolution - 4, 8);
+    sGroup->addChild(sphereGroupRT(am, depth, 0.643951f * scale, 0, 0.172546f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, 0.172546f * scale, 0, 0.643951f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, -0.471405f * scale, 0, 0.471405f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, -0.643951f * scale, 0, -0.172546f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, -0.172546f * scale, 0, -0.643951f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, 0.471405f * scale, 0, -0.471405f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, 0.272166f * scale, 0.544331f * scale, 0.272166f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, -0.371785f * scale, 0.544331f * scale, 0.099619f * scale, scale / 3, newRes, matRed, matRed));
+    sGroup->addChild(sphereGroupRT(am, depth, 0.099619f * scale, 0.544331f * scale, -0.371785f * scale, scale / 3, newRes, matRed, matRed));
+    return sGroup;
+}
+//-----------------------------------------------------------------------------
+static double msSince(std::chrono::high_resolution_clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+}
+//-----------------------------------------------------------------------------
+//! Timing and result of one light
+struct LightResult
+{
+    const char* name;
+    double      closestMS = 0; //!< Time for all sample rays with hitRec
+    double      anyMS     = 0; //!< Time for all sample rays with hitAnyRec
+    double      testMS    = 0; //!< Time for all shadowTest calls
+    SLuint      numRays   = 0; //!< NO. of sample rays
+    SLuint      numShaded = 0; //!< NO. of shaded sample rays with hitRec
+    SLuint      numDiffs  = 0; //!< NO. of rays with a different result
+    SLuint64    testsOld  = 0; //!< NO. of triangle tests with hitRec
+    SLuint64    testsNew  = 0; //!< NO. of triangle tests with hitAnyRec
+};
+//-----------------------------------------------------------------------------
+/*! Shoots numSamples shadow rays from each hit point to random points on a
+disc with the radius lightRadius around the light center. All rays are shot
+once with hitRec and once with hitAnyRec and the results get compared. At
+last the shadowTest of the light is timed.
+*/
+static void benchmarkLight(SLLight*       light,
+                           SLNode*        lightNode,
+                           SLfloat        lightRadius,
+                           SLNode*        root,
+                           vector<SLRay>& hits,
+                           SLuint         numSamples,
+                           LightResult&   res)
+{
+    SLVec3f C(lightNode->updateAndGetWM().translation());
+
+    // Generate all sample directions first so that both traversals get the
+    // same rays
+    vector<SLVec3f> dirs;
+    vector<SLfloat> dists;
+    dirs.reserve(hits.size() * numSamples);
+    dists.reserve(hits.size() * numSamples);
+    for (auto& hit : hits)
+    {
+        for (SLuint i = 0; i < numSamples; ++i)
+        {
+            SLfloat r   = lightRadius * sqrt(Utils::random(0.0f, 1.0f));
+            SLfloat phi = Utils::random(0.0f, Utils::TWOPI);
+            SLVec3f P(C.x + r * cos(phi), C.y, C.z + r * sin(phi));
+            SLVec3f L(P - hit.hitPoint);
+            dists.push_back(L.length());
+            L.normalize();
+            dirs.push_back(L);
+        }
+    }
+    res.numRays = (SLuint)dirs.size();
+
+    vector<SLbool> shadedOld(dirs.size());
+    SLRay::tests = 0;
+    auto t       = std::chrono::high_resolution_clock::now();
+    for (size_t h = 0, i = 0; h < hits.size(); ++h)
+    {
+        for (SLuint s = 0; s < numSamples; ++s, ++i)
+        {
+            SLRay shadowRay(dists[i], dirs[i], &hits[h]);
+            root->hitRec(&shadowRay);
+            shadedOld[i] = shadowRay.isShaded();
+        }
+    }
+    res.closestMS = msSince(t);
+    res.testsOld  = SLRay::tests;
+
+    SLRay::tests = 0;
+    t            = std::chrono::high_resolution_clock::now();
+    for (size_t h = 0, i = 0; h < hits.size(); ++h)
+    {
+        for (SLuint s = 0; s < numSamples; ++s, ++i)
+        {
+            SLRay shadowRay(dists[i], dirs[i], &hits[h]);
+            root->hitAnyRec(&shadowRay);
+            res.numShaded += shadedOld[i] ? 1 : 0;
+            res.numDiffs += shadowRay.isShaded() != shadedOld[i] ? 1 : 0;
+        }
+    }
+    res.anyMS    = msSince(t);
+    res.testsNew = SLRay::tests;
+
+    t = std::chrono::high_resolution_clock::now();
+    for (auto& hit : hits)
+    {
+        SLVec3f L(C - hit.hitPoint);
+        SLfloat lightDist = L.length();
+        L.normalize();
+        light->shadowTest(&hit, L, lightDist, root);
+    }
+    res.testMS = msSince(t);
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    SLint width       = argc > 1 ? std::stoi(argv[1]) : 320;
+    SLint height      = argc > 2 ? std::stoi(argv[2]) : 240;
+    SLint sphereDepth = argc > 3 ? std::stoi(argv[3]) : 2;
+
+    SLAssetManager am;
+    SLScene        s("ShadowBenchmark", nullptr);
+
+    // Ray tracing soft shadow scene with an additional rectangular light
+    SLMaterial* matBlk = new SLMaterial(&am, "Glass", SLCol4f(0.0f, 0.0f, 0.0f), SLCol4f(0.5f, 0.5f, 0.5f), 100, 0.5f, 0.5f, 1.5f);
+    SLMaterial* matRed = new SLMaterial(&am, "Red", SLCol4f(0.5f, 0.0f, 0.0f), SLCol4f(0.5f, 0.5f, 0.5f), 100, 0.5f, 0.0f, 1.0f);
+    SLMaterial* matYel = new SLMaterial(&am, "Floor", SLCol4f(0.8f, 0.6f, 0.2f), SLCol4f(0.8f, 0.8f, 0.8f), 100, 0.0f, 0.0f, 1.0f);
+
+    SLNode* scene = new SLNode;
+    s.root3D(scene);
+
+    SLNode* rect = new SLNode(new SLRectangle(&am, SLVec2f(-5, -5), SLVec2f(5, 5), 1, 1, "Rect", matYel));
+    rect->rotate(90, -1, 0, 0);
+    rect->translate(0, 0, -0.5f);
+    scene->addChild(rect);
+
+    SLLightSpot* light1 = new SLLightSpot(&am, &s, 2, 2, 2, 0.3f);
+    light1->samples(8, 8);
+    scene->addChild(light1);
+
+    SLLightSpot* light2 = new SLLightSpot(&am, &s, 2, 2, -2, 0.3f);
+    light2->samples(8, 8);
+    scene->addChild(light2);
+
+    SLLightRect* light3 = new SLLightRect(&am, &s, 1, 1);
+    light3->rotate(-90, 1, 0, 0);
+    light3->translation(0, 2, 0);
+    light3->samplesXY(7, 7);
+    scene->addChild(light3);
+
+    scene->addChild(sphereGroupRT(&am, sphereDepth, 0, 0, 0, 1, 32, matBlk, matRed));
+    scene->updateAABBRec(true);
+
+    // Primary rays from the demo camera position for the hit points
+    SLVec3f      eye(0, 0.1f, 4);
+    vector<SLRay> hits;
+    for (SLint y = 0; y < height; ++y)
+    {
+        for (SLint x = 0; x < width; ++x)
+        {
+            SLVec3f target(-2.0f + 4.0f * (SLfloat)x / (SLfloat)width,
+                           1.5f - 3.0f * (SLfloat)y / (SLfloat)height,
+                           0.0f);
+            SLVec3f dir(target - eye);
+            dir.normalize();
+            SLRay ray(eye, dir, (SLfloat)x, (SLfloat)y, SLCol4f::BLACK, nullptr);
+            if (scene->hitRec(&ray) && ray.hitMesh)
+            {
+                ray.hitPoint = ray.origin + ray.length * ray.dir;
+                hits.push_back(ray);
+            }
+        }
+    }
+
+    SLNodeStats stats;
+    scene->statsRec(stats);
+    printf("Scene: %u triangles, %zu hit points, threads: %u\n",
+           stats.numTriangles,
+           hits.size(),
+           Utils::maxThreads());
+
+    LightResult results[3];
+    results[0].name = "Spot 1 (8x8)";
+    results[1].name = "Spot 2 (8x8)";
+    results[2].name = "Rect (7x7)";
+    benchmarkLight(light1, light1, light1->radius(), scene, hits, 64, results[0]);
+    benchmarkLight(light2, light2, light2->radius(), scene, hits, 64, results[1]);
+    benchmarkLight(light3, light3, 0.5f, scene, hits, 49, results[2]);
+
+    printf("%-14s %10s %10s %9s %8s %13s %13s %8s %14s\n",
+           "",
+           "rays",
+           "shaded",
+           "hitRec",
+           "hitAny",
+           "tests hitRec",
+           "tests hitAny",
+           "speedup",
+           "shadowTest");
+    for (auto& r : results)
+    {
+        printf("%-14s %10u %10u %6.1f ms %5.1f ms %13llu %13llu %7.2fx %11.1f ms  %u diffs\n",
+               r.name,
+               r.numRays,
+               r.numShaded,
+               r.closestMS,
+               r.anyMS,
+               (unsigned long long)r.testsOld,
+               (unsigned long long)r.testsNew,
+               r.closestMS / r.anyMS,
+               r.testMS,
+               r.numDiffs);
+    }
+    return 0;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,163 @@
+// Compares fbow::VocabularyCreator with fbow::VocabularyTrainer on a synthetic set
+// of ORB like binary descriptors (training time and quantization purity).
+// Usage: app-VocTrainerBenchmark [numWords] [descPerWord] [k] [L] [threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <WAIOrbVocabulary.h>
+
+//-----------------------------------------------------------------------------
+/*! Creates numWords random 256 bit "true words" and for each of them
+descPerWord descriptors with every bit flipped with probability flipProb.
+The descriptors are split into images of imageSize descriptors.
+ */
+static void createSyntheticDescriptors(int                   numWords,
+                                       int                   descPerWord,
+                                       double                flipProb,
+                                       int                   imageSize,
+                                       std::vector<cv::Mat>& images,
+                                       std::vector<int>&     trueWords)
+{
+    std::mt19937                       rng(42);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::bernoulli_distribution        flip(flipProb);
+
+    std::vector<std::vector<uchar>> words(numWords, std::vector<uchar>(32));
+    for (auto& w : words)
+        for (auto& b : w) b = (uchar)byteDist(rng);
+
+    int numDesc = numWords * descPerWord;
+    trueWords.resize(numDesc);
+    for (int i = 0; i < numDesc; i++)
+        trueWords[i] = i % numWords;
+    std::shuffle(trueWords.begin(), trueWords.end(), rng);
+
+    images.clear();
+    for (int start = 0; start < numDesc; start += imageSize)
+    {
+        int     rows = std::min(imageSize, numDesc - start);
+        cv::Mat img(rows, 32, CV_8UC1);
+        for (int r = 0; r < rows; r++)
+        {
+            const std::vector<uchar>& w = words[trueWords[start + r]];
+            uchar*                    p = img.ptr<uchar>(r);
+            for (int b = 0; b < 32; b++)
+            {
+                uchar v = w[b];
+                for (int bit = 0; bit < 8; bit++)
+                    if (flip(rng)) v ^= (uchar)(1 << bit);
+                p[b] = v;
+            }
+        }
+        images.push_back(img);
+    }
+}
+//-----------------------------------------------------------------------------
+/*! Purity of the quantization: for every true word the fraction of its
+descriptors that fall into its most frequent vocabulary word (1 is best).
+Only every step-th descriptor is evaluated.
+ */
+static double purity(fbow::Vocabulary&           voc,
+                     const std::vector<cv::Mat>& images,
+                     const std::vector<int>&     trueWords,
+                     int                         step)
+{
+    std::map<int, std::map<uint32_t, int>> hist;
+    int                                    i = 0;
+    for (const cv::Mat& img : images)
+    {
+        for (int r = 0; r < img.rows; r++, i++)
+        {
+            if (i % step) continue;
+            fbow::fBow bow = voc.transform(img.row(r));
+            if (!bow.empty())
+                hist[trueWords[i]][bow.begin()->first]++;
+        }
+    }
+
+    int numBest = 0, numTotal = 0;
+    for (auto& h : hist)
+    {
+        int best = 0;
+        for (auto& c : h.second)
+        {
+            best = std::max(best, c.second);
+            numTotal += c.second;
+        }
+        numBest += best;
+    }
+    return numTotal ? (double)numBest / numTotal : 0.0;
+}
+//-----------------------------------------------------------------------------
+static double msSince(std::chrono::high_resolution_clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t).count();
+}
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    int    numWords    = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int    descPerWord = argc > 2 ? std::stoi(argv[2]) : 200;
+    int    k           = argc > 3 ? std::stoi(argv[3]) : 10;
+    int    L           = argc > 4 ? std::stoi(argv[4]) : 4;
+    int    nthreads    = argc > 5 ? std::stoi(argv[5]) : (int)std::max(1u, std::thread::hardware_concurrency());
+    double flipProb    = 0.08;
+
+    std::vector<cv::Mat> images;
+    std::vector<int>     trueWords;
+    createSyntheticDescriptors(numWords, descPerWord, flipProb, 1000, images, trueWords);
+    std::cout << "Synthetic set: " << numWords << " words x " << descPerWord << " descriptors, "
+              << "k=" << k << " L=" << L << " threads=" << nthreads << std::endl;
+
+    // the existing creator
+    fbow::Vocabulary                creatorVoc;
+    fbow::VocabularyCreator::Params creatorParams(k, L, nthreads);
+    fbow::VocabularyCreator         creator;
+    auto                            t = std::chrono::high_resolution_clock::now();
+    creator.create(creatorVoc, images, "orb", creatorParams);
+    double creatorMS = msSince(t);
+
+    // the parallel trainer streaming from a descriptor file
+    std::string descFile = "vocTrainerBenchmark.desc";
+    fbow::VocabularyTrainer::writeDescriptorFile(descFile, images);
+
+    fbow::VocabularyTrainer::Params trainerParams;
+    trainerParams.k        = k;
+    trainerParams.L        = L;
+    trainerParams.nthreads = nthreads;
+    fbow::Vocabulary        trainerVoc;
+    fbow::VocabularyTrainer trainer(trainerParams);
+    t = std::chrono::high_resolution_clock::now();
+    trainer.addDescriptorFile(descFile);
+    double readMS = msSince(t);
+    t             = std::chrono::high_resolution_clock::now();
+    trainer.train(trainerVoc, "orb");
+    double trainerMS = msSince(t);
+    std::remove(descFile.c_str());
+
+    // the trained vocabulary must be loadable by WAIOrbVocabulary
+    std::string vocFile = "vocTrainerBenchmark.bin";
+    trainerVoc.saveToFile(vocFile);
+    WAIOrbVocabulary waiVoc;
+    waiVoc.loadFromFile(vocFile);
+    std::remove(vocFile.c_str());
+
+    int step = std::max(1, numWords * descPerWord / 20000);
+    printf("%-22s %12s %10s %8s\n", "", "time [ms]", "blocks", "purity");
+    printf("%-22s %12.1f %10zu %8.3f\n", "VocabularyCreator", creatorMS, creatorVoc.size(), purity(creatorVoc, images, trueWords, step));
+    printf("%-22s %12.1f %10zu %8.3f\n", "VocabularyTrainer", trainerMS, trainerVoc.size(), purity(trainerVoc, images, trueWords, step));
+    printf("(streaming %zu descriptors from disk: %.1f ms, speedup: %.2fx, loaded by WAIOrbVocabulary: %zu words)\n",
+           trainer.size(),
+           readMS,
+           creatorMS / trainerMS,
+           waiVoc.size());
+    return 0;
+}
+//-----------------------------------------------------------------------------
@@ -12,6 +12,7 @@
 #define SLMAT4_H
 
 #include <SLMath.h>
+#include <SLMathSimd.h>
 #include <stack>
 #include <Utils.h>
 #include <SLMat3.h>
@@ -118,6 +119,21 @@ class SLMat4
         void        multiply    (const SLMat4& A);
         SLVec3<T>   multVec     (SLVec3<T> v) const;
         SLVec4<T>   multVec     (SLVec4<T> v) const;
+        void        multVecs    (const SLVec3<T>* src,
+                                 SLVec3<T>*       dst,
+                                 size_t           num) const; //!< multVec for an array
+        void        multVecs    (const SLVec4<T>* src,
+                                 SLVec4<T>*       dst,
+                                 size_t           num) const; //!< multVec for an array
+        void        transformAABB (const SLVec3<T>& minOS,
+                                   const SLVec3<T>& maxOS,
+                                   SLVec3<T>&       minWS,
+                                   SLVec3<T>&       maxWS) const;
+        void        transformAABBs(const SLVec3<T>* minOS,
+                                   const SLVec3<T>* maxOS,
+                                   SLVec3<T>*       minWS,
+                                   SLVec3<T>*       maxWS,
+                                   size_t           num) const;
         void        add         (const SLMat4& A);
         void        translate   (T tx, T ty, T tz=0);
         void        translate   (const SLVec2<T>& t);
@@ -451,10 +467,7 @@ Matrix - 3D vector multiplication with perspective division
 template<class T>
 SLVec3<T> SLMat4<T>::operator *(const SLVec3<T>& v) const  
 {
-    T W = 1 / (_m[3]*v.x + _m[7]*v.y + _m[11]*v.z + _m[15]);
-    return SLVec3<T>((_m[0]*v.x + _m[4]*v.y + _m[ 8]*v.z + _m[12]) * W,
-                     (_m[1]*v.x + _m[5]*v.y + _m[ 9]*v.z + _m[13]) * W,
-                     (_m[2]*v.x + _m[6]*v.y + _m[10]*v.z + _m[14]) * W);
+    return multVec(v);
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -463,10 +476,7 @@ Matrix - 4D vector multiplication
 template<class T>
 SLVec4<T> SLMat4<T>::operator *(const SLVec4<T>& v) const
 {
-    return SLVec4<T>(_m[0]*v.x + _m[4]*v.y + _m[ 8]*v.z + _m[12]*v.w,
-                     _m[1]*v.x + _m[5]*v.y + _m[ 9]*v.z + _m[13]*v.w,
-                     _m[2]*v.x + _m[6]*v.y + _m[10]*v.z + _m[14]*v.w,
-                     _m[3]*v.x + _m[7]*v.y + _m[11]*v.z + _m[15]*v.w);
+    return multVec(v);
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -594,6 +604,68 @@ SLVec4<T> SLMat4<T>::multVec(const SLVec4<T> v) const
 }
 //-----------------------------------------------------------------------------
 /*!
+Matrix - 3D vector multiplication with perspective division for num vectors.
+src and dst may be the same array.
+*/
+template<class T>
+void SLMat4<T>::multVecs(const SLVec3<T>* src, SLVec3<T>* dst, size_t num) const
+{
+    for (size_t i = 0; i < num; ++i)
+        dst[i] = multVec(src[i]);
+}
+//-----------------------------------------------------------------------------
+/*!
+Matrix - 4D vector multiplication for num vectors. src and dst may be the same
+array.
+*/
+template<class T>
+void SLMat4<T>::multVecs(const SLVec4<T>* src, SLVec4<T>* dst, size_t num) const
+{
+    for (size_t i = 0; i < num; ++i)
+        dst[i] = multVec(src[i]);
+}
+//-----------------------------------------------------------------------------
+/*!
+Transforms an axis aligned bounding box given by minOS and maxOS and returns
+the axis aligned bounding box minWS and maxWS of the 8 transformed corners.
+*/
+template<class T>
+void SLMat4<T>::transformAABB(const SLVec3<T>& minOS,
+                              const SLVec3<T>& maxOS,
+                              SLVec3<T>&       minWS,
+                              SLVec3<T>&       maxWS) const
+{
+    SLVec3<T> corner[8] = {SLVec3<T>(minOS.x, minOS.y, minOS.z),
+                           SLVec3<T>(maxOS.x, minOS.y, minOS.z),
+                           SLVec3<T>(maxOS.x, minOS.y, maxOS.z),
+                           SLVec3<T>(minOS.x, minOS.y, maxOS.z),
+                           SLVec3<T>(maxOS.x, maxOS.y, minOS.z),
+                           SLVec3<T>(minOS.x, maxOS.y, minOS.z),
+                           SLVec3<T>(minOS.x, maxOS.y, maxOS.z),
+                           SLVec3<T>(maxOS.x, maxOS.y, maxOS.z)};
+
+    minWS = maxWS = multVec(corner[0]);
+    for (int i = 1; i < 8; ++i)
+    {
+        SLVec3<T> c = multVec(corner[i]);
+        minWS.setMin(c);
+        maxWS.setMax(c);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Transforms num axis aligned bounding boxes (see transformAABB)
+template<class T>
+void SLMat4<T>::transformAABBs(const SLVec3<T>* minOS,
+                               const SLVec3<T>* maxOS,
+                               SLVec3<T>*       minWS,
+                               SLVec3<T>*       maxWS,
+                               size_t           num) const
+{
+    for (size_t i = 0; i < num; ++i)
+        transformAABB(minOS[i], maxOS[i], minWS[i], maxWS[i]);
+}
+//-----------------------------------------------------------------------------
+/*!
 Multiplies the matrix with a translation matrix. 
 Corresponds to the OpenGL function glTranslate*.
 */
@@ -1576,6 +1648,296 @@ SLstring SLMat4<T>::toString() const
     SLstring cppstr = cstr;
     return cppstr;
 }
+#if defined(SL_SIMD)
+//-----------------------------------------------------------------------------
+// SIMD specializations for SLMat4<SLfloat> (see SLMathSimd.h)
+//-----------------------------------------------------------------------------
+/*!
+Matrix - matrix multiplication with SIMD. Each column of the result is the
+linear combination of the 4 columns of this matrix with the elements of the
+corresponding column of A. The sums are built in the same order as in the
+scalar version.
+*/
+template<>
+inline void SLMat4<SLfloat>::multiply(const SLMat4& A)
+{
+    SLSimd4f c0 = simdLoad(_m);
+    SLSimd4f c1 = simdLoad(_m + 4);
+    SLSimd4f c2 = simdLoad(_m + 8);
+    SLSimd4f c3 = simdLoad(_m + 12);
+
+    for (int j = 0; j < 16; j += 4)
+    {
+        SLSimd4f a = simdLoad(A._m + j);
+        SLSimd4f r = simdMul(c0, simdSplat<0>(a));
+        r          = simdMadd(c1, simdSplat<1>(a), r);
+        r          = simdMadd(c2, simdSplat<2>(a), r);
+        r          = simdMadd(c3, simdSplat<3>(a), r);
+        simdStore(_m + j, r);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Matrix - 3D vector multiplication with perspective division with SIMD
+template<>
+inline SLVec3f SLMat4<SLfloat>::multVec(const SLVec3f v) const
+{
+    SLSimd4f r = simdMul(simdLoad(_m), simdSplat(v.x));
+    r          = simdMadd(simdLoad(_m + 4), simdSplat(v.y), r);
+    r          = simdMadd(simdLoad(_m + 8), simdSplat(v.z), r);
+    r          = simdAdd(r, simdLoad(_m + 12));
+    r          = simdMul(r, simdDiv(simdSplat(1.0f), simdSplat<3>(r)));
+
+    SLVec3f result;
+    simdStore3(&result.x, r);
+    return result;
+}
+//-----------------------------------------------------------------------------
+//! Matrix - 4D vector multiplication with SIMD
+template<>
+inline SLVec4f SLMat4<SLfloat>::multVec(const SLVec4f v) const
+{
+    SLSimd4f r = simdMul(simdLoad(_m), simdSplat(v.x));
+    r          = simdMadd(simdLoad(_m + 4), simdSplat(v.y), r);
+    r          = simdMadd(simdLoad(_m + 8), simdSplat(v.z), r);
+    r          = simdMadd(simdLoad(_m + 12), simdSplat(v.w), r);
+
+    SLVec4f result;
+    simdStore(&result.x, r);
+    return result;
+}
+//-----------------------------------------------------------------------------
+/*!
+Matrix - 3D vector multiplication with perspective division for num vectors
+with SIMD. 4 vectors are loaded with 3 loads and transposed into one register
+per component, so that every instruction works on 4 vectors.
+*/
+template<>
+inline void SLMat4<SLfloat>::multVecs(const SLVec3f* src,
+                                      SLVec3f*       dst,
+                                      size_t         num) const
+{
+    static_assert(sizeof(SLVec3f) == 3 * sizeof(SLfloat), "SLVec3f must be packed");
+
+    SLSimd4f m[16];
+    for (int i = 0; i < 16; ++i)
+        m[i] = simdSplat(_m[i]);
+
+    size_t i = 0;
+    for (; i + 4 <= num; i += 4)
+    {
+        // (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3) -> (x0..x3) (y0..y3) (z0..z3)
+        const SLfloat* p = &src[i].x;
+        SLSimd4f       a = simdLoad(p);
+        SLSimd4f       b = simdLoad(p + 4);
+        SLSimd4f       c = simdLoad(p + 8);
+        SLSimd4f       X = simdShuffle<0, 3, 0, 2>(a, simdShuffle<2, 2, 1, 1>(b, c));
+        SLSimd4f       Y = simdShuffle<0, 2, 0, 2>(simdShuffle<1, 1, 0, 0>(a, b),
+                                             simdShuffle<3, 3, 2, 2>(b, c));
+        SLSimd4f       Z = simdShuffle<0, 2, 0, 2>(simdShuffle<2, 2, 1, 1>(a, b),
+                                             simdShuffle<0, 0, 3, 3>(c, c));
+
+        SLSimd4f RX = simdAdd(simdMadd(m[8], Z, simdMadd(m[4], Y, simdMul(m[0], X))), m[12]);
+        SLSimd4f RY = simdAdd(simdMadd(m[9], Z, simdMadd(m[5], Y, simdMul(m[1], X))), m[13]);
+        SLSimd4f RZ = simdAdd(simdMadd(m[10], Z, simdMadd(m[6], Y, simdMul(m[2], X))), m[14]);
+        SLSimd4f RW = simdAdd(simdMadd(m[11], Z, simdMadd(m[7], Y, simdMul(m[3], X))), m[15]);
+        SLSimd4f W  = simdDiv(simdSplat(1.0f), RW);
+        RX          = simdMul(RX, W);
+        RY          = simdMul(RY, W);
+        RZ          = simdMul(RZ, W);
+
+        // Back to (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+        SLfloat* q = &dst[i].x;
+        simdStore(q, simdShuffle<0, 2, 0, 2>(simdShuffle<0, 0, 0, 0>(RX, RY),
+                                             simdShuffle<0, 0, 1, 1>(RZ, RX)));
+        simdStore(q + 4, simdShuffle<0, 2, 0, 2>(simdShuffle<1, 1, 1, 1>(RY, RZ),
+                                                 simdShuffle<2, 2, 2, 2>(RX, RY)));
+        simdStore(q + 8, simdShuffle<0, 2, 0, 2>(simdShuffle<2, 2, 3, 3>(RZ, RX),
+                                                 simdShuffle<3, 3, 3, 3>(RY, RZ)));
+    }
+
+    for (; i < num; ++i)
+        dst[i] = multVec(src[i]);
+}
+//-----------------------------------------------------------------------------
+//! Matrix - 4D vector multiplication for num vectors with SIMD
+template<>
+inline void SLMat4<SLfloat>::multVecs(const SLVec4f* src,
+                                      SLVec4f*       dst,
+                                      size_t         num) const
+{
+    SLSimd4f c0 = simdLoad(_m);
+    SLSimd4f c1 = simdLoad(_m + 4);
+    SLSimd4f c2 = simdLoad(_m + 8);
+    SLSimd4f c3 = simdLoad(_m + 12);
+
+    for (size_t i = 0; i < num; ++i)
+    {
+        SLSimd4f v = simdLoad(&src[i].x);
+        SLSimd4f r = simdMul(c0, simdSplat<0>(v));
+        r          = simdMadd(c1, simdSplat<1>(v), r);
+        r          = simdMadd(c2, simdSplat<2>(v), r);
+        r          = simdMadd(c3, simdSplat<3>(v), r);
+        simdStore(&dst[i].x, r);
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Transforms num axis aligned bounding boxes with SIMD. For an affine matrix the
+center is transformed by the matrix and the half extent by the absolute values
+of the linear part (J. Arvo, Graphics Gems 1990). This is exact and needs no
+transform of the 8 corners. Projective matrices are done with the corners.
+*/
+template<>
+inline void SLMat4<SLfloat>::transformAABBs(const SLVec3f* minOS,
+                                            const SLVec3f* maxOS,
+                                            SLVec3f*       minWS,
+                                            SLVec3f*       maxWS,
+                                            size_t         num) const
+{
+    if (_m[3] != 0.0f || _m[7] != 0.0f || _m[11] != 0.0f || _m[15] != 1.0f)
+    {
+        for (size_t i = 0; i < num; ++i)
+        {
+            SLVec3f corner[8] = {SLVec3f(minOS[i].x, minOS[i].y, minOS[i].z),
+                                 SLVec3f(maxOS[i].x, minOS[i].y, minOS[i].z),
+                                 SLVec3f(maxOS[i].x, minOS[i].y, maxOS[i].z),
+                                 SLVec3f(minOS[i].x, minOS[i].y, maxOS[i].z),
+                                 SLVec3f(maxOS[i].x, maxOS[i].y, minOS[i].z),
+                                 SLVec3f(minOS[i].x, maxOS[i].y, minOS[i].z),
+                                 SLVec3f(minOS[i].x, maxOS[i].y, maxOS[i].z),
+                                 SLVec3f(maxOS[i].x, maxOS[i].y, maxOS[i].z)};
+            for (auto& c : corner)
+                c = multVec(c);
+            minWS[i] = maxWS[i] = corner[0];
+            for (int c = 1; c < 8; ++c)
+            {
+                minWS[i].setMin(corner[c]);
+                maxWS[i].setMax(corner[c]);
+            }
+        }
+        return;
+    }
+
+    SLSimd4f c0   = simdLoad(_m);
+    SLSimd4f c1   = simdLoad(_m + 4);
+    SLSimd4f c2   = simdLoad(_m + 8);
+    SLSimd4f c3   = simdLoad(_m + 12);
+    SLSimd4f a0   = simdAbs(c0);
+    SLSimd4f a1   = simdAbs(c1);
+    SLSimd4f a2   = simdAbs(c2);
+    SLSimd4f half = simdSplat(0.5f);
+
+    for (size_t i = 0; i < num; ++i)
+    {
+        SLSimd4f mn = simdLoad3(&minOS[i].x, 0.0f);
+        SLSimd4f mx = simdLoad3(&maxOS[i].x, 0.0f);
+        SLSimd4f c  = simdMul(simdAdd(mn, mx), half);
+        SLSimd4f e  = simdMul(simdSub(mx, mn), half);
+
+        SLSimd4f cWS = simdMul(c0, simdSplat<0>(c));
+        cWS          = simdMadd(c1, simdSplat<1>(c), cWS);
+        cWS          = simdMadd(c2, simdSplat<2>(c), cWS);
+        cWS          = simdAdd(cWS, c3);
+
+        SLSimd4f eWS = simdMul(a0, simdSplat<0>(e));
+        eWS          = simdMadd(a1, simdSplat<1>(e), eWS);
+        eWS          = simdMadd(a2, simdSplat<2>(e), eWS);
+
+        simdStore3(&minWS[i].x, simdSub(cWS, eWS));
+        simdStore3(&maxWS[i].x, simdAdd(cWS, eWS));
+    }
+}
+//-----------------------------------------------------------------------------
+//! Transforms an axis aligned bounding box with SIMD (see transformAABBs)
+template<>
+inline void SLMat4<SLfloat>::transformAABB(const SLVec3f& minOS,
+                                           const SLVec3f& maxOS,
+                                           SLVec3f&       minWS,
+                                           SLVec3f&       maxWS) const
+{
+    transformAABBs(&minOS, &maxOS, &minWS, &maxWS, 1);
+}
+//-----------------------------------------------------------------------------
+/*!
+Computes the inverse of a 4x4 non-singular matrix with SIMD by 2x2 block
+matrices (E. Zhang, Fast 4x4 Matrix Inverse with SSE SIMD, 2017). The
+algorithm is formulated for rows. With the columns as input it computes the
+inverse of the transposed matrix whose rows are the columns of the inverse.
+*/
+template<>
+inline SLMat4<SLfloat> SLMat4<SLfloat>::inverted() const
+{
+    // 2x2 matrix multiplication A * B with the 2x2 matrices in one register
+    auto mat2Mul = [](SLSimd4f a, SLSimd4f b)
+    {
+        return simdAdd(simdMul(a, simdSwizzle<0, 3, 0, 3>(b)),
+                       simdMul(simdSwizzle<1, 0, 3, 2>(a), simdSwizzle<2, 1, 2, 1>(b)));
+    };
+    // 2x2 matrix adjugate multiplication adj(A) * B
+    auto mat2AdjMul = [](SLSimd4f a, SLSimd4f b)
+    {
+        return simdSub(simdMul(simdSwizzle<3, 3, 0, 0>(a), b),
+                       simdMul(simdSwizzle<1, 1, 2, 2>(a), simdSwizzle<2, 3, 0, 1>(b)));
+    };
+    // 2x2 matrix multiplication with adjugate A * adj(B)
+    auto mat2MulAdj = [](SLSimd4f a, SLSimd4f b)
+    {
+        return simdSub(simdMul(a, simdSwizzle<3, 0, 3, 0>(b)),
+                       simdMul(simdSwizzle<1, 0, 3, 2>(a), simdSwizzle<2, 1, 2, 1>(b)));
+    };
+
+    SLSimd4f r0 = simdLoad(_m);
+    SLSimd4f r1 = simdLoad(_m + 4);
+    SLSimd4f r2 = simdLoad(_m + 8);
+    SLSimd4f r3 = simdLoad(_m + 12);
+
+    // 2x2 sub matrices
+    SLSimd4f A = simdShuffle<0, 1, 0, 1>(r0, r1);
+    SLSimd4f B = simdShuffle<2, 3, 2, 3>(r0, r1);
+    SLSimd4f C = simdShuffle<0, 1, 0, 1>(r2, r3);
+    SLSimd4f D = simdShuffle<2, 3, 2, 3>(r2, r3);
+
+    // Determinants of the sub matrices as (|A| |B| |C| |D|)
+    SLSimd4f detSub = simdSub(simdMul(simdShuffle<0, 2, 0, 2>(r0, r2),
+                                      simdShuffle<1, 3, 1, 3>(r1, r3)),
+                              simdMul(simdShuffle<1, 3, 1, 3>(r0, r2),
+                                      simdShuffle<0, 2, 0, 2>(r1, r3)));
+    SLSimd4f detA   = simdSplat<0>(detSub);
+    SLSimd4f detB   = simdSplat<1>(detSub);
+    SLSimd4f detC   = simdSplat<2>(detSub);
+    SLSimd4f detD   = simdSplat<3>(detSub);
+
+    SLSimd4f D_C = mat2AdjMul(D, C);
+    SLSimd4f A_B = mat2AdjMul(A, B);
+    SLSimd4f X_  = simdSub(simdMul(detD, A), mat2Mul(B, D_C));
+    SLSimd4f W_  = simdSub(simdMul(detA, D), mat2Mul(C, A_B));
+    SLSimd4f Y_  = simdSub(simdMul(detB, C), mat2MulAdj(D, A_B));
+    SLSimd4f Z_  = simdSub(simdMul(detC, B), mat2MulAdj(A, D_C));
+
+    // |M| = |A|*|D| + |B|*|C| - tr((A#B)(D#C))
+    SLSimd4f tr   = simdHSum(simdMul(A_B, simdSwizzle<0, 2, 1, 3>(D_C)));
+    SLSimd4f detM = simdSub(simdAdd(simdMul(detA, detD), simdMul(detB, detC)), tr);
+
+    if (fabs(simdX(detM)) < FLT_EPSILON)
+    {
+        SL_LOG("4x4-Matrix is singular. Inversion impossible.");
+        exit(-1);
+    }
+
+    SLSimd4f rDetM = simdDiv(simdSet(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X_             = simdMul(X_, rDetM);
+    Y_             = simdMul(Y_, rDetM);
+    Z_             = simdMul(Z_, rDetM);
+    W_             = simdMul(W_, rDetM);
+
+    SLMat4<SLfloat> i;
+    simdStore(i._m, simdShuffle<3, 1, 3, 1>(X_, Y_));
+    simdStore(i._m + 4, simdShuffle<2, 0, 2, 0>(X_, Y_));
+    simdStore(i._m + 8, simdShuffle<3, 1, 3, 1>(Z_, W_));
+    simdStore(i._m + 12, simdShuffle<2, 0, 2, 0>(Z_, W_));
+    return i;
+}
+#endif // SL_SIMD
 //-----------------------------------------------------------------------------
 typedef SLMat4<SLfloat>  SLMat4f;
 #ifdef SL_HAS_DOUBLE
@@ -0,0 +1,156 @@
+//#############################################################################
+//  File:      math/SLMathSimd.h
+//  Purpose:   Compile time selection of SSE or NEON for 4 float vectors
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLMATHSIMD_H
+#define SLMATHSIMD_H
+
+//-----------------------------------------------------------------------------
+/*!
+SLSimd4f is a vector of 4 floats in one SIMD register. The instruction set is
+selected at compile time:
+- SL_SIMD_SSE:  SSE2 on x86 and x64 (always available on x64)
+- SL_SIMD_NEON: NEON on ARMv7 with NEON and on ARM64
+With none of both or if SL_NO_SIMD is defined, SL_SIMD is not defined and the
+SLMat4f specializations in SLMat4.h are not compiled, so that the scalar
+template code is used.
+\n The functions are written so that the kernels in SLMat4.h exist only once
+for both instruction sets. All loads and stores are unaligned because the
+SLMat4 and SLVec4 members have no 16 byte alignment.
+*/
+#if !defined(SL_NO_SIMD)
+#    if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#        define SL_SIMD
+#        define SL_SIMD_SSE
+#        include <emmintrin.h>
+#    elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#        define SL_SIMD
+#        define SL_SIMD_NEON
+#        include <arm_neon.h>
+#    endif
+#endif
+
+#if defined(SL_SIMD)
+//-----------------------------------------------------------------------------
+#    if defined(SL_SIMD_SSE)
+typedef __m128 SLSimd4f;
+
+inline SLSimd4f simdLoad(const float* p) { return _mm_loadu_ps(p); }
+inline void     simdStore(float* p, SLSimd4f a) { _mm_storeu_ps(p, a); }
+inline SLSimd4f simdSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline SLSimd4f simdSplat(float a) { return _mm_set1_ps(a); }
+inline SLSimd4f simdAdd(SLSimd4f a, SLSimd4f b) { return _mm_add_ps(a, b); }
+inline SLSimd4f simdSub(SLSimd4f a, SLSimd4f b) { return _mm_sub_ps(a, b); }
+inline SLSimd4f simdMul(SLSimd4f a, SLSimd4f b) { return _mm_mul_ps(a, b); }
+inline SLSimd4f simdDiv(SLSimd4f a, SLSimd4f b) { return _mm_div_ps(a, b); }
+inline SLSimd4f simdMin(SLSimd4f a, SLSimd4f b) { return _mm_min_ps(a, b); }
+inline SLSimd4f simdMax(SLSimd4f a, SLSimd4f b) { return _mm_max_ps(a, b); }
+inline SLSimd4f simdAbs(SLSimd4f a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline float    simdX(SLSimd4f a) { return _mm_cvtss_f32(a); }
+
+//! Returns (a[x], a[y], b[z], b[w]) like _mm_shuffle_ps
+template<int x, int y, int z, int w>
+inline SLSimd4f simdShuffle(SLSimd4f a, SLSimd4f b)
+{
+    return _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x));
+}
+//-----------------------------------------------------------------------------
+#    elif defined(SL_SIMD_NEON)
+typedef float32x4_t SLSimd4f;
+
+inline SLSimd4f simdLoad(const float* p) { return vld1q_f32(p); }
+inline void     simdStore(float* p, SLSimd4f a) { vst1q_f32(p, a); }
+inline SLSimd4f simdSet(float x, float y, float z, float w)
+{
+    const float v[4] = {x, y, z, w};
+    return vld1q_f32(v);
+}
+inline SLSimd4f simdSplat(float a) { return vdupq_n_f32(a); }
+inline SLSimd4f simdAdd(SLSimd4f a, SLSimd4f b) { return vaddq_f32(a, b); }
+inline SLSimd4f simdSub(SLSimd4f a, SLSimd4f b) { return vsubq_f32(a, b); }
+inline SLSimd4f simdMul(SLSimd4f a, SLSimd4f b) { return vmulq_f32(a, b); }
+inline SLSimd4f simdMin(SLSimd4f a, SLSimd4f b) { return vminq_f32(a, b); }
+inline SLSimd4f simdMax(SLSimd4f a, SLSimd4f b) { return vmaxq_f32(a, b); }
+inline SLSimd4f simdAbs(SLSimd4f a) { return vabsq_f32(a); }
+inline float    simdX(SLSimd4f a) { return vgetq_lane_f32(a, 0); }
+
+inline SLSimd4f simdDiv(SLSimd4f a, SLSimd4f b)
+{
+#        if defined(__aarch64__) || defined(_M_ARM64)
+    return vdivq_f32(a, b);
+#        else
+    // ARMv7 has no division: reciprocal estimate with 2 Newton-Raphson steps
+    SLSimd4f r = vrecpeq_f32(b);
+    r          = vmulq_f32(vrecpsq_f32(b, r), r);
+    r          = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+#        endif
+}
+
+//! Returns (a[x], a[y], b[z], b[w]) like _mm_shuffle_ps
+template<int x, int y, int z, int w>
+inline SLSimd4f simdShuffle(SLSimd4f a, SLSimd4f b)
+{
+#        if defined(__clang__)
+    return __builtin_shufflevector(a, b, x, y, z + 4, w + 4);
+#        elif defined(__GNUC__)
+    return __builtin_shuffle(a, b, (uint32x4_t){x, y, z + 4, w + 4});
+#        else
+    float va[4], vb[4];
+    vst1q_f32(va, a);
+    vst1q_f32(vb, b);
+    return simdSet(va[x], va[y], vb[z], vb[w]);
+#        endif
+}
+#    endif
+//-----------------------------------------------------------------------------
+//! Returns (a[x], a[y], a[z], a[w])
+template<int x, int y, int z, int w>
+inline SLSimd4f simdSwizzle(SLSimd4f a)
+{
+    return simdShuffle<x, y, z, w>(a, a);
+}
+//-----------------------------------------------------------------------------
+//! Returns a vector with all 4 components set to a[i]
+template<int i>
+inline SLSimd4f simdSplat(SLSimd4f a)
+{
+    return simdShuffle<i, i, i, i>(a, a);
+}
+//-----------------------------------------------------------------------------
+//! Returns a * b + c
+inline SLSimd4f simdMadd(SLSimd4f a, SLSimd4f b, SLSimd4f c)
+{
+    return simdAdd(simdMul(a, b), c);
+}
+//-----------------------------------------------------------------------------
+//! Returns the sum of all 4 components in all 4 components
+inline SLSimd4f simdHSum(SLSimd4f a)
+{
+    SLSimd4f s = simdAdd(a, simdSwizzle<1, 0, 3, 2>(a));
+    return simdAdd(s, simdSwizzle<2, 3, 0, 1>(s));
+}
+//-----------------------------------------------------------------------------
+//! Loads 3 floats into x, y & z and sets w
+inline SLSimd4f simdLoad3(const float* p, float w)
+{
+    return simdSet(p[0], p[1], p[2], w);
+}
+//-----------------------------------------------------------------------------
+//! Stores the components x, y & z
+inline void simdStore3(float* p, SLSimd4f a)
+{
+    float v[4];
+    simdStore(v, a);
+    p[0] = v[0];
+    p[1] = v[1];
+    p[2] = v[2];
+}
+//-----------------------------------------------------------------------------
+#endif // SL_SIMD
+#endif // SLMATHSIMD_H
@@ -218,8 +218,16 @@ void SENSBaseCamera::updateFrame(cv::Mat bgrImg,
                                  bool    intrinsicsChanged)
 {
     // estimate time before running into lock
-    SENSTimePt timePt = SENSClock::now();
-
+    updateFrame(SENSClock::now(), bgrImg, intrinsics, width, height, intrinsicsChanged);
+}
+//-----------------------------------------------------------------------------
+void SENSBaseCamera::updateFrame(const SENSTimePt& timePt,
+                                 cv::Mat           bgrImg,
+                                 cv::Mat           intrinsics,
+                                 int               width,
+                                 int               height,
+                                 bool              intrinsicsChanged)
+{
     // inform listeners
     {
         std::lock_guard<std::mutex> lock(_listenerMutex);
@@ -209,6 +209,13 @@ protected:
                      int     width,
                      int     height,
                      bool    intrinsicsChanged);
+    //!same as above but with a given frame time point (e.g. recorded time point in sensor simulation)
+    void updateFrame(const SENSTimePt& timePt,
+                     cv::Mat           bgrImg,
+                     cv::Mat           intrinsics,
+                     int               width,
+                     int               height,
+                     bool              intrinsicsChanged);
 
     void processStart(); //!< call from start function to do startup preprocessing
 
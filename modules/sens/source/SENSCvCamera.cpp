@@ -7,50 +7,82 @@
 SENSFramePtr SENSCvCamera::processNewFrame(const SENSTimePt& timePt, cv::Mat bgrImg, cv::Mat intrinsics, bool intrinsicsChanged)
 {
     //todo: accessing config readonly should be no problem  here, as the config only changes when camera is stopped
-    cv::Size inputSize = bgrImg.size();
-
-    // Crop Video image to required aspect ratio
+    //Crop Video image to required aspect ratio (this is only a view into the camera image, it is not copied)
     int cropW = 0, cropH = 0;
     SENS::cropImage(bgrImg, (float)_config->targetWidth / (float)_config->targetHeight, cropW, cropH);
 
-    // Mirroring
-    SENS::mirrorImage(bgrImg, _config->mirrorH, _config->mirrorV);
+    const bool mirror = _config->mirrorH || _config->mirrorV;
 
     cv::Mat manipImg;
     float   scale = 1.0f;
     //problem: eingangsbild 16:9 -> targetImg 4:3 -> crop left and right -> manipImg 16:9 -> weiterer crop oben und unten -> FALSCH
     if (_config->manipWidth > 0 && _config->manipHeight > 0)
     {
-        manipImg  = bgrImg;
-        int cropW = 0, cropH = 0;
-        SENS::cropImage(manipImg, (float)_config->manipWidth / (float)_config->manipHeight, cropW, cropH);
-        scale = (float)_config->manipWidth / (float)manipImg.size().width;
-        cv::resize(manipImg, manipImg, cv::Size(), scale, scale);
+        cv::Mat manipSrc = bgrImg;
+        SENS::cropImage(manipSrc, (float)_config->manipWidth / (float)_config->manipHeight, cropW, cropH);
+        scale = (float)_config->manipWidth / (float)manipSrc.size().width;
+        cv::Size manipSize(cvRound((float)manipSrc.cols * scale), cvRound((float)manipSrc.rows * scale));
+
+        if (!_config->convertManipToGray && !mirror)
+        {
+            //resize directly into the pooled buffer
+            manipImg = _framePool->acquire(manipSize.height, manipSize.width, manipSrc.type());
+            cv::resize(manipSrc, manipImg, manipSize);
+        }
+        else
+        {
+            //resize the small image first, so that gray conversion and mirroring only work on the small image
+            cv::resize(manipSrc, _manipBuffer, manipSize);
+            manipImg = grayAndMirrorToPool(_manipBuffer);
+        }
     }
     else if (_config->convertManipToGray)
     {
-        manipImg = bgrImg;
-    }
-
-    // Create grayscale
-    if (_config->convertManipToGray)
-    {
-        cv::cvtColor(manipImg, manipImg, cv::COLOR_BGR2GRAY);
+        manipImg = grayAndMirrorToPool(bgrImg);
     }
 
-    SENSFramePtr sensFrame = std::make_unique<SENSFrame>(timePt,
-                                                         bgrImg.clone(),
+    //The bgr image is mirrored and copied lazily on first call to SENSFrame::imgBGR().
+    //The camera frame is not changed anymore after it was published, so we can reference it and its intrinsics without cloning.
+    SENSFramePtr sensFrame = std::make_shared<SENSFrame>(timePt,
+                                                         bgrImg,
+                                                         _framePool,
                                                          manipImg,
                                                          _config->mirrorH,
                                                          _config->mirrorV,
                                                          1 / scale,
-                                                         intrinsics.clone(),
+                                                         intrinsics,
                                                          manipImg.cols,
                                                          manipImg.rows);
 
     return sensFrame;
 }
 
+//convert to gray (if configured) and mirror (if configured) into a pooled buffer
+cv::Mat SENSCvCamera::grayAndMirrorToPool(const cv::Mat& src)
+{
+    int flipCode = _config->mirrorH ? (_config->mirrorV ? -1 : 1) : 0;
+
+    if (_config->convertManipToGray)
+    {
+        cv::Mat grayImg = _framePool->acquire(src.rows, src.cols, CV_8UC1);
+        if (_config->mirrorH || _config->mirrorV)
+        {
+            cv::cvtColor(src, _grayBuffer, cv::COLOR_BGR2GRAY);
+            cv::flip(_grayBuffer, grayImg, flipCode);
+        }
+        else
+            cv::cvtColor(src, grayImg, cv::COLOR_BGR2GRAY);
+        return grayImg;
+    }
+
+    cv::Mat img = _framePool->acquire(src.rows, src.cols, src.type());
+    if (_config->mirrorH || _config->mirrorV)
+        cv::flip(src, img, flipCode);
+    else
+        src.copyTo(img);
+    return img;
+}
+
 void SENSCvCamera::guessAndSetCalibration(float fovDegFallbackGuess)
 {
     //We make a calibration with full resolution and adjust it to the manipulated image size later if neccessary:
@@ -79,7 +111,8 @@ void SENSCvCamera::guessAndSetCalibration(float fovDegFallbackGuess)
 }
 
 SENSCvCamera::SENSCvCamera(SENSCamera* camera)
-  : _camera(camera)
+  : _camera(camera),
+    _framePool(std::make_shared<SENSFramePool>())
 {
     assert(camera);
     //retrieve capture properties
@@ -168,6 +201,9 @@ SENSCvCamera::ConfigReturnCode SENSCvCamera::configure(SENSCameraFacing facing,
                                                    mirrorV,
                                                    convertManipToGray);
 
+    //image sizes may change: release pooled buffers (buffers of frames that are still in use stay valid)
+    _framePool->clear();
+
     //guess calibrations if no calibration is set from outside
     if (!_calibrationOverwrite)
         guessAndSetCalibration(65.f);
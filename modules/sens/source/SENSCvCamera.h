@@ -108,6 +108,8 @@ public:
     bool start();
     void stop();
 
+    //! Process latest camera frame. The images of the returned frame are pooled buffers that are recycled when
+    //! the frame is released, so do not keep frames longer than needed. The BGR image is copied on first access (SENSFrame::imgBGR()).
     SENSFramePtr latestFrame();
 
     bool supportsFacing(SENSCameraFacing facing);
@@ -133,6 +135,7 @@ public:
 
 private:
     SENSFramePtr processNewFrame(const SENSTimePt& timePt, cv::Mat bgrImg, cv::Mat intrinsics, bool intrinsicsChanged);
+    cv::Mat      grayAndMirrorToPool(const cv::Mat& src);
 
     SENSCamera*                         _camera;
     std::unique_ptr<SENSCvCameraConfig> _config;
@@ -144,6 +147,12 @@ private:
 
     //this is a calibration that is set from outside. if it is valid, no guesses will be made
     std::unique_ptr<SENSCalibration> _calibrationOverwrite;
+
+    //! recycled image buffers for processed frames
+    SENSFramePoolPtr _framePool;
+    //! intermediate buffers of processNewFrame (reused for every frame)
+    cv::Mat _manipBuffer;
+    cv::Mat _grayBuffer;
 };
 
 #endif //SENS_CV_CAMERA_H
@@ -4,6 +4,9 @@
 #include <opencv2/core.hpp>
 #include <SENS.h>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <vector>
 
 //Camera frame obeject
 struct SENSFrameBase
@@ -27,6 +30,67 @@ struct SENSFrameBase
 using SENSFrameBasePtr = std::shared_ptr<SENSFrameBase>;
 //typedef std::shared_ptr<SENSFrameBase> SENSFrameBasePtr;
 
+/*! SENSFramePool
+Pool of recycled image buffers for SENSFrame. A buffer is free again as soon as no cv::Mat outside
+of the pool references it anymore (we use the reference counting of cv::Mat). In this way a steady
+stream of camera frames needs no new image allocations once the pool is warmed up.
+ */
+class SENSFramePool
+{
+public:
+    //!maxBuffers: maximum number of buffers kept in the pool. If all of them are in use, an unpooled buffer is returned.
+    explicit SENSFramePool(size_t maxBuffers = 16)
+      : _maxBuffers(maxBuffers)
+    {
+    }
+
+    //!get a buffer of given size and type that is not referenced outside of the pool
+    cv::Mat acquire(int rows, int cols, int type)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (cv::Mat& buffer : _buffers)
+        {
+            if (buffer.u && buffer.u->refcount == 1 && buffer.rows == rows && buffer.cols == cols && buffer.type() == type)
+                return buffer;
+        }
+
+        _numAllocations++;
+        cv::Mat buffer(rows, cols, type);
+        if (_buffers.size() < _maxBuffers)
+            _buffers.push_back(buffer);
+        else
+        {
+            //replace a free buffer of wrong size, if there is one
+            for (cv::Mat& b : _buffers)
+            {
+                if (b.u && b.u->refcount == 1)
+                {
+                    b = buffer;
+                    break;
+                }
+            }
+        }
+        return buffer;
+    }
+
+    //!release all buffers (buffers that are still in use stay valid)
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _buffers.clear();
+    }
+
+    //!number of buffer allocations since construction (should stay constant for a stream of equally sized frames)
+    size_t numAllocations() const { return _numAllocations; }
+
+private:
+    std::vector<cv::Mat> _buffers;
+    size_t               _maxBuffers;
+    std::atomic<size_t>  _numAllocations{0};
+    std::mutex           _mutex;
+};
+using SENSFramePoolPtr = std::shared_ptr<SENSFramePool>;
+
 struct SENSFrame
 {
     SENSFrame(const SENSTimePt& timePt,
@@ -39,7 +103,32 @@ struct SENSFrame
               int               width,
               int               height)
       : timePt(timePt),
-        imgBGR(imgBGR),
+        _imgBGR(imgBGR),
+        imgManip(imgManip),
+        mirroredH(mirroredH),
+        mirroredV(mirroredV),
+        scaleToManip(scaleToManip),
+        intrinsics(intrinsics),
+        width(width),
+        height(height)
+    {
+    }
+
+    //!Constructor for lazy BGR images: srcBGR is the (cropped) unmirrored camera image. The mirrored copy is
+    //!only materialized in a pooled buffer when imgBGR() is called for the first time.
+    SENSFrame(const SENSTimePt& timePt,
+              cv::Mat           srcBGR,
+              SENSFramePoolPtr  pool,
+              cv::Mat           imgManip,
+              bool              mirroredH,
+              bool              mirroredV,
+              float             scaleToManip,
+              cv::Mat           intrinsics,
+              int               width,
+              int               height)
+      : timePt(timePt),
+        _srcBGR(srcBGR),
+        _pool(pool),
         imgManip(imgManip),
         mirroredH(mirroredH),
         mirroredV(mirroredV),
@@ -50,10 +139,41 @@ struct SENSFrame
     {
     }
 
+    //! original image (maybe cropped and scaled). It is materialized on first call if the frame was created lazily.
+    //! Every call goes through call_once, so that _srcBGR is never read while another thread releases it.
+    const cv::Mat& imgBGR()
+    {
+        std::call_once(_bgrMaterialized, [this] { materializeBGR(); });
+        return _imgBGR;
+    }
+
     const SENSTimePt timePt;
 
+private:
+    void materializeBGR()
+    {
+        //frames created with an image are already materialized
+        if (_srcBGR.empty())
+            return;
+
+        _imgBGR = _pool ? _pool->acquire(_srcBGR.rows, _srcBGR.cols, _srcBGR.type()) : cv::Mat(_srcBGR.size(), _srcBGR.type());
+        if (mirroredH || mirroredV)
+            cv::flip(_srcBGR, _imgBGR, mirroredH && mirroredV ? -1 : (mirroredH ? 1 : 0));
+        else
+            _srcBGR.copyTo(_imgBGR);
+        //release the camera image
+        _srcBGR.release();
+        _pool.reset();
+    }
+
     //! original image (maybe cropped and scaled)
-    cv::Mat imgBGR;
+    cv::Mat _imgBGR;
+    //! source of lazy BGR image and pool to materialize it
+    cv::Mat          _srcBGR;
+    SENSFramePoolPtr _pool;
+    std::once_flag   _bgrMaterialized;
+
+public:
     //! scaled and maybe gray manipulated image
     cv::Mat imgManip;
 
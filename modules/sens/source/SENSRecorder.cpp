@@ -96,6 +96,30 @@ bool SENSRecorder::deactivateCamera()
         return true;
 }
 
+bool SENSRecorder::configureCameraQueue(size_t capacity, SENSRecorderQueuePolicy policy)
+{
+    if (!_running && _cameraDataHandler)
+    {
+        _cameraDataHandler->configureQueue(capacity, policy);
+        return true;
+    }
+    else
+        return false;
+}
+
+bool SENSRecorder::configureCameraEncoding(SENSRecorderVideoFormat format,
+                                           int                     numEncoderThreads,
+                                           int                     jpegQuality)
+{
+    if (!_running && _cameraDataHandler)
+    {
+        _cameraDataHandler->configureEncoding(format, numEncoderThreads, jpegQuality);
+        return true;
+    }
+    else
+        return false;
+}
+
 bool SENSRecorder::start()
 {
     if (_running)
@@ -182,6 +206,21 @@ bool SENSRecorder::getCameraHandlerError(std::string& errorMsg)
         return false;
 }
 
+SENSRecorderQueueStats SENSRecorder::getGpsStats()
+{
+    return _gpsDataHandler ? _gpsDataHandler->getStats() : SENSRecorderQueueStats();
+}
+
+SENSRecorderQueueStats SENSRecorder::getOrientationStats()
+{
+    return _orientationDataHandler ? _orientationDataHandler->getStats() : SENSRecorderQueueStats();
+}
+
+SENSRecorderQueueStats SENSRecorder::getCameraStats()
+{
+    return _cameraDataHandler ? _cameraDataHandler->getStats() : SENSRecorderQueueStats();
+}
+
 void SENSRecorder::onGps(const SENSTimePt& timePt, const SENSGps::Location& loc)
 {
     auto newData = std::make_pair(loc, timePt);
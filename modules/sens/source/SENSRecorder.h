@@ -30,6 +30,13 @@ public:
     bool activateCamera(SENSCamera* sensor);
     bool deactivateCamera();
 
+    //!Configure capacity and full queue policy of the camera frame queue (only possible if not running)
+    bool configureCameraQueue(size_t capacity, SENSRecorderQueuePolicy policy);
+    //!Configure video format, no. of jpeg encoder threads and jpeg quality (only possible if not running)
+    bool configureCameraEncoding(SENSRecorderVideoFormat format,
+                                 int                     numEncoderThreads = 2,
+                                 int                     jpegQuality       = 95);
+
     //!Start the recording of activated sensors (Registers listeners and starts SENSRecorderDataHandler backends).
     //!Returns true on success. Possible reasons for fail are: Output directory does not exist or recorder is already running.
     bool start();
@@ -40,6 +47,11 @@ public:
     bool getOrientationHandlerError(std::string& errorMsg);
     bool getCameraHandlerError(std::string& errorMsg);
 
+    //!Queue depth, dropped and written values of the current or last recording
+    SENSRecorderQueueStats getGpsStats();
+    SENSRecorderQueueStats getOrientationStats();
+    SENSRecorderQueueStats getCameraStats();
+
     bool               isRunning() const { return _running; }
     const std::string& outputDir() const { return _outputDir; }
 
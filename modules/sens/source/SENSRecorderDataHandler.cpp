@@ -1,10 +1,18 @@
 #include "SENSRecorderDataHandler.h"
+#include <ByteOrder.h>
 #include <HighResTimer.h>
+#include <algorithm>
+#include <sstream>
 //-----------------------------------------------------------------------------
 template<typename T>
-SENSRecorderDataHandler<T>::SENSRecorderDataHandler(const std::string& name)
-  : _name(name)
+SENSRecorderDataHandler<T>::SENSRecorderDataHandler(const std::string&      name,
+                                                    size_t                  capacity,
+                                                    SENSRecorderQueuePolicy policy)
+  : _name(name),
+    _queue(std::max<size_t>(capacity, 1)),
+    _policy(policy)
 {
+    _stats.capacity = _queue.size();
 }
 
 template<typename T>
@@ -13,12 +21,38 @@ SENSRecorderDataHandler<T>::~SENSRecorderDataHandler()
     stop();
 }
 
+template<typename T>
+void SENSRecorderDataHandler<T>::configureQueue(size_t capacity, SENSRecorderQueuePolicy policy)
+{
+    if (_thread.joinable())
+    {
+        SENS_WARN("SENSRecorderDataHandler configureQueue: not possible while %s is recording", _name.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue          = std::vector<T>(std::max<size_t>(capacity, 1));
+    _queueHead      = 0;
+    _queueSize      = 0;
+    _policy         = policy;
+    _stats.capacity = _queue.size();
+}
+
 template<typename T>
 void SENSRecorderDataHandler<T>::start(const std::string& outputDir)
 {
     stop();
     //start writer thread
-    _errorMsg.clear();
+    {
+        std::lock_guard<std::mutex> lock(_msgMutex);
+        _errorMsg.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats          = SENSRecorderQueueStats();
+        _stats.capacity = _queue.size();
+        _running        = true;
+    }
     _outputDir = outputDir;
     _thread    = std::thread(&SENSRecorderDataHandler::store, this);
 }
@@ -27,16 +61,24 @@ template<typename T>
 void SENSRecorderDataHandler<T>::stop()
 {
     std::unique_lock<std::mutex> lock(_mutex);
-    _stop = true;
+    _stop    = true;
+    _running = false;
     lock.unlock();
     _condVar.notify_one();
+    _spaceCondVar.notify_all();
 
     if (_thread.joinable())
         _thread.join();
 
+    //the store thread writes all queued values before it finishes, so only
+    //values that could not be written anymore are left here
     lock.lock();
-    _queue.clear();
-    _stop = false;
+    _stats.numDropped += _queueSize;
+    std::fill(_queue.begin(), _queue.end(), T());
+    _queueHead        = 0;
+    _queueSize        = 0;
+    _stats.queueDepth = 0;
+    _stop             = false;
 }
 
 template<typename T>
@@ -49,49 +91,40 @@ void SENSRecorderDataHandler<T>::store()
     ofstream    file;
     file.open(fileName);
     if (file.is_open())
-    {
         writeHeaderToFile(file);
-        while (true)
-        {
-            std::unique_lock<std::mutex> lock(_mutex);
-
-            _condVar.wait(lock, [&] { return (_stop == true || _queue.size() != 0); });
-            if (_stop)
-                break;
+    else
+        setErrorMsg("Could not open file: " + fileName);
 
-            SENS_DEBUG("SENSRecorderDataHandler: queue size: %d", _queue.size());
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
 
-            std::deque<T> localQueue;
-            while (_queue.size())
-            {
-                localQueue.push_back(_queue.front());
-                _queue.pop_front();
-            }
+        _condVar.wait(lock, [&] { return (_stop == true || _queueSize != 0); });
+        //on stop we finish writing the values in the queue
+        if (_queueSize == 0)
+            break;
 
-            lock.unlock();
+        T item             = std::move(_queue[_queueHead]);
+        _queue[_queueHead] = T();
+        _queueHead         = (_queueHead + 1) % _queue.size();
+        _queueSize--;
+        _stats.queueDepth = _queueSize;
 
-            //write data
-            if (localQueue.size())
-            {
-                writeLineToFile(file, localQueue.front());
-                localQueue.pop_front();
-            }
+        lock.unlock();
+        _spaceCondVar.notify_one();
 
-            if (localQueue.size())
-            {
-                std::stringstream ss;
-                ss << "Data writing is too slow. Skipping " << localQueue.size() << " values from queue!";
-                SENS_WARN("SENSRecorderDataHandler store: %s", ss.str().c_str());
-                //if buffer is running full, warn and skip values
-                {
-                    std::lock_guard<std::mutex> lock(_msgMutex);
-                    _errorMsg = ss.str();
-                }
-                localQueue.clear();
-            }
+        //write data
+        if (file.is_open())
+        {
+            writeLineToFile(file, item);
+            if (!_reportsWrittenItself)
+                reportWritten(1);
         }
+        else
+            reportDropped(1);
     }
-    writeOnThreadFinish();
+
+    writeOnThreadFinish(file);
     //close file
     file.close();
 }
@@ -100,9 +133,59 @@ template<typename T>
 void SENSRecorderDataHandler<T>::add(T&& item)
 {
     std::unique_lock<std::mutex> lock(_mutex);
-    _queue.push_back(std::move(item));
+    if (!_running)
+        return;
+
+    _stats.numAdded++;
+
+    bool dropped       = false;
+    bool droppedOldest = false;
+    if (_queueSize == _queue.size())
+    {
+        switch (_policy)
+        {
+            case SENSRecorderQueuePolicy::DROP_NEWEST:
+                dropped = true;
+                break;
+            case SENSRecorderQueuePolicy::DROP_OLDEST:
+                _queue[_queueHead] = T();
+                _queueHead         = (_queueHead + 1) % _queue.size();
+                _queueSize--;
+                _stats.numDropped++;
+                droppedOldest = true;
+                break;
+            case SENSRecorderQueuePolicy::BLOCK:
+                _spaceCondVar.wait(lock, [&] { return (_stop == true || _queueSize < _queue.size()); });
+                dropped = _queueSize == _queue.size();
+                break;
+        }
+    }
+
+    if (dropped)
+        _stats.numDropped++;
+    else
+    {
+        _queue[(_queueHead + _queueSize) % _queue.size()] = std::move(item);
+        _queueSize++;
+        _stats.queueDepth    = _queueSize;
+        _stats.maxQueueDepth = std::max(_stats.maxQueueDepth, _queueSize);
+    }
+
+    uint64_t numDropped = _stats.numDropped;
     lock.unlock();
-    _condVar.notify_one();
+
+    if (!dropped)
+        _condVar.notify_one();
+
+    if (dropped || droppedOldest)
+    {
+        std::stringstream ss;
+        ss << "Data writing is too slow. Dropped " << numDropped << " " << _name << " values so far!";
+        //warn only at powers of two to not flood the log
+        if ((numDropped & (numDropped - 1)) == 0)
+            SENS_WARN("SENSRecorderDataHandler add: %s", ss.str().c_str());
+        setErrorMsg(ss.str());
+    }
 }
 
 template<typename T>
@@ -118,6 +201,34 @@ bool SENSRecorderDataHandler<T>::getErrorMsg(std::string& msg)
     }
 }
 
+template<typename T>
+SENSRecorderQueueStats SENSRecorderDataHandler<T>::getStats()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+template<typename T>
+void SENSRecorderDataHandler<T>::reportDropped(uint64_t numDropped)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.numDropped += numDropped;
+}
+
+template<typename T>
+void SENSRecorderDataHandler<T>::reportWritten(uint64_t numWritten)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.numWritten += numWritten;
+}
+
+template<typename T>
+void SENSRecorderDataHandler<T>::setErrorMsg(const std::string& msg)
+{
+    std::lock_guard<std::mutex> lock(_msgMutex);
+    _errorMsg = msg;
+}
+
 //explicit instantiation
 template class SENSRecorderDataHandler<GpsInfo>;
 template class SENSRecorderDataHandler<OrientationInfo>;
@@ -158,15 +269,203 @@ void SENSOrientationRecorderDataHandler::writeLineToFile(ofstream& file, const O
          << data.first.quatW << "\n";
 }
 
+//-----------------------------------------------------------------------------
+bool SENSMJpegAviWriter::open(const std::string& fileName, int width, int height, double fps)
+{
+    close();
+    _file.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!_file.is_open())
+        return false;
+
+    _index.clear();
+    _maxFrameSize = 0;
+    _width        = width;
+    _height       = height;
+    _fps          = fps > 0.0 ? fps : 30.0;
+
+    //write headers with placeholders for the sizes and frame counts
+    writeHeaders(0, 0, 0);
+    _moviStart = _file.tellp() - (std::streamoff)4;
+    return _file.good();
+}
+
+bool SENSMJpegAviWriter::write(const std::vector<uchar>& jpeg)
+{
+    if (!_file.is_open() || jpeg.empty())
+        return false;
+
+    uint64_t size   = jpeg.size();
+    uint64_t padded = size + (size & 1);
+    uint64_t pos    = (uint64_t)_file.tellp();
+
+    //the whole file incl. the index has to fit into 32 bit sizes
+    uint64_t indexSize = 8 + 16 * (_index.size() / 2 + 1);
+    if (pos + 8 + padded + indexSize > 0xFFFFFFFFull)
+        return false;
+
+    _index.push_back((uint32_t)(pos - (uint64_t)_moviStart));
+    _index.push_back((uint32_t)size);
+    _maxFrameSize = std::max(_maxFrameSize, (uint32_t)size);
+
+    writeFourCC("00dc");
+    writeU32((uint32_t)size);
+    _file.write((const char*)jpeg.data(), (std::streamsize)size);
+    if (size & 1)
+        _file.put(0);
+
+    return _file.good();
+}
+
+void SENSMJpegAviWriter::close()
+{
+    if (!_file.is_open())
+        return;
+
+    uint64_t moviEnd = (uint64_t)_file.tellp();
+
+    //index with one entry per frame (all frames are key frames)
+    writeFourCC("idx1");
+    writeU32((uint32_t)(_index.size() * 8));
+    for (size_t i = 0; i < _index.size(); i += 2)
+    {
+        writeFourCC("00dc");
+        writeU32(0x10); //AVIIF_KEYFRAME
+        writeU32(_index[i]);
+        writeU32(_index[i + 1]);
+    }
+
+    uint64_t fileEnd = (uint64_t)_file.tellp();
+
+    _file.seekp(0);
+    writeHeaders((uint32_t)(_index.size() / 2),
+                 (uint32_t)(fileEnd - 8),
+                 (uint32_t)(moviEnd - (uint64_t)_moviStart));
+    _file.close();
+    _index.clear();
+}
+
+void SENSMJpegAviWriter::writeHeaders(uint32_t numFrames, uint32_t riffSize, uint32_t moviSize)
+{
+    uint32_t usPerFrame = (uint32_t)(1000000.0 / _fps);
+
+    writeFourCC("RIFF");
+    writeU32(riffSize);
+    writeFourCC("AVI ");
+
+    writeFourCC("LIST");
+    writeU32(192);
+    writeFourCC("hdrl");
+
+    //main avi header
+    writeFourCC("avih");
+    writeU32(56);
+    writeU32(usPerFrame);
+    writeU32((uint32_t)(_maxFrameSize * _fps)); //max bytes per second
+    writeU32(0);                                //padding granularity
+    writeU32(0x10);                             //AVIF_HASINDEX
+    writeU32(numFrames);
+    writeU32(0); //initial frames
+    writeU32(1); //no. of streams
+    writeU32(_maxFrameSize);
+    writeU32((uint32_t)_width);
+    writeU32((uint32_t)_height);
+    for (int i = 0; i < 4; ++i)
+        writeU32(0);
+
+    writeFourCC("LIST");
+    writeU32(116);
+    writeFourCC("strl");
+
+    //stream header
+    writeFourCC("strh");
+    writeU32(56);
+    writeFourCC("vids");
+    writeFourCC("MJPG");
+    writeU32(0); //flags
+    writeU32(0); //priority and language
+    writeU32(0); //initial frames
+    writeU32(1000);
+    writeU32((uint32_t)(_fps * 1000.0 + 0.5)); //rate / scale = fps
+    writeU32(0);                               //start
+    writeU32(numFrames);
+    writeU32(_maxFrameSize);
+    writeU32(0xFFFFFFFF); //quality
+    writeU32(0);          //sample size
+    writeU32(0);          //frame rectangle left, top
+    writeU32((uint32_t)_width | (uint32_t)_height << 16);
+
+    //stream format (BITMAPINFOHEADER)
+    writeFourCC("strf");
+    writeU32(40);
+    writeU32(40);
+    writeU32((uint32_t)_width);
+    writeU32((uint32_t)_height);
+    writeU32(1 | 24 << 16); //planes and bits per pixel
+    writeFourCC("MJPG");
+    writeU32((uint32_t)(_width * _height * 3));
+    for (int i = 0; i < 4; ++i)
+        writeU32(0);
+
+    writeFourCC("LIST");
+    writeU32(moviSize);
+    writeFourCC("movi");
+}
+
+void SENSMJpegAviWriter::writeU32(uint32_t value)
+{
+    char bytes[4] = {(char)(value & 0xFF),
+                     (char)((value >> 8) & 0xFF),
+                     (char)((value >> 16) & 0xFF),
+                     (char)((value >> 24) & 0xFF)};
+    _file.write(bytes, 4);
+}
+
+void SENSMJpegAviWriter::writeFourCC(const char* fourCC)
+{
+    _file.write(fourCC, 4);
+}
+
 //-----------------------------------------------------------------------------
 SENSCameraRecorderDataHandler::SENSCameraRecorderDataHandler()
-  : SENSRecorderDataHandler("camera")
+  : SENSRecorderDataHandler("camera", 32, SENSRecorderQueuePolicy::DROP_NEWEST)
+{
+    _reportsWrittenItself = true;
+}
+
+SENSCameraRecorderDataHandler::~SENSCameraRecorderDataHandler()
+{
+    //stop the store thread before our members are destroyed
+    stop();
+}
+
+void SENSCameraRecorderDataHandler::configureEncoding(SENSRecorderVideoFormat format,
+                                                      int                     numEncoderThreads,
+                                                      int                     jpegQuality)
 {
+    _format            = format;
+    _numEncoderThreads = std::max(1, numEncoderThreads);
+    _jpegQuality       = std::min(100, std::max(0, jpegQuality));
 }
 
 void SENSCameraRecorderDataHandler::writeOnThreadStart()
 {
-    _frameIndex = 0;
+    _frameIndex    = 0;
+    _nextSubmitSeq = 0;
+    _nextWriteSeq  = 0;
+    _encoded.clear();
+    _frameSize = cv::Size();
+
+    if (_format == SENSRecorderVideoFormat::MJPEG)
+        startEncoders();
+    else
+    {
+        std::string filename = _outputDir + "video.raw";
+        _rawFile.open(filename, std::ios::binary | std::ios::trunc);
+        if (_rawFile.is_open())
+            _rawFile.write("SENSRAW1", 8);
+        else
+            setErrorMsg("Could not open file: " + filename);
+    }
 }
 
 void SENSCameraRecorderDataHandler::writeLineToFile(ofstream& file, const FrameInfo& data)
@@ -174,37 +473,196 @@ void SENSCameraRecorderDataHandler::writeLineToFile(ofstream& file, const FrameI
     if (data.first.empty())
     {
         SENS_WARN("SENSCameraRecorderDataHandler::writeLineToFile: frame is empty");
+        reportDropped(1);
+        return;
+    }
+
+    if (_format == SENSRecorderVideoFormat::RAW)
+    {
+        writeRawFrame(file, data);
         return;
     }
 
-    if (!_videoWriter.isOpened())
+    if (!_aviWriter.isOpened())
     {
         std::string filename = _outputDir + "video.avi";
-        _videoWriter.open(filename, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 30, data.first.size(), true);
-        //_videoWriter.open(filename, cv::VideoWriter::fourcc('X', 'V', 'I', 'D'), 30, data.first.size(), true);
-        SENS_DEBUG("Opening video for writing: %s", filename.c_str());
+        _frameSize           = data.first.size();
+        if (_aviWriter.open(filename, _frameSize.width, _frameSize.height, 30))
+            SENS_DEBUG("Opening video for writing: %s", filename.c_str());
     }
 
-    if (!_videoWriter.isOpened())
+    if (!_aviWriter.isOpened())
     {
         SENS_WARN("SENSCameraRecorderDataHandler::writeLineToFile: video writer not opened");
+        reportDropped(1);
+        return;
     }
-    else
+
+    //all frames in an avi must have the same size
+    if (data.first.size() != _frameSize)
+    {
+        SENS_WARN("SENSCameraRecorderDataHandler::writeLineToFile: frame size changed during recording");
+        reportDropped(1);
+        return;
+    }
+
+    //hand frame over to the encoder pool
+    {
+        std::lock_guard<std::mutex> lock(_encMutex);
+        _jobs.push_back({_nextSubmitSeq++, data});
+    }
+    _jobCondVar.notify_one();
+
+    //write finished frames in order and wait if too many frames are in flight,
+    //so that the backpressure reaches the queue and its policy
+    writeEncodedFrames(file, 2 * (uint64_t)_encoders.size());
+}
+
+void SENSCameraRecorderDataHandler::writeOnThreadFinish(ofstream& file)
+{
+    if (_format == SENSRecorderVideoFormat::MJPEG)
+    {
+        writeEncodedFrames(file, 0);
+        stopEncoders();
+        _aviWriter.close();
+    }
+    else if (_rawFile.is_open())
+        _rawFile.close();
+}
+
+void SENSCameraRecorderDataHandler::startEncoders()
+{
+    stopEncoders();
+    for (int i = 0; i < _numEncoderThreads; ++i)
+        _encoders.emplace_back(&SENSCameraRecorderDataHandler::encode, this);
+}
+
+void SENSCameraRecorderDataHandler::stopEncoders()
+{
+    std::unique_lock<std::mutex> lock(_encMutex);
+    _stopEncoders = true;
+    lock.unlock();
+    _jobCondVar.notify_all();
+
+    for (auto& encoder : _encoders)
+        encoder.join();
+    _encoders.clear();
+
+    lock.lock();
+    _stopEncoders = false;
+}
+
+//!encoder thread routine: encodes jobs until stopped and no jobs are left
+void SENSCameraRecorderDataHandler::encode()
+{
+    std::vector<int> params = {cv::IMWRITE_JPEG_QUALITY, _jpegQuality};
+
+    while (true)
     {
-        long long timePt = std::chrono::time_point_cast<SENSMicroseconds>(data.second).time_since_epoch().count();
-        //write time and frame index
-        file << timePt << " " << _frameIndex << "\n";
-        //SENS_DEBUG("SENSCameraRecorderDataHandler: time point for frame %d is %s", _frameIndex, timeStr.c_str());
-        _frameIndex++;
+        std::unique_lock<std::mutex> lock(_encMutex);
+        _jobCondVar.wait(lock, [&] { return (_stopEncoders || !_jobs.empty()); });
+        if (_jobs.empty())
+            break;
+
+        EncodeJob job = std::move(_jobs.front());
+        _jobs.pop_front();
+        lock.unlock();
 
-        _videoWriter.write(data.first);
+        std::vector<uchar> jpeg;
+        try
+        {
+            cv::imencode(".jpg", job.frame.first, jpeg, params);
+        }
+        catch (cv::Exception& e)
+        {
+            SENS_WARN("SENSCameraRecorderDataHandler::encode: %s", e.what());
+            jpeg.clear();
+        }
+
+        lock.lock();
+        _encoded[job.seq] = std::make_pair(std::move(jpeg), job.frame.second);
+        lock.unlock();
+        _resultCondVar.notify_all();
+    }
+}
+
+/*! Writes the encoded frames in the order they were submitted. Returns when the
+ next frame is not yet encoded and at most maxInFlight frames are still in the
+ encoder pool. With maxInFlight = 0 it waits until all frames are written.
+ */
+void SENSCameraRecorderDataHandler::writeEncodedFrames(ofstream& file, uint64_t maxInFlight)
+{
+    std::unique_lock<std::mutex> lock(_encMutex);
+    while (true)
+    {
+        auto it = _encoded.find(_nextWriteSeq);
+        if (it != _encoded.end())
+        {
+            EncodedFrame encoded = std::move(it->second);
+            _encoded.erase(it);
+            _nextWriteSeq++;
+            lock.unlock();
+
+            if (_aviWriter.write(encoded.first))
+            {
+                writeTimePt(file, encoded.second);
+                reportWritten(1);
+            }
+            else
+            {
+                if (!encoded.first.empty())
+                    setErrorMsg("Video file is full (4 GB). Frames are dropped!");
+                reportDropped(1);
+            }
+
+            lock.lock();
+            continue;
+        }
+
+        if (_nextSubmitSeq - _nextWriteSeq <= maxInFlight)
+            break;
+
+        _resultCondVar.wait(lock);
+    }
+}
+
+void SENSCameraRecorderDataHandler::writeRawFrame(ofstream& file, const FrameInfo& data)
+{
+    if (!_rawFile.is_open())
+    {
+        reportDropped(1);
+        return;
+    }
+
+    cv::Mat  frame  = data.first.isContinuous() ? data.first : data.first.clone();
+    int32_t  header[4] = {_frameIndex, frame.rows, frame.cols, frame.type()};
+    int64_t  timePt    = std::chrono::time_point_cast<SENSMicroseconds>(data.second).time_since_epoch().count();
+    uint64_t size      = frame.total() * frame.elemSize();
+
+    for (int32_t value : header)
+        ByteOrder::writeLittleEndian32((uint32_t)value, _rawFile);
+    ByteOrder::writeLittleEndian64((uint64_t)timePt, _rawFile);
+    ByteOrder::writeLittleEndian64(size, _rawFile);
+    _rawFile.write((const char*)frame.data, (std::streamsize)size);
+
+    if (_rawFile.good())
+    {
+        writeTimePt(file, data.second);
+        reportWritten(1);
+    }
+    else
+    {
+        setErrorMsg("Writing raw video file failed!");
+        reportDropped(1);
     }
 }
 
-void SENSCameraRecorderDataHandler::writeOnThreadFinish()
+//!write time and frame index to camera.txt
+void SENSCameraRecorderDataHandler::writeTimePt(ofstream& file, const SENSTimePt& timePt)
 {
-    if (_videoWriter.isOpened())
-        _videoWriter.release();
+    file << std::chrono::time_point_cast<SENSMicroseconds>(timePt).time_since_epoch().count()
+         << " " << _frameIndex << "\n";
+    _frameIndex++;
 }
 
 void SENSCameraRecorderDataHandler::updateConfig(const SENSCameraConfig& config)
@@ -5,6 +5,8 @@
 #include <thread>
 #include <atomic>
 #include <deque>
+#include <map>
+#include <vector>
 #include <utility>
 #include <mutex>
 #include <fstream>
@@ -23,18 +25,67 @@ using GpsInfo         = std::pair<SENSGps::Location, SENSTimePt>;
 using OrientationInfo = std::pair<SENSOrientation::Quat, SENSTimePt>;
 using FrameInfo       = std::pair<cv::Mat, SENSTimePt>;
 
+//-----------------------------------------------------------------------------
+//!What happens with new values if the queue of a SENSRecorderDataHandler is full
+enum class SENSRecorderQueuePolicy
+{
+    //!the new value is dropped
+    DROP_NEWEST = 0,
+    //!the oldest value in the queue is dropped
+    DROP_OLDEST,
+    //!the sensor thread is blocked until the store thread made space
+    BLOCK
+};
+
+//-----------------------------------------------------------------------------
+//!Statistics of the queue of a SENSRecorderDataHandler
+struct SENSRecorderQueueStats
+{
+    //!current number of values in the queue
+    size_t queueDepth = 0;
+    //!maximum number of values that were in the queue during this recording
+    size_t maxQueueDepth = 0;
+    //!capacity of the queue
+    size_t capacity = 0;
+    //!number of values added by the sensors
+    uint64_t numAdded = 0;
+    //!number of values written to file
+    uint64_t numWritten = 0;
+    //!number of values dropped because the queue was full or writing failed
+    uint64_t numDropped = 0;
+};
+
+//-----------------------------------------------------------------------------
+//!Output format of recorded camera frames
+enum class SENSRecorderVideoFormat
+{
+    //!MJPEG avi (video.avi) that can be replayed with SENSSimulator
+    MJPEG = 0,
+    //!lossless raw frames (video.raw), see SENSCameraRecorderDataHandler
+    RAW
+};
+
 //-----------------------------------------------------------------------------
 /*! SENSRecorderDataHandler
  This class is meant to be used exclusively by the SENSRecorder class. The SENSRecorder listens to sensors
  and informs SENSRecorderDataHandler backends about new data. The SENSRecorderDataHandler stores values to file.
+ New values are transferred to the store thread in a bounded ring buffer. If the store thread falls behind and
+ the buffer is full, the configured SENSRecorderQueuePolicy decides if values are dropped or if the sensor
+ thread is blocked. So the memory usage stays bounded also on long recordings. The number of dropped values
+ and the queue depth can be retrieved with getStats().
  */
 template<typename T>
 class SENSRecorderDataHandler
 {
 public:
-    SENSRecorderDataHandler(const std::string& name);
+    SENSRecorderDataHandler(const std::string&      name,
+                            size_t                  capacity = 1024,
+                            SENSRecorderQueuePolicy policy   = SENSRecorderQueuePolicy::DROP_NEWEST);
     virtual ~SENSRecorderDataHandler();
 
+    //!set capacity and full queue policy (only valid if store thread is not running)
+    void configureQueue(size_t capacity, SENSRecorderQueuePolicy policy);
+
     //!start the store thread
     void start(const std::string& outputDir);
     //!stop the store thread and clear values in queue
@@ -43,6 +94,8 @@ public:
     void add(T&& item);
     //!get error msg (valid if function returns true)
     bool getErrorMsg(std::string& msg);
+    //!get queue statistics of the current or last recording
+    SENSRecorderQueueStats getStats();
 
 protected:
     //!called in thread store routine when thread starts
@@ -51,25 +104,47 @@ protected:
     virtual void writeHeaderToFile(ofstream& file) {}
     //!called in thread store routine for every new line
     virtual void writeLineToFile(ofstream& file, const T& data) = 0;
-    //!called in thread store routine when thread finished
-    virtual void writeOnThreadFinish() {}
+    //!called in thread store routine when thread finished (all queued values are written)
+    virtual void writeOnThreadFinish(ofstream& file) {}
+
+    //!report values that were added but could not be written (e.g. encoding failed)
+    void reportDropped(uint64_t numDropped);
+    //!report values that were written to file (if not done in writeLineToFile)
+    void reportWritten(uint64_t numWritten);
+    //!set error message
+    void setErrorMsg(const std::string& msg);
 
     //!output directory
     std::string _outputDir;
 
+    //!flag if writeLineToFile reports the written values itself with reportWritten
+    bool _reportsWrittenItself = false;
+
 private:
     void store();
 
-    //new data queue: values are added by SENSRecorder and retrieved and
+    //new data ring buffer: values are added by SENSRecorder and retrieved and
     //written by store thread
-    std::deque<T> _queue;
+    std::vector<T> _queue;
+    //index of the oldest value in the ring buffer
+    size_t _queueHead = 0;
+    //number of values in the ring buffer
+    size_t _queueSize = 0;
+    //policy if ring buffer is full
+    SENSRecorderQueuePolicy _policy;
+    //statistics (guarded by _mutex)
+    SENSRecorderQueueStats _stats;
     //condition variable and mutex for store thread
     std::mutex              _mutex;
     std::condition_variable _condVar;
+    //condition variable for blocked sensor threads
+    std::condition_variable _spaceCondVar;
     //store thread
     std::thread _thread;
     //stop store thread
     bool _stop = false;
+    //flag if values are accepted (between start and stop)
+    bool _running = false;
     //name of this handler (e.g. gps)
     std::string _name;
 
@@ -97,23 +172,98 @@ public:
     void writeLineToFile(ofstream& file, const OrientationInfo& data) override;
 };
 
+//-----------------------------------------------------------------------------
+/*! SENSMJpegAviWriter
+ Minimal writer for MJPEG avi files (RIFF AVI 1.0 with idx1 index) from already JPEG encoded frames. This way
+ the frames can be encoded in parallel which is not possible with cv::VideoWriter. The resulting file can be
+ read with cv::VideoCapture. Because of the 32 bit sizes of AVI 1.0 the file is limited to 4 GB.
+ */
+class SENSMJpegAviWriter
+{
+public:
+    ~SENSMJpegAviWriter() { close(); }
+
+    bool open(const std::string& fileName, int width, int height, double fps);
+    //!write a jpeg encoded frame. Returns false if the file is not open or full.
+    bool write(const std::vector<uchar>& jpeg);
+    //!write index and patch headers
+    void close();
+    bool isOpened() const { return _file.is_open(); }
+
+private:
+    void writeHeaders(uint32_t numFrames, uint32_t riffSize, uint32_t moviSize);
+    void writeU32(uint32_t value);
+    void writeFourCC(const char* fourCC);
+
+    std::ofstream         _file;
+    std::vector<uint32_t> _index; //!<offset and size of every frame in movi list
+    std::streampos        _moviStart;
+    uint32_t              _maxFrameSize = 0;
+    int                   _width        = 0;
+    int                   _height       = 0;
+    double                _fps          = 30.0;
+};
+
 //-----------------------------------------------------------------------------
 /*! SENSCameraRecorderDataHandler
+ Writes the camera frames either as MJPEG avi or as raw frames. In the MJPEG format the frames are JPEG encoded
+ by a pool of encoder threads and written in the original order by the store thread. In the RAW format every
+ frame is stored lossless as one chunk in video.raw:
+ file header:  "SENSRAW1"
+ chunk header: int32 frameIndex, int32 rows, int32 cols, int32 cv type, int64 time point in us, uint64 data size
+ chunk data:   the continuous pixel data of the cv::Mat
+ All header values are little-endian on every platform. The pixel data is stored as in memory (the camera
+ frames have 8 bit channels). In both formats camera.txt contains a line with time point and frame index
+ for every written frame.
  */
 class SENSCameraRecorderDataHandler : public SENSRecorderDataHandler<FrameInfo>
 {
 public:
     SENSCameraRecorderDataHandler();
+    ~SENSCameraRecorderDataHandler();
 
     void writeOnThreadStart() override;
     void writeLineToFile(ofstream& file, const FrameInfo& data) override;
-    void writeOnThreadFinish() override;
+    void writeOnThreadFinish(ofstream& file) override;
 
     void updateConfig(const SENSCameraConfig& config);
+    //!set video format, no. of encoder threads and jpeg quality (only valid if store thread is not running)
+    void configureEncoding(SENSRecorderVideoFormat format, int numEncoderThreads, int jpegQuality);
 
 private:
-    cv::VideoWriter _videoWriter;
-    int             _frameIndex = 0;
+    struct EncodeJob
+    {
+        uint64_t  seq;
+        FrameInfo frame;
+    };
+    using EncodedFrame = std::pair<std::vector<uchar>, SENSTimePt>;
+
+    void encode();
+    void startEncoders();
+    void stopEncoders();
+    void writeEncodedFrames(ofstream& file, uint64_t maxInFlight);
+    void writeRawFrame(ofstream& file, const FrameInfo& data);
+    void writeTimePt(ofstream& file, const SENSTimePt& timePt);
+
+    SENSRecorderVideoFormat _format            = SENSRecorderVideoFormat::MJPEG;
+    int                     _numEncoderThreads = 2;
+    int                     _jpegQuality       = 95;
+
+    SENSMJpegAviWriter _aviWriter;
+    std::ofstream      _rawFile;
+    int                _frameIndex = 0;
+
+    //encoder pool: jobs are numbered by seq and results are written in seq order
+    std::vector<std::thread>         _encoders;
+    std::deque<EncodeJob>            _jobs;
+    std::map<uint64_t, EncodedFrame> _encoded;
+    std::mutex                       _encMutex;
+    std::condition_variable          _jobCondVar;
+    std::condition_variable          _resultCondVar;
+    uint64_t                         _nextSubmitSeq = 0;
+    uint64_t                         _nextWriteSeq  = 0;
+    bool                             _stopEncoders  = false;
+    cv::Size                         _frameSize;
 };
 
 #endif
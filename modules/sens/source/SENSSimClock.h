@@ -7,6 +7,8 @@
 
 /*! SENSSimClock
 Clock used for sensor simulation in SENSSimulator and SENSSimulated
+In real time mode the simulation time follows the wall clock. With useVirtualTime(true) the simulation time
+only advances when setVirtualNow is called (used for lock-step and fast replay, see SENSSimMode).
 */
 class SENSSimClock
 {
@@ -47,14 +49,31 @@ public:
         pause();
         _startTimePt = SENSClock::now();
         _pauseTime   = SENSMicroseconds(0);
+        setVirtualNow(_simStartTimePt);
         resume();
     }
 
+    //!switch between wall clock driven and virtual simulation time
+    void useVirtualTime(bool virtualTime)
+    {
+        setVirtualNow(_simStartTimePt);
+        _virtualTime = virtualTime;
+    }
+    bool usesVirtualTime() const { return _virtualTime; }
+
+    //!set current virtual simulation time (only used if useVirtualTime is on)
+    void setVirtualNow(const SENSTimePt& timePt)
+    {
+        _virtualNowUs = std::chrono::time_point_cast<SENSMicroseconds>(timePt).time_since_epoch().count();
+    }
+
     //!get passed simulation time
     SENSMicroseconds passedTime() const
     {
         SENSMicroseconds passedSimTime;
-        if (_pause)
+        if (_virtualTime)
+            passedSimTime = std::chrono::duration_cast<SENSMicroseconds>(virtualNow() - _simStartTimePt);
+        else if (_pause)
         {
             const std::lock_guard<std::mutex> lock(_pauseMutex);
             passedSimTime = std::chrono::duration_cast<SENSMicroseconds>(_pauseTimePt - _startTimePt) - _pauseTime;
@@ -70,6 +89,9 @@ public:
     //!get current simulation time (const function which should be thread save)
     SENSTimePt now() const
     {
+        if (_virtualTime)
+            return virtualNow();
+
         SENSMicroseconds passedSimTime;
         if (_pause)
         {
@@ -85,6 +107,11 @@ public:
     }
 
 private:
+    SENSTimePt virtualNow() const
+    {
+        return SENSTimePt(SENSMicroseconds(_virtualNowUs.load()));
+    }
+
     //!atomic, because we use it in now without mutex
     std::atomic_bool _pause{true};
     SENSTimePt       _pauseTimePt;
@@ -97,6 +124,11 @@ private:
     SENSTimePt _startTimePt;
     //!start time point of simulation in the past
     SENSTimePt _simStartTimePt;
+
+    //!flags if the simulation time is virtual (atomic, because we use it in now without mutex)
+    std::atomic_bool _virtualTime{false};
+    //!current virtual simulation time in us since epoch
+    std::atomic<long long> _virtualNowUs{0};
 };
 
 #endif //SENS_SIMCLOCK_H
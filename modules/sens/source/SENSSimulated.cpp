@@ -24,6 +24,21 @@ void SENSSimulated<T>::startSim()
     //stop the local simulation thread if running
     stopSim();
     _errorMsg.clear();
+
+    if (_mode != SENSSimMode::REAL_TIME && !_isLeader)
+    {
+        //in virtual time modes this sensor is fed by the leader via feedUntil (skip data before current sim time)
+        std::lock_guard<std::mutex> lock(_mutex);
+        SENSTimePt                  simTime = _clock.now();
+        _passiveCounter                     = 0;
+        while (_passiveCounter < _data.size() && _data[_passiveCounter].first < simTime)
+            _passiveCounter++;
+        _passiveStarted = true;
+        return;
+    }
+
+    //set running before the thread starts, so that a consumer waiting in lock step mode does not miss the start
+    _threadIsRunning = true;
     //start the simulation thread
     _thread = std::thread(&SENSSimulated::feedSensor, this);
 }
@@ -32,9 +47,10 @@ template<typename T>
 void SENSSimulated<T>::stopSim()
 {
     std::unique_lock<std::mutex> lock(_mutex);
-    _stop = true;
+    _stop           = true;
+    _passiveStarted = false;
     lock.unlock();
-    _condVar.notify_one();
+    _condVar.notify_all();
 
     if (_thread.joinable())
         _thread.join();
@@ -43,6 +59,20 @@ void SENSSimulated<T>::stopSim()
     _stop = false;
 }
 
+template<typename T>
+void SENSSimulated<T>::feedUntil(const SENSTimePt& timePt)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_passiveStarted)
+        return;
+
+    while (_passiveCounter < _data.size() && _data[_passiveCounter].first <= timePt)
+    {
+        feedSensorData(_passiveCounter);
+        _passiveCounter++;
+    }
+}
+
 template<typename T>
 bool SENSSimulated<T>::getErrorMsg(std::string& msg)
 {
@@ -56,9 +86,67 @@ bool SENSSimulated<T>::getErrorMsg(std::string& msg)
     }
 }
 
+template<typename T>
+void SENSSimulated<T>::feedSensorReplay()
+{
+    //index of current data set to feed
+    int counter = 0;
+
+    //bring counter close to startTimePt (maybe we skip some values to synchronize simulated sensors)
+    SENSTimePt simTime = _clock.now();
+    while (counter < _data.size() && _data[counter].first < simTime)
+        counter++;
+
+    for (; counter < _data.size(); ++counter)
+    {
+        //e.g. fetch the next decoded video frame
+        prepareSensorData(counter);
+
+        {
+            //virtual time does not advance while simulation is paused
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (_clock.isPaused() && !_stop)
+                _condVar.wait_for(lock, std::chrono::milliseconds(10));
+            if (_stop)
+                break;
+        }
+
+        //advance the virtual simulation time (this feeds the other sensors up to this time)
+        if (_advanceTimeCB)
+            _advanceTimeCB(_data[counter].first);
+
+        feedSensorData(counter);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_mode == SENSSimMode::LOCK_STEP && waitsForConsumer())
+        {
+            //wait until the consumer has fetched the data and asks for the next one
+            _dataPending = true;
+            _condVar.notify_all();
+            _condVar.wait(lock, [&] { return !_dataPending || _stop; });
+        }
+        if (_stop)
+            break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threadIsRunning = false;
+        _dataPending     = false;
+    }
+    _condVar.notify_all();
+    _sensorSimStoppedCB();
+}
+
 template<typename T>
 void SENSSimulated<T>::feedSensor()
 {
+    if (_mode != SENSSimMode::REAL_TIME)
+    {
+        feedSensorReplay();
+        return;
+    }
+
     _threadIsRunning = true;
     //index of current data set to feed
     int counter = 0;
@@ -251,6 +339,11 @@ const SENSCameraConfig& SENSSimulatedCamera::start(std::string
             throw SENSException(SENSType::CAM, "Could not open camera simulator for filename: " + _videoFileName, __LINE__, __FILE__);
     }
 
+    //decode video frames ahead in a separate thread
+    startReadAhead();
+    _preparedFrameIndex = -1;
+    _frameHandedOut     = false;
+
     //retrieve all camera characteristics
     if (_captureProperties.size() == 0)
         captureProperties();
@@ -272,10 +365,35 @@ void SENSSimulatedCamera::stop()
     if (_started)
     {
         stopSim();
+        stopReadAhead();
         _started = false;
     }
 }
 
+SENSFrameBasePtr SENSSimulatedCamera::latestFrame()
+{
+    if (_mode != SENSSimMode::LOCK_STEP || !_started)
+        return SENSBaseCamera::latestFrame();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    //the consumer asks for a new frame, so it has processed the last one: release the simulation
+    if (_frameHandedOut)
+    {
+        _frameHandedOut = false;
+        _dataPending    = false;
+        _condVar.notify_all();
+    }
+
+    _condVar.wait(lock, [&] { return _dataPending || !_threadIsRunning || _stop; });
+    if (!_dataPending)
+        return nullptr;
+
+    _frameHandedOut = true;
+    lock.unlock();
+
+    return SENSBaseCamera::latestFrame();
+}
+
 const SENSCaptureProps& SENSSimulatedCamera::captureProperties()
 {
     if (!_captureProperties.size())
@@ -311,7 +429,15 @@ void SENSSimulatedCamera::feedSensorData(const int counter)
         prepareSensorData(counter);
     }
 
-    updateFrame(_preparedFrame, cv::Mat(), false, _preparedFrame.size().width, _preparedFrame.size().height);
+    //end of video or read error
+    if (_preparedFrame.empty())
+        return;
+
+    //in virtual time modes the frame gets the recorded time point, so results are reproducible
+    if (_mode == SENSSimMode::REAL_TIME)
+        updateFrame(_preparedFrame, cv::Mat(), _preparedFrame.size().width, _preparedFrame.size().height, false);
+    else
+        updateFrame(_data[counter].first, _preparedFrame, cv::Mat(), _preparedFrame.size().width, _preparedFrame.size().height, false);
 
     SENS_DEBUG("feedSensorData %lld us", t.elapsedTimeInMicroSec());
 }
@@ -327,16 +453,7 @@ void SENSSimulatedCamera::prepareSensorData(const int counter)
 
     HighResTimer t;
 
-    int nextFramePos = _cap.get(cv::CAP_PROP_POS_FRAMES);
-    if (nextFramePos != frameIndex)
-    {
-        SENS_DEBUG("updating frame pos");
-        _cap.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
-    }
-
-    cv::Mat frame;
-
-    _cap.read(frame);
+    cv::Mat frame = readAheadFrame(frameIndex);
 
     {
         _preparedFrameIndex = frameIndex;
@@ -382,3 +499,120 @@ void SENSSimulatedCamera::onLatencyProblem(int& counter)
         now = _clock.now();
     }
 }
+
+void SENSSimulatedCamera::startReadAhead()
+{
+    stopReadAhead();
+
+    {
+        std::lock_guard<std::mutex> lock(_readAheadMutex);
+        _readAheadFrames.clear();
+        _readAheadNextIndex = (int)_cap.get(cv::CAP_PROP_POS_FRAMES);
+        _seekIndex          = -1;
+        _readAheadEnd       = false;
+        _stopReadAhead      = false;
+    }
+
+    _readAheadThread = std::thread(&SENSSimulatedCamera::readAhead, this);
+}
+
+void SENSSimulatedCamera::stopReadAhead()
+{
+    {
+        std::lock_guard<std::mutex> lock(_readAheadMutex);
+        _stopReadAhead = true;
+    }
+    _readAheadCondVar.notify_all();
+
+    if (_readAheadThread.joinable())
+        _readAheadThread.join();
+}
+
+void SENSSimulatedCamera::readAhead()
+{
+    while (true)
+    {
+        int  frameIndex;
+        bool seek = false;
+        {
+            std::unique_lock<std::mutex> lock(_readAheadMutex);
+            _readAheadCondVar.wait(lock, [&] { return _stopReadAhead ||
+                                                      _seekIndex >= 0 ||
+                                                      (!_readAheadEnd && _readAheadFrames.size() < _readAheadCapacity); });
+            if (_stopReadAhead)
+                break;
+
+            if (_seekIndex >= 0)
+            {
+                _readAheadFrames.clear();
+                _readAheadNextIndex = _seekIndex;
+                _seekIndex          = -1;
+                _readAheadEnd       = false;
+                seek                = true;
+            }
+            frameIndex = _readAheadNextIndex;
+        }
+
+        //updating the frame pos may take a lot of time, so we only do it when it is really needed
+        if (seek)
+        {
+            SENS_DEBUG("updating frame pos");
+            _cap.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+        }
+
+        cv::Mat frame;
+        bool    valid = _cap.read(frame);
+
+        {
+            std::lock_guard<std::mutex> lock(_readAheadMutex);
+            //a new position was requested while decoding, so this frame is outdated
+            if (_seekIndex >= 0)
+                continue;
+
+            if (valid && !frame.empty())
+            {
+                _readAheadFrames.emplace_back(frameIndex, frame);
+                _readAheadNextIndex = frameIndex + 1;
+            }
+            else
+                _readAheadEnd = true;
+        }
+        _readAheadCondVar.notify_all();
+    }
+}
+
+cv::Mat SENSSimulatedCamera::readAheadFrame(int frameIndex)
+{
+    std::unique_lock<std::mutex> lock(_readAheadMutex);
+    while (!_stopReadAhead)
+    {
+        if (_seekIndex < 0)
+        {
+            //drop frames we do not need anymore
+            while (!_readAheadFrames.empty() && _readAheadFrames.front().first < frameIndex)
+                _readAheadFrames.pop_front();
+
+            if (!_readAheadFrames.empty() && _readAheadFrames.front().first == frameIndex)
+            {
+                cv::Mat frame = _readAheadFrames.front().second;
+                _readAheadFrames.pop_front();
+                lock.unlock();
+                _readAheadCondVar.notify_all();
+                return frame;
+            }
+
+            //the frame is behind the decoding position or too far ahead: request a new position
+            int nextIndex = _readAheadFrames.empty() ? _readAheadNextIndex : _readAheadFrames.front().first;
+            if (frameIndex < nextIndex || frameIndex > nextIndex + 2 * (int)_readAheadCapacity)
+                _seekIndex = frameIndex;
+            else if (_readAheadEnd)
+                return cv::Mat();
+
+            _readAheadCondVar.notify_all();
+        }
+
+        _readAheadCondVar.wait(lock);
+    }
+
+    return cv::Mat();
+}
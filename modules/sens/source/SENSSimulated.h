@@ -5,6 +5,7 @@
 #include <memory>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 
 #include <Utils.h>
 #include <SENSSimClock.h>
@@ -14,18 +15,52 @@
 
 class SENSSimulator;
 
+//-----------------------------------------------------------------------------
+//!Defines how the simulation time advances during sensor simulation
+enum class SENSSimMode
+{
+    //!simulation time follows the wall clock, data is skipped if feeding is too slow
+    REAL_TIME = 0,
+    //!virtual simulation time advances only when the consumer has fetched the previous camera frame (no data is skipped)
+    LOCK_STEP,
+    //!virtual simulation time advances as fast as the data can be fed (no data is skipped)
+    FAST
+};
+
 //-----------------------------------------------------------------------------
 /*! SENSSimulatedBase
 This ia pure virtual base class to control SENSSimulated implementations via a common interface in SENSSimulator
  */
 class SENSSimulatedBase
 {
+    friend class SENSSimulator;
+
 public:
+    using AdvanceTimeCB = std::function<void(const SENSTimePt&)>;
+
     virtual ~SENSSimulatedBase() {}
     //!indicates if simulation thread is running
     virtual bool isThreadRunning() const = 0;
 
     virtual bool getErrorMsg(std::string& msg) = 0;
+
+protected:
+    //!Set replay mode (called by SENSSimulator when simulation is not running). In virtual time modes the leader
+    //!runs the feeding thread and advances the simulation time via advanceTimeCB, all other sensors are fed by feedUntil.
+    void setReplayMode(SENSSimMode mode, bool isLeader, AdvanceTimeCB advanceTimeCB)
+    {
+        _mode          = mode;
+        _isLeader      = isLeader;
+        _advanceTimeCB = advanceTimeCB;
+    }
+    //!feed all data with a time point before or equal timePt that was not fed yet (used for non-leaders in virtual time modes)
+    virtual void feedUntil(const SENSTimePt& timePt) = 0;
+    //!indicates if the leader has to wait for the consumer to fetch the data in LOCK_STEP mode
+    virtual bool waitsForConsumer() const { return false; }
+
+    SENSSimMode   _mode     = SENSSimMode::REAL_TIME;
+    bool          _isLeader = true;
+    AdvanceTimeCB _advanceTimeCB;
 };
 
 //-----------------------------------------------------------------------------
@@ -63,6 +98,8 @@ protected:
 
     bool isThreadRunning() const override { return _threadIsRunning; }
 
+    void feedUntil(const SENSTimePt& timePt) override;
+
     //!feed new sensor data to sensor
     virtual void feedSensorData(const int counter) = 0;
     //!prepare things that may take some time for the next writing of sensor data
@@ -74,6 +111,8 @@ protected:
 private:
     //!thread run routine to feed sensor with data.
     void feedSensor();
+    //!thread run routine to feed sensor with data in virtual time modes (lock step or fast)
+    void feedSensorReplay();
 
 protected:
     std::vector<std::pair<SENSTimePt, T>> _data;
@@ -89,7 +128,13 @@ protected:
 
     SENSTimePt _commonSimStartTimePt;
 
-    bool _threadIsRunning = false;
+    std::atomic_bool _threadIsRunning{false};
+
+    //!LOCK_STEP: flags that data was fed and the leader waits for the consumer to fetch it (guarded by _mutex)
+    bool _dataPending = false;
+    //!non-leaders in virtual time modes: index of next data to feed and if sensor was started (guarded by _mutex)
+    int  _passiveCounter = 0;
+    bool _passiveStarted = false;
 
     const SENSSimClock& _clock;
 
@@ -171,6 +216,10 @@ public:
 
     const SENSCaptureProps& captureProperties() override;
 
+    //!In LOCK_STEP mode this call waits until the next frame was fed and releases the simulation to continue.
+    //!Returns nullptr if the simulation has ended.
+    SENSFrameBasePtr latestFrame() override;
+
 private:
     SENSSimulatedCamera(StartSimCB                                startSimCB,
                         SensorSimStoppedCB                        sensorSimStoppedCB,
@@ -183,14 +232,36 @@ private:
     void prepareSensorData(const int counter) override;
     //!when feeding camera frames from cv::videocapture updating the frame pos may take ages. So we skip one more frame and update the next frame counter
     void onLatencyProblem(int& counter) override;
+    bool waitsForConsumer() const override { return true; }
+
+    //!thread run routine that decodes video frames ahead of the simulation
+    void readAhead();
+    void startReadAhead();
+    void stopReadAhead();
+    //!get decoded frame with frameIndex from read ahead queue (blocks until available, empty if end of video)
+    cv::Mat readAheadFrame(int frameIndex);
 
     std::string      _videoFileName;
     cv::VideoCapture _cap;
 
+    //read ahead video decoding (_cap is only used by read ahead thread while it runs)
+    std::thread                         _readAheadThread;
+    std::mutex                          _readAheadMutex;
+    std::condition_variable             _readAheadCondVar;
+    std::deque<std::pair<int, cv::Mat>> _readAheadFrames;
+    const size_t                        _readAheadCapacity  = 8;
+    int                                 _readAheadNextIndex = 0;
+    int                                 _seekIndex          = -1;
+    bool                                _readAheadEnd       = false;
+    bool                                _stopReadAhead      = false;
+
     cv::Mat    _preparedFrame;
     int        _preparedFrameIndex = -1;
     cv::Mat    _frame;
     std::mutex _frameMutex;
+
+    //!LOCK_STEP: flags that the pending frame was handed out to the consumer (guarded by _mutex)
+    bool _frameHandedOut = false;
 };
 
 #endif
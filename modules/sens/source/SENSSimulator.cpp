@@ -53,6 +53,45 @@ SENSTimePt SENSSimulator::now()
     return simNow;
 }
 
+bool SENSSimulator::setReplayMode(SENSSimMode mode)
+{
+    if (_running)
+    {
+        Utils::log("SENS", "SENSSimulator: Replay mode can only be changed if simulator is not running");
+        return false;
+    }
+
+    //the camera leads if available, otherwise the first sensor
+    SENSSimulatedBase* leader = getCameraSensorPtr();
+    if (!leader && _activeSensors.size())
+        leader = _activeSensors.front().get();
+
+    for (int i = 0; i < _activeSensors.size(); ++i)
+    {
+        SENSSimulatedBase* sensor = _activeSensors[i].get();
+        if (sensor == leader)
+            sensor->setReplayMode(mode, true, std::bind(&SENSSimulator::advanceTime, this, std::placeholders::_1));
+        else
+            sensor->setReplayMode(mode, false, nullptr);
+    }
+
+    if (_clock)
+        _clock->useVirtualTime(mode != SENSSimMode::REAL_TIME);
+
+    _replayMode = mode;
+    return true;
+}
+
+void SENSSimulator::advanceTime(const SENSTimePt& timePt)
+{
+    if (!_clock)
+        return;
+
+    _clock->setVirtualNow(timePt);
+    for (int i = 0; i < _activeSensors.size(); ++i)
+        _activeSensors[i]->feedUntil(timePt);
+}
+
 void findSimStartTimePt(SENSTimePt& simStartTimePt, bool& initialized, SENSTimePt tp)
 {
     if (!initialized)
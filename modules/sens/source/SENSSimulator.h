@@ -19,6 +19,11 @@
  depending on this time. The idea is to provide sensor data exactly as it was recorded.
  ATTENTION: Simulation time starts, as soon as one simulated sensor was started and is resetted when all simulated
  sensors are stopped.
+ For offline evaluation the simulation can be switched to a virtual time replay mode (see SENSSimMode and setReplayMode).
+ In this case no data is skipped and the results are reproducible: the camera (or the first sensor if there is no camera)
+ becomes the leader that advances the virtual time and feeds gps and orientation values up to the current frame time.
+ In LOCK_STEP mode the next frame is fed when the consumer calls latestFrame() again (it has processed the last frame),
+ in FAST mode frames are fed as fast as they can be decoded.
  */
 class SENSSimulator
 {
@@ -48,6 +53,10 @@ public:
     //!get passed simulation time
     SENSMicroseconds passedTime();
 
+    //!set replay mode (only possible if simulator is not running, returns false otherwise)
+    bool        setReplayMode(SENSSimMode mode);
+    SENSSimMode replayMode() const { return _replayMode; }
+
 private:
     template<typename T>
     T* getActiveSensor()
@@ -66,6 +75,8 @@ private:
     void onStart();
     //!callback called from SENSSimulated when the simulated sensor was stopped
     void onSensorSimStopped();
+    //!callback called from the leading SENSSimulated in virtual time modes to advance the simulation time
+    void advanceTime(const SENSTimePt& timePt);
 
     //!load data from file and instantiate sensor if valid
     void loadGpsData(const std::string& dirName, std::vector<std::pair<SENSTimePt, SENSGps::Location>>& data);
@@ -80,6 +91,7 @@ private:
     std::unique_ptr<SENSSimClock> _clock;
     //!flags if simulator is currently running
     std::atomic_bool _running{false};
+    SENSSimMode      _replayMode = SENSSimMode::REAL_TIME;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include <SLAssetStore.h>
 #include <Utils.h>
+#include <ZipUtils.h>
 #include <emscripten.h>
 #include <iostream>
 
@@ -8,12 +9,17 @@
 
 #ifdef SL_ASSET_STORE_REMOTE
 #    include <SDL_image.h>
-std::unordered_map<SLstring, SLAsset> assets;
 #endif
 
+// Assets held in memory (downloaded or decompressed from zip archives)
+std::unordered_map<SLstring, SLAsset> assets;
+
 SLAsset SLAssetStore::loadAsset(SLstring path)
 {
 #if defined(SL_ASSET_STORE_FS)
+    if (assets.count(path))
+        return assets[path];
+
     std::ifstream file(path, std::ios::binary | std::ios::ate);
     size_t        size = (size_t)file.tellg();
     file.seekg(0, std::ios::beg);
@@ -29,6 +35,11 @@ SLAsset SLAssetStore::loadAsset(SLstring path)
 SLstring SLAssetStore::loadTextAsset(SLstring path)
 {
 #if defined(SL_ASSET_STORE_FS)
+    if (assets.count(path))
+    {
+        SLAsset& asset = assets[path];
+        return SLstring(asset.data, asset.data + asset.size);
+    }
     return Utils::readTextFileIntoString("SLProject", path);
 #elif defined(SL_ASSET_STORE_REMOTE)
     std::cout << "loading text asset '" << path << "'" << std::endl;
@@ -78,7 +89,7 @@ void SLAssetStore::saveTextAsset(SLstring path, SLstring content)
 bool SLAssetStore::assetExists(SLstring path)
 {
 #if defined(SL_ASSET_STORE_FS)
-    return Utils::fileExists(path);
+    return assets.count(path) || Utils::fileExists(path);
 #elif defined(SL_ASSET_STORE_REMOTE)
     return assets.count(path) || Utils::fileExists(path);
 #endif
@@ -93,6 +104,30 @@ bool SLAssetStore::dirExists(SLstring dir)
 #endif
 }
 
+/*!
+ * Decompresses all entries of a zip archive on multiple threads directly into
+ * in-memory assets without writing them to disk. The assets are stored under
+ * assetPath + the path of the entry in the archive. If the archive itself was
+ * downloaded as an asset it is decompressed from memory.
+ */
+bool SLAssetStore::loadAssetsFromZip(SLstring zipPath, SLstring assetPath)
+{
+    assetPath = Utils::unifySlashes(assetPath);
+
+    auto addAsset = [assetPath](string path, string filename, vector<char>& data)
+    {
+        assets[assetPath + path + filename] = data.empty() ? SLAsset() : SLAsset(data.data(), data.size());
+    };
+
+    if (assets.count(zipPath))
+    {
+        SLAsset& zip = assets[zipPath];
+        return ZipUtils::unzipToMemory(zip.data, zip.size, addAsset);
+    }
+
+    return ZipUtils::unzipToMemory(zipPath, addAsset);
+}
+
 #ifdef SL_ASSET_STORE_REMOTE
 
 
@@ -82,6 +82,7 @@ CVMat    loadCVImageAsset(SLstring path);
 void     saveTextAsset(SLstring path, SLstring content);
 bool     assetExists(SLstring path);
 bool     dirExists(SLstring dir);
+bool     loadAssetsFromZip(SLstring zipPath, SLstring assetPath);
 
 #ifdef SL_ASSET_STORE_REMOTE
 CVMat loadPNG(SLstring path);
@@ -11,6 +11,8 @@
 #include <Utils.h>
 #include <SLKeyframeCamera.h>
 #include <SLGLProgramManager.h>
+#include <SLGLProgramBinaryCache.h>
+#include <SLGLVertexArray.h>
 #include <SLSkybox.h>
 #include <GlobalTimer.h>
 #include <Profiler.h>
@@ -42,7 +44,9 @@ SLScene::SLScene(const SLstring& name,
     _frameTimesMS(60, 0.0f),
     _updateTimesMS(60, 0.0f),
     _updateAABBTimesMS(60, 0.0f),
+    _updateNodesTimesMS(60, 0.0f),
     _updateAnimTimesMS(60, 0.0f),
+    _updateSkinTimesMS(60, 0.0f),
     _updateDODTimesMS(60, 0.0f)
 {
     onLoad = onSceneLoadCallback;
@@ -65,7 +69,10 @@ SLScene::~SLScene()
 {
     unInit();
 
-    // delete global SLGLState instance
+    // delete the shared uniform buffer and the global SLGLState instance
+    SLGLProgram::deleteFrameUniformBuffer();
+    SLGLVertexArray::deleteInstanceBuffer();
+    SLGLProgramBinaryCache::clear();
     SLGLState::deleteInstance();
 
     SL_LOG("Destructor      : ~SLScene");
@@ -92,7 +99,9 @@ void SLScene::init(SLAssetManager* am)
     // Reset timing variables
     _frameTimesMS.init(20, 0.0f);
     _updateTimesMS.init(60, 0.0f);
+    _updateNodesTimesMS.init(60, 0.0f);
     _updateAnimTimesMS.init(60, 0.0f);
+    _updateSkinTimesMS.init(60, 0.0f);
     _updateAABBTimesMS.init(60, 0.0f);
     _updateDODTimesMS.init(60, 0.0f);
 }
@@ -163,31 +172,33 @@ bool SLScene::onUpdate(bool renderTypeIsRT,
     // 2) Update all animations //
     //////////////////////////////
 
-    SLfloat startAnimUpdateMS = GlobalTimer::timeMS();
-
+    // Call the onUpdate callbacks of all nodes
+    SLfloat startNodesUpdateMS = GlobalTimer::timeMS();
     if (_root3D)
         _root3D->updateRec();
     if (_root2D)
         _root2D->updateRec();
+    _updateNodesTimesMS.set(GlobalTimer::timeMS() - startNodesUpdateMS);
 
     // Update node animations
+    SLfloat startAnimUpdateMS = GlobalTimer::timeMS();
     sceneHasChanged |= !_stopAnimations && _animManager.update(elapsedTimeSec());
+    _updateAnimTimesMS.set(GlobalTimer::timeMS() - startAnimUpdateMS);
 
     // Do software skinning on all changed skeletons. Update any out of date acceleration structure for RT or if they're being rendered.
+    SLfloat startSkinUpdateMS = GlobalTimer::timeMS();
     if (_root3D)
     {
-        // we use a lambda to inform nodes that share a mesh that the mesh got updated (so we don't have to transfer the root node)
+        // we use a lambda to inform all nodes that share a mesh that the mesh got updated
         sceneHasChanged |= _root3D->updateMeshSkins([&](SLMesh* mesh)
                                                     {
-            SLVNode nodes = _root3D->findChildren(mesh, true);
-            for (auto* node : nodes)
+            for (auto* node : mesh->nodes())
                 node->needAABBUpdate(); });
 
         if (renderTypeIsRT || voxelsAreShown)
             _root3D->updateMeshAccelStructs();
     }
-
-    _updateAnimTimesMS.set(GlobalTimer::timeMS() - startAnimUpdateMS);
+    _updateSkinTimesMS.set(GlobalTimer::timeMS() - startSkinUpdateMS);
 
     /////////////////////
     // 3) Update AABBs //
@@ -197,7 +208,7 @@ bool SLScene::onUpdate(bool renderTypeIsRT,
     SLfloat startAAABBUpdateMS = GlobalTimer::timeMS();
     SLNode::numWMUpdates       = 0;
     if (_root3D)
-        _root3D->updateAABBRec(renderTypeIsRT);
+        _root3D->updateAABBRecParallel(renderTypeIsRT);
     if (_root2D)
         _root2D->updateAABBRec(renderTypeIsRT);
     _updateAABBTimesMS.set(GlobalTimer::timeMS() - startAAABBUpdateMS);
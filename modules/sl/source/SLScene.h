@@ -90,7 +90,9 @@ public:
     SLfloat          fps() const { return _fps; }
     AvgFloat&        frameTimesMS() { return _frameTimesMS; }
     AvgFloat&        updateTimesMS() { return _updateTimesMS; }
+    AvgFloat&        updateNodesTimesMS() { return _updateNodesTimesMS; }
     AvgFloat&        updateAnimTimesMS() { return _updateAnimTimesMS; }
+    AvgFloat&        updateSkinTimesMS() { return _updateSkinTimesMS; }
     AvgFloat&        updateAABBTimesMS() { return _updateAABBTimesMS; }
     AvgFloat&        updateDODTimesMS() { return _updateDODTimesMS; }
 
@@ -145,11 +147,13 @@ protected:
     SLfloat _fps;              //!< Averaged no. of frames per second
 
     // major part times
-    AvgFloat _frameTimesMS;      //!< Averaged total time per frame in ms
-    AvgFloat _updateTimesMS;     //!< Averaged time for update in ms
-    AvgFloat _updateAABBTimesMS; //!< Averaged time for update the nodes AABB in ms
-    AvgFloat _updateAnimTimesMS; //!< Averaged time for update the animations in ms
-    AvgFloat _updateDODTimesMS;  //!< Averaged time for update the SLEntities graph
+    AvgFloat _frameTimesMS;       //!< Averaged total time per frame in ms
+    AvgFloat _updateTimesMS;      //!< Averaged time for update in ms
+    AvgFloat _updateAABBTimesMS;  //!< Averaged time for update the nodes WM & AABB in ms
+    AvgFloat _updateNodesTimesMS; //!< Averaged time for the nodes onUpdate callbacks in ms
+    AvgFloat _updateAnimTimesMS;  //!< Averaged time for update the animations in ms
+    AvgFloat _updateSkinTimesMS;  //!< Averaged time for skinning & accel. structs in ms
+    AvgFloat _updateDODTimesMS;   //!< Averaged time for update the SLEntities graph
 
     SLbool _stopAnimations; //!< Global flag for stopping all animations
 
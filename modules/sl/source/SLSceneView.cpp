@@ -95,6 +95,7 @@ void SLSceneView::init(SLstring       name,
     _doMultiSampling  = true;
     _doFrustumCulling = true;
     _doAlphaSorting   = true;
+    _doInstancing     = true;
     _doWaitOnIdle     = true;
     _drawBits.allOff();
 
@@ -129,6 +130,7 @@ void SLSceneView::unInit()
     _doMultiSampling  = true;
     _doFrustumCulling = true;
     _doAlphaSorting   = true;
+    _doInstancing     = true;
     _doWaitOnIdle     = true;
     _drawBits.allOff();
 
@@ -519,7 +521,13 @@ SLbool SLSceneView::onPaint()
     // Clear NO. of draw calls after UI creation
     SLGLVertexArray::totalDrawCalls          = 0;
     SLGLVertexArray::totalPrimitivesRendered = 0;
+    SLGLVertexArray::totalInstancesRendered  = 0;
     SLShadowMap::drawCalls                   = 0;
+    SLShadowMap::cachedViews                 = 0;
+    SLGLProgram::totalGLCalls                = 0;
+
+    // Light and camera parameters may have changed since the last frame
+    SLGLProgram::invalidateFrameUniforms();
 
     if (_s && _camera)
     { // Render the 3D scenegraph by raytracing, pathtracing or OpenGL
@@ -627,6 +635,20 @@ SLbool SLSceneView::draw3DGL(SLfloat elapsedTimeMS)
 
     SLfloat startMS = GlobalTimer::timeMS();
 
+    // Cull the shadow casters of all lights and cascades in parallel
+    vector<SLShadowMap*> shadowMaps;
+    for (SLLight* light : _s->lights())
+    {
+        if (light->createsShadows())
+        {
+            if (!light->shadowMap())
+                light->createShadowMap();
+            shadowMaps.push_back(light->shadowMap());
+        }
+    }
+    if (!shadowMaps.empty())
+        SLShadowMap::cullShadowCasters(this, _s->root3D(), shadowMaps);
+
     // Render shadow map for each light which creates shadows
     for (SLLight* light : _s->lights())
     {
@@ -861,6 +883,14 @@ void SLSceneView::draw3DGLNodes(SLVNode& nodes,
             return a->aabb()->sqrViewDist() > b->aabb()->sqrViewDist(); });
     }
 
+    // Opaque nodes sharing a mesh can be drawn with one instanced draw call
+    if (!alphaBlended && _doInstancing)
+    {
+        draw3DGLNodesInstanced(nodes);
+        GET_GL_ERROR;
+        return;
+    }
+
     // draw the shapes directly with their wm transform
     for (auto* node : nodes)
     {
@@ -874,6 +904,94 @@ void SLSceneView::draw3DGLNodes(SLVNode& nodes,
     GET_GL_ERROR; // Check if any OGL errors occurred
 }
 //-----------------------------------------------------------------------------
+//! Node drawing bits that need the individual drawing in SLMesh::draw
+static const SLuint SL_DB_NOINSTANCING = SL_DB_HIDDEN |
+                                         SL_DB_MESHWIRED |
+                                         SL_DB_NORMALS |
+                                         SL_DB_VOXELS |
+                                         SL_DB_CULLOFF |
+                                         SL_DB_WITHEDGES |
+                                         SL_DB_ONLYEDGES;
+//-----------------------------------------------------------------------------
+//! Returns true if the node can be drawn in an instanced draw call
+static SLbool nodeIsInstanceable(SLNode* node)
+{
+    // Derived nodes (cameras, lights, text) have their own drawMesh
+    return node &&
+           node->mesh() &&
+           typeid(*node) == typeid(SLNode) &&
+           !node->isSelected() &&
+           (node->drawBits()->bits() & SL_DB_NOINSTANCING) == 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLSceneView::draw3DGLNodesInstanced draws opaque nodes grouped by their mesh.
+The nodes get sorted by their mesh so that all nodes sharing a mesh follow each
+other. A run of at least two instanceable nodes with the same mesh is drawn
+with their world matrices in one instanced draw call by SLMesh::drawInstanced.
+All other nodes are drawn individually with SLNode::drawMesh.
+*/
+void SLSceneView::draw3DGLNodesInstanced(SLVNode& nodes)
+{
+    SLGLState* stateGL = SLGLState::instance();
+
+    std::sort(nodes.begin(), nodes.end(), [](SLNode* a, SLNode* b)
+              {
+                  if (!a) return false;
+                  if (!b) return true;
+                  return std::less<SLMesh*>()(a->mesh(), b->mesh()); });
+
+    // The scene view drawing bits and the rectangle selection apply to all nodes
+    SLbool svAllowsInstancing = !drawBit(SL_DB_HIDDEN) &&
+                                !drawBit(SL_DB_NORMALS) &&
+                                !drawBit(SL_DB_VOXELS) &&
+                                !drawBit(SL_DB_WITHEDGES) &&
+                                !drawBit(SL_DB_ONLYEDGES) &&
+                                _camera->selectRect().isEmpty() &&
+                                _camera->deselectRect().isEmpty();
+
+    for (size_t i = 0; i < nodes.size();)
+    {
+        SLNode* node = nodes[i];
+        size_t  end  = i + 1;
+
+        if (svAllowsInstancing && nodeIsInstanceable(node))
+        {
+            SLMesh*      mesh = node->mesh();
+            SLMaterial*  mat  = mesh->mat();
+            SLGLProgram* sp   = mat ? mat->program() : nullptr;
+
+            if (mesh->primitive() == PT_triangles &&
+                !mesh->isSelected() &&
+                sp && sp->usesInstancing() &&
+                !(mat->has3DTexture() && mat->textures3d()[0]->autoCalcTM3D()))
+            {
+                while (end < nodes.size() &&
+                       nodeIsInstanceable(nodes[end]) &&
+                       nodes[end]->mesh() == mesh)
+                    end++;
+            }
+
+            if (end - i > 1)
+            {
+                _instanceMatrices.clear();
+                for (size_t n = i; n < end; ++n)
+                    _instanceMatrices.push_back(nodes[n]->updateAndGetWM());
+
+                mesh->drawInstanced(this,
+                                    _instanceMatrices.data(),
+                                    (SLuint)_instanceMatrices.size());
+                i = end;
+                continue;
+            }
+        }
+
+        stateGL->modelMatrix = node->updateAndGetWM();
+        node->drawMesh(this);
+        i++;
+    }
+}
+//-----------------------------------------------------------------------------
 /*!
 SLSceneView::draw3DGLLines draws the AABB from the passed node vector directly
 with their world coordinates after the view transform. The lines must be drawn
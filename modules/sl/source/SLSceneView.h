@@ -107,6 +107,7 @@ public:
     SLbool draw3DGL(SLfloat elapsedTimeSec);
     void   draw3DGLAll();
     void   draw3DGLNodes(SLVNode& nodes, SLbool alphaBlended, SLbool depthSorted);
+    void   draw3DGLNodesInstanced(SLVNode& nodes);
     void   draw3DGLLines(SLVNode& nodes);
     void   draw3DGLLinesOverlay(SLVNode& nodes);
     void   draw2DGL();
@@ -146,6 +147,7 @@ public:
     void doDepthTest(SLbool doDT) { _doDepthTest = doDT; }
     void doFrustumCulling(SLbool doFC) { _doFrustumCulling = doFC; }
     void doAlphaSorting(SLbool doAS) { _doAlphaSorting = doAS; }
+    void doInstancing(SLbool doI) { _doInstancing = doI; }
     void renderType(SLRenderType rt) { _renderType = rt; }
     void viewportSameAsVideo(bool sameAsVideo) { _viewportSameAsVideo = sameAsVideo; }
     void screenCaptureIsRequested(bool doScreenCap)
@@ -178,6 +180,7 @@ public:
     SLUiInterface*  gui() { return _gui; }
     SLbool          doFrustumCulling() const { return _doFrustumCulling; }
     SLbool          doAlphaSorting() const { return _doAlphaSorting; }
+    SLbool          doInstancing() const { return _doInstancing; }
     SLbool          doMultiSampling() const { return _doMultiSampling; }
     SLbool          doDepthTest() const { return _doDepthTest; }
     SLbool          doWaitOnIdle() const { return _doWaitOnIdle; }
@@ -229,6 +232,7 @@ protected:
     SLbool     _doMultiSampling;  //!< Flag if multisampling is on
     SLbool     _doFrustumCulling; //!< Flag if view frustum culling is on
     SLbool     _doAlphaSorting;   //!< Flag if alpha sorting in blending is on
+    SLbool     _doInstancing;     //!< Flag if nodes sharing a mesh are drawn instanced
     SLbool     _doWaitOnIdle;     //!< Flag for Event waiting
     SLbool     _isFirstFrame;     //!< Flag if it is the first frame rendering
     SLDrawBits _drawBits;         //!< Sceneview level drawing flags
@@ -272,6 +276,8 @@ protected:
     SLVNode _nodesBlended3D; //!< Vector of visible blended nodes not in _visibleMaterials3D rendered in 3D
     SLVNode _nodesOverdrawn; //!< Vector of helper nodes drawn over all others
 
+    SLVMat4f _instanceMatrices; //!< Temp. vector of world matrices for instanced drawing
+
     SLRaytracer                     _raytracer;  //!< Whitted style raytracer
     SLbool                          _stopRT;     //!< Flag to stop the RT
     SLPathtracer                    _pathtracer; //!< Pathtracer
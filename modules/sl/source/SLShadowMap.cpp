@@ -8,6 +8,9 @@
 //#############################################################################
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 
 #include <SLGLDepthBuffer.h>
 #include <SLGLProgramManager.h>
@@ -26,7 +29,8 @@
 #include <SLLightDirect.h>
 
 //-----------------------------------------------------------------------------
-SLuint SLShadowMap::drawCalls = 0; //!< NO. of draw calls for shadow mapping
+SLuint SLShadowMap::drawCalls   = 0; //!< NO. of draw calls for shadow mapping
+SLuint SLShadowMap::cachedViews = 0; //!< NO. of views not re-rendered
 //-----------------------------------------------------------------------------
 /*! Ctor for standard fixed size shadow map for any type of light
  * @param light Pointer to the light for which the shadow is created
@@ -70,6 +74,9 @@ SLShadowMap::SLShadowMap(SLLight*       light,
     _textureSize   = texSize;
     _camera        = nullptr;
     _numCascades   = 0;
+    _numViews      = 0;
+    _isCulled      = false;
+    _useCaching    = true;
 }
 //-----------------------------------------------------------------------------
 /*! Ctor for auto sized cascaded shadow mapping
@@ -111,6 +118,9 @@ SLShadowMap::SLShadowMap(SLLight*       light,
     _lightClipNear  = 0.1f;          // will be ignored and automatically calculated
     _lightClipFar   = 20.f;          // will be ignored and automatically calculated
     _cascadesFactor = 30.f;
+    _numViews       = 0;
+    _isCulled       = false;
+    _useCaching     = true;
 }
 //-----------------------------------------------------------------------------
 SLShadowMap::~SLShadowMap()
@@ -305,13 +315,13 @@ void SLShadowMap::updateLightSpaces()
  * @param lightProj The cascades light projection matrix that gets adapted
  * @param lightView The cascades light view matrix
  * @param lightFrustumPlanes The six light frustum planes
- * @param visibleNodes Vector to push the lighted nodes
+ * @param view The view with the visibility list to push the lighted nodes
  */
-void SLShadowMap::lightCullingAdaptiveRec(SLNode*  node,
-                                          SLMat4f& lightProj,
-                                          SLMat4f& lightView,
-                                          SLPlane* lightFrustumPlanes,
-                                          SLVNode& visibleNodes)
+void SLShadowMap::lightCullingAdaptiveRec(SLNode*       node,
+                                          SLMat4f&      lightProj,
+                                          SLMat4f&      lightView,
+                                          SLPlane*      lightFrustumPlanes,
+                                          SLShadowView& view)
 {
     assert(node &&
            "SLShadowMap::lightCullingAdaptiveRec: No node passed.");
@@ -376,7 +386,7 @@ void SLShadowMap::lightCullingAdaptiveRec(SLNode*  node,
         }
 
         // If the node survived until now it can cast a shadow in this cascade
-        visibleNodes.push_back(node);
+        addVisibleNode(node, view);
     }
 
     // Now recursively cull the children nodes
@@ -385,22 +395,98 @@ void SLShadowMap::lightCullingAdaptiveRec(SLNode*  node,
                                 lightProj,
                                 lightView,
                                 lightFrustumPlanes,
-                                visibleNodes);
+                                view);
 }
 //-----------------------------------------------------------------------------
-/*! SLShadowMap::drawNodesDirectionalCulling draw all nodes in the vector
- * visibleNodes.
- * @param visibleNodes Vector of visible nodes
+/*! Standard light culling: Adds the shadow casters of the node and its
+ * children to the visibility list of the view if their AABB intersects the
+ * light frustum. The AABB of a node encloses the ones of its children, so
+ * subtrees outside of the frustum are skipped as a whole. As in
+ * lightCullingAdaptiveRec a node that doesn't cast shadows excludes its whole
+ * subtree, e.g. the generated levels of an SLNodeLOD below it.
+ * @param node Node to cull or add to to the visibility list
+ * @param lightFrustumPlanes The six light frustum planes
+ * @param view The view with the visibility list
+ */
+void SLShadowMap::lightCullingRec(SLNode*       node,
+                                  SLPlane*      lightFrustumPlanes,
+                                  SLShadowView& view)
+{
+    assert(node && "SLShadowMap::lightCullingRec: No node passed.");
+
+    if (node->drawBit(SL_DB_HIDDEN) || !node->castsShadows())
+        return;
+
+    SLVec3f centerWS = node->aabb()->centerWS();
+    SLfloat radiusWS = node->aabb()->radiusWS();
+    for (int i = 0; i < 6; i++)
+        if (lightFrustumPlanes[i].distToPoint(centerWS) < -radiusWS)
+            return;
+
+    if (node->mesh())
+        addVisibleNode(node, view);
+
+    for (SLNode* child : node->children())
+        lightCullingRec(child, lightFrustumPlanes, view);
+}
+//-----------------------------------------------------------------------------
+/*! Adds a node with its current world matrix to the visibility list of a
+ * view. This runs on the culling threads, so the world matrix is only read
+ * and must have been updated before (see cullView).
+ */
+void SLShadowMap::addVisibleNode(SLNode* node, SLShadowView& view)
+{
+    assert(node->isWMUpToDate() &&
+           "SLShadowMap::addVisibleNode: World matrix is not up to date.");
+    view.visibleNodes.push_back(node);
+    view.visibleWMs.push_back(node->wm());
+    if (node->mesh() && node->mesh()->skeleton())
+        view.hasSkinnedMesh = true;
+}
+//-----------------------------------------------------------------------------
+static SLbool isEqual(const SLMat4f& a, const SLMat4f& b)
+{
+    return memcmp(a.m(), b.m(), 16 * sizeof(SLfloat)) == 0;
+}
+//-----------------------------------------------------------------------------
+/*! Returns true if the depth buffer of a view has to be rendered. This is the
+ * case if caching is off, the light space changed or if the visible nodes or
+ * their world matrices differ from the last rendering. Skinned meshes can
+ * change without any matrix change, so their views are always rendered.
+ * @param viewIndex Index of the cube map face or cascade
+ */
+SLbool SLShadowMap::viewNeedsRendering(SLint viewIndex)
+{
+    SLShadowView& view = _views[viewIndex];
+
+    if (!_useCaching || !view.isRendered || view.hasSkinnedMesh)
+        return true;
+
+    if (!isEqual(view.renderedLightSpace, _lightSpace[viewIndex]) ||
+        view.renderedNodes != view.visibleNodes)
+        return true;
+
+    for (size_t i = 0; i < view.visibleWMs.size(); ++i)
+        if (!isEqual(view.renderedWMs[i], view.visibleWMs[i]))
+            return true;
+
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*! SLShadowMap::drawVisibleNodes draws all nodes in the visibility list of a
+ * view and keeps the list for the cache test of the next frame.
+ * @param viewIndex Index of the cube map face or cascade
  * @param sv Pointer to the sceneview
  * @param lightView The light view matrix
  */
-void SLShadowMap::drawNodesDirectionalCulling(SLVNode      visibleNodes,
-                                              SLSceneView* sv,
-                                              SLMat4f&     lightView)
+void SLShadowMap::drawVisibleNodes(SLint        viewIndex,
+                                   SLSceneView* sv,
+                                   SLMat4f&     lightView)
 {
-    SLGLState* stateGL = SLGLState::instance();
+    SLGLState*    stateGL = SLGLState::instance();
+    SLShadowView& view    = _views[viewIndex];
 
-    for (SLNode* node : visibleNodes)
+    for (SLNode* node : view.visibleNodes)
     {
         if (node->castsShadows() &&
             node->mesh() &&
@@ -412,38 +498,130 @@ void SLShadowMap::drawNodesDirectionalCulling(SLVNode      visibleNodes,
             SLShadowMap::drawCalls++;
         }
     }
+
+    view.renderedNodes      = view.visibleNodes;
+    view.renderedWMs        = view.visibleWMs;
+    view.renderedLightSpace = _lightSpace[viewIndex];
+    view.isRendered         = true;
 }
 //-----------------------------------------------------------------------------
-/*! Recursive node drawing function for standard shadow map drawing.
- * @param node The node do draw
- * @param sv Pointer to the sceneview
- * @param lightView The light view matrix
+//! Forces the re-rendering of all views (e.g. after a mesh has been modified)
+void SLShadowMap::invalidate()
+{
+    for (SLShadowView& view : _views)
+        view.isRendered = false;
+}
+//-----------------------------------------------------------------------------
+/*! Updates the light matrices of all views for the culling. Must be called on
+ * the render thread before cullView because it updates the world matrices of
+ * the light and the camera.
+ * @param sv Pointer of the sceneview
  */
-void SLShadowMap::drawNodesIntoDepthBufferRec(SLNode*      node,
-                                              SLSceneView* sv,
-                                              SLMat4f&     lightView)
+void SLShadowMap::prepareCulling(SLSceneView* sv)
 {
-    assert(node && "SLShadowMap::drawNodesIntoDepthBufferRec: No node passed.");
+    if (_useCascaded)
+        updateCascades(sv);
+    else
+    {
+        updateLightSpaces();
+        _numViews = _useCubemap ? 6 : 1;
+    }
+    _isCulled = false;
+}
+//-----------------------------------------------------------------------------
+/*! Culls the shadow casters of one view into its visibility list. The scene
+ * graph is only read, so all views of all shadow maps can be culled in
+ * parallel after prepareCulling. The world matrices and AABBs of the nodes
+ * must be up to date what SLScene::onUpdate guarantees.
+ * @param viewIndex Index of the cube map face or cascade
+ * @param root Pointer to the root node of the scene
+ */
+void SLShadowMap::cullView(SLint viewIndex, SLNode* root)
+{
+    assert(root && "SLShadowMap::cullView: No root node passed.");
+    assert(viewIndex >= 0 && viewIndex < _numViews &&
+           "SLShadowMap::cullView: Invalid view index.");
 
-    if (node->drawBit(SL_DB_HIDDEN))
-        return;
-    SLGLState* stateGL = SLGLState::instance();
-    stateGL->viewMatrix  = lightView;
-    stateGL->modelMatrix = node->updateAndGetWM();
+    SLShadowView& view = _views[viewIndex];
+    view.visibleNodes.clear();
+    view.visibleWMs.clear();
+    view.hasSkinnedMesh = false;
 
-    if (node->castsShadows() &&
-        node->mesh() &&
-        node->mesh()->primitive() >= GL_TRIANGLES)
+    SLPlane lightFrustumPlanes[6];
+
+    if (_useCascaded)
+    {
+        // Light culling with light frustum adaptation
+        SLFrustum::viewToFrustumPlanes(lightFrustumPlanes,
+                                       _lightProj[viewIndex],
+                                       _lightView[viewIndex]);
+        for (SLNode* child : root->children())
+        {
+            lightCullingAdaptiveRec(child,
+                                    _lightProj[viewIndex],
+                                    _lightView[viewIndex],
+                                    lightFrustumPlanes,
+                                    view);
+        }
+        _lightSpace[viewIndex] = _lightProj[viewIndex] * _lightView[viewIndex];
+    }
+    else
     {
-        node->mesh()->drawIntoDepthBuffer(sv, node, _material);
-        SLShadowMap::drawCalls++;
+        SLFrustum::viewToFrustumPlanes(lightFrustumPlanes,
+                                       _lightProj[0],
+                                       _lightView[viewIndex]);
+        lightCullingRec(root, lightFrustumPlanes, view);
     }
+}
+//-----------------------------------------------------------------------------
+/*! Culls the shadow casters of all views of all shadow maps before any OpenGL
+ * work is done. The light matrices are prepared on the calling thread. The
+ * views (cube map faces and cascades) are then distributed over up to
+ * Utils::maxThreads() threads. The following renderShadows calls draw the
+ * culled visibility lists.
+ * @param sv Pointer of the sceneview
+ * @param root Pointer to the root node of the scene
+ * @param shadowMaps Shadow maps of all lights that create shadows
+ */
+void SLShadowMap::cullShadowCasters(SLSceneView*          sv,
+                                    SLNode*               root,
+                                    vector<SLShadowMap*>& shadowMaps)
+{
+    assert(root && "SLShadowMap::cullShadowCasters: No root node passed.");
 
-    for (SLNode* child : node->children())
-        drawNodesIntoDepthBufferRec(child, sv, lightView);
+    PROFILE_FUNCTION();
+
+    vector<pair<SLShadowMap*, SLint>> jobs;
+    for (SLShadowMap* shadowMap : shadowMaps)
+    {
+        shadowMap->prepareCulling(sv);
+        for (SLint i = 0; i < shadowMap->_numViews; ++i)
+            jobs.push_back(make_pair(shadowMap, i));
+    }
+
+    atomic<size_t> nextJob(0);
+    auto           cullJobs = [&]()
+    {
+        for (size_t j = nextJob++; j < jobs.size(); j = nextJob++)
+            jobs[j].first->cullView(jobs[j].second, root);
+    };
+
+    // Start additional threads and do the same work in the main thread
+    vector<thread> threads;
+    SLuint         numThreads = std::min((SLuint)jobs.size(), Utils::maxThreads());
+    for (SLuint t = 1; t < numThreads; t++)
+        threads.emplace_back(cullJobs);
+    cullJobs();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (SLShadowMap* shadowMap : shadowMaps)
+        shadowMap->_isCulled = true;
 }
 //-----------------------------------------------------------------------------
 /*! SLShadowMap::render Toplevel entry function for shadow map rendering.
+ * If the views were not culled with cullShadowCasters before, they get
+ * culled here.
  * @param sv Pointer of the sceneview
  * @param root Pointer to the root node of the scene
  */
@@ -453,9 +631,17 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
 
     PROFILE_FUNCTION();
 
+    if (!_isCulled)
+    {
+        prepareCulling(sv);
+        for (SLint i = 0; i < _numViews; ++i)
+            cullView(i, root);
+    }
+    _isCulled = false;
+
     if (_projection == P_monoOrthographic && _camera != nullptr)
     {
-        renderDirectionalLightCascaded(sv, root);
+        renderDirectionalLightCascaded(sv);
         return;
     }
 
@@ -473,8 +659,6 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
     // Create depth buffer
     static SLfloat borderColor[] = {1.0, 1.0, 1.0, 1.0};
 
-    updateLightSpaces();
-
     if (this->_useCubemap)
         this->_textureSize.y = this->_textureSize.x;
 
@@ -501,12 +685,26 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
                                                     this->_useCubemap
                                                       ? GL_TEXTURE_CUBE_MAP
                                                       : GL_TEXTURE_2D));
+        invalidate();
     }
 
-    _depthBuffers[0]->bind();
+    SLbool isBound = false;
 
-    for (SLint i = 0; i < (_useCubemap ? 6 : 1); ++i)
+    for (SLint i = 0; i < _numViews; ++i)
     {
+        // Nothing changed since the last rendering of this view
+        if (!viewNeedsRendering(i))
+        {
+            SLShadowMap::cachedViews++;
+            continue;
+        }
+
+        if (!isBound)
+        {
+            _depthBuffers[0]->bind();
+            isBound = true;
+        }
+
         if (_useCubemap)
             _depthBuffers[0]->bindFace(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
 
@@ -518,12 +716,13 @@ void SLShadowMap::renderShadows(SLSceneView* sv, SLNode* root)
         stateGL->clearColor(SLCol4f::BLACK);
         stateGL->clearColorDepthBuffer();
 
-        /////////////////////////////////////////////////////
-        drawNodesIntoDepthBufferRec(root, sv, _lightView[i]);
-        /////////////////////////////////////////////////////
+        /////////////////////////////////////////////
+        drawVisibleNodes(i, sv, _lightView[i]);
+        /////////////////////////////////////////////
     }
 
-    _depthBuffers[0]->unbind();
+    if (isBound)
+        _depthBuffers[0]->unbind();
 }
 //-----------------------------------------------------------------------------
 /*! Returns a vector of near and far clip distances for all shadow cascades
@@ -554,38 +753,13 @@ SLVVec2f SLShadowMap::getShadowMapCascades(int   numCascades,
     return cascades;
 }
 //-----------------------------------------------------------------------------
-/*! Renders the nodes into cascaded shadow maps for directional lights
+/*! Updates the light view and projection matrices of all cascades around
+ * the view frustum of the camera. The projection matrices get adapted during
+ * the culling in lightCullingAdaptiveRec.
  * @param sv Pointer of the sceneview
- * @param root Pointer to the root node of the scene
  */
-void SLShadowMap::renderDirectionalLightCascaded(SLSceneView* sv,
-                                                 SLNode*      root)
+void SLShadowMap::updateCascades(SLSceneView* sv)
 {
-    assert(root && "LShadowMap::renderDirectionalLightCascaded: no root node");
-
-    // Create depth buffer
-    static SLfloat borderColor[] = {1.0, 1.0, 1.0, 1.0};
-
-    // Create material
-    if (_material == nullptr)
-        _material = new SLMaterial(
-          nullptr,
-          "shadowMapMaterial",
-          nullptr,
-          nullptr,
-          nullptr,
-          nullptr,
-          SLGLProgramManager::get(SP_depth));
-
-    // Erase depth buffer textures if the number or size changed
-    if (_depthBuffers.size() != 0 &&
-        (_depthBuffers[0]->dimensions() != _textureSize ||
-         _depthBuffers[0]->target() != GL_TEXTURE_2D ||
-         _depthBuffers.size() != _numCascades))
-    {
-        _depthBuffers.erase(_depthBuffers.begin(), _depthBuffers.end());
-    }
-
     // Get the vector of cascades with near and far distances
     SLVVec2f cascades = getShadowMapCascades(_numCascades,
                                              _camera->clipNear(),
@@ -594,24 +768,6 @@ void SLShadowMap::renderDirectionalLightCascaded(SLSceneView* sv,
     SLMat4f camWM     = _camera->updateAndGetWM(); // camera space in world space
     SLNode* lightNode = dynamic_cast<SLNode*>(_light);
 
-#ifdef SL_GLES
-    SLint wrapMode = GL_CLAMP_TO_EDGE;
-#else
-    SLint wrapMode = GL_CLAMP_TO_BORDER;
-#endif
-
-    // Create the depth buffer if they don't exist
-    if (_depthBuffers.size() == 0)
-    {
-        for (int i = 0; i < cascades.size(); i++)
-            _depthBuffers.push_back(new SLGLDepthBuffer(_textureSize,
-                                                        GL_NEAREST,
-                                                        GL_NEAREST,
-                                                        wrapMode,
-                                                        borderColor,
-                                                        GL_TEXTURE_2D));
-    }
-
     // for all subdivision of frustum
     for (int i = 0; i < cascades.size(); i++)
     {
@@ -660,25 +816,70 @@ void SLShadowMap::renderDirectionalLightCascaded(SLSceneView* sv,
         lightProjMat.scale(sx, sy, sz);
         lightProjMat.translate(t);
 
-        // Do light culling recursively with light frustum adaptation
-        SLPlane lightFrustumPlanes[6];
-        SLVNode visibleNodes;
-        SLFrustum::viewToFrustumPlanes(lightFrustumPlanes,
-                                       lightProjMat,
-                                       lightViewMat);
-        for (SLNode* child : root->children())
+        _lightView[i] = lightViewMat;
+        _lightProj[i] = lightProjMat;
+    }
+
+    _numViews = (SLint)cascades.size();
+}
+//-----------------------------------------------------------------------------
+/*! Renders the culled nodes into cascaded shadow maps for directional lights
+ * @param sv Pointer of the sceneview
+ */
+void SLShadowMap::renderDirectionalLightCascaded(SLSceneView* sv)
+{
+    // Create depth buffer
+    static SLfloat borderColor[] = {1.0, 1.0, 1.0, 1.0};
+
+    // Create material
+    if (_material == nullptr)
+        _material = new SLMaterial(
+          nullptr,
+          "shadowMapMaterial",
+          nullptr,
+          nullptr,
+          nullptr,
+          nullptr,
+          SLGLProgramManager::get(SP_depth));
+
+    // Erase depth buffer textures if the number or size changed
+    if (_depthBuffers.size() != 0 &&
+        (_depthBuffers[0]->dimensions() != _textureSize ||
+         _depthBuffers[0]->target() != GL_TEXTURE_2D ||
+         _depthBuffers.size() != _numViews))
+    {
+        _depthBuffers.erase(_depthBuffers.begin(), _depthBuffers.end());
+    }
+
+#ifdef SL_GLES
+    SLint wrapMode = GL_CLAMP_TO_EDGE;
+#else
+    SLint wrapMode = GL_CLAMP_TO_BORDER;
+#endif
+
+    // Create the depth buffer if they don't exist
+    if (_depthBuffers.size() == 0)
+    {
+        for (int i = 0; i < _numViews; i++)
+            _depthBuffers.push_back(new SLGLDepthBuffer(_textureSize,
+                                                        GL_NEAREST,
+                                                        GL_NEAREST,
+                                                        wrapMode,
+                                                        borderColor,
+                                                        GL_TEXTURE_2D));
+        invalidate();
+    }
+
+    // for all subdivision of frustum
+    for (int i = 0; i < _numViews; i++)
+    {
+        // Nothing changed since the last rendering of this cascade
+        if (!viewNeedsRendering(i))
         {
-            lightCullingAdaptiveRec(child,
-                                    lightProjMat,
-                                    lightViewMat,
-                                    lightFrustumPlanes,
-                                    visibleNodes);
+            SLShadowMap::cachedViews++;
+            continue;
         }
 
-        _lightView[i]  = lightViewMat;
-        _lightProj[i]  = lightProjMat;
-        _lightSpace[i] = lightProjMat * lightViewMat;
-
         _depthBuffers[i]->bind();
 
         // Set OpenGL states for depth buffer rendering
@@ -686,12 +887,12 @@ void SLShadowMap::renderDirectionalLightCascaded(SLSceneView* sv,
         stateGL->viewport(0, 0, _textureSize.x, _textureSize.y);
         stateGL->clearColor(SLCol4f::BLACK);
         stateGL->clearColorDepthBuffer();
-        stateGL->projectionMatrix = lightProjMat;
-        stateGL->viewMatrix       = lightViewMat;
+        stateGL->projectionMatrix = _lightProj[i];
+        stateGL->viewMatrix       = _lightView[i];
 
-        ////////////////////////////////////////////////////////////
-        drawNodesDirectionalCulling(visibleNodes, sv, lightViewMat);
-        ////////////////////////////////////////////////////////////
+        ////////////////////////////////////////////
+        drawVisibleNodes(i, sv, _lightView[i]);
+        ////////////////////////////////////////////
 
         _depthBuffers[i]->unbind();
     }
@@ -34,6 +34,11 @@ class SLCamera;
  * with all light types. The auto sized shadow maps get automatically sized
  * to a specified camera. At the moment only directional light get supported
  * with multiple cascaded shadow maps.
+ * The shadow casters of every view (cube map face or cascade) are culled on
+ * the CPU into a visibility list before any OpenGL work. With cullShadowCasters
+ * the views of all lights are culled in parallel. A view is only re-rendered
+ * if its light space, its visible nodes or their world matrices changed since
+ * the last rendering, so static lights with static geometry cost nothing.
  */
 class SLShadowMap
 {
@@ -54,9 +59,15 @@ public:
     ~SLShadowMap();
 
     // Public methods
-    void renderShadows(SLSceneView* sv, SLNode* root);
-    void drawFrustum();
-    void drawRays();
+    void        prepareCulling(SLSceneView* sv);
+    void        cullView(SLint viewIndex, SLNode* root);
+    void        renderShadows(SLSceneView* sv, SLNode* root);
+    void        invalidate();
+    void        drawFrustum();
+    void        drawRays();
+    static void cullShadowCasters(SLSceneView*          sv,
+                                  SLNode*               root,
+                                  vector<SLShadowMap*>& shadowMaps);
 
     // Setters
     void useCubemap(SLbool useCubemap) { _useCubemap = useCubemap; }
@@ -71,6 +82,11 @@ public:
     void textureSize(const SLVec2i& textureSize) { _textureSize.set(textureSize); }
     void numCascades(int numCascades) { _numCascades = numCascades; }
     void cascadesFactor(float factor) { _cascadesFactor = factor; }
+    void useCaching(SLbool useCaching)
+    {
+        _useCaching = useCaching;
+        invalidate();
+    }
 
     // Getters
     SLProjType       projection() { return _projection; }
@@ -88,26 +104,45 @@ public:
     int              maxCascades() { return _maxCascades; }
     float            cascadesFactor() { return _cascadesFactor; }
     SLCamera*        camera() { return _camera; }
+    SLbool           useCaching() const { return _useCaching; }
+    SLint            numViews() const { return _numViews; }
+    const SLVNode&   visibleNodes(SLint viewIndex) const { return _views[viewIndex].visibleNodes; }
 
-    static SLuint drawCalls; //!< NO. of draw calls for shadow mapping
+    static SLuint drawCalls;   //!< NO. of draw calls for shadow mapping
+    static SLuint cachedViews; //!< NO. of views not re-rendered because nothing changed
 
 private:
+    //! CPU culling result and cache state of one view (cube map face or cascade)
+    struct SLShadowView
+    {
+        SLVNode  visibleNodes;               //!< Shadow casters inside the light frustum
+        SLVMat4f visibleWMs;                 //!< World matrices of the visible nodes
+        SLbool   hasSkinnedMesh     = false; //!< Skinned meshes change without world matrix change
+        SLVNode  renderedNodes;              //!< Visible nodes of the last rendering
+        SLVMat4f renderedWMs;                //!< World matrices of the last rendering
+        SLMat4f  renderedLightSpace;         //!< Light space matrix of the last rendering
+        SLbool   isRendered         = false; //!< Flag if the depth buffer holds the last rendering
+    };
+
     void     updateLightSpaces();
-    void     renderDirectionalLightCascaded(SLSceneView* sv, SLNode* root);
+    void     updateCascades(SLSceneView* sv);
+    void     renderDirectionalLightCascaded(SLSceneView* sv);
     SLVVec2f getShadowMapCascades(int   numCascades,
                                   float camClipNear,
                                   float camClipFar);
-    void     drawNodesIntoDepthBufferRec(SLNode*      node,
-                                         SLSceneView* sv,
-                                         SLMat4f&     lightView);
-    void     lightCullingAdaptiveRec(SLNode*  node,
-                                     SLMat4f& lightProj,
-                                     SLMat4f& lightView,
-                                     SLPlane* lightFrustumPlanes,
-                                     SLVNode& visibleNodes);
-    void     drawNodesDirectionalCulling(SLVNode      visibleNodes,
-                                         SLSceneView* sv,
-                                         SLMat4f&     lightView);
+    void     lightCullingRec(SLNode*       node,
+                             SLPlane*      lightFrustumPlanes,
+                             SLShadowView& view);
+    void     lightCullingAdaptiveRec(SLNode*       node,
+                                     SLMat4f&      lightProj,
+                                     SLMat4f&      lightView,
+                                     SLPlane*      lightFrustumPlanes,
+                                     SLShadowView& view);
+    void     addVisibleNode(SLNode* node, SLShadowView& view);
+    SLbool   viewNeedsRendering(SLint viewIndex);
+    void     drawVisibleNodes(SLint        viewIndex,
+                              SLSceneView* sv,
+                              SLMat4f&     lightView);
 
 private:
     SLLight*            _light;          //!< The light which uses this shadow map
@@ -130,6 +165,10 @@ private:
     SLVec2f             _halfSize;       //!< _size divided by two (only for SLLightDirect non cascaded)
     SLVec2i             _textureSize;    //!< Size of the shadow map texture
     SLCamera*           _camera;         //!< Camera to witch the light frustums are adapted
+    SLShadowView        _views[6];       //!< Culling result and cache state per view
+    SLint               _numViews;       //!< NO. of views (1, 6 for cubemaps or NO. of cascades)
+    SLbool              _isCulled;       //!< Flag if the views are culled for the next rendering
+    SLbool              _useCaching;     //!< Flag if unchanged views are not re-rendered
 };
 //-----------------------------------------------------------------------------
 #endif // SLSHADOWMAP_H
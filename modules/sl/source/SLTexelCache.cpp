@@ -0,0 +1,269 @@
+//#############################################################################
+//  File:      SLTexelCache.cpp
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <SLTexelCache.h>
+#include <Utils.h>
+#include <thread>
+
+//-----------------------------------------------------------------------------
+//! Spreads the 3 bits of a coordinate within a tile for the Morton order
+static const SLuint mortonSpread[8] = {0, 1, 4, 5, 16, 17, 20, 21};
+//-----------------------------------------------------------------------------
+//! Texel size of the square tiles
+static const SLint TILE_SIZE = 8;
+//-----------------------------------------------------------------------------
+//! Packs 4 bytes into a RGBA8 texel
+static inline SLuint packRGBA(SLuint r, SLuint g, SLuint b, SLuint a)
+{
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+//-----------------------------------------------------------------------------
+//! Unpacks a RGBA8 texel into a color with components between 0 and 1
+static inline SLCol4f unpackRGBA(SLuint texel)
+{
+    const SLfloat s = 1.0f / 255.0f;
+    return SLCol4f((SLfloat)(texel & 0xFF) * s,
+                   (SLfloat)((texel >> 8) & 0xFF) * s,
+                   (SLfloat)((texel >> 16) & 0xFF) * s,
+                   (SLfloat)(texel >> 24) * s);
+}
+//-----------------------------------------------------------------------------
+//! Wraps an integer texel coordinate into [0, size) for GL_REPEAT
+static inline SLint wrap(SLint i, SLint size)
+{
+    i %= size;
+    return i < 0 ? i + size : i;
+}
+//-----------------------------------------------------------------------------
+/*!
+Converts the image into the tiled RGBA8 level 0 and builds the mip map levels
+down to 1x1 if buildMipmaps is true. The image must be supported (see
+isSupported).
+@param image Pointer to the source image
+@param buildMipmaps Flag if the mip map levels should be built
+*/
+SLTexelCache::SLTexelCache(CVImage* image, SLbool buildMipmaps)
+{
+    assert(image && isSupported(image));
+
+    _levels.resize(1);
+    convert(image);
+
+    if (buildMipmaps)
+    {
+        while (_levels.back().width > 1 || _levels.back().height > 1)
+        {
+            _levels.emplace_back();
+            buildMipLevel(_levels[_levels.size() - 2], _levels.back());
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns true for the 8 bit image formats that can be cached
+SLbool SLTexelCache::isSupported(CVImage* image)
+{
+    if (!image || image->width() == 0 || image->height() == 0 ||
+        image->cvMat().depth() != CV_8U)
+        return false;
+
+    switch (image->format())
+    {
+        case PF_rgb:
+        case PF_rgba:
+        case PF_bgr:
+        case PF_bgra:
+        case PF_red:
+        case PF_luminance:
+        case PF_rg:
+        case PF_luminance_alpha: return true;
+        default: return false;
+    }
+}
+//-----------------------------------------------------------------------------
+inline SLuint SLTexelCache::texelIndex(const SLTexelLevel& l, SLint x, SLint y)
+{
+    // x & y are >= 0, so the shifts are divisions by the tile size of 8
+    SLuint tile = ((SLuint)y >> 3) * (SLuint)l.tilesX + ((SLuint)x >> 3);
+    return (tile << 6) | mortonSpread[x & 7] | (mortonSpread[y & 7] << 1);
+}
+//-----------------------------------------------------------------------------
+/*!
+Converts the image into level 0. The channels are mapped like in
+CVImage::getPixeli. Large images are converted with multiple threads by rows.
+*/
+void SLTexelCache::convert(CVImage* image)
+{
+    CVMat         mat = image->cvMat();
+    SLTexelLevel& l   = _levels[0];
+    l.width           = mat.cols;
+    l.height          = mat.rows;
+    l.tilesX          = (l.width + TILE_SIZE - 1) / TILE_SIZE;
+    SLint tilesY      = (l.height + TILE_SIZE - 1) / TILE_SIZE;
+    l.texels.assign((size_t)l.tilesX * tilesY * TILE_SIZE * TILE_SIZE, 0);
+
+    // Channel offsets of r, g, b & a per pixel (-1 for an opaque alpha)
+    SLint numCh = 0, iR = 0, iG = 0, iB = 0, iA = -1;
+    switch (image->format())
+    {
+        case PF_rgb: numCh = 3, iR = 0, iG = 1, iB = 2; break;
+        case PF_rgba: numCh = 4, iR = 0, iG = 1, iB = 2, iA = 3; break;
+        case PF_bgr: numCh = 3, iR = 2, iG = 1, iB = 0; break;
+        case PF_bgra: numCh = 4, iR = 2, iG = 1, iB = 0, iA = 3; break;
+        case PF_red:
+        case PF_luminance: numCh = 1; break;
+        case PF_rg:
+        case PF_luminance_alpha: numCh = 2, iA = 1; break;
+        default: Utils::exitMsg("SLProject", "SLTexelCache::convert: Unsupported format!", __LINE__, __FILE__);
+    }
+
+    auto convertRows = [&](SLint yStart, SLint yEnd)
+    {
+        for (SLint y = yStart; y < yEnd; ++y)
+        {
+            const SLuchar* pixel = mat.ptr<SLuchar>(y);
+            for (SLint x = 0; x < l.width; ++x, pixel += numCh)
+            {
+                SLuint a = iA < 0 ? 255 : pixel[iA];
+                l.texels[texelIndex(l, x, y)] = packRGBA(pixel[iR],
+                                                         pixel[iG],
+                                                         pixel[iB],
+                                                         a);
+            }
+        }
+    };
+
+    // Only images with more than 256 rows are worth extra threads
+    SLint numThreads = std::min((SLint)Utils::maxThreads(),
+                                std::max(1, l.height / 256));
+    if (numThreads <= 1)
+        convertRows(0, l.height);
+    else
+    {
+        SLint               rowsPerThread = (l.height + numThreads - 1) / numThreads;
+        vector<std::thread> threads;
+        for (SLint t = 1; t < numThreads; ++t)
+            threads.emplace_back(convertRows,
+                                 std::min(l.height, t * rowsPerThread),
+                                 std::min(l.height, (t + 1) * rowsPerThread));
+        convertRows(0, rowsPerThread);
+        for (auto& t : threads)
+            t.join();
+    }
+}
+//-----------------------------------------------------------------------------
+//! Builds the next smaller mip map level dst from src with a 2x2 box filter
+void SLTexelCache::buildMipLevel(const SLTexelLevel& src, SLTexelLevel& dst)
+{
+    dst.width    = std::max(1, src.width / 2);
+    dst.height   = std::max(1, src.height / 2);
+    dst.tilesX   = (dst.width + TILE_SIZE - 1) / TILE_SIZE;
+    SLint tilesY = (dst.height + TILE_SIZE - 1) / TILE_SIZE;
+    dst.texels.assign((size_t)dst.tilesX * tilesY * TILE_SIZE * TILE_SIZE, 0);
+
+    for (SLint y = 0; y < dst.height; ++y)
+    {
+        SLint y0 = std::min(2 * y, src.height - 1);
+        SLint y1 = std::min(2 * y + 1, src.height - 1);
+
+        for (SLint x = 0; x < dst.width; ++x)
+        {
+            SLint  x0     = std::min(2 * x, src.width - 1);
+            SLint  x1     = std::min(2 * x + 1, src.width - 1);
+            SLuint t[4]   = {src.texels[texelIndex(src, x0, y0)],
+                             src.texels[texelIndex(src, x1, y0)],
+                             src.texels[texelIndex(src, x0, y1)],
+                             src.texels[texelIndex(src, x1, y1)]};
+            SLuint sum[4] = {2, 2, 2, 2}; // for rounding
+            for (auto texel : t)
+                for (SLuint c = 0; c < 4; ++c)
+                    sum[c] += (texel >> (8 * c)) & 0xFF;
+
+            dst.texels[texelIndex(dst, x, y)] = packRGBA(sum[0] / 4,
+                                                         sum[1] / 4,
+                                                         sum[2] / 4,
+                                                         sum[3] / 4);
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns the nearest texel at the integer position x,y of a mip map level
+SLCol4f SLTexelCache::texeli(SLint x, SLint y, SLint level) const
+{
+    const SLTexelLevel& l = _levels[(SLuint)Utils::clamp(level, 0, numLevels() - 1)];
+    return unpackRGBA(l.texels[texelIndex(l, wrap(x, l.width), wrap(y, l.height))]);
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns the color at the texture coordinates u,v. For a level of detail (lod)
+of 0 a bilinear lookup in level 0 is done. For a lod > 0 the two levels
+floor(lod) and floor(lod)+1 are looked up bilinear and linearly blended.
+@param u Horizontal texture coordinate between 0 and 1
+@param v Vertical texture coordinate between 0 and 1
+@param lod Level of detail: log2 of the texel footprint in level 0
+*/
+SLCol4f SLTexelCache::texelf(SLfloat u, SLfloat v, SLfloat lod) const
+{
+    SLint maxLevel = numLevels() - 1;
+    if (lod <= 0.0f || maxLevel == 0)
+        return bilinear(_levels[0], u, v);
+    if (lod >= (SLfloat)maxLevel)
+        return bilinear(_levels[(SLuint)maxLevel], u, v);
+
+    SLint   level = (SLint)lod;
+    SLfloat t     = lod - (SLfloat)level;
+    SLCol4f c0    = bilinear(_levels[(SLuint)level], u, v);
+    SLCol4f c1    = bilinear(_levels[(SLuint)level + 1], u, v);
+    return c0 * (1.0f - t) + c1 * t;
+}
+//-----------------------------------------------------------------------------
+/*!
+Bilinear lookup with the texel centers at half integer positions. The weights
+are quantized to 8 bit like on most GPUs, so that the four texels can be
+blended with integer arithmetic and only the result is converted to float.
+*/
+SLCol4f SLTexelCache::bilinear(const SLTexelLevel& l, SLfloat u, SLfloat v) const
+{
+    SLfloat x  = u * (SLfloat)l.width - 0.5f;
+    SLfloat y  = v * (SLfloat)l.height - 0.5f;
+    SLint   x0 = (SLint)floor(x);
+    SLint   y0 = (SLint)floor(y);
+    SLuint  wx = (SLuint)((x - (SLfloat)x0) * 256.0f + 0.5f); // weight of right texels
+    SLuint  wy = (SLuint)((y - (SLfloat)y0) * 256.0f + 0.5f); // weight of lower texels
+
+    // u & v are expected between 0 and 1, so that a conditional wrap suffices
+    if (x0 < 0 || x0 >= l.width) x0 = wrap(x0, l.width);
+    if (y0 < 0 || y0 >= l.height) y0 = wrap(y0, l.height);
+    SLint x1 = x0 + 1 < l.width ? x0 + 1 : 0;
+    SLint y1 = y0 + 1 < l.height ? y0 + 1 : 0;
+
+    SLuint tUL = l.texels[texelIndex(l, x0, y0)];
+    SLuint tUR = l.texels[texelIndex(l, x1, y0)];
+    SLuint tLL = l.texels[texelIndex(l, x0, y1)];
+    SLuint tLR = l.texels[texelIndex(l, x1, y1)];
+
+    SLfloat c[4];
+    for (SLuint i = 0, shift = 0; i < 4; ++i, shift += 8)
+    {
+        SLuint upper = ((tUL >> shift) & 0xFF) * (256 - wx) + ((tUR >> shift) & 0xFF) * wx;
+        SLuint lower = ((tLL >> shift) & 0xFF) * (256 - wx) + ((tLR >> shift) & 0xFF) * wx;
+        c[i]         = (SLfloat)(upper * (256 - wy) + lower * wy);
+    }
+
+    const SLfloat s = 1.0f / (255.0f * 65536.0f);
+    return SLCol4f(c[0] * s, c[1] * s, c[2] * s, c[3] * s);
+}
+//-----------------------------------------------------------------------------
+//! Returns the NO. of bytes of all levels
+size_t SLTexelCache::numBytes() const
+{
+    size_t bytes = sizeof(SLTexelCache);
+    for (const auto& l : _levels)
+        bytes += l.texels.size() * sizeof(SLuint);
+    return bytes;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,68 @@
+//#############################################################################
+//  File:      SLTexelCache.h
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLTEXELCACHE_H
+#define SLTEXELCACHE_H
+
+#include <SL.h>
+#include <SLVec4.h>
+#include <cv/CVImage.h>
+
+//-----------------------------------------------------------------------------
+//! Tiled and mip mapped RGBA8 copy of a CVImage for fast texel fetches on the CPU
+/*!
+The ray tracers call SLGLTexture::getTexelf for every shading sample. Reading
+the texels directly from the row major OpenCV matrix of a CVImage needs a
+format switch and a float conversion per texel and the four texels of a
+bilinear lookup often lie on different cache lines.
+\n SLTexelCache converts an 8 bit CVImage once into RGBA8 texels that are
+stored in tiles of 8x8 texels. The texels within a tile are in Morton
+(Z-curve) order, so that the four texels of a bilinear lookup are mostly in
+the same 256 byte tile. Optionally a mip map chain is built with a 2x2 box
+filter. texelf does a bilinear lookup in one level or a trilinear lookup
+between two levels for a level of detail > 0.
+\n All texture coordinates wrap around (GL_REPEAT) like in CVImage::getPixeli.
+Only the 8 bit formats of CVImage::getPixeli are supported (see isSupported).
+*/
+class SLTexelCache
+{
+public:
+    SLTexelCache(CVImage* image, SLbool buildMipmaps);
+
+    SLCol4f texeli(SLint x, SLint y, SLint level = 0) const;
+    SLCol4f texelf(SLfloat u, SLfloat v, SLfloat lod = 0.0f) const;
+    size_t  numBytes() const;
+
+    // Getters
+    SLint numLevels() const { return (SLint)_levels.size(); }
+    SLint width(SLint level = 0) const { return _levels[(SLuint)level].width; }
+    SLint height(SLint level = 0) const { return _levels[(SLuint)level].height; }
+
+    static SLbool isSupported(CVImage* image);
+
+private:
+    //! One mip map level with its texels in 8x8 tiles
+    struct SLTexelLevel
+    {
+        SLint   width;  //!< Width in texels
+        SLint   height; //!< Height in texels
+        SLint   tilesX; //!< NO. of tiles in x direction
+        SLVuint texels; //!< RGBA8 texels tile by tile in Morton order
+    };
+
+    //! Returns the index of the texel at x,y within the texels of a level
+    static inline SLuint texelIndex(const SLTexelLevel& l, SLint x, SLint y);
+
+    void    convert(CVImage* image);
+    void    buildMipLevel(const SLTexelLevel& src, SLTexelLevel& dst);
+    SLCol4f bilinear(const SLTexelLevel& l, SLfloat u, SLfloat v) const;
+
+    vector<SLTexelLevel> _levels; //!< Mip map levels. Level 0 has the image size
+};
+//-----------------------------------------------------------------------------
+#endif // SLTEXELCACHE_H
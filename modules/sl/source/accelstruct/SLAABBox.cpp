@@ -53,40 +53,17 @@ void SLAABBox::fromOStoWS(const SLVec3f& minOS,
 
     _minOS.set(minOS);
     _maxOS.set(maxOS);
-    _minWS.set(minOS);
-    _maxWS.set(maxOS);
 
-    // we need to transform all 8 corners for a non-optimal bounding box
-    SLVec3f vCorner[8];
-    SLint   i;
-
-    vCorner[0].set(_minWS);
-    vCorner[1].set(_maxWS.x, _minWS.y, _minWS.z);
-    vCorner[2].set(_maxWS.x, _minWS.y, _maxWS.z);
-    vCorner[3].set(_minWS.x, _minWS.y, _maxWS.z);
-    vCorner[4].set(_maxWS.x, _maxWS.y, _minWS.z);
-    vCorner[5].set(_minWS.x, _maxWS.y, _minWS.z);
-    vCorner[6].set(_minWS.x, _maxWS.y, _maxWS.z);
-    vCorner[7].set(_maxWS);
-
-    // apply world transform
-    for (i = 0; i < 8; ++i)
-        vCorner[i] = wm.multVec(vCorner[i]);
-
-    // sets the minimum and maximum of the vertex components of the 8 corners
-    _minWS.set(vCorner[0]);
-    _maxWS.set(vCorner[0]);
-    for (i = 1; i < 8; ++i)
-    {
-        _minWS.setMin(vCorner[i]);
-        _maxWS.setMax(vCorner[i]);
-    }
+    // The min & max of the 8 transformed corners (SIMD for SLMat4f)
+    wm.transformAABB(minOS, maxOS, _minWS, _maxWS);
 
     // set coordinate axis in world space
-    _axis0WS = wm.multVec(SLVec3f::ZERO);
-    _axisXWS = wm.multVec(SLVec3f::AXISX);
-    _axisYWS = wm.multVec(SLVec3f::AXISY);
-    _axisZWS = wm.multVec(SLVec3f::AXISZ);
+    SLVec3f axis[4] = {SLVec3f::ZERO, SLVec3f::AXISX, SLVec3f::AXISY, SLVec3f::AXISZ};
+    wm.multVecs(axis, axis, 4);
+    _axis0WS = axis[0];
+    _axisXWS = axis[1];
+    _axisYWS = axis[2];
+    _axisZWS = axis[3];
 
     // Delete OpenGL vertex array
     if (_vao.vaoID()) _vao.clearAttribs();
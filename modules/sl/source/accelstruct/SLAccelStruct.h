@@ -16,7 +16,8 @@
 //! SLAccelStruct is an abstract base class for acceleration structures
 /*! The SLAccelStruct class serves as common class for the SLUniformGrid,
 SLCompactGrid and the SLKDTree class. All derived acceleration structures must
-be able to build, draw, intersect with a ray and update statistics.
+be able to build, draw, intersect with a ray (closest hit and any hit for shadow
+rays) and update statistics.
 All structures work on meshes.
 */
 class SLAccelStruct
@@ -25,11 +26,12 @@ public:
     SLAccelStruct(SLMesh* m) { _m = m; }
     virtual ~SLAccelStruct() { ; }
 
-    virtual void   build(SLVec3f minV, SLVec3f maxV)   = 0;
-    virtual void   updateStats(SLNodeStats& stats)     = 0;
-    virtual void   draw(SLSceneView* sv)               = 0;
-    virtual SLbool intersect(SLRay* ray, SLNode* node) = 0;
-    virtual void   disposeBuffers()                    = 0;
+    virtual void   build(SLVec3f minV, SLVec3f maxV)      = 0;
+    virtual void   updateStats(SLNodeStats& stats)        = 0;
+    virtual void   draw(SLSceneView* sv)                  = 0;
+    virtual SLbool intersect(SLRay* ray, SLNode* node)    = 0;
+    virtual SLbool intersectAny(SLRay* ray, SLNode* node) = 0;
+    virtual void   disposeBuffers()                       = 0;
 
 protected:
     SLMesh* _m;    //!< Pointer to the mesh
@@ -409,3 +409,104 @@ SLbool SLCompactGrid::intersect(SLRay* ray, SLNode* node)
         return false; // did not hit aabb
 }
 //-----------------------------------------------------------------------------
+/*!
+Any hit ray mesh intersection for shadow rays. The same voxel traversal as in
+SLCompactGrid::intersect is used but it stops at the first triangle hit within
+the ray length (the distance to the light). The traversal also stops as soon
+as the next voxel starts behind the ray length.
+*/
+SLbool SLCompactGrid::intersectAny(SLRay* ray, SLNode* node)
+{
+    // Check first if the AABB is hit at all
+    if (!node->aabb()->isHitInOS(ray))
+        return false;
+
+    if (_voxelCnt == 0)
+    { // not enough triangles for regular grid > check them all
+        for (SLuint t = 0; t < _m->numI(); t += 3)
+            if (_m->hitTriangleOS(ray, node, t))
+                return true;
+        return false;
+    }
+
+    SLVec3f O          = ray->originOS;
+    SLVec3f D          = ray->dirOS;
+    SLVec3f invD       = ray->invDirOS;
+    SLVec3f startPoint = O;
+
+    // Determine start voxel of the grid
+    if (ray->tmin > 0) startPoint += ray->tmin * D;
+    SLVec3i startVox = containingVoxel(startPoint);
+    SLuint  voxID    = indexAtPos(startVox);
+
+    // clang-format off
+    SLint stepX = (D.x > 0) ? 1 : (D.x < 0) ? -1 : 0;
+    SLint stepY = (D.y > 0) ? 1 : (D.y < 0) ? -1 : 0;
+    SLint stepZ = (D.z > 0) ? 1 : (D.z < 0) ? -1 : 0;
+
+    SLVec3f minVox(_minV.x + startVox.x * _voxelSize.x,
+                   _minV.y + startVox.y * _voxelSize.y,
+                   _minV.z + startVox.z * _voxelSize.z);
+    SLVec3f maxVox(minVox + _voxelSize);
+
+    SLfloat tMaxX = FLT_MAX, tMaxY = FLT_MAX, tMaxZ = FLT_MAX;
+    if (stepX ==  1) tMaxX = (maxVox.x - O.x) * invD.x; else
+    if (stepX == -1) tMaxX = (minVox.x - O.x) * invD.x;
+    if (stepY ==  1) tMaxY = (maxVox.y - O.y) * invD.y; else
+    if (stepY == -1) tMaxY = (minVox.y - O.y) * invD.y;
+    if (stepZ ==  1) tMaxZ = (maxVox.z - O.z) * invD.z; else
+    if (stepZ == -1) tMaxZ = (minVox.z - O.z) * invD.z;
+    // clang-format on
+
+    SLint incIDX = stepX;
+    SLint incIDY = stepY * (SLint)_size.x;
+    SLint incIDZ = stepZ * (SLint)_size.x * (SLint)_size.y;
+
+    SLfloat tDeltaX = (_voxelSize.x * invD.x) * stepX;
+    SLfloat tDeltaY = (_voxelSize.y * invD.y) * stepY;
+    SLfloat tDeltaZ = (_voxelSize.z * invD.z) * stepZ;
+
+    while (true)
+    {
+        // Any triangle hit within the ray length blocks the ray
+        if (_m->I16.size())
+        {
+            for (SLuint i = _voxelOffsets[voxID]; i < _voxelOffsets[voxID + 1]; ++i)
+                if (_m->hitTriangleOS(ray, node, _triangleIndexes16[i] * 3))
+                    return true;
+        }
+        else
+        {
+            for (SLuint i = _voxelOffsets[voxID]; i < _voxelOffsets[voxID + 1]; ++i)
+                if (_m->hitTriangleOS(ray, node, _triangleIndexes32[i] * 3))
+                    return true;
+        }
+
+        // step voxel
+        if (tMaxX < tMaxY && tMaxX < tMaxZ)
+        {
+            if (tMaxX > ray->length) return false;
+            startVox.x += stepX;
+            if (startVox.x >= (SLint)_size.x || startVox.x < 0) return false;
+            tMaxX += tDeltaX;
+            voxID += (SLuint)incIDX;
+        }
+        else if (tMaxY < tMaxZ)
+        {
+            if (tMaxY > ray->length) return false;
+            startVox.y += stepY;
+            if (startVox.y >= (SLint)_size.y || startVox.y < 0) return false;
+            tMaxY += tDeltaY;
+            voxID += (SLuint)incIDY;
+        }
+        else
+        {
+            if (tMaxZ > ray->length) return false;
+            startVox.z += stepZ;
+            if (startVox.z >= (SLint)_size.z || startVox.z < 0) return false;
+            tMaxZ += tDeltaZ;
+            voxID += (SLuint)incIDZ;
+        }
+    }
+}
+//-----------------------------------------------------------------------------
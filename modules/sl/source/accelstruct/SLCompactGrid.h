@@ -39,6 +39,7 @@ public:
     void   updateStats(SLNodeStats& stats);
     void   draw(SLSceneView* sv);
     SLbool intersect(SLRay* ray, SLNode* node);
+    SLbool intersectAny(SLRay* ray, SLNode* node);
 
     void deleteAll();
     void disposeBuffers()
@@ -11,6 +11,16 @@
 #include <json.hpp>
 #include <Utils.h>
 #include <SL.h>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#if !defined(SL_OS_WINDOWS) && !defined(__EMSCRIPTEN__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
 
 using json = nlohmann::json;
 
@@ -18,10 +28,19 @@ using json = nlohmann::json;
 CVImageGeoTiff::CVImageGeoTiff()
 {
     _noDataValue = 0.0;
+    _demCols     = 0;
+    _demRows     = 0;
+    _mappedData  = nullptr;
+    _mappedSize  = 0;
+    _swapBytes   = false;
+    _tileWidth   = 0;
+    _tileHeight  = 0;
+    _tilesAcross = 0;
 }
 //-----------------------------------------------------------------------------
 CVImageGeoTiff::~CVImageGeoTiff()
 {
+    unmapGeoTiff();
     clearData();
 }
 //-----------------------------------------------------------------------------
@@ -50,12 +69,34 @@ void CVImageGeoTiff::loadGeoTiff(const string& geoTiffFile)
         throw std::runtime_error(msg.c_str());
     }
 
-    // Read the geo tiff image with OpenCV
-    cv::Mat imgGeoTiff = cv::imread(geoTiffFile,
-                                    cv::IMREAD_LOAD_GDAL | cv::IMREAD_ANYDEPTH);
+    // Release a previously loaded DEM
+    unmapGeoTiff();
+    clearData();
+    _demCols = 0;
+    _demRows = 0;
+
+    // Try to memory map an uncompressed float GeoTiff and otherwise read the
+    // full geo tiff image with OpenCV
+    cv::Mat imgGeoTiff;
+    int     cols, rows;
+    if (mapGeoTiff(geoTiffFile))
+    {
+        cols     = _demCols;
+        rows     = _demRows;
+        _demCols = 0; // the DEM gets valid only after all checks below
+        _demRows = 0;
+    }
+    else
+    {
+        imgGeoTiff = cv::imread(geoTiffFile,
+                                cv::IMREAD_LOAD_GDAL | cv::IMREAD_ANYDEPTH);
 
-    if (imgGeoTiff.type() != CV_32FC1)
-        throw std::runtime_error("GEOTiff image must be of 32-bit float type.");
+        if (imgGeoTiff.type() != CV_32FC1)
+            throw std::runtime_error("GEOTiff image must be of 32-bit float type.");
+
+        cols = imgGeoTiff.cols;
+        rows = imgGeoTiff.rows;
+    }
 
     // Read the JSON file
     std::ifstream  jsonFile(jsonFileName);
@@ -79,6 +120,7 @@ void CVImageGeoTiff::loadGeoTiff(const string& geoTiffFile)
     }
     catch (json::exception& e)
     {
+        unmapGeoTiff();
         msg = "Error reading JSON-File: " + jsonFileName;
         msg += "\nException: ";
         msg += e.what();
@@ -86,11 +128,12 @@ void CVImageGeoTiff::loadGeoTiff(const string& geoTiffFile)
     }
 
     // Check some correspondences between image file an json file
-    if (size.size() < 2 || size[0] != imgGeoTiff.cols || size[1] != imgGeoTiff.rows)
+    if (size.size() < 2 || size[0] != cols || size[1] != rows)
     {
+        unmapGeoTiff();
         msg = "Mismatch between geotiff image size and size json tag:";
-        msg += "\nGEOTiff image width : " + to_string(imgGeoTiff.cols);
-        msg += "\nGEOTiff image height: " + to_string(imgGeoTiff.rows);
+        msg += "\nGEOTiff image width : " + to_string(cols);
+        msg += "\nGEOTiff image height: " + to_string(rows);
         msg += "\nJSON Size tag[0]    : " + to_string(size[0]);
         msg += "\nJSON Size tag[1]    : " + to_string(size[1]);
         throw std::runtime_error(msg.c_str());
@@ -99,30 +142,323 @@ void CVImageGeoTiff::loadGeoTiff(const string& geoTiffFile)
     if (!Utils::containsString(geocsc, "WGS 84") &&
         !Utils::containsString(geocsc, "WGS_1984"))
     {
+        unmapGeoTiff();
         msg = "GeoTiff file seams not have WGS84 coordinates.";
         throw std::runtime_error(msg.c_str());
     }
 
-    _cvMat  = imgGeoTiff.clone();
-    _format = cvType2glPixelFormat(imgGeoTiff.type());
+    // The freshly read matrix is owned by us, so no clone is needed
+    if (!isMapped())
+    {
+        _cvMat  = imgGeoTiff;
+        _format = cvType2glPixelFormat(imgGeoTiff.type());
+    }
+    _demCols = cols;
+    _demRows = rows;
+
+    _upperleftLatLonAlt[0]  = upperLeft[1];            // We store first latitude in degrees! (N)
+    _upperleftLatLonAlt[1]  = upperLeft[0];            // and then longitude in degrees (W)
+    _upperleftLatLonAlt[2]  = altitudeAtPixel(0, 0);   // and then altitude in m from the image
+    _lowerRightLatLonAlt[0] = lowerRight[1];           // we store first latitude in degrees! (S)
+    _lowerRightLatLonAlt[1] = lowerRight[0];           // and then longitude in degrees (E)
+    _lowerRightLatLonAlt[2] = altitudeAtPixel(cols - 1, rows - 1);
 
-    _upperleftLatLonAlt[0]  = upperLeft[1];           // We store first latitude in degrees! (N)
-    _upperleftLatLonAlt[1]  = upperLeft[0];           // and then longitude in degrees (W)
-    _upperleftLatLonAlt[2]  = _cvMat.at<float>(0, 0); // and then altitude in m from the image
-    _lowerRightLatLonAlt[0] = lowerRight[1];          // we store first latitude in degrees! (S)
-    _lowerRightLatLonAlt[1] = lowerRight[0];          // and then longitude in degrees (E)
-    _lowerRightLatLonAlt[2] = _cvMat.at<float>(_cvMat.rows - 1, _cvMat.cols - 1);
+    SL_LOG("GeoTiff loaded %s: %d x %d pixels",
+           isMapped() ? "(memory mapped)" : "(in memory)",
+           cols,
+           rows);
 #endif
 }
 //-----------------------------------------------------------------------------
-//! Returns the altitude in m at the given position in WGS84 latitude-longitude
-float CVImageGeoTiff::getAltitudeAtLatLon(double latDEG,
-                                          double lonDEG) const
+//! Memory maps an uncompressed 32-bit float GeoTiff with strips or tiles
+/*! Parses the TIFF header and the first IFD (classic TIFF and BigTIFF in both
+ byte orders) and maps the entire file read-only. Nothing but the header gets
+ read here. The pixel data is paged in by the OS on first access in
+ altitudeAtPixel. Returns false if the file can not be mapped, e.g. because
+ it is compressed, so that the caller can fall back to OpenCV.
+ */
+bool CVImageGeoTiff::mapGeoTiff(const string& geoTiffFile)
+{
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+    // Map the whole file read-only
+#    if defined(SL_OS_WINDOWS)
+    HANDLE file = CreateFileA(geoTiffFile.c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < 16)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    // The view keeps the mapping alive after closing its handle
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+        return false;
+
+    _mappedSize = (size_t)fileSize.QuadPart;
+#    else
+    int fd = open(geoTiffFile.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 16)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    // DEM queries jump around, so read-ahead of whole neighbouring regions is useless
+    madvise(data, (size_t)st.st_size, MADV_RANDOM);
+    _mappedSize = (size_t)st.st_size;
+#    endif
+    _mappedData = (uint8_t*)data;
+
+    // Byte order dependent reader with bounds check
+    const uint8_t* p     = _mappedData;
+    size_t         size  = _mappedSize;
+    bool           isLE  = p[0] == 'I' && p[1] == 'I';
+    bool           isBE  = p[0] == 'M' && p[1] == 'M';
+    bool           valid = isLE || isBE;
+
+    auto readUInt = [&](uint64_t pos, int numBytes) -> uint64_t
+    {
+        if (pos + (uint64_t)numBytes > size)
+        {
+            valid = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < numBytes; ++i)
+            v |= (uint64_t)p[pos + i] << (isLE ? 8 * i : 8 * (numBytes - 1 - i));
+        return v;
+    };
+    auto readU16 = [&](uint64_t pos) { return readUInt(pos, 2); };
+    auto readU32 = [&](uint64_t pos) { return readUInt(pos, 4); };
+    auto readU64 = [&](uint64_t pos) { return readUInt(pos, 8); };
+
+    // Classic TIFF (42) or BigTIFF (43)
+    uint64_t version   = readU16(2);
+    bool     isBigTiff = version == 43;
+    if (!valid || (version != 42 && !isBigTiff))
+    {
+        unmapGeoTiff();
+        return false;
+    }
+
+    uint64_t ifdOffset  = isBigTiff ? readU64(8) : readU32(4);
+    uint64_t numEntries = isBigTiff ? readU64(ifdOffset) : readU16(ifdOffset);
+    uint64_t entrySize  = isBigTiff ? 20 : 12;
+    uint64_t inlineSize = isBigTiff ? 8 : 4;
+    uint64_t firstEntry = ifdOffset + (isBigTiff ? 8 : 2);
+
+    auto readCount = [&](uint64_t entry)
+    {
+        return isBigTiff ? readU64(entry + 4) : readU32(entry + 4);
+    };
+
+    // Reads the i-th value of an IFD entry of type SHORT, LONG or LONG8
+    auto readValue = [&](uint64_t entry, uint64_t i) -> uint64_t
+    {
+        uint64_t type     = readU16(entry + 2);
+        uint64_t count    = readCount(entry);
+        int      typeSize = type == 3 ? 2 : type == 4 ? 4 : (type == 16 || type == 18) ? 8 : 0;
+        if (!typeSize || i >= count)
+        {
+            valid = false;
+            return 0;
+        }
+        uint64_t valuePos = entry + (isBigTiff ? 12 : 8);
+        uint64_t dataPos  = count * typeSize <= inlineSize
+                              ? valuePos
+                              : (isBigTiff ? readU64(valuePos) : readU32(valuePos));
+        return readUInt(dataPos + i * typeSize, typeSize);
+    };
+
+    uint64_t width = 0, height = 0, bitsPerSample = 0, compression = 1;
+    uint64_t samplesPerPixel = 1, rowsPerStrip = 0, sampleFormat = 1;
+    uint64_t predictor = 1, tileWidth = 0, tileHeight = 0;
+    uint64_t offsetsEntry = 0, countsEntry = 0;
+
+    for (uint64_t e = 0; e < numEntries && valid; ++e)
+    {
+        uint64_t entry = firstEntry + e * entrySize;
+        switch (readU16(entry))
+        {
+            case 256: width = readValue(entry, 0); break;
+            case 257: height = readValue(entry, 0); break;
+            case 258: bitsPerSample = readValue(entry, 0); break;
+            case 259: compression = readValue(entry, 0); break;
+            case 277: samplesPerPixel = readValue(entry, 0); break;
+            case 278: rowsPerStrip = readValue(entry, 0); break;
+            case 317: predictor = readValue(entry, 0); break;
+            case 322: tileWidth = readValue(entry, 0); break;
+            case 323: tileHeight = readValue(entry, 0); break;
+            case 339: sampleFormat = readValue(entry, 0); break;
+            case 273:
+            case 324: offsetsEntry = entry; break;
+            case 279:
+            case 325: countsEntry = entry; break;
+            default: break;
+        }
+    }
+
+    // Only single channel uncompressed 32-bit float files can be accessed in place
+    bool isTiled = tileWidth > 0 && tileHeight > 0;
+    if (!valid || !offsetsEntry || !width || !height ||
+        width > INT32_MAX || height > INT32_MAX ||
+        compression != 1 || predictor != 1 || bitsPerSample != 32 ||
+        sampleFormat != 3 || samplesPerPixel != 1)
+    {
+        unmapGeoTiff();
+        return false;
+    }
+
+    // A file with strips is handled as one column of tiles with full width
+    if (!isTiled)
+    {
+        tileWidth  = width;
+        tileHeight = rowsPerStrip && rowsPerStrip < height ? rowsPerStrip : height;
+    }
+
+    uint64_t tilesAcross = (width + tileWidth - 1) / tileWidth;
+    uint64_t tilesDown   = (height + tileHeight - 1) / tileHeight;
+    uint64_t numTiles    = tilesAcross * tilesDown;
+    if (readCount(offsetsEntry) < numTiles)
+    {
+        unmapGeoTiff();
+        return false;
+    }
+
+    // Check that all tiles lie within the file so that no query can fault
+    _tileOffsets.resize(numTiles);
+    for (uint64_t t = 0; t < numTiles && valid; ++t)
+    {
+        uint64_t tileRows  = isTiled ? tileHeight : std::min(tileHeight, height - (t / tilesAcross) * tileHeight);
+        uint64_t tileBytes = tileRows * tileWidth * 4;
+        uint64_t offset    = readValue(offsetsEntry, t);
+        if (countsEntry && readValue(countsEntry, t) < tileBytes)
+            valid = false;
+        if (offset + tileBytes > size)
+            valid = false;
+        _tileOffsets[t] = offset;
+    }
+
+    if (!valid)
+    {
+        unmapGeoTiff();
+        return false;
+    }
+
+    uint16_t one      = 1;
+    bool     hostIsLE = *(uint8_t*)&one == 1;
+    _swapBytes   = hostIsLE != isLE;
+    _tileWidth   = (int)tileWidth;
+    _tileHeight  = (int)tileHeight;
+    _tilesAcross = (int)tilesAcross;
+    _demCols     = (int)width;
+    _demRows     = (int)height;
+    return true;
+#endif
+}
+//-----------------------------------------------------------------------------
+//! Releases the memory mapping of the GeoTiff file if any
+void CVImageGeoTiff::unmapGeoTiff()
+{
+    if (_mappedData)
+    {
+#if defined(SL_OS_WINDOWS)
+        UnmapViewOfFile(_mappedData);
+#elif !defined(__EMSCRIPTEN__)
+        munmap(_mappedData, _mappedSize);
+#endif
+    }
+    _mappedData  = nullptr;
+    _mappedSize  = 0;
+    _swapBytes   = false;
+    _tileWidth   = 0;
+    _tileHeight  = 0;
+    _tilesAcross = 0;
+    _tileOffsets.clear();
+}
+//-----------------------------------------------------------------------------
+//! Returns the altitude of the pixel at x,y clamped to the image borders
+float CVImageGeoTiff::altitudeAtPixel(int x, int y) const
+{
+    x = std::max(0, std::min(x, _demCols - 1));
+    y = std::max(0, std::min(y, _demRows - 1));
+
+    if (!_mappedData)
+        return _cvMat.at<float>(y, x);
+
+    int      tile   = (y / _tileHeight) * _tilesAcross + x / _tileWidth;
+    uint64_t offset = _tileOffsets[(size_t)tile] +
+                      ((uint64_t)(y % _tileHeight) * (uint64_t)_tileWidth +
+                       (uint64_t)(x % _tileWidth)) *
+                        4;
+
+    uint32_t bits;
+    memcpy(&bits, _mappedData + offset, 4);
+    if (_swapBytes)
+        bits = (bits >> 24) | ((bits >> 8) & 0xFF00) | ((bits << 8) & 0xFF0000) | (bits << 24);
+
+    float altitude;
+    memcpy(&altitude, &bits, 4);
+    return altitude;
+}
+//-----------------------------------------------------------------------------
+/*! Returns the bilinear interpolated altitude at the subpixel position x,y.
+ This corresponds to cv::getRectSubPix with a 1x1 patch and replicated
+ borders that was used before on the full cvMat.
+ */
+float CVImageGeoTiff::altitudeAtSubPixel(double x, double y) const
+{
+    int    x0 = (int)floor(x);
+    int    y0 = (int)floor(y);
+    double ax = x - x0;
+    double ay = y - y0;
+
+    double a00 = altitudeAtPixel(x0, y0);
+    double a10 = altitudeAtPixel(x0 + 1, y0);
+    double a01 = altitudeAtPixel(x0, y0 + 1);
+    double a11 = altitudeAtPixel(x0 + 1, y0 + 1);
+
+    return (float)((1.0 - ay) * ((1.0 - ax) * a00 + ax * a10) +
+                   ay * ((1.0 - ax) * a01 + ax * a11));
+}
+//-----------------------------------------------------------------------------
+//! Converts WGS84 lat-lon to pixel position and returns true if it is inside
+bool CVImageGeoTiff::latLonToPixel(double  latDEG,
+                                   double  lonDEG,
+                                   double& x,
+                                   double& y) const
 {
     double dLatDEG   = _upperleftLatLonAlt[0] - _lowerRightLatLonAlt[0];
     double dLonDEG   = _lowerRightLatLonAlt[1] - _upperleftLatLonAlt[1];
-    double latPerPix = dLatDEG / (double)_cvMat.rows;
-    double lonPerPix = dLonDEG / (double)_cvMat.cols;
+    double latPerPix = dLatDEG / (double)_demRows;
+    double lonPerPix = dLonDEG / (double)_demCols;
 
     double offsetLat = latDEG - _lowerRightLatLonAlt[0];
     double offsetLon = lonDEG - _upperleftLatLonAlt[1];
@@ -131,26 +467,87 @@ float CVImageGeoTiff::getAltitudeAtLatLon(double latDEG,
     double pixPosLon = offsetLon / lonPerPix; // pixels from left
 
     // pixels are top-left coordinates in OpenCV
-    pixPosLat = _cvMat.rows - pixPosLat;
+    y = _demRows - pixPosLat;
+    x = pixPosLon;
+
+    return y >= 0.0 && y <= _demRows - 1.0 &&
+           x >= 0.0 && x <= _demCols - 1.0;
+}
+//-----------------------------------------------------------------------------
+//! Returns the altitude in m at the given position in WGS84 latitude-longitude
+float CVImageGeoTiff::getAltitudeAtLatLon(double latDEG,
+                                          double lonDEG) const
+{
+    if (!isLoaded())
+        return 0.0f;
+
+    double pixPosLon, pixPosLat;
+    latLonToPixel(latDEG, lonDEG, pixPosLon, pixPosLat);
 
-    if (pixPosLat < 0.0 || pixPosLat > _cvMat.rows - 1.0)
+    if (pixPosLat < 0.0 || pixPosLat > _demRows - 1.0)
     {
         SL_LOG("Invalid pixPosLat %3.2f", pixPosLat);
         pixPosLat = 0;
     }
-    if (pixPosLon < 0.0 || pixPosLon > _cvMat.cols - 1.0)
+    if (pixPosLon < 0.0 || pixPosLon > _demCols - 1.0)
     {
         SL_LOG("Invalid pixPosLon %3.2f", pixPosLon);
         pixPosLon = 0;
     }
 
     // get subpixel accurate interpolated height value
-    cv::Point2f pt((float)pixPosLon, (float)pixPosLat);
-    cv::Mat     patch;
-    cv::getRectSubPix(_cvMat, cv::Size(1, 1), pt, patch);
+    return altitudeAtSubPixel(pixPosLon, pixPosLat);
+}
+//-----------------------------------------------------------------------------
+/*! Returns the altitudes in m for many WGS84 positions at once. The x-values
+ of latLonDEG are the latitudes and the y-values the longitudes. The queries
+ are processed sorted by tile so that each tile of a memory mapped DEM is
+ paged in only once. Positions outside the DEM are handled as in
+ getAltitudeAtLatLon.
+ */
+void CVImageGeoTiff::getAltitudesAtLatLon(const CVVPoint2d& latLonDEG,
+                                          vector<float>&    altitudesM) const
+{
+    altitudesM.assign(latLonDEG.size(), 0.0f);
+    if (!isLoaded() || latLonDEG.empty())
+        return;
+
+    vector<cv::Point2d> pixPos(latLonDEG.size());
+    vector<int>         tileOfQuery(latLonDEG.size());
+    int                 numOutside = 0;
+
+    for (size_t i = 0; i < latLonDEG.size(); ++i)
+    {
+        double x, y;
+        if (!latLonToPixel(latLonDEG[i].x, latLonDEG[i].y, x, y))
+        {
+            numOutside++;
+            if (y < 0.0 || y > _demRows - 1.0) y = 0;
+            if (x < 0.0 || x > _demCols - 1.0) x = 0;
+        }
+        pixPos[i] = cv::Point2d(x, y);
+
+        if (_mappedData)
+            tileOfQuery[i] = ((int)y / _tileHeight) * _tilesAcross + (int)x / _tileWidth;
+    }
+
+    if (numOutside)
+        SL_LOG("CVImageGeoTiff::getAltitudesAtLatLon: %d positions outside DEM", numOutside);
+
+    // Order the queries by tile and row for locality within the mapped file
+    vector<size_t> order(latLonDEG.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (_mappedData)
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [&](size_t a, size_t b)
+                         {
+                             if (tileOfQuery[a] != tileOfQuery[b])
+                                 return tileOfQuery[a] < tileOfQuery[b];
+                             return pixPos[a].y < pixPos[b].y;
+                         });
 
-    float heightMatPix    = _cvMat.at<float>((int)pixPosLat, (int)pixPosLon);
-    float heightMatSubPix = patch.at<float>(0, 0);
-    return heightMatSubPix;
+    for (size_t i : order)
+        altitudesM[i] = altitudeAtSubPixel(pixPos[i].x, pixPos[i].y);
 }
 //-----------------------------------------------------------------------------
@@ -23,6 +23,18 @@
  information with OpenCV we have to store them in a separate json file with
  the same name. They are generated with a tool that comes with QGIS as follows:
  gdalinfo -json DTM-Aventicum-WGS84.tif > DTM-Aventicum-WGS84.json
+
+ Uncompressed 32-bit float GeoTiffs are not loaded into memory but memory
+ mapped. The OS then only pages in the strips or tiles around the queried
+ positions, so also regional elevation models of several hundred MB can be
+ used. For the best locality store the DEM tiled, e.g. with:
+ gdal_translate -co TILED=YES -co COMPRESS=NONE in.tif out.tif
+ Compressed GeoTiffs and platforms without memory mapping (Emscripten) fall
+ back to the full load with OpenCV into the cvMat. Use isLoaded instead of
+ empty() to check whether a DEM is available because a mapped DEM has an
+ empty cvMat.
+ For many positions at once (e.g. all POIs of a scene or the samples of a GPS
+ track) use getAltitudesAtLatLon that processes the queries in tile order.
  */
 class CVImageGeoTiff : public CVImage
 {
@@ -34,11 +46,36 @@ public:
     CVVec3d upperLeftLatLonAlt() const { return _upperleftLatLonAlt; }
     CVVec3d lowerRightLatLonAlt() const { return _lowerRightLatLonAlt; }
     float   getAltitudeAtLatLon(double lat, double lon) const;
+    void    getAltitudesAtLatLon(const CVVPoint2d& latLonDEG,
+                                 vector<float>&    altitudesM) const;
+
+    // Getters
+    bool isLoaded() const { return _demCols > 0 && _demRows > 0; }
+    bool isMapped() const { return _mappedData != nullptr; }
+    int  demCols() const { return _demCols; }
+    int  demRows() const { return _demRows; }
 
 private:
+    bool  mapGeoTiff(const string& geoTiffFile);
+    void  unmapGeoTiff();
+    bool  latLonToPixel(double latDEG, double lonDEG, double& x, double& y) const;
+    float altitudeAtPixel(int x, int y) const;
+    float altitudeAtSubPixel(double x, double y) const;
+
     CVVec3d _upperleftLatLonAlt;  //! Upper-left corner of DEM in WGS84 coords
     CVVec3d _lowerRightLatLonAlt; //! Lower-right corner of DEM in WGS84 coords
     double  _noDataValue;         //! double pixel value that stands for no data
+    int     _demCols;             //! No. of DEM columns (also if memory mapped)
+    int     _demRows;             //! No. of DEM rows (also if memory mapped)
+
+    // Memory mapped DEM (uncompressed float GeoTiff)
+    uint8_t*         _mappedData;  //! Pointer to the mapped file or nullptr
+    size_t           _mappedSize;  //! Size of the mapped file in bytes
+    bool             _swapBytes;   //! Flag if the file byte order differs
+    int              _tileWidth;   //! Tile width in pixels (image width for strips)
+    int              _tileHeight;  //! Tile height in pixels (rows per strip for strips)
+    int              _tilesAcross; //! No. of tiles per tile row
+    vector<uint64_t> _tileOffsets; //! File offsets of all tiles or strips
 };
 //-----------------------------------------------------------------------------
 #endif
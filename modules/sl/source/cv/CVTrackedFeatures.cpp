@@ -20,6 +20,9 @@ for a good top down information.
 #include <cv/CVFeatureManager.h>
 #include <cv/CVTrackedFeatures.h>
 #include <Utils.h>
+#include <opencv2/core/hal/hal.hpp>
+#include <algorithm>
+#include <cfloat>
 
 #if defined(SL_OS_WINDOWS)
 #    include <direct.h>
@@ -45,6 +48,12 @@ CVTrackedFeatures::CVTrackedFeatures(string markerFilename)
     // Hamming distance <-> XOR sum
     _matcher = cv::BFMatcher::create(cv::BFMatcher::BRUTEFORCE_HAMMING, false);
 
+    // For the global matching we use by default a LSH index over the marker
+    // descriptors and once we have a pose we only match around the reprojected
+    // marker features.
+    _matcherType        = FMT_LSH;
+    _projectionMatching = true;
+
     // Initialize some member variables on startup to prevent uncontrolled behaviour
     _currentFrame.foundPose         = false;
     _prevFrame.foundPose            = false;
@@ -126,6 +135,7 @@ void CVTrackedFeatures::initFeaturesOnMarker()
     assert(!_marker.imageGray.empty() && "Grayscale image is empty!");
 
     // Clear previous initializations
+    _markerIndex.release();
     _marker.keypoints2D.clear();
     _marker.keypoints3D.clear();
     _marker.descriptors.release();
@@ -134,6 +144,10 @@ void CVTrackedFeatures::initFeaturesOnMarker()
     _featureManager.detectAndDescribe(_marker.imageGray,
                                       _marker.keypoints2D,
                                       _marker.descriptors);
+
+    // Build the descriptor index once for all frames
+    buildMarkerIndex();
+
     // Scaling factor for the 3D point.
     // Width of image is A4 size in image, 297mm is the real A4 height
     float pixelPerMM = (float)_marker.imageGray.cols / 297.0f;
@@ -199,6 +213,58 @@ void CVTrackedFeatures::type(CVDetectDescribeType ddType)
     _frameCount = 0;
 }
 //-----------------------------------------------------------------------------
+//! Setter of the matcher type that rebuilds the marker index if needed
+void CVTrackedFeatures::matcherType(CVFeatureMatcherType mType)
+{
+    _matcherType = mType;
+
+    if (!_marker.descriptors.empty())
+        buildMarkerIndex();
+}
+//-----------------------------------------------------------------------------
+/*! Creates the brute force matcher with the distance fitting the descriptor
+type and builds the search index over the marker descriptors for the LSH or
+hierarchical matcher type. LSH is only defined for binary descriptors, so for
+float descriptors (SURF, SIFT) a randomized kd-tree index is built instead.
+The index references the marker descriptors and must be rebuilt whenever
+they change.
+*/
+void CVTrackedFeatures::buildMarkerIndex()
+{
+    _markerIndex.release();
+
+    bool isBinary = _marker.descriptors.depth() == CV_8U;
+    _matcher      = cv::BFMatcher::create(isBinary ? cv::NORM_HAMMING : cv::NORM_L2, false);
+
+    if (_matcherType == FMT_BRUTE_FORCE || _marker.descriptors.rows < 2)
+        return;
+
+    float startMS = _timer.elapsedTimeInMilliSec();
+
+    if (!isBinary)
+        _markerIndex = cv::makePtr<cv::flann::Index>(_marker.descriptors,
+                                                     cv::flann::KDTreeIndexParams(4),
+                                                     cvflann::FLANN_DIST_L2);
+    else if (_matcherType == FMT_LSH)
+        _markerIndex = cv::makePtr<cv::flann::Index>(_marker.descriptors,
+                                                     cv::flann::LshIndexParams(6,  // no. of hash tables
+                                                                               12, // key size in bits
+                                                                               2), // multi-probe level
+                                                     cvflann::FLANN_DIST_HAMMING);
+    else
+        _markerIndex = cv::makePtr<cv::flann::Index>(_marker.descriptors,
+                                                     cv::flann::HierarchicalClusteringIndexParams(32, // branching
+                                                                                                  cvflann::FLANN_CENTERS_RANDOM,
+                                                                                                  4,    // no. of trees
+                                                                                                  100), // leaf size
+                                                     cvflann::FLANN_DIST_HAMMING);
+
+    Utils::log("SLProject",
+               "CVTrackedFeatures: Marker index over %d descriptors built in %.1f ms",
+               _marker.descriptors.rows,
+               _timer.elapsedTimeInMilliSec() - startMS);
+}
+//-----------------------------------------------------------------------------
 /*! The main part of this tracker is to calculate a correct Pose.
 @param imageGray Current grayscale frame
 @param image Current RGB frame
@@ -264,7 +330,16 @@ void CVTrackedFeatures::relocate()
 {
     _isTracking = false;
     detectKeypointsAndDescriptors();
-    _currentFrame.matches   = getFeatureMatches();
+
+    // With a previous pose we only match around the reprojected marker features
+    _currentFrame.matches.clear();
+    if (_projectionMatching && _prevFrame.foundPose)
+        _currentFrame.matches = getFeatureMatchesByProjection();
+
+    // Fall back to the global matching if the marker moved too much
+    if (_currentFrame.matches.size() < (size_t)minProjectionMatches)
+        _currentFrame.matches = getFeatureMatches();
+
     _currentFrame.foundPose = calculatePose();
 
     // Zero time keeping on the tracking branch
@@ -485,16 +560,46 @@ void CVTrackedFeatures::detectKeypointsAndDescriptors()
 //-----------------------------------------------------------------------------
 /*! Get matching features with the defined feature matcher. Since we are using
 the k-next-neighbour matcher, we check if the best and second best match are
-not too identical with the so called ratio test.
+not too identical with the so called ratio test. If a marker index was built
+the neighbours are searched in the index instead of comparing all descriptors.
 @return Vector of found matches
 */
 CVVDMatch CVTrackedFeatures::getFeatureMatches()
 {
     float startMS = _timer.elapsedTimeInMilliSec();
 
+    if (_currentFrame.descriptors.empty())
+        return CVVDMatch();
+
     int        k = 2;
     CVVVDMatch matches;
-    _matcher->knnMatch(_currentFrame.descriptors, _marker.descriptors, matches, k);
+
+    if (_markerIndex)
+    {
+        CVMat indices, dists;
+        _markerIndex->knnSearch(_currentFrame.descriptors,
+                                indices,
+                                dists,
+                                k,
+                                cv::flann::SearchParams(64));
+
+        // Hamming distances are returned as int, L2 distances squared as float
+        matches.resize((size_t)indices.rows);
+        for (int q = 0; q < indices.rows; ++q)
+        {
+            for (int j = 0; j < k; ++j)
+            {
+                int trainIdx = indices.at<int>(q, j);
+                if (trainIdx < 0) continue;
+                float dist = dists.depth() == CV_32S
+                               ? (float)dists.at<int>(q, j)
+                               : sqrt(dists.at<float>(q, j));
+                matches[(size_t)q].push_back(cv::DMatch(q, trainIdx, dist));
+            }
+        }
+    }
+    else
+        _matcher->knnMatch(_currentFrame.descriptors, _marker.descriptors, matches, k);
 
     // Perform ratio test which determines if k matches from the knn matcher
     // are not too similar. If the ratio of the the distance of the two
@@ -502,6 +607,7 @@ CVVDMatch CVTrackedFeatures::getFeatureMatches()
     CVVDMatch goodMatches;
     for (auto& match : matches)
     {
+        if (match.size() < 2) continue;
         const cv::DMatch& match1 = match[0];
         const cv::DMatch& match2 = match[1];
         if (match2.distance == 0.0f ||
@@ -513,6 +619,137 @@ CVVDMatch CVTrackedFeatures::getFeatureMatches()
     return goodMatches;
 }
 //-----------------------------------------------------------------------------
+/*! Frame-to-frame matching guided by the previous pose: The marker features
+are reprojected with the previous pose into a grid with the search radius as
+cell size. Every frame keypoint is then only compared with the reprojected
+marker features within the search radius. The same ratio test as in
+getFeatureMatches is applied and every marker feature keeps only its best
+frame keypoint.
+@return Vector of found matches
+*/
+CVVDMatch CVTrackedFeatures::getFeatureMatchesByProjection()
+{
+    float startMS = _timer.elapsedTimeInMilliSec();
+
+    CVVDMatch matches;
+    if (_currentFrame.keypoints.empty() ||
+        _currentFrame.descriptors.empty() ||
+        _marker.keypoints3D.empty())
+        return matches;
+
+    // 1. Reproject the marker features with the previous pose
+    CVVPoint2f projectedPoints;
+    cv::projectPoints(_marker.keypoints3D,
+                      _prevFrame.rvec,
+                      _prevFrame.tvec,
+                      _calib->cameraMat(),
+                      _calib->distortion(),
+                      projectedPoints);
+
+    // 2. Sort the reprojected marker features within the image into the grid
+    float       cellSize = projectionSearchRadius;
+    int         gridCols = (int)((float)_currentFrame.imageGray.cols / cellSize) + 1;
+    int         gridRows = (int)((float)_currentFrame.imageGray.rows / cellSize) + 1;
+    vector<int> gridCellStart((size_t)(gridCols * gridRows + 1), 0);
+    vector<int> cellOfPoint(projectedPoints.size(), -1);
+
+    for (size_t i = 0; i < projectedPoints.size(); ++i)
+    {
+        const CVPoint2f& p = projectedPoints[i];
+        if (p.x < 0 || p.y < 0 ||
+            p.x >= (float)_currentFrame.imageGray.cols ||
+            p.y >= (float)_currentFrame.imageGray.rows)
+            continue;
+        cellOfPoint[i] = (int)(p.y / cellSize) * gridCols + (int)(p.x / cellSize);
+        gridCellStart[(size_t)cellOfPoint[i] + 1]++;
+    }
+
+    // Counting sort of the point indices by cell
+    for (size_t c = 1; c < gridCellStart.size(); ++c)
+        gridCellStart[c] += gridCellStart[c - 1];
+    vector<int> gridPoints((size_t)gridCellStart.back());
+    vector<int> cellFill(gridCellStart.begin(), gridCellStart.end() - 1);
+    for (size_t i = 0; i < projectedPoints.size(); ++i)
+        if (cellOfPoint[i] >= 0)
+            gridPoints[(size_t)cellFill[(size_t)cellOfPoint[i]]++] = (int)i;
+
+    // 3. Compare every frame keypoint with the nearby marker features
+    bool  isBinary  = _currentFrame.descriptors.depth() == CV_8U;
+    int   descLen   = _currentFrame.descriptors.cols;
+    float radiusSqr = projectionSearchRadius * projectionSearchRadius;
+
+    auto descriptorDistance = [&](int q, int t) -> float
+    {
+        if (isBinary)
+            return (float)cv::hal::normHamming(_currentFrame.descriptors.ptr<uchar>(q),
+                                               _marker.descriptors.ptr<uchar>(t),
+                                               descLen);
+        return sqrt(cv::hal::normL2Sqr_(_currentFrame.descriptors.ptr<float>(q),
+                                        _marker.descriptors.ptr<float>(t),
+                                        descLen));
+    };
+
+    vector<int> bestMatchOfMarker(_marker.keypoints3D.size(), -1);
+
+    for (int q = 0; q < (int)_currentFrame.keypoints.size(); ++q)
+    {
+        const CVPoint2f& kp    = _currentFrame.keypoints[(size_t)q].pt;
+        int              cellX = (int)(kp.x / cellSize);
+        int              cellY = (int)(kp.y / cellSize);
+        float            dist1 = FLT_MAX, dist2 = FLT_MAX;
+        int              best  = -1;
+
+        for (int y = std::max(0, cellY - 1); y <= std::min(gridRows - 1, cellY + 1); ++y)
+        {
+            for (int x = std::max(0, cellX - 1); x <= std::min(gridCols - 1, cellX + 1); ++x)
+            {
+                int cell = y * gridCols + x;
+                for (int i = gridCellStart[(size_t)cell]; i < gridCellStart[(size_t)cell + 1]; ++i)
+                {
+                    int       t = gridPoints[(size_t)i];
+                    CVPoint2f d = projectedPoints[(size_t)t] - kp;
+                    if (d.x * d.x + d.y * d.y > radiusSqr) continue;
+
+                    float dist = descriptorDistance(q, t);
+                    if (dist < dist1)
+                    {
+                        dist2 = dist1;
+                        dist1 = dist;
+                        best  = t;
+                    }
+                    else if (dist < dist2)
+                        dist2 = dist;
+                }
+            }
+        }
+
+        if (best < 0) continue;
+
+        // Ratio test as in getFeatureMatches
+        if (dist2 < FLT_MAX && dist2 > 0.0f && dist1 / dist2 >= minRatio)
+            continue;
+
+        // Keep only the best frame keypoint per marker feature
+        int& prev = bestMatchOfMarker[(size_t)best];
+        if (prev >= 0)
+        {
+            if (matches[(size_t)prev].distance <= dist1) continue;
+            matches[(size_t)prev].queryIdx = -1;
+        }
+        prev = (int)matches.size();
+        matches.push_back(cv::DMatch(q, best, dist1));
+    }
+
+    matches.erase(std::remove_if(matches.begin(),
+                                 matches.end(),
+                                 [](const cv::DMatch& m)
+                                 { return m.queryIdx < 0; }),
+                  matches.end());
+
+    CVTracked::matchTimesMS.set(_timer.elapsedTimeInMilliSec() - startMS);
+    return matches;
+}
+//-----------------------------------------------------------------------------
 /*! This method does the most important work of the whole pipeline:
 
 RANSAC: We execute first RANSAC to eliminate wrong feature correspondences
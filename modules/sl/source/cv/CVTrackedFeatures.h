@@ -22,6 +22,7 @@ for a good top down information.
 #include <cv/CVFeatureManager.h>
 #include <cv/CVRaulMurOrb.h>
 #include <cv/CVTracked.h>
+#include <opencv2/flann.hpp>
 
 #define SL_SPLIT_DETECT_COMPUTE 0
 #define SL_DO_FEATURE_BENCHMARKING 0
@@ -49,11 +50,23 @@ const int    iterations         = 500;
 const float  reprojection_error = 2.0f;
 const double confidence         = 0.95;
 
+// Projection guided matching parameters
+const float projectionSearchRadius = 20.0f; // search radius in pixels around reprojected marker features
+const int   minProjectionMatches   = 30;    // below this we fall back to the global matching
+
 // Repose patch size
 const int reposeFrequency  = 10;
 const int initialPatchSize = 2;
 const int maxPatchSize     = 60;
 
+//-----------------------------------------------------------------------------
+//! Descriptor matching strategies for the global matching in CVTrackedFeatures
+enum CVFeatureMatcherType
+{
+    FMT_BRUTE_FORCE,  //!< Brute force knn matching against all marker descriptors
+    FMT_LSH,          //!< Multi-probe LSH index over the marker descriptors
+    FMT_HIERARCHICAL, //!< Hierarchical clustering index over the marker descriptors
+};
 //-----------------------------------------------------------------------------
 //! CVTrackedFeatures is the main part of the AR Christoffelturm scene
 /*! The implementation tries to find a valid pose based on feature points in
@@ -62,6 +75,14 @@ frame with against a reference. There are two important parts of this procedure:
 The relocalisation, which will be called if we have to find the pose with no hint
 where the camera could be. The other one is called feature tracking: If a pose
 was found, the implementation tries to track them and update the pose respectively.
+
+The global matching of the frame descriptors against the marker descriptors
+can use an index (multi-probe LSH or hierarchical clustering) that is built
+once in initFeaturesOnMarker instead of the brute force matcher. With the
+projection guided matching the marker features are reprojected with the
+previous pose and every frame keypoint is only compared with the marker
+features nearby. This keeps the matching cost independent of the number of
+marker features as long as the marker is tracked.
 */
 class CVTrackedFeatures : public CVTracked
 {
@@ -74,10 +95,14 @@ public:
     // Getters
     bool                 forceRelocation() { return _forceRelocation; }
     CVDetectDescribeType type() { return _featureManager.type(); }
+    CVFeatureMatcherType matcherType() { return _matcherType; }
+    bool                 projectionMatching() { return _projectionMatching; }
 
     // Setters
     void forceRelocation(bool fR) { _forceRelocation = fR; }
     void type(CVDetectDescribeType ddType);
+    void matcherType(CVFeatureMatcherType mType);
+    void projectionMatching(bool pM) { _projectionMatching = pM; }
 
 private:
     void      loadMarker(string markerFilename);
@@ -87,12 +112,15 @@ private:
     void      drawDebugInformation(bool drawDetection);
     void      transferFrameData();
     void      detectKeypointsAndDescriptors();
+    void      buildMarkerIndex();
     CVVDMatch getFeatureMatches();
+    CVVDMatch getFeatureMatchesByProjection();
     bool      calculatePose();
     void      optimizeMatches();
     bool      trackWithOptFlow(CVMat rvec, CVMat tvec);
 
-    cv::Ptr<cv::DescriptorMatcher> _matcher;    //!< Descriptor matching algorithm
+    cv::Ptr<cv::DescriptorMatcher> _matcher;     //!< Brute force descriptor matching algorithm
+    cv::Ptr<cv::flann::Index>      _markerIndex; //!< Search index over the marker descriptors
     CVCalibration*                 _calib;      //!< Current calibration in use
     int                            _frameCount; //!< NO. of frames since process start
     bool                           _isTracking; //!< True if tracking
@@ -125,11 +153,13 @@ private:
         bool        useExtrinsicGuess; //!< flag if extrinsic gues should be used
     };
 
-    SLFeatureMarker2D _marker;          //!< 2D marker data
-    SLFrameData       _currentFrame;    //!< The current video frame data
-    SLFrameData       _prevFrame;       //!< The previous video frame data
-    bool              _forceRelocation; //!< Force relocation every frame (no opt. flow tracking)
-    CVFeatureManager  _featureManager;  //!< Feature detector-descriptor wrapper instance
+    SLFeatureMarker2D    _marker;             //!< 2D marker data
+    SLFrameData          _currentFrame;       //!< The current video frame data
+    SLFrameData          _prevFrame;          //!< The previous video frame data
+    bool                 _forceRelocation;    //!< Force relocation every frame (no opt. flow tracking)
+    CVFeatureManager     _featureManager;     //!< Feature detector-descriptor wrapper instance
+    CVFeatureMatcherType _matcherType;        //!< Matcher used for the global matching
+    bool                 _projectionMatching; //!< Flag if matching is guided by the previous pose
 };
 //-----------------------------------------------------------------------------
 #endif // CVTrackedFeatures_H
@@ -63,16 +63,10 @@ enum SLGLAttributeType
     AT_jointIndex,   //!< Vertex joint id for vertex skinning
     AT_jointWeight,  //!< Vertex joint weight for vertex skinning
 
-    AT_custom0, //!< Custom vertex attribute 0
-    AT_custom1, //!< Custom vertex attribute 1
-    AT_custom2, //!< Custom vertex attribute 2
-    AT_custom3, //!< Custom vertex attribute 3
-    AT_custom4, //!< Custom vertex attribute 4
-    AT_custom5, //!< Custom vertex attribute 5
-    AT_custom6, //!< Custom vertex attribute 6
-    AT_custom7, //!< Custom vertex attribute 7
-    AT_custom8, //!< Custom vertex attribute 8
-    AT_custom9,  //!< Custom vertex attribute 9
+    AT_custom0 = 8, //!< Custom vertex attribute 0 at location 8
+    AT_custom1,     //!< Custom vertex attribute 1 at location 9
+    AT_custom2,     //!< Custom vertex attribute 2 at location 10
+    AT_custom3,     //!< Custom vertex attribute 3 at location 11
 
     AT_velocity = 1,        //!< Vertex velocity 3 component vectors
     AT_startTime = 2,       //!< Vertex start time float
@@ -80,7 +74,17 @@ enum SLGLAttributeType
     AT_rotation = 4,       //!< Vertex rotation float
     AT_angularVelo = 5, //!< Vertex angulare velocity for rotation float
     AT_texNum = 6,         //!< Vertex texture number int
-    AT_initialPosition = 7  //!< Vertex initial position 3 component vectors
+    AT_initialPosition = 7,  //!< Vertex initial position 3 component vectors
+
+    AT_timeWarpFactor = 1, //!< Oculus distortion mesh time warp factor float
+    AT_vignetteFactor = 2, //!< Oculus distortion mesh vignette factor float
+    AT_texCoordR      = 3, //!< Oculus distortion mesh red tex. coords. 2 component vector
+    AT_texCoordG      = 4, //!< Oculus distortion mesh green tex. coords. 2 component vector
+    AT_texCoordB      = 5, //!< Oculus distortion mesh blue tex. coords. 2 component vector
+
+    // GL ES 3.0 only guarantees 16 locations (GL_MAX_VERTEX_ATTRIBS), so the
+    // instance matrix takes the last 4 of them after the custom attributes
+    AT_instanceMatrix = 12 //!< Instance model matrix as 4 column vectors at the locations 12-15
 };
 //-----------------------------------------------------------------------------
 //! Enumeration for buffer usage types also supported by OpenGL ES
@@ -1189,11 +1189,11 @@ void createSLDistortionMesh(SLGLProgram* stereoOculusDistProgram, SLEyeType eye,
 
     // set attributes with all the same data pointer to the interleaved array
     vao.setAttrib(AT_position, 2, AT_position, &verts[0]);
-    vao.setAttrib(AT_custom1, 1, 1, &verts[0]);
-    vao.setAttrib(AT_custom2, 1, 2, &verts[0]);
-    vao.setAttrib(AT_custom3, 2, 3, &verts[0]);
-    vao.setAttrib(AT_custom4, 2, 4, &verts[0]);
-    vao.setAttrib(AT_custom5, 2, 5, &verts[0]);
+    vao.setAttrib(AT_timeWarpFactor, 1, AT_timeWarpFactor, &verts[0]);
+    vao.setAttrib(AT_vignetteFactor, 1, AT_vignetteFactor, &verts[0]);
+    vao.setAttrib(AT_texCoordR, 2, AT_texCoordR, &verts[0]);
+    vao.setAttrib(AT_texCoordG, 2, AT_texCoordG, &verts[0]);
+    vao.setAttrib(AT_texCoordB, 2, AT_texCoordB, &verts[0]);
     vao.setIndices(indexCount, BT_uint, &tempIndex[0]);
     vao.generate(vertexCount);
 
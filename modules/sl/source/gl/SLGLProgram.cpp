@@ -12,15 +12,39 @@
 #include <SLAssetManager.h>
 #include <SLGLDepthBuffer.h>
 #include <SLGLProgram.h>
+#include <SLGLProgramBinaryCache.h>
 #include <SLGLShader.h>
 #include <SLGLState.h>
 #include <SLScene.h>
 #include <SLSkybox.h>
+#include <cstring>
 
 //-----------------------------------------------------------------------------
 // Error Strings defined in SLGLShader.h
 extern char* aGLSLErrorString[];
 //-----------------------------------------------------------------------------
+SLuint    SLGLProgram::totalGLCalls           = 0;
+SLuint    SLGLProgram::_frameUBO              = 0;
+SLbool    SLGLProgram::_frameUniformsAreValid = false;
+SLCamera* SLGLProgram::_frameUniformsCam      = nullptr;
+SLVLight* SLGLProgram::_frameUniformsLights   = nullptr;
+SLMat4f   SLGLProgram::_frameUniformsVM;
+//-----------------------------------------------------------------------------
+static_assert(sizeof(SLGLFrameUniforms) % 16 == 0,
+              "SLGLFrameUniforms must be a multiple of 16 bytes for std140");
+//-----------------------------------------------------------------------------
+//! 64-bit FNV-1a hash of a uniform name for the location cache
+static inline SLuint64 hashUniformName(const SLchar* name)
+{
+    SLuint64 hash = 14695981039346656037ULL;
+    for (; *name; ++name)
+    {
+        hash ^= (SLuint64)(unsigned char)*name;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+//-----------------------------------------------------------------------------
 //! Ctor with a vertex and a fragment shader filename.
 /*!
  Constructor for shader programs. Shader programs can be used in multiple
@@ -44,8 +68,11 @@ SLGLProgram::SLGLProgram(SLAssetManager* am,
                          const string&   geomShaderFile,
                          const string&   programName) : SLObject(programName)
 {
-    _isLinked = false;
-    _progID   = 0;
+    _isLinked        = false;
+    _progID          = 0;
+    _frameBlockIndex = GL_INVALID_INDEX;
+    _useBinaryCache  = false;
+    _usesInstancing  = false;
 
     // optional load vertex and/or fragment shaders
     addShader(new SLGLShader(vertShaderFile, ST_vertex));
@@ -70,7 +97,7 @@ SLGLProgram::~SLGLProgram()
     // SL_LOG("~SLGLProgram");
     for (auto shader : _shaders)
     {
-        if (_isLinked)
+        if (_isLinked && shader->_shaderID)
         {
             glDetachShader(_progID, shader->_shaderID);
             GET_GL_ERROR;
@@ -101,8 +128,11 @@ void SLGLProgram::deleteDataGpu()
     {
         for (auto shader : _shaders)
         {
-            glDetachShader(_progID, shader->_shaderID);
-            GET_GL_ERROR;
+            if (shader->_shaderID)
+            {
+                glDetachShader(_progID, shader->_shaderID);
+                GET_GL_ERROR;
+            }
         }
         _isLinked = false;
     }
@@ -112,6 +142,10 @@ void SLGLProgram::deleteDataGpu()
         glDeleteProgram(_progID);
         GET_GL_ERROR;
     }
+
+    _uniformLocations.clear();
+    _frameBlockIndex = GL_INVALID_INDEX;
+    _usesInstancing  = false;
 }
 //-----------------------------------------------------------------------------
 //! SLGLProgram::addShader adds a shader to the shader list
@@ -136,7 +170,7 @@ void SLGLProgram::initTF(const char* writeBackAttrib[], int size)
     {
         for (auto* shader : _shaders)
         {
-            if (_isLinked)
+            if (shader->_shaderID)
             {
                 glDetachShader(_progID, shader->_shaderID);
                 GET_GL_ERROR;
@@ -145,6 +179,18 @@ void SLGLProgram::initTF(const char* writeBackAttrib[], int size)
         _isLinked = false;
     }
 
+    // Generated programs are first created from the binary of a former run
+    string varyings;
+    for (int i = 0; i < size; ++i)
+        varyings += string(writeBackAttrib[i]) + ";";
+    SLuint64 binaryKey = binaryCacheKey(varyings);
+    if (binaryKey && SLGLProgramBinaryCache::load(_progID, binaryKey))
+    {
+        _isLinked = true;
+        initUniforms();
+        return;
+    }
+
     // compile all shader objects
     SLbool allSuccuessfullyCompiled = true;
     for (auto* shader : _shaders)
@@ -188,6 +234,8 @@ void SLGLProgram::initTF(const char* writeBackAttrib[], int size)
     }
 
     int linked = 0;
+    if (binaryKey)
+        glProgramParameteri(_progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glTransformFeedbackVaryings(_progID,
                                 size,
                                 writeBackAttrib,
@@ -200,6 +248,10 @@ void SLGLProgram::initTF(const char* writeBackAttrib[], int size)
     if (linked)
     {
         _isLinked = true;
+        initUniforms();
+
+        if (binaryKey)
+            SLGLProgramBinaryCache::save(_progID, binaryKey);
 
         // if name is empty concatenate shader names
         if (_name.empty())
@@ -235,7 +287,7 @@ void SLGLProgram::init(SLVLight* lights)
     {
         for (auto* shader : _shaders)
         {
-            if (_isLinked)
+            if (shader->_shaderID)
             {
                 glDetachShader(_progID, shader->_shaderID);
                 GET_GL_ERROR;
@@ -244,6 +296,15 @@ void SLGLProgram::init(SLVLight* lights)
         _isLinked = false;
     }
 
+    // Generated programs are first created from the binary of a former run
+    SLuint64 binaryKey = binaryCacheKey(lights ? std::to_string(lights->size()) : "");
+    if (binaryKey && SLGLProgramBinaryCache::load(_progID, binaryKey))
+    {
+        _isLinked = true;
+        initUniforms();
+        return;
+    }
+
     // compile all shader objects
     SLbool allSuccuessfullyCompiled = true;
     for (auto* shader : _shaders)
@@ -287,6 +348,8 @@ void SLGLProgram::init(SLVLight* lights)
     }
 
     int linked = 0;
+    if (binaryKey)
+        glProgramParameteri(_progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(_progID);
     GET_GL_ERROR;
     glGetProgramiv(_progID, GL_LINK_STATUS, &linked);
@@ -295,6 +358,10 @@ void SLGLProgram::init(SLVLight* lights)
     if (linked)
     {
         _isLinked = true;
+        initUniforms();
+
+        if (binaryKey)
+            SLGLProgramBinaryCache::save(_progID, binaryKey);
 
         // if name is empty concatenate shader names
         if (_name.empty())
@@ -314,6 +381,94 @@ void SLGLProgram::init(SLVLight* lights)
     }
 }
 //-----------------------------------------------------------------------------
+/*! SLGLProgram::binaryCacheKey returns the key of the program in the binary
+cache (SLGLProgramBinaryCache) or 0 if the program doesn't use the cache. The
+key is a hash of the source code of all shaders and the extra string for
+additional inputs such as the number of lights or the transform feedback
+varyings. Only programs with their complete source code in memory like the
+generated programs use the cache. Programs from files could include other
+files that may change without changing the key.
+*/
+SLuint64 SLGLProgram::binaryCacheKey(const string& extra) const
+{
+    if (!_useBinaryCache || !SLGLProgramBinaryCache::isSupported())
+        return 0;
+
+    SLuint64 key = SLGLProgramBinaryCache::hash(extra);
+    for (auto* shader : _shaders)
+    {
+        key = SLGLProgramBinaryCache::hash(std::to_string(shader->type()), key);
+        key = SLGLProgramBinaryCache::hash(shader->code(), key);
+    }
+    return key ? key : 1;
+}
+//-----------------------------------------------------------------------------
+/*! SLGLProgram::initUniforms is called after a successful link. It stores the
+locations of all active uniforms in the hash map _uniformLocations, so that the
+uniform functions by name don't need a glGetUniformLocation per call. If the
+program declares the uniform block u_frame it gets bound to the shared uniform
+buffer with the per frame light and camera data. Programs with the attribute
+a_instanceMatrix can be drawn with SLGLVertexArray::drawElementsInstanced.
+*/
+void SLGLProgram::initUniforms()
+{
+    _uniformLocations.clear();
+
+    SLint numUniforms = 0, maxNameLength = 0;
+    glGetProgramiv(_progID, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(_progID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    GET_GL_ERROR;
+
+    vector<SLchar> name((SLuint)std::max(maxNameLength, 1));
+    for (SLint i = 0; i < numUniforms; ++i)
+    {
+        GLsizei length = 0;
+        GLint   size   = 0;
+        GLenum  type   = 0;
+        glGetActiveUniform(_progID,
+                           (GLuint)i,
+                           (GLsizei)name.size(),
+                           &length,
+                           &size,
+                           &type,
+                           name.data());
+        string uniformName(name.data(), (size_t)length);
+
+        // Members of uniform blocks have no location
+        SLint loc = glGetUniformLocation(_progID, uniformName.c_str());
+        if (loc < 0) continue;
+
+        _uniformLocations[hashUniformName(uniformName.c_str())] = {uniformName, loc};
+
+        // Arrays are reported as "name[0]" but are set by "name"
+        if (Utils::endsWithString(uniformName, "[0]"))
+        {
+            string arrayName = uniformName.substr(0, uniformName.size() - 3);
+            _uniformLocations[hashUniformName(arrayName.c_str())] = {arrayName, loc};
+        }
+    }
+    GET_GL_ERROR;
+
+    _frameBlockIndex = glGetUniformBlockIndex(_progID, "u_frame");
+    if (_frameBlockIndex != GL_INVALID_INDEX)
+    {
+        glUniformBlockBinding(_progID, _frameBlockIndex, SL_FRAME_UBO_BINDING);
+
+#if defined(DEBUG) || defined(_DEBUG)
+        SLint blockSize = 0;
+        glGetActiveUniformBlockiv(_progID,
+                                  _frameBlockIndex,
+                                  GL_UNIFORM_BLOCK_DATA_SIZE,
+                                  &blockSize);
+        if (blockSize > (SLint)sizeof(SLGLFrameUniforms))
+            SL_WARN_MSG("SLGLProgram::initUniforms: u_frame is larger than SLGLFrameUniforms!");
+#endif
+    }
+
+    _usesInstancing = glGetAttribLocation(_progID, "a_instanceMatrix") == AT_instanceMatrix;
+    GET_GL_ERROR;
+}
+//-----------------------------------------------------------------------------
 /*! SLGLProgram::useProgram inits the first time the program and then uses it.
 Call this initialization if you pass your own custom uniform variables.
 */
@@ -332,6 +487,8 @@ void SLGLProgram::useProgram()
 /*! SLGLProgram::beginUse starts using the shader program and transfers the
 the camera,  lights and material parameter as uniform variables. It also passes
 the custom uniform variables of the _uniform1fList as well as the texture names.
+Programs with the uniform block u_frame get the light and camera data from the
+shared uniform buffer that is updated at most once per frame and view.
 */
 void SLGLProgram::beginUse(SLCamera*   cam,
                            SLMaterial* mat,
@@ -346,6 +503,9 @@ void SLGLProgram::beginUse(SLCamera*   cam,
 
         stateGL->useProgram(_progID);
 
+        if (usesFrameUniforms())
+            updateFrameUniforms(cam, lights);
+
         SLint nextTexUnit = 0;
         if (lights)
             nextTexUnit = passLightsToUniforms(lights, nextTexUnit);
@@ -353,7 +513,7 @@ void SLGLProgram::beginUse(SLCamera*   cam,
         if (mat)
             mat->passToUniforms(this, nextTexUnit);
 
-        if (cam)
+        if (cam && !usesFrameUniforms())
             cam->passToUniforms(this);
 
         for (auto* uf : _uniforms1f)
@@ -371,9 +531,12 @@ SLint SLGLProgram::passLightsToUniforms(SLVLight* lights,
 {
     SLGLState* stateGL = SLGLState::instance();
 
-    // Pass global lighting value
-    uniform1f("u_oneOverGamma", SLLight::oneOverGamma());
-    uniform4fv("u_globalAmbi", 1, (const SLfloat*)&SLLight::globalAmbient);
+    // Pass global lighting value if they are not in the uniform block u_frame
+    if (!usesFrameUniforms())
+    {
+        uniform1f("u_oneOverGamma", SLLight::oneOverGamma());
+        uniform4fv("u_globalAmbi", 1, (const SLfloat*)&SLLight::globalAmbient);
+    }
 
     if (!lights->empty())
     {
@@ -480,18 +643,21 @@ SLint SLGLProgram::passLightsToUniforms(SLVLight* lights,
         // Pass vectors as uniform vectors
         auto  nL = (SLint)lights->size();
         SLint loc;
-        loc = uniform1iv("u_lightIsOn", nL, (SLint*)&lightIsOn);
-        loc = uniform4fv("u_lightPosWS", nL, (SLfloat*)&lightPosWS);
-        loc = uniform4fv("u_lightPosVS", nL, (SLfloat*)&lightPosVS);
-        loc = uniform4fv("u_lightAmbi", nL, (SLfloat*)&lightAmbient);
-        loc = uniform4fv("u_lightDiff", nL, (SLfloat*)&lightDiffuse);
-        loc = uniform4fv("u_lightSpec", nL, (SLfloat*)&lightSpecular);
-        loc = uniform3fv("u_lightSpotDir", nL, (SLfloat*)&lightSpotDirVS);
-        loc = uniform1fv("u_lightSpotDeg", nL, (SLfloat*)&lightSpotCutoff);
-        loc = uniform1fv("u_lightSpotCos", nL, (SLfloat*)&lightSpotCosCut);
-        loc = uniform1fv("u_lightSpotExp", nL, (SLfloat*)&lightSpotExp);
-        loc = uniform3fv("u_lightAtt", nL, (SLfloat*)&lightAtt);
-        loc = uniform1iv("u_lightDoAtt", nL, (SLint*)&lightDoAtt);
+        if (!usesFrameUniforms())
+        {
+            loc = uniform1iv("u_lightIsOn", nL, (SLint*)&lightIsOn);
+            loc = uniform4fv("u_lightPosWS", nL, (SLfloat*)&lightPosWS);
+            loc = uniform4fv("u_lightPosVS", nL, (SLfloat*)&lightPosVS);
+            loc = uniform4fv("u_lightAmbi", nL, (SLfloat*)&lightAmbient);
+            loc = uniform4fv("u_lightDiff", nL, (SLfloat*)&lightDiffuse);
+            loc = uniform4fv("u_lightSpec", nL, (SLfloat*)&lightSpecular);
+            loc = uniform3fv("u_lightSpotDir", nL, (SLfloat*)&lightSpotDirVS);
+            loc = uniform1fv("u_lightSpotDeg", nL, (SLfloat*)&lightSpotCutoff);
+            loc = uniform1fv("u_lightSpotCos", nL, (SLfloat*)&lightSpotCosCut);
+            loc = uniform1fv("u_lightSpotExp", nL, (SLfloat*)&lightSpotExp);
+            loc = uniform3fv("u_lightAtt", nL, (SLfloat*)&lightAtt);
+            loc = uniform1iv("u_lightDoAtt", nL, (SLint*)&lightDoAtt);
+        }
         loc = uniform1iv("u_lightCreatesShadows", nL, (SLint*)&lightCreatesShadows);
         loc = uniform1iv("u_lightDoSmoothShadows", nL, (SLint*)&lightDoSmoothShadows);
         loc = uniform1iv("u_lightSmoothShadowLevel", nL, (SLint*)&lightSmoothShadowLevel);
@@ -519,6 +685,7 @@ SLint SLGLProgram::passLightsToUniforms(SLVLight* lights,
                         {
                             lightShadowMap[i * 6 + j]->bindActive(nextTexUnit);
                             glUniform1i(loc, nextTexUnit);
+                            totalGLCalls++;
                             nextTexUnit++;
                         }
                     }
@@ -544,6 +711,7 @@ SLint SLGLProgram::passLightsToUniforms(SLVLight* lights,
                     {
                         lightShadowMap[i * 6]->bindActive(nextTexUnit);
                         glUniform1i(loc, nextTexUnit);
+                        totalGLCalls++;
                         nextTexUnit++;
                     }
                 }
@@ -555,6 +723,95 @@ SLint SLGLProgram::passLightsToUniforms(SLVLight* lights,
     return nextTexUnit;
 }
 //-----------------------------------------------------------------------------
+/*! SLGLProgram::updateFrameUniforms uploads the light and camera data into the
+uniform buffer that is shared by all programs with the uniform block u_frame.
+The upload is skipped if the data is still valid for the same camera, lights
+and view matrix. invalidateFrameUniforms is called once per frame in
+SLSceneView::draw3D so that changed light or camera parameters get uploaded.
+*/
+void SLGLProgram::updateFrameUniforms(SLCamera* cam, SLVLight* lights)
+{
+    SLGLState* stateGL = SLGLState::instance();
+
+    if (_frameUniformsAreValid &&
+        _frameUniformsCam == cam &&
+        _frameUniformsLights == lights &&
+        memcmp(&_frameUniformsVM, &stateGL->viewMatrix, sizeof(SLMat4f)) == 0)
+        return;
+
+    SLMat4f viewRotMat(stateGL->viewMatrix);
+    viewRotMat.translation(0, 0, 0); // delete translation part, only rotation needed
+
+    SLGLFrameUniforms u = {};
+
+    // Init to defaults
+    for (SLint i = 0; i < SL_MAX_LIGHTS; ++i)
+    {
+        u.lightPosVS[i].set(0, 0, 1, 1);
+        u.lightSpotDir[i].set(0, 0, -1, 0);
+        u.lightAtt[i].set(1, 0, 0, 0);
+        u.lightSpotDeg[i].x = 180.0f;
+        u.lightSpotCos[i].x = -1.0f;
+        u.lightSpotExp[i].x = 1.0f;
+    }
+
+    if (lights)
+    {
+        SLuint numLights = std::min((SLuint)lights->size(), (SLuint)SL_MAX_LIGHTS);
+        for (SLuint i = 0; i < numLights; ++i)
+        {
+            SLLight* light = lights->at(i);
+            SLVec3f  dirVS = viewRotMat.multVec(light->spotDirWS());
+
+            u.lightIsOn[i].x = light->isOn();
+            u.lightPosVS[i]  = stateGL->viewMatrix * light->positionWS();
+            u.lightAmbi[i].set(light->ambient());
+            u.lightDiff[i].set(light->diffuse());
+            u.lightSpec[i].set(light->specular());
+            u.lightSpotDir[i].set(dirVS.x, dirVS.y, dirVS.z, 0.0f);
+            u.lightAtt[i].set(light->kc(), light->kl(), light->kq(), 0.0f);
+            u.lightSpotDeg[i].x = light->spotCutOffDEG();
+            u.lightSpotCos[i].x = light->spotCosCut();
+            u.lightSpotExp[i].x = light->spotExponent();
+            u.lightDoAtt[i].x   = light->isAttenuated();
+        }
+    }
+
+    u.globalAmbi   = SLLight::globalAmbient;
+    u.oneOverGamma = SLLight::oneOverGamma();
+
+    if (cam)
+        cam->passToFrameUniforms(u);
+
+    if (!_frameUBO)
+    {
+        glGenBuffers(1, &_frameUBO);
+        totalGLCalls++;
+    }
+
+    glBindBufferBase(GL_UNIFORM_BUFFER, SL_FRAME_UBO_BINDING, _frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(u), &u, GL_DYNAMIC_DRAW);
+    totalGLCalls += 2;
+    GET_GL_ERROR;
+
+    _frameUniformsAreValid = true;
+    _frameUniformsCam      = cam;
+    _frameUniformsLights   = lights;
+    _frameUniformsVM       = stateGL->viewMatrix;
+}
+//-----------------------------------------------------------------------------
+//! Deletes the shared uniform buffer of the uniform block u_frame
+void SLGLProgram::deleteFrameUniformBuffer()
+{
+    if (_frameUBO)
+    {
+        glDeleteBuffers(1, &_frameUBO);
+        GET_GL_ERROR;
+        _frameUBO = 0;
+    }
+    _frameUniformsAreValid = false;
+}
+//-----------------------------------------------------------------------------
 //! SLGLProgram::endUse stops the shader program
 void SLGLProgram::endUse()
 {
@@ -578,10 +835,26 @@ void SLGLProgram::addUniform1i(SLGLUniform1i* u)
     _uniforms1i.push_back(u);
 }
 //-----------------------------------------------------------------------------
+/*! Returns the location of the uniform variable "name" from the hash map that
+is filled after linking. Names that are not yet in the map (e.g. single array
+elements like "u_arr[2]") are queried once from OpenGL and then cached as well.
+Inactive uniforms are cached with the location -1.
+*/
 SLint SLGLProgram::getUniformLocation(const SLchar* name) const
 {
+    SLuint64 hash = hashUniformName(name);
+    auto     it   = _uniformLocations.find(hash);
+    if (it != _uniformLocations.end() && it->second.name == name)
+        return it->second.loc;
+
     SLint loc = glGetUniformLocation(_progID, name);
+    totalGLCalls++;
     GET_GL_ERROR;
+
+    // Only cache after linking and if there is no hash collision
+    if (_isLinked && it == _uniformLocations.end())
+        _uniformLocations[hash] = {name, loc};
+
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -589,7 +862,11 @@ SLint SLGLProgram::getUniformLocation(const SLchar* name) const
 SLint SLGLProgram::uniform1f(const SLchar* name, SLfloat v0) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform1f(loc, v0);
+    if (loc >= 0)
+    {
+        glUniform1f(loc, v0);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -599,7 +876,11 @@ SLint SLGLProgram::uniform2f(const SLchar* name,
                              SLfloat       v1) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform2f(loc, v0, v1);
+    if (loc >= 0)
+    {
+        glUniform2f(loc, v0, v1);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -610,7 +891,11 @@ SLint SLGLProgram::uniform3f(const SLchar* name,
                              SLfloat       v2) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform3f(loc, v0, v1, v2);
+    if (loc >= 0)
+    {
+        glUniform3f(loc, v0, v1, v2);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -622,7 +907,11 @@ SLint SLGLProgram::uniform4f(const SLchar* name,
                              SLfloat       v3) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform4f(loc, v0, v1, v2, v3);
+    if (loc >= 0)
+    {
+        glUniform4f(loc, v0, v1, v2, v3);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -630,7 +919,11 @@ SLint SLGLProgram::uniform4f(const SLchar* name,
 SLint SLGLProgram::uniform1i(const SLchar* name, SLint v0) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform1i(loc, v0);
+    if (loc >= 0)
+    {
+        glUniform1i(loc, v0);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -640,7 +933,11 @@ SLint SLGLProgram::uniform2i(const SLchar* name,
                              SLint         v1) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform2i(loc, v0, v1);
+    if (loc >= 0)
+    {
+        glUniform2i(loc, v0, v1);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -651,7 +948,11 @@ SLint SLGLProgram::uniform3i(const SLchar* name,
                              SLint         v2) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform3i(loc, v0, v1, v2);
+    if (loc >= 0)
+    {
+        glUniform3i(loc, v0, v1, v2);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -665,6 +966,7 @@ SLint SLGLProgram::uniform4i(const SLchar* name,
     SLint loc = getUniformLocation(name);
     if (loc == -1) return false;
     glUniform4i(loc, v0, v1, v2, v3);
+    totalGLCalls++;
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -674,7 +976,11 @@ SLint SLGLProgram::uniform1fv(const SLchar*  name,
                               const SLfloat* value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform1fv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform1fv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -684,7 +990,11 @@ SLint SLGLProgram::uniform2fv(const SLchar*  name,
                               const SLfloat* value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform2fv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform2fv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -696,6 +1006,7 @@ SLint SLGLProgram::uniform3fv(const SLchar*  name,
     SLint loc = getUniformLocation(name);
     if (loc == -1) return false;
     glUniform3fv(loc, count, value);
+    totalGLCalls++;
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -705,7 +1016,11 @@ SLint SLGLProgram::uniform4fv(const SLchar*  name,
                               const SLfloat* value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform4fv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform4fv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -715,7 +1030,11 @@ SLint SLGLProgram::uniform1iv(const SLchar* name,
                               const SLint*  value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform1iv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform1iv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -725,7 +1044,11 @@ SLint SLGLProgram::uniform2iv(const SLchar* name,
                               const SLint*  value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform2iv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform2iv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -735,7 +1058,11 @@ SLint SLGLProgram::uniform3iv(const SLchar* name,
                               const SLint*  value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform3iv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform3iv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -745,7 +1072,11 @@ SLint SLGLProgram::uniform4iv(const SLchar* name,
                               const SLint*  value) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniform4iv(loc, count, value);
+    if (loc >= 0)
+    {
+        glUniform4iv(loc, count, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -756,7 +1087,11 @@ SLint SLGLProgram::uniformMatrix2fv(const SLchar*  name,
                                     GLboolean      transpose) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniformMatrix2fv(loc, count, transpose, value);
+    if (loc >= 0)
+    {
+        glUniformMatrix2fv(loc, count, transpose, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -767,6 +1102,7 @@ void SLGLProgram::uniformMatrix2fv(const SLint    loc,
                                    GLboolean      transpose) const
 {
     glUniformMatrix2fv(loc, count, transpose, value);
+    totalGLCalls++;
 }
 //-----------------------------------------------------------------------------
 //! Passes a 3x3 float matrix values py pointer to the uniform variable "name"
@@ -776,7 +1112,11 @@ SLint SLGLProgram::uniformMatrix3fv(const SLchar*  name,
                                     GLboolean      transpose) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniformMatrix3fv(loc, count, transpose, value);
+    if (loc >= 0)
+    {
+        glUniformMatrix3fv(loc, count, transpose, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -787,6 +1127,7 @@ void SLGLProgram::uniformMatrix3fv(const SLint    loc,
                                    GLboolean      transpose) const
 {
     glUniformMatrix3fv(loc, count, transpose, value);
+    totalGLCalls++;
 }
 //-----------------------------------------------------------------------------
 //! Passes a 4x4 float matrix values py pointer to the uniform variable "name"
@@ -796,7 +1137,11 @@ SLint SLGLProgram::uniformMatrix4fv(const SLchar*  name,
                                     GLboolean      transpose) const
 {
     SLint loc = getUniformLocation(name);
-    if (loc >= 0) glUniformMatrix4fv(loc, count, transpose, value);
+    if (loc >= 0)
+    {
+        glUniformMatrix4fv(loc, count, transpose, value);
+        totalGLCalls++;
+    }
     return loc;
 }
 //-----------------------------------------------------------------------------
@@ -807,5 +1152,6 @@ void SLGLProgram::uniformMatrix4fv(const SLint    loc,
                                    GLboolean      transpose) const
 {
     glUniformMatrix4fv(loc, count, transpose, value);
+    totalGLCalls++;
 }
 //-----------------------------------------------------------------------------
@@ -13,6 +13,7 @@
 #define SLGLPROGRAM_H
 
 #include <map>
+#include <unordered_map>
 
 #include <SLGLState.h>
 #include <SLVec4.h>
@@ -40,6 +41,51 @@ typedef std::map<string, int> SLLocMap;
 typedef std::map<string, int> SLLocMap;
 #endif
 
+//-----------------------------------------------------------------------------
+//! Binding point of the uniform buffer with the per frame light and camera data
+static const SLuint SL_FRAME_UBO_BINDING = 0;
+//-----------------------------------------------------------------------------
+//! Per frame light and camera data in the std140 layout of the uniform block u_frame
+/*!
+The uniform block u_frame is declared by all generated shader programs
+(SLGLProgramGenerated). The data is uploaded only once per frame and view into
+a uniform buffer that is shared by all programs (see
+SLGLProgram::updateFrameUniforms). In std140 each element of a scalar or vec3
+array has a stride of 16 bytes, so that these arrays are stored as SLVec4f or
+SLVec4i and only the x or xyz components are used. Bools are stored as ints.
+*/
+struct SLGLFrameUniforms
+{
+    SLVec4f lightPosVS[SL_MAX_LIGHTS];   //!< position of light in view space
+    SLVec4f lightAmbi[SL_MAX_LIGHTS];    //!< ambient light intensity (Ia)
+    SLVec4f lightDiff[SL_MAX_LIGHTS];    //!< diffuse light intensity (Id)
+    SLVec4f lightSpec[SL_MAX_LIGHTS];    //!< specular light intensity (Is)
+    SLVec4f lightSpotDir[SL_MAX_LIGHTS]; //!< xyz: spot direction in view space
+    SLVec4f lightAtt[SL_MAX_LIGHTS];     //!< xyz: att. factor (const,linear,quadratic)
+    SLVec4f lightSpotDeg[SL_MAX_LIGHTS]; //!< x: spot cutoff angle 1-180 degrees
+    SLVec4f lightSpotCos[SL_MAX_LIGHTS]; //!< x: cosine of spot cutoff angle
+    SLVec4f lightSpotExp[SL_MAX_LIGHTS]; //!< x: spot exponent
+    SLVec4i lightIsOn[SL_MAX_LIGHTS];    //!< x: flag if light is on
+    SLVec4i lightDoAtt[SL_MAX_LIGHTS];   //!< x: flag if att. must be calculated
+    SLVec4f globalAmbi;                  //!< global ambient scene color
+    SLVec4f camFogColor;                 //!< fog color (usually the background)
+    SLVec4f camStereoColors[3];          //!< columns of the stereo color filter matrix
+    SLfloat oneOverGamma;                //!< 1.0f / gamma correction value
+    SLint   camProjType;                 //!< type of stereo
+    SLint   camStereoEye;                //!< -1=left, 0=center, 1=right
+    SLint   camFogIsOn;                  //!< flag if fog is on
+    SLint   camFogMode;                  //!< 0=LINEAR, 1=EXP, 2=EXP2
+    SLfloat camFogDensity;               //!< fog density value
+    SLfloat camFogStart;                 //!< fog start distance
+    SLfloat camFogEnd;                   //!< fog end distance
+    SLfloat camClipNear;                 //!< camera near plane
+    SLfloat camClipFar;                  //!< camera far plane
+    SLfloat camBkgdWidth;                //!< camera background width
+    SLfloat camBkgdHeight;               //!< camera background height
+    SLfloat camBkgdLeft;                 //!< camera background left
+    SLfloat camBkgdBottom;               //!< camera background bottom
+    SLfloat pad[2];                      //!< std140 block size is a multiple of 16
+};
 //-----------------------------------------------------------------------------
 //! Encapsulation of an OpenGL shader program object
 /*!
@@ -50,6 +96,11 @@ node for execution. An SLGLProgram object can hold an vector of uniform
 variable that can transfer variables from the CPU program to the GPU program.
 For more details on GLSL please refer to official GLSL documentation and to
 SLGLShader.<br>
+The locations of all active uniforms are queried once after linking and
+stored in a hash map, so that the uniform functions by name don't call
+glGetUniformLocation on every draw. Programs that declare the uniform block
+u_frame (see SLGLFrameUniforms) get their light and camera data from a shared
+uniform buffer instead of individual uniforms.<br>
 All shader files are located in the directory data/shaders. For OSX, iOS and
 Android applications they are copied to the appropriate file system locations.
 */
@@ -92,6 +143,13 @@ public:
 
     // Variable location getters
     SLint getUniformLocation(const SLchar* name) const;
+    SLbool usesFrameUniforms() const { return _frameBlockIndex != GL_INVALID_INDEX; }
+    SLbool usesInstancing() const { return _usesInstancing; }
+
+    // Uniform buffer with the per frame light and camera data
+    static void updateFrameUniforms(SLCamera* cam, SLVLight* lights);
+    static void invalidateFrameUniforms() { _frameUniformsAreValid = false; }
+    static void deleteFrameUniformBuffer();
 
     // Send uniform variables to program
     SLint uniform1f(const SLchar* name, SLfloat v0) const;
@@ -139,12 +197,37 @@ public:
                            const SLfloat* value,
                            GLboolean      transpose = false) const;
 
+    static SLuint totalGLCalls; //!< NO. of GL calls for uniforms per frame
+
 protected:
-    SLuint       _progID;     //!< OpenGL shader program object ID
-    SLbool       _isLinked;   //!< Flag if program is linked
-    SLVGLShader  _shaders;    //!< Vector of all shader objects
-    SLVUniform1f _uniforms1f; //!< Vector of uniform1f variables
-    SLVUniform1i _uniforms1i; //!< Vector of uniform1i variables
+    void     initUniforms();
+    SLuint64 binaryCacheKey(const string& extra) const;
+
+    SLuint       _progID;          //!< OpenGL shader program object ID
+    SLbool       _isLinked;        //!< Flag if program is linked
+    SLVGLShader  _shaders;         //!< Vector of all shader objects
+    SLVUniform1f _uniforms1f;      //!< Vector of uniform1f variables
+    SLVUniform1i _uniforms1i;      //!< Vector of uniform1i variables
+    SLuint       _frameBlockIndex; //!< Index of the uniform block u_frame or GL_INVALID_INDEX
+    SLbool       _useBinaryCache;  //!< Flag if the program binary gets cached on disk
+    SLbool       _usesInstancing;  //!< Flag if the program has the attribute a_instanceMatrix
+
+    //! Location of a uniform with its name for the check of hash collisions
+    struct SLUniformLocation
+    {
+        string name; //!< Uniform name
+        SLint  loc;  //!< Location or -1 if the uniform is not active
+    };
+
+    //! Uniform locations by the hash of their name
+    mutable std::unordered_map<SLuint64, SLUniformLocation> _uniformLocations;
+
+private:
+    static SLuint    _frameUBO;              //!< OpenGL uniform buffer object ID of u_frame
+    static SLbool    _frameUniformsAreValid; //!< Flag if the uniform buffer is up to date
+    static SLCamera* _frameUniformsCam;      //!< Camera of the last upload
+    static SLVLight* _frameUniformsLights;   //!< Lights of the last upload
+    static SLMat4f   _frameUniformsVM;       //!< View matrix of the last upload
 };
 //-----------------------------------------------------------------------------
 //! STL vector of SLGLProgram pointers
@@ -0,0 +1,285 @@
+//#############################################################################
+//  File:      SLGLProgramBinaryCache.cpp
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <SLGLProgramBinaryCache.h>
+#include <SLGLProgramManager.h>
+#include <SLGLState.h>
+#include <Utils.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+//-----------------------------------------------------------------------------
+SLuint SLGLProgramBinaryCache::numLoaded = 0;
+SLuint SLGLProgramBinaryCache::numSaved  = 0;
+
+SLint                                                       SLGLProgramBinaryCache::_isSupported = -1;
+string                                                      SLGLProgramBinaryCache::_cachePath;
+std::map<SLuint64, SLGLProgramBinaryCache::SLProgramBinary> SLGLProgramBinaryCache::_binaries;
+std::set<SLuint64>                                          SLGLProgramBinaryCache::_usedKeys;
+std::mutex                                                  SLGLProgramBinaryCache::_mutex;
+std::thread                                                 SLGLProgramBinaryCache::_warmUpThread;
+SLbool                                                      SLGLProgramBinaryCache::_warmUpStarted = false;
+//-----------------------------------------------------------------------------
+//! Magic number at the begin of each binary file
+static const char BINARY_MAGIC[4] = {'S', 'L', 'P', 'B'};
+//-----------------------------------------------------------------------------
+//! Returns true if the driver supports at least one program binary format
+SLbool SLGLProgramBinaryCache::isSupported()
+{
+#if defined(SL_EMSCRIPTEN)
+    return false;
+#else
+    if (_isSupported < 0)
+    {
+        SLGLState* stateGL    = SLGLState::instance();
+        SLint      numFormats = 0;
+
+        // glProgramBinary is core since OpenGL 4.1 and OpenGL ES 3.0
+        if (stateGL->glIsES3() ||
+            (!stateGL->glIsES() && stateGL->glVersionNOf() >= 4.1f))
+        {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+            GET_GL_ERROR;
+        }
+
+        _isSupported = numFormats > 0 &&
+                           !SLGLProgramManager::configPath.empty()
+                         ? 1
+                         : 0;
+    }
+    return _isSupported == 1;
+#endif
+}
+//-----------------------------------------------------------------------------
+/*! 64-bit FNV-1a hash of a string. The seed allows to chain multiple strings.
+ */
+SLuint64 SLGLProgramBinaryCache::hash(const string& s, SLuint64 seed)
+{
+    SLuint64 h = seed;
+    for (char c : s)
+    {
+        h ^= (SLuint64)(unsigned char)c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+//-----------------------------------------------------------------------------
+/*! Returns the cache directory of the current driver and creates it if it
+doesn't exist. Must be called first on the thread with the GL context.
+ */
+string SLGLProgramBinaryCache::cachePath()
+{
+    if (_cachePath.empty())
+    {
+        SLGLState* stateGL = SLGLState::instance();
+        SLuint64   driver  = hash(stateGL->glVendor());
+        driver             = hash(stateGL->glRenderer(), driver);
+        driver             = hash(stateGL->glVersion(), driver);
+        driver             = hash(stateGL->glSLVersion(), driver);
+
+        _cachePath = SLGLProgramManager::configPath + "programBinaries/" +
+                     Utils::formatString("%016llx", (unsigned long long)driver) + "/";
+
+        if (!Utils::dirExists(_cachePath))
+            Utils::makeDirRecurse(_cachePath);
+    }
+    return _cachePath;
+}
+//-----------------------------------------------------------------------------
+//! Returns the file name of a program binary with the key as hex number
+string SLGLProgramBinaryCache::fileName(SLuint64 key)
+{
+    return Utils::formatString("%016llx.bin", (unsigned long long)key);
+}
+//-----------------------------------------------------------------------------
+//! Reads a program binary file. Returns false for missing or invalid files.
+SLbool SLGLProgramBinaryCache::readFile(const string&    pathFilename,
+                                        SLProgramBinary& binary)
+{
+    std::ifstream in(pathFilename, std::ios::binary | std::ios::ate);
+    if (!in.is_open())
+        return false;
+    std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+
+    char   magic[4];
+    SLuint length = 0;
+    in.read(magic, sizeof(magic));
+    in.read((char*)&binary.format, sizeof(binary.format));
+    in.read((char*)&length, sizeof(length));
+    if (!in || memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0 || length == 0)
+        return false;
+
+    // Don't allocate more than a truncated or corrupt file can contain
+    if ((std::streamoff)length > fileSize - in.tellg())
+        return false;
+
+    binary.data.resize(length);
+    in.read((char*)binary.data.data(), length);
+    return (bool)in;
+}
+//-----------------------------------------------------------------------------
+/*! Thread function of warmUp that reads all binary files in path into memory.
+Binaries that were already requested by load get skipped.
+ */
+void SLGLProgramBinaryCache::readAllFiles(string path)
+{
+    for (const auto& file : Utils::getFileNamesInDir(path, false))
+    {
+        if (Utils::getFileExt(file) != "bin")
+            continue;
+
+        SLuint64 key = strtoull(Utils::getFileNameWOExt(file).c_str(), nullptr, 16);
+        {
+            std::lock_guard<std::mutex> guard(_mutex);
+            if (_usedKeys.count(key))
+                continue;
+        }
+
+        SLProgramBinary binary;
+        if (!readFile(path + file, binary))
+            continue;
+
+        std::lock_guard<std::mutex> guard(_mutex);
+        if (!_usedKeys.count(key))
+            _binaries[key] = std::move(binary);
+    }
+}
+//-----------------------------------------------------------------------------
+/*! Starts the background thread that reads all program binaries of the
+current driver into memory. Only the first call after clear starts the thread.
+Must be called on the thread with the GL context, e.g. in
+SLGLState::onInitialize.
+ */
+void SLGLProgramBinaryCache::warmUp()
+{
+    if (_warmUpStarted || !isSupported())
+        return;
+
+    _warmUpStarted = true;
+    _warmUpThread  = std::thread(readAllFiles, cachePath());
+}
+//-----------------------------------------------------------------------------
+/*!
+Creates the program progID from the binary with the passed key. The binary is
+taken from the warm-up memory or read from the file if the warm-up thread
+didn't read it yet. If the driver rejects the binary the file gets deleted.
+@param progID OpenGL program object ID without attached shaders
+@param key Hash of the program source code (see SLGLProgram::binaryCacheKey)
+@return true if the program is linked
+*/
+SLbool SLGLProgramBinaryCache::load(SLuint progID, SLuint64 key)
+{
+    if (!isSupported())
+        return false;
+
+    SLProgramBinary binary;
+    SLbool          isInMemory = false;
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        auto                        it = _binaries.find(key);
+        if (it != _binaries.end())
+        {
+            binary = std::move(it->second);
+            _binaries.erase(it);
+            isInMemory = true;
+        }
+        _usedKeys.insert(key);
+    }
+
+    string pathFilename = cachePath() + fileName(key);
+    if (!isInMemory && !readFile(pathFilename, binary))
+        return false;
+
+    glProgramBinary(progID,
+                    (GLenum)binary.format,
+                    binary.data.data(),
+                    (GLsizei)binary.data.size());
+
+    SLint linked = 0;
+    glGetProgramiv(progID, GL_LINK_STATUS, &linked);
+    GET_GL_ERROR;
+
+    if (!linked)
+    {
+        SL_LOG("SLGLProgramBinaryCache::load: Binary rejected: %s", pathFilename.c_str());
+        Utils::deleteFile(pathFilename);
+        return false;
+    }
+
+    numLoaded++;
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+Saves the binary of the linked program progID under the passed key. The file
+is written under a temporary name first, so that an interrupted write never
+leaves a truncated binary.
+@param progID OpenGL program object ID of a linked program
+@param key Hash of the program source code (see SLGLProgram::binaryCacheKey)
+*/
+void SLGLProgramBinaryCache::save(SLuint progID, SLuint64 key)
+{
+    if (!isSupported())
+        return;
+
+    SLint length = 0;
+    glGetProgramiv(progID, GL_PROGRAM_BINARY_LENGTH, &length);
+    GET_GL_ERROR;
+    if (length <= 0)
+        return;
+
+    SLProgramBinary binary;
+    GLenum          format = 0;
+    binary.data.resize((size_t)length);
+    glGetProgramBinary(progID, length, &length, &format, binary.data.data());
+    GET_GL_ERROR;
+    if (length <= 0)
+        return;
+
+    string pathFilename = cachePath() + fileName(key);
+    string tmpFilename  = pathFilename + ".tmp";
+    SLuint uFormat      = (SLuint)format;
+    SLuint uLength      = (SLuint)length;
+
+    std::ofstream out(tmpFilename, std::ios::binary);
+    out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    out.write((const char*)&uFormat, sizeof(uFormat));
+    out.write((const char*)&uLength, sizeof(uLength));
+    out.write((const char*)binary.data.data(), length);
+    out.close();
+
+    if (!out)
+    {
+        Utils::deleteFile(tmpFilename);
+        return;
+    }
+
+    std::remove(pathFilename.c_str());
+    if (std::rename(tmpFilename.c_str(), pathFilename.c_str()) == 0)
+        numSaved++;
+}
+//-----------------------------------------------------------------------------
+/*! Waits for the warm-up thread and frees all binaries in memory. Must be
+called before the GL context gets destroyed, e.g. in the SLScene destructor.
+ */
+void SLGLProgramBinaryCache::clear()
+{
+    if (_warmUpThread.joinable())
+        _warmUpThread.join();
+
+    std::lock_guard<std::mutex> guard(_mutex);
+    _binaries.clear();
+    _usedKeys.clear();
+    _warmUpStarted = false;
+    _isSupported   = -1;
+    _cachePath.clear();
+}
+//-----------------------------------------------------------------------------
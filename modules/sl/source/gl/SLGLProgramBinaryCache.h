@@ -0,0 +1,76 @@
+//#############################################################################
+//  File:      SLGLProgramBinaryCache.h
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLGLPROGRAMBINARYCACHE_H
+#define SLGLPROGRAMBINARYCACHE_H
+
+#include <SL.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+//-----------------------------------------------------------------------------
+//! Static on-disk cache of linked OpenGL shader program binaries
+/*!
+Compiling and linking the generated shader programs (SLGLProgramGenerated)
+stalls the first frames of every app start and scene load. After a successful
+link the program binary is retrieved with glGetProgramBinary and stored in
+the directory programBinaries/<driver hash>/ of SLGLProgramManager::configPath.
+At the next start the program is created with glProgramBinary without any
+compilation.
+\n The file name is the hash of the complete shader source code (see
+SLGLProgram::binaryCacheKey). The driver hash is built from the OpenGL vendor,
+renderer and version strings, so that a driver update never loads an
+incompatible binary. If the driver rejects a binary anyway the file gets
+deleted and the program is compiled from source again.
+\n warmUp starts a background thread that reads the binaries of all known
+program permutations of the current driver into memory, so that load does no
+file IO on the render thread. The GL calls itself must stay on the thread of
+the GL context.
+\n Program binaries are not available in WebGL, so the cache is disabled for
+Emscripten builds and for drivers without any program binary format.
+*/
+class SLGLProgramBinaryCache
+{
+public:
+    static SLbool   isSupported();
+    static void     warmUp();
+    static SLbool   load(SLuint progID, SLuint64 key);
+    static void     save(SLuint progID, SLuint64 key);
+    static void     clear();
+    static SLuint64 hash(const string& s,
+                         SLuint64      seed = 14695981039346656037ULL);
+
+    static SLuint numLoaded; //!< NO. of programs created from a binary
+    static SLuint numSaved;  //!< NO. of program binaries saved
+
+private:
+    //! Program binary with its driver specific format
+    struct SLProgramBinary
+    {
+        SLuint          format = 0; //!< Binary format of glGetProgramBinary
+        vector<SLuchar> data;       //!< Binary program data
+    };
+
+    static string cachePath();
+    static string fileName(SLuint64 key);
+    static SLbool readFile(const string&    pathFilename,
+                           SLProgramBinary& binary);
+    static void   readAllFiles(string path);
+
+    static SLint                               _isSupported;   //!< -1: not yet checked, 0: no, 1: yes
+    static string                              _cachePath;     //!< Directory of the current driver
+    static std::map<SLuint64, SLProgramBinary> _binaries;      //!< Binaries read by the warm-up thread
+    static std::set<SLuint64>                  _usedKeys;      //!< Keys already requested by load
+    static std::mutex                          _mutex;         //!< Mutex for _binaries & _usedKeys
+    static std::thread                         _warmUpThread;  //!< Background thread of warmUp
+    static SLbool                              _warmUpStarted; //!< Flag if warmUp was called
+};
+//-----------------------------------------------------------------------------
+#endif // SLGLPROGRAMBINARYCACHE_H
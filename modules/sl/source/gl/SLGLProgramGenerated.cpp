@@ -51,6 +51,8 @@ const string vertInput_a_uv1              = R"(
 layout (location = 3) in vec2  a_uv1;            // Vertex tex.coord. 2 for AO)";
 const string vertInput_a_tangent          = R"(
 layout (location = 5) in vec4  a_tangent;        // Vertex tangent attribute)";
+const string vertInput_a_instanceMatrix   = R"(
+layout (location = 12) in mat4 a_instanceMatrix; // Instance model matrix (identity if not instanced))";
 //-----------------------------------------------------------------------------
 const string vertInput_u_matrices_all = R"(
 
@@ -60,11 +62,40 @@ uniform mat4  u_pMatrix;    // Projection matrix (camera to normalize device coo
 const string vertInput_u_matrix_vOmv  = R"(
 uniform mat4  u_vOmvMatrix;         // view or modelview matrix)";
 //-----------------------------------------------------------------------------
-const string vertInput_u_lightNm = R"(
+//! Per frame light and camera uniforms in one uniform block (see SLGLFrameUniforms)
+const string uniformBlock_u_frame = R"(
 
-uniform vec4  u_lightPosVS[NUM_LIGHTS];     // position of light in view space
-uniform vec3  u_lightSpotDir[NUM_LIGHTS];   // spot direction in view space
-uniform float u_lightSpotDeg[NUM_LIGHTS];   // spot cutoff angle 1-180 degrees)";
+layout (std140) uniform u_frame
+{
+    highp vec4  u_lightPosVS[MAX_LIGHTS];   // position of light in view space
+    highp vec4  u_lightAmbi[MAX_LIGHTS];    // ambient light intensity (Ia)
+    highp vec4  u_lightDiff[MAX_LIGHTS];    // diffuse light intensity (Id)
+    highp vec4  u_lightSpec[MAX_LIGHTS];    // specular light intensity (Is)
+    highp vec3  u_lightSpotDir[MAX_LIGHTS]; // spot direction in view space
+    highp vec3  u_lightAtt[MAX_LIGHTS];     // attenuation (const,linear,quadr.)
+    highp float u_lightSpotDeg[MAX_LIGHTS]; // spot cutoff angle 1-180 degrees
+    highp float u_lightSpotCos[MAX_LIGHTS]; // cosine of spot cutoff angle
+    highp float u_lightSpotExp[MAX_LIGHTS]; // spot exponent
+    bool        u_lightIsOn[MAX_LIGHTS];    // flag if light is on
+    bool        u_lightDoAtt[MAX_LIGHTS];   // flag if att. must be calc.
+    highp vec4  u_globalAmbi;               // Global ambient scene color
+    highp vec4  u_camFogColor;              // fog color (usually the background)
+    highp mat3  u_camStereoColors;          // color filter matrix
+    highp float u_oneOverGamma;             // 1.0f / Gamma correction value
+    highp int   u_camProjType;              // type of stereo
+    highp int   u_camStereoEye;             // -1=left, 0=center, 1=right
+    bool        u_camFogIsOn;               // flag if fog is on
+    highp int   u_camFogMode;               // 0=LINEAR, 1=EXP, 2=EXP2
+    highp float u_camFogDensity;            // fog density value
+    highp float u_camFogStart;              // fog start distance
+    highp float u_camFogEnd;                // fog end distance
+    highp float u_camClipNear;              // camera near plane
+    highp float u_camClipFar;               // camera far plane
+    highp float u_camBkgdWidth;             // camera background width
+    highp float u_camBkgdHeight;            // camera background height
+    highp float u_camBkgdLeft;              // camera background left
+    highp float u_camBkgdBottom;            // camera background bottom
+};)";
 //-----------------------------------------------------------------------------
 const string vertConstant_PS_pi = R"(
 
@@ -172,10 +203,11 @@ const string vertMain_Begin              = R"(
 void main()
 {)";
 const string vertMain_v_P_VS             = R"(
-    mat4 mvMatrix = u_vMatrix * u_mMatrix;
+    mat4 mMatrix  = u_mMatrix * a_instanceMatrix;
+    mat4 mvMatrix = u_vMatrix * mMatrix;
     v_P_VS = vec3(mvMatrix *  a_position);   // vertex position in view space)";
 const string vertMain_v_P_WS_Sm          = R"(
-    v_P_WS = vec3(u_mMatrix * a_position);   // vertex position in world space)";
+    v_P_WS = vec3(mMatrix * a_position);     // vertex position in world space)";
 const string vertMain_v_N_VS             = R"(
     mat3 invMvMatrix = mat3(inverse(mvMatrix));
     mat3 nMatrix = transpose(invMvMatrix);
@@ -681,22 +713,6 @@ const string fragMain_PS_endAll = R"(
    o_fragColor.rgb = pow(o_fragColor.rgb, vec3(u_oneOverGamma));
 })";
 //-----------------------------------------------------------------------------
-const string fragInput_u_lightAll    = R"(
-
-uniform bool        u_lightIsOn[NUM_LIGHTS];        // flag if light is on
-uniform vec4        u_lightPosVS[NUM_LIGHTS];       // position of light in view space
-uniform vec4        u_lightAmbi[NUM_LIGHTS];        // ambient light intensity (Ia)
-uniform vec4        u_lightDiff[NUM_LIGHTS];        // diffuse light intensity (Id)
-uniform vec4        u_lightSpec[NUM_LIGHTS];        // specular light intensity (Is)
-uniform vec3        u_lightSpotDir[NUM_LIGHTS];     // spot direction in view space
-uniform float       u_lightSpotDeg[NUM_LIGHTS];     // spot cutoff angle 1-180 degrees
-uniform float       u_lightSpotCos[NUM_LIGHTS];     // cosine of spot cutoff angle
-uniform float       u_lightSpotExp[NUM_LIGHTS];     // spot exponent
-uniform vec3        u_lightAtt[NUM_LIGHTS];         // attenuation (const,linear,quadr.)
-uniform bool        u_lightDoAtt[NUM_LIGHTS];       // flag if att. must be calc.
-uniform vec4        u_globalAmbi;                   // Global ambient scene color
-uniform float       u_oneOverGamma;                 // 1.0f / Gamma correction value
-)";
 const string fragInput_u_matBlinnAll = R"(
 uniform vec4        u_matAmbi;                      // ambient color reflection coefficient (ka)
 uniform vec4        u_matDiff;                      // diffuse color reflection coefficient (kd)
@@ -740,24 +756,6 @@ uniform samplerCube u_skyRoughnessCubemap;  // PBR skybox cubemap for rough refl
 uniform sampler2D   u_skyBrdfLutTexture;    // PBR lighting lookup table for BRDF
 uniform float       u_skyExposure;          // PBR skybox exposure)";
 //-----------------------------------------------------------------------------
-const string fragInput_u_cam = R"(
-
-uniform int         u_camProjType;    // type of stereo
-uniform int         u_camStereoEye;     // -1=left, 0=center, 1=right
-uniform mat3        u_camStereoColors;  // color filter matrix
-uniform bool        u_camFogIsOn;       // flag if fog is on
-uniform int         u_camFogMode;       // 0=LINEAR, 1=EXP, 2=EXP2
-uniform float       u_camFogDensity;    // fog density value
-uniform float       u_camFogStart;      // fog start distance
-uniform float       u_camFogEnd;        // fog end distance
-uniform vec4        u_camFogColor;      // fog color (usually the background)
-uniform float       u_camClipNear;      // camera near plane
-uniform float       u_camClipFar;       // camera far plane
-uniform float       u_camBkgdWidth;     // camera background width
-uniform float       u_camBkgdHeight;    // camera background height
-uniform float       u_camBkgdLeft;      // camera background left
-uniform float       u_camBkgdBottom;    // camera background bottom)";
-//-----------------------------------------------------------------------------
 const string fragOutputs_o_fragColor = R"(
 
 out     vec4        o_fragColor;        // output fragment color)";
@@ -1783,9 +1781,10 @@ void SLGLProgramGenerated::buildPerPixCook(SLMaterial* mat, SLVLight* lights)
     vertCode += vertInput_a_pn;
     if (uv0) vertCode += vertInput_a_uv0;
     if (Nm) vertCode += vertInput_a_tangent;
+    vertCode += vertInput_a_instanceMatrix;
     vertCode += vertInput_u_matrices_all;
     // if (sky) vertCode += vertInput_u_matrix_invMv;
-    if (Nm) vertCode += vertInput_u_lightNm;
+    if (Nm) vertCode += uniformBlock_u_frame;
 
     // Vertex shader outputs
     vertCode += vertOutput_v_P_VS;
@@ -1820,7 +1819,7 @@ void SLGLProgramGenerated::buildPerPixCook(SLMaterial* mat, SLVLight* lights)
     if (Nm) fragCode += fragInput_v_lightVecTS;
 
     // Fragment shader uniforms
-    fragCode += fragInput_u_lightAll;
+    fragCode += uniformBlock_u_frame;
     if (Sm) fragCode += fragInput_u_lightSm(lights);
     fragCode += Dm ? fragInput_u_matTexDm : fragInput_u_matDiff;
     fragCode += Em ? fragInput_u_matTexEm : fragInput_u_matEmis;
@@ -1835,7 +1834,6 @@ void SLGLProgramGenerated::buildPerPixCook(SLMaterial* mat, SLVLight* lights)
     if (Sm) fragCode += fragInput_u_matGetsSm;
     if (Sm) fragCode += fragInput_u_shadowMaps(lights);
     if (sky) fragCode += fragInput_u_skyCookEnvMaps;
-    fragCode += fragInput_u_cam;
 
     // Fragment shader outputs
     fragCode += fragOutputs_o_fragColor;
@@ -1898,8 +1896,9 @@ void SLGLProgramGenerated::buildPerPixBlinn(SLMaterial* mat, SLVLight* lights)
     if (uv0) vertCode += vertInput_a_uv0;
     if (uv1) vertCode += vertInput_a_uv1;
     if (Nm) vertCode += vertInput_a_tangent;
+    vertCode += vertInput_a_instanceMatrix;
     vertCode += vertInput_u_matrices_all;
-    if (Nm) vertCode += vertInput_u_lightNm;
+    if (Nm) vertCode += uniformBlock_u_frame;
 
     // Vertex shader outputs
     vertCode += vertOutput_v_P_VS;
@@ -1934,7 +1933,7 @@ void SLGLProgramGenerated::buildPerPixBlinn(SLMaterial* mat, SLVLight* lights)
     if (Nm) fragCode += fragInput_v_lightVecTS;
 
     // Fragment shader uniforms
-    fragCode += fragInput_u_lightAll;
+    fragCode += uniformBlock_u_frame;
     fragCode += fragInput_u_matBlinnAll;
     if (Sm) fragCode += fragInput_u_lightSm(lights);
     if (Dm) fragCode += fragInput_u_matTexDm;
@@ -1943,7 +1942,6 @@ void SLGLProgramGenerated::buildPerPixBlinn(SLMaterial* mat, SLVLight* lights)
     if (Om0 || Om1) fragCode += fragInput_u_matTexOm;
     if (Sm) fragCode += fragInput_u_matGetsSm;
     if (Sm) fragCode += fragInput_u_shadowMaps(lights);
-    fragCode += fragInput_u_cam;
 
     // Fragment shader outputs
     fragCode += fragOutputs_o_fragColor;
@@ -2220,6 +2218,7 @@ void SLGLProgramGenerated::buildPerPixVideoBkgdSm(SLVLight* lights)
     string vertCode;
     vertCode += shaderHeader((int)lights->size());
     vertCode += vertInput_a_pn;
+    vertCode += vertInput_a_instanceMatrix;
     vertCode += vertInput_u_matrices_all;
     vertCode += vertOutput_v_P_VS;
     vertCode += vertOutput_v_P_WS;
@@ -2239,9 +2238,8 @@ in      vec3        v_P_VS;     // Interpol. point of illumination in view space
 in      vec3        v_P_WS;     // Interpol. point of illumination in world space (WS)
 in      vec3        v_N_VS;     // Interpol. normal at v_P_VS in view space
 )";
-    fragCode += fragInput_u_lightAll;
+    fragCode += uniformBlock_u_frame;
     fragCode += fragInput_u_lightSm(lights);
-    fragCode += fragInput_u_cam;
     fragCode += fragInput_u_matAmbi;
     fragCode += fragInput_u_matTexDm;
     fragCode += fragInput_u_matGetsSm;
@@ -2624,6 +2622,7 @@ string SLGLProgramGenerated::shaderHeader(int numLights)
 {
     string header = "\nprecision highp float;\n";
     header += "\n#define NUM_LIGHTS " + to_string(numLights) + "\n";
+    header += "#define MAX_LIGHTS " + to_string(SL_MAX_LIGHTS) + "\n";
     return header;
 }
 
@@ -48,7 +48,9 @@ class SLAssetManager;
  get compiled, linked and activated with the OpenGL functions in SLGLShader
  and SLGLProgram.
  After successful compilation the shader get exported into the applications
- config directory if they not yet exist there.
+ config directory if they not yet exist there. The linked program binary gets
+ stored in the SLGLProgramBinaryCache, so that the next app start doesn't need
+ to compile the same program again.
 */
 class SLGLProgramGenerated : public SLGLProgram
 {
@@ -66,6 +68,7 @@ public:
                     "",
                     programName)
     {
+        _useBinaryCache = true;
         buildProgramCode(mat, lights);
     }
 
@@ -81,6 +84,7 @@ public:
                     geomShader,
                     programName)
     {
+        _useBinaryCache = true;
         buildProgramCodePS(mat, isDrawProg);
     }
 
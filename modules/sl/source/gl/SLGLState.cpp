@@ -10,6 +10,8 @@
 
 #include <SLGLState.h>
 #include <SLMaterial.h>
+#include <SLGLProgramBinaryCache.h>
+#include <SLGLVertexArray.h>
 #include <cv/CVImage.h>
 #ifdef SL_OS_ANDROID
 #    include <android/log.h>
@@ -137,6 +139,12 @@ void SLGLState::onInitialize(const SLCol4f& clearColor)
                  clearColor.b,
                  clearColor.a);
     GET_GL_ERROR;
+
+    // Constant identity for the instance matrix of non instanced draw calls
+    SLGLVertexArray::resetInstanceMatrix();
+
+    // Start reading the cached program binaries in the background
+    SLGLProgramBinaryCache::warmUp();
 }
 //-----------------------------------------------------------------------------
 void SLGLState::clearColor(const SLCol4f& newColor)
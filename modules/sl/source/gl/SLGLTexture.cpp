@@ -9,6 +9,7 @@
 
 #include <SLGLState.h>
 #include <SLGLTexture.h>
+#include <SLTexelCache.h>
 #include <SLScene.h>
 #include <SLGLProgramManager.h>
 #include <SLAssetManager.h>
@@ -478,6 +479,8 @@ void SLGLTexture::deleteData()
 //! Deletes the CVImages in _images. No more texture mapping in ray tracing.
 void SLGLTexture::deleteImages()
 {
+    deleteTexelCaches();
+
     for (auto& img : _images)
     {
         delete img;
@@ -486,6 +489,18 @@ void SLGLTexture::deleteImages()
     _images.clear();
 }
 //-----------------------------------------------------------------------------
+/*!
+Deletes the tiled texel caches of getTexelf. Must be called whenever the
+pixels of the images change. They get rebuilt on the next getTexelf call.
+Ray tracing threads that still hold a cache from texelCache keep it alive
+until their lookup is done.
+*/
+void SLGLTexture::deleteTexelCaches()
+{
+    std::lock_guard<std::mutex> guard(_mutex);
+    std::atomic_store(&_texelCaches, std::shared_ptr<const SLVTexelCache>());
+}
+//-----------------------------------------------------------------------------
 //! Deletes the OpenGL texture objects and releases the memory on the GPU
 void SLGLTexture::deleteDataGpu()
 {
@@ -628,6 +643,7 @@ SLbool SLGLTexture::copyVideoImage(SLint           camWidth,
                                        data,
                                        isContinuous,
                                        isTopLeft);
+    deleteTexelCaches();
 
     if (!_images.empty())
     {
@@ -678,6 +694,7 @@ SLbool SLGLTexture::copyVideoImage(SLint           camWidth,
                                        data,
                                        isContinuous,
                                        isTopLeft);
+    deleteTexelCaches();
     if (!_images.empty())
     {
         _width         = _images[0]->width();
@@ -842,7 +859,10 @@ void SLGLTexture::build(SLint texUnit)
             if (w2 == 0) SL_EXIT_MSG("Image can not be rescaled: width=0");
             if (h2 == 0) SL_EXIT_MSG("Image can not be rescaled: height=0");
             if (w2 != _images[0]->width() || h2 != _images[0]->height())
+            {
                 _images[0]->resize((SLint)w2, (SLint)h2);
+                deleteTexelCaches();
+            }
         }
 
         // check 2D size
@@ -1233,8 +1253,16 @@ void SLGLTexture::drawSprite(SLbool doUpdate, SLfloat x, SLfloat y, SLfloat w, S
 //! SLGLTexture::getTexelf returns a pixel color from u & v texture coordinates.
 /*! If the OpenGL filtering is set to GL_LINEAR a bilinear interpolated color out
 of four neighboring pixels is return. Otherwise the nearest pixel is returned.
+The texels are read from a tiled SLTexelCache copy of the image that is built on
+the first call. For mipmap minification filters the cache has mip levels and
+lod > 0 selects a trilinear lookup. Images with a format that the cache does
+not support are read directly with CVImage::getPixelf and getPixeli.
+@param u Horizontal texture coordinate
+@param v Vertical texture coordinate
+@param imgIndex Index of the image (cube map side or 3D texture slice)
+@param lod Level of detail: log2 of the texel footprint in the image
 */
-SLCol4f SLGLTexture::getTexelf(SLfloat u, SLfloat v, SLuint imgIndex)
+SLCol4f SLGLTexture::getTexelf(SLfloat u, SLfloat v, SLuint imgIndex, SLfloat lod)
 {
     if (imgIndex < _images.size())
     {
@@ -1247,14 +1275,26 @@ SLCol4f SLGLTexture::getTexelf(SLfloat u, SLfloat v, SLuint imgIndex)
         if (u < 0.0f || u > 1.0f) u -= floor(u);
         if (v < 0.0f || v > 1.0f) v -= floor(v);
 
+        std::shared_ptr<SLTexelCache> cache = texelCache(imgIndex);
+
         // Bilinear interpolation
         if (_min_filter == GL_LINEAR || _mag_filter == GL_LINEAR)
         {
+            if (cache)
+            {
+                // Alpha is 1 as in CVImage::getPixelf
+                SLCol4f c4f = cache->texelf(u, v, lod);
+                c4f.a       = 1.0f;
+                return c4f;
+            }
             CVVec4f c4f = _images[imgIndex]->getPixelf(u, v);
             return SLCol4f(c4f[0], c4f[1], c4f[2], c4f[3]);
         }
         else
         {
+            if (cache)
+                return cache->texeli((SLint)(u * (SLfloat)cache->width()),
+                                     (SLint)(v * (SLfloat)cache->height()));
             CVVec4f c4f = _images[imgIndex]->getPixeli((SLint)(u * _images[imgIndex]->width()),
                                                        (SLint)(v * _images[imgIndex]->height()));
             return SLCol4f(c4f[0], c4f[1], c4f[2], c4f[3]);
@@ -1264,6 +1304,40 @@ SLCol4f SLGLTexture::getTexelf(SLfloat u, SLfloat v, SLuint imgIndex)
         return SLCol4f::BLACK;
 }
 //-----------------------------------------------------------------------------
+/*!
+Returns the texel cache of the image with index imgIndex or nullptr if its
+format is not supported. All caches are built on the first call by the first
+ray tracing thread while the others wait. Mip levels are only built for the
+mipmap minification filters. The returned shared pointer keeps the cache
+alive even if deleteTexelCaches is called by another thread meanwhile.
+*/
+std::shared_ptr<SLTexelCache> SLGLTexture::texelCache(SLuint imgIndex)
+{
+    std::shared_ptr<const SLVTexelCache> caches = std::atomic_load(&_texelCaches);
+    if (!caches)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        caches = std::atomic_load(&_texelCaches);
+        if (!caches)
+        {
+            SLbool buildMipmaps = _min_filter == GL_NEAREST_MIPMAP_NEAREST ||
+                                  _min_filter == GL_LINEAR_MIPMAP_NEAREST ||
+                                  _min_filter == GL_NEAREST_MIPMAP_LINEAR ||
+                                  _min_filter == GL_LINEAR_MIPMAP_LINEAR;
+
+            auto newCaches = std::make_shared<SLVTexelCache>();
+            for (auto* img : _images)
+                newCaches->push_back(SLTexelCache::isSupported(img)
+                                       ? std::make_shared<SLTexelCache>(img, buildMipmaps)
+                                       : nullptr);
+            caches = newCaches;
+            std::atomic_store(&_texelCaches, caches);
+        }
+    }
+
+    return imgIndex < caches->size() ? (*caches)[imgIndex] : nullptr;
+}
+//-----------------------------------------------------------------------------
 //! SLGLTexture::getTexelf returns a pixel color at the specified cubemap direction
 SLCol4f SLGLTexture::getTexelf(const SLVec3f& cubemapDir)
 {
@@ -1562,6 +1636,8 @@ void SLGLTexture::calc3DGradients(SLint                      sampleRadius,
         }
     }
 
+    deleteTexelCaches();
+
     // Debug check
     // for (auto img : _images)
     //   img->savePNG(img->path() + "Normals_" + img->name());
@@ -1628,6 +1704,8 @@ void SLGLTexture::smooth3DGradients(SLint               smoothRadius,
             }
         }
     }
+
+    deleteTexelCaches();
 }
 //-----------------------------------------------------------------------------
 //! Computes the unnormalised vector x,y,z from tex. coords. uv with cubemap index.
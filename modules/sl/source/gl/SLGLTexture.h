@@ -15,6 +15,7 @@
 #include <SLGLVertexArray.h>
 #include <SLMat4.h>
 #include <atomic>
+#include <memory>
 #include <mutex>
 
 #ifdef SL_BUILD_WITH_KTX
@@ -28,6 +29,8 @@
 class SLGLState;
 class SLAssetManager;
 class SLGLProgram;
+class SLTexelCache;
+typedef vector<std::shared_ptr<SLTexelCache>> SLVTexelCache;
 
 //-----------------------------------------------------------------------------
 // Special constants for anisotropic filtering
@@ -153,6 +156,7 @@ public:
     void     deleteData();
     void     deleteDataGpu();
     void     deleteImages();
+    void     deleteTexelCaches();
     void     bindActive(SLuint texUnit = 0);
     void     fullUpdate();
     void     drawSprite(SLbool doUpdate, SLfloat x, SLfloat y, SLfloat w, SLfloat h);
@@ -191,7 +195,7 @@ public:
     SLuint        texID() const { return _texID; }
     SLTextureType texType() { return _texType; }
     SLfloat       bumpScale() const { return _bumpScale; }
-    SLCol4f       getTexelf(SLfloat u, SLfloat v, SLuint imgIndex = 0);
+    SLCol4f       getTexelf(SLfloat u, SLfloat v, SLuint imgIndex = 0, SLfloat lod = 0.0f);
     SLCol4f       getTexelf(const SLVec3f& cubemapDir);
     SLbool        hasAlpha() { return (!_images.empty() &&
                                 ((_images[0]->format() == PF_rgba ||
@@ -263,6 +267,8 @@ protected:
               SLbool          loadGrayscaleIntoAlpha = false);
     void load(const SLVCol4f& colors);
 
+    std::shared_ptr<SLTexelCache> texelCache(SLuint imgIndex);
+
     CVVImage          _images;         //!< Vector of CVImage pointers
     SLuint            _texID;          //!< OpenGL texture ID
     SLTextureType     _texType;        //!< See SLTextureType
@@ -287,6 +293,8 @@ protected:
     std::atomic<bool> _needsUpdate{};  //!< Flag if image needs an single update
     std::mutex        _mutex;          //!< Mutex to protect parallel access (used in ray tracing)
 
+    std::shared_ptr<const SLVTexelCache> _texelCaches; //!< Tiled copies of _images for getTexelf (only with std::atomic_load/store)
+
     SLbool _deleteImageAfterBuild;     //!< Flag if images should be deleted after build on GPU
     SLbool _compressedTexture = false; //!< True for compressed texture format on GPU
 
@@ -16,6 +16,9 @@
 //-----------------------------------------------------------------------------
 SLuint SLGLVertexArray::totalDrawCalls          = 0;
 SLuint SLGLVertexArray::totalPrimitivesRendered = 0;
+SLuint SLGLVertexArray::totalInstancesRendered  = 0;
+SLuint SLGLVertexArray::_instanceBufferID       = 0;
+SLuint SLGLVertexArray::_instanceBufferSize     = 0;
 //-----------------------------------------------------------------------------
 /*! Constructor initializing with default values
  */
@@ -391,6 +394,122 @@ void SLGLVertexArray::drawElementsAs(SLGLPrimitiveType primitiveType,
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
+/*! Draws the vertex attributes by elements once for every passed instance
+model matrix with one glDrawElementsInstanced call. The matrices are uploaded
+into the shared instance buffer that gets bound to the 4 attribute locations
+of AT_instanceMatrix with a divisor of 1. The shader program must declare the
+attribute a_instanceMatrix (see SLGLProgram::usesInstancing). The VAO itself
+remains unchanged because the instance attributes get disabled again after
+the draw call.
+*/
+void SLGLVertexArray::drawElementsInstanced(SLGLPrimitiveType primitiveType,
+                                            const SLMat4f*    instanceMatrices,
+                                            SLuint            numInstances)
+{
+    assert(_numIndicesElements && _idVBOIndices && "No index VBO generated for VAO");
+    assert(instanceMatrices && numInstances && "No instance matrices");
+
+    glBindVertexArray(_vaoID);
+    GET_GL_ERROR;
+
+    // Upload the matrices into the shared instance buffer
+    SLuint bytes = numInstances * (SLuint)sizeof(SLMat4f);
+    if (!_instanceBufferID)
+    {
+        glGenBuffers(1, &_instanceBufferID);
+        SLGLVertexBuffer::totalBufferCount++;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBufferID);
+    if (bytes > _instanceBufferSize)
+    {
+        SLGLVertexBuffer::totalBufferSize += bytes - _instanceBufferSize;
+        _instanceBufferSize = bytes;
+    }
+    // Orphan the buffer from the last draw call before the upload
+    glBufferData(GL_ARRAY_BUFFER, _instanceBufferSize, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instanceMatrices);
+
+    // A mat4 attribute occupies 4 locations with one column each
+    for (SLuint c = 0; c < 4; ++c)
+    {
+        SLuint loc = AT_instanceMatrix + c;
+        glEnableVertexAttribArray(loc);
+        glVertexAttribPointer(loc,
+                              4,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(SLMat4f),
+                              (void*)(size_t)(c * 4 * sizeof(SLfloat)));
+        glVertexAttribDivisor(loc, 1);
+    }
+    GET_GL_ERROR;
+
+    //////////////////////////////////////////////////////////////
+    glDrawElementsInstanced(primitiveType,
+                            (SLsizei)_numIndicesElements,
+                            _indexDataType,
+                            nullptr,
+                            (SLsizei)numInstances);
+    //////////////////////////////////////////////////////////////
+
+    GET_GL_ERROR;
+    totalDrawCalls++;
+    totalInstancesRendered += numInstances;
+    switch (primitiveType)
+    {
+        case PT_triangles:
+            totalPrimitivesRendered += (_numIndicesElements / 3) * numInstances;
+            break;
+        case PT_lines:
+            totalPrimitivesRendered += (_numIndicesElements / 2) * numInstances;
+            break;
+        case PT_points:
+            totalPrimitivesRendered += _numIndicesElements * numInstances;
+            break;
+        default: break;
+    }
+
+    // Disable the instance attributes so that the VAO draws normally again
+    for (SLuint c = 0; c < 4; ++c)
+    {
+        glVertexAttribDivisor(AT_instanceMatrix + c, 0);
+        glDisableVertexAttribArray(AT_instanceMatrix + c);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // The constant attribute value is undefined after an instanced draw
+    resetInstanceMatrix();
+    GET_GL_ERROR;
+}
+//-----------------------------------------------------------------------------
+/*! Sets the constant value of the disabled attribute a_instanceMatrix to the
+identity matrix. Non instanced draw calls of programs with this attribute
+then transform only with u_mMatrix. Must be called once after the GL context
+is created (see SLGLState::onInitialize).
+*/
+void SLGLVertexArray::resetInstanceMatrix()
+{
+    glVertexAttrib4f(AT_instanceMatrix + 0, 1, 0, 0, 0);
+    glVertexAttrib4f(AT_instanceMatrix + 1, 0, 1, 0, 0);
+    glVertexAttrib4f(AT_instanceMatrix + 2, 0, 0, 1, 0);
+    glVertexAttrib4f(AT_instanceMatrix + 3, 0, 0, 0, 1);
+}
+//-----------------------------------------------------------------------------
+//! Deletes the shared instance buffer (see drawElementsInstanced)
+void SLGLVertexArray::deleteInstanceBuffer()
+{
+    if (_instanceBufferID)
+    {
+        glDeleteBuffers(1, &_instanceBufferID);
+        SLGLVertexBuffer::totalBufferCount--;
+        SLGLVertexBuffer::totalBufferSize -= _instanceBufferSize;
+        _instanceBufferID   = 0;
+        _instanceBufferSize = 0;
+    }
+}
+//-----------------------------------------------------------------------------
 /*! Draws the vertex attributes as a specified primitive type as the vertices
 are defined in the attribute arrays.
 */
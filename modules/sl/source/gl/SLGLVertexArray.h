@@ -13,6 +13,7 @@
 
 #include <SLGLEnums.h>
 #include <SLGLVertexBuffer.h>
+#include <SLMat4.h>
 
 //-----------------------------------------------------------------------------
 //! SLGLVertexArray encapsulates the core OpenGL drawing
@@ -34,7 +35,13 @@
  The VAO has no or one active index buffer. For drawArrayAs no indices are needed.
  For drawElementsAs the index buffer is used. For triangle meshes also hard edges
  are generated. Their indices are stored behind the indices of the triangles.
- See SLMesh::computeHardEdgesIndices for more infos on hard edges.
+ See SLMesh::computeHardEdgesIndices for more infos on hard edges.\n
+ With drawElementsInstanced the same VAO is drawn for multiple model matrices
+ in one draw call. The matrices are streamed into one instance buffer that is
+ shared by all VAOs and bound to the attribute a_instanceMatrix
+ (AT_instanceMatrix) with an attribute divisor of 1. Outside instanced draws
+ the attribute is disabled and its constant value is the identity matrix
+ (see resetInstanceMatrix).
 */
 class SLGLVertexArray
 {
@@ -176,6 +183,11 @@ public:
                         SLuint            numIndexes       = 0,
                         SLuint            indexOffsetBytes = 0);
 
+    //! Draws the VAO by element indices once per instance model matrix
+    void drawElementsInstanced(SLGLPrimitiveType primitiveType,
+                               const SLMat4f*    instanceMatrices,
+                               SLuint            numInstances);
+
     //! Draws the VAO as an array with a primitive type
     void drawArrayAs(SLGLPrimitiveType primitiveType,
                      SLint             firstVertex   = 0,
@@ -192,6 +204,10 @@ public:
     // Some statistics
     static SLuint totalDrawCalls;          //! static total no. of draw calls
     static SLuint totalPrimitivesRendered; //! static total no. of primitives rendered
+    static SLuint totalInstancesRendered;  //! static total no. of instances in instanced draw calls
+
+    static void resetInstanceMatrix();
+    static void deleteInstanceBuffer();
 
 protected:
     SLuint           _vaoID;              //! OpenGL id of vertex array object
@@ -204,6 +220,10 @@ protected:
     SLuint           _numIndicesEdges;    //! NO. of vertex indices in array for hard edges
     void*            _indexDataEdges;     //! Pointer to index data for hard edges
     SLGLBufferType   _indexDataType;      //! index data type (ubyte, ushort, uint)
+
+private:
+    static SLuint _instanceBufferID;   //! OpenGL id of the shared instance matrix buffer
+    static SLuint _instanceBufferSize; //! Size in bytes of the instance matrix buffer
 };
 //-----------------------------------------------------------------------------
 
@@ -10,6 +10,7 @@
 
 #include <SLGLState.h>
 #include <SLGLVertexBuffer.h>
+#include <Profiler.h>
 
 //-----------------------------------------------------------------------------
 SLuint SLGLVertexBuffer::totalBufferSize  = 0;
@@ -316,6 +317,7 @@ void SLGLVertexBuffer::generate(SLuint          numVertices,
 
     totalBufferCount++;
     totalBufferSize += _sizeBytes;
+    PROFILE_COUNTER("GPU vertex upload bytes", _sizeBytes);
     GET_GL_ERROR;
 }
 //-----------------------------------------------------------------------------
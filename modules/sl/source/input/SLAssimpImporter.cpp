@@ -18,6 +18,7 @@
 #    include <SLGLTexture.h>
 #    include <SLMaterial.h>
 #    include <SLAnimSkeleton.h>
+#    include <SLMeshOptimizer.h>
 #    include <SLAssetManager.h>
 #    include <SLAnimManager.h>
 #    include <Profiler.h>
@@ -344,6 +345,8 @@ SLNode* SLAssimpImporter::load(SLAnimManager&     aniMan,                 //!< R
         SLMesh* mesh = loadMesh(assetMgr, scene->mMeshes[i]);
         if (mesh != nullptr)
         {
+            if (_optimizeVertexCache)
+                SLMeshOptimizer::optimize(mesh);
             if (overrideMat)
                 mesh->mat(overrideMat);
             else
@@ -360,6 +363,13 @@ SLNode* SLAssimpImporter::load(SLAnimManager&     aniMan,                 //!< R
     // load the scene nodes recursively
     _sceneRoot = loadNodesRec(nullptr, scene->mRootNode, meshMap, loadMeshesOnly);
 
+    // replace the big meshes by LOD groups with simplified levels
+    if (_generateLODs && _sceneRoot)
+    {
+        SLuint numLODGroups = SLNodeLOD::addLODsRec(_sceneRoot, assetMgr, _lodSettings);
+        logMessage(LV_minimal, "LOD groups generated: %d\n", numLODGroups);
+    }
+
     // load animations
     vector<SLAnimation*> animations;
     for (SLint i = 0; i < (SLint)scene->mNumAnimations; i++)
@@ -370,6 +370,44 @@ SLVec3d SLDeviceLocation::convertLatLonAlt2ENU(SLVec3d locLatLonAlt) const
     return locENU;
 }
 //------------------------------------------------------------------------------
+/*! Converts many wgs84 coordinates to the ENU frame. The altitudes of all
+ positions on the DEM are queried at once with CVImageGeoTiff::getAltitudesAtLatLon
+ so that every tile of a large memory mapped DEM is touched only once.
+ */
+SLVVec3d SLDeviceLocation::convertLatLonAlt2ENU(const SLVVec3d& locLatLonAlts) const
+{
+    SLVVec3d locLatLonAltsDEM = locLatLonAlts;
+
+    if (geoTiffIsAvailableAndValid())
+    {
+        CVVPoint2d     latLonDEG;
+        vector<size_t> indices;
+        for (size_t i = 0; i < locLatLonAlts.size(); ++i)
+        {
+            if (posIsOnGeoTiff(locLatLonAlts[i].x, locLatLonAlts[i].y))
+            {
+                latLonDEG.push_back(cv::Point2d(locLatLonAlts[i].x, locLatLonAlts[i].y));
+                indices.push_back(i);
+            }
+        }
+
+        vector<float> altitudesM;
+        _demGeoTiff.getAltitudesAtLatLon(latLonDEG, altitudesM);
+        for (size_t i = 0; i < indices.size(); ++i)
+            locLatLonAltsDEM[indices[i]].z = altitudesM[i];
+    }
+
+    SLVVec3d locENUs(locLatLonAltsDEM.size());
+    for (size_t i = 0; i < locLatLonAltsDEM.size(); ++i)
+    {
+        SLVec3d locECEF;
+        locECEF.latlonAlt2ecef(locLatLonAltsDEM[i]);
+        locENUs[i] = _wRecef * locECEF;
+    }
+
+    return locENUs;
+}
+//------------------------------------------------------------------------------
 //! Loads a GeoTiff DEM (Digital Elevation Model) Image
 /* Loads a GeoTiff DEM (Digital Elevation Model) Image that must be in WGS84
  coordinates. For more info see CVImageGeoTiff.
@@ -426,7 +464,7 @@ void SLDeviceLocation::loadGeoTiff(const SLstring& geoTiffFile)
 */
 bool SLDeviceLocation::geoTiffIsAvailableAndValid() const
 {
-    return (!_demGeoTiff.cvMat().empty() &&
+    return (_demGeoTiff.isLoaded() &&
             _originLatLonAlt.lat < _demGeoTiff.upperLeftLatLonAlt()[0] &&
             _originLatLonAlt.lat > _demGeoTiff.lowerRightLatLonAlt()[0] &&
             _originLatLonAlt.lon > _demGeoTiff.upperLeftLatLonAlt()[1] &&
@@ -440,7 +478,7 @@ bool SLDeviceLocation::geoTiffIsAvailableAndValid() const
 //! Return true if the current GPS location is within the GeoTiff boundaries
 bool SLDeviceLocation::posIsOnGeoTiff(SLdouble latDEG, SLdouble lonDEG) const
 {
-    return (!_demGeoTiff.empty() &&
+    return (_demGeoTiff.isLoaded() &&
             latDEG < _demGeoTiff.upperLeftLatLonAlt()[0] &&
             latDEG > _demGeoTiff.lowerRightLatLonAlt()[0] &&
             lonDEG > _demGeoTiff.upperLeftLatLonAlt()[1] &&
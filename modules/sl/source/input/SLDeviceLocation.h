@@ -100,6 +100,9 @@ public:
     //! Converter method: the transferred wgs84 coordinate is converted to ENU frame and returned (does not change SLDeviceLocation)
     SLVec3d convertLatLonAlt2ENU(SLVec3d locLatLonAlt) const;
 
+    //! Batch converter for many wgs84 coordinates with one DEM batch query (e.g. for all POIs)
+    SLVVec3d convertLatLonAlt2ENU(const SLVVec3d& locLatLonAlts) const;
+
     // Setters
     void isUsed(SLbool isUsed);
     void useOriginAltitude(SLbool useGLA) { _useOriginAltitude = useGLA; }
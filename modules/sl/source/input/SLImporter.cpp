@@ -17,6 +17,8 @@
 SLImporter::SLImporter()
   : _logConsoleVerbosity(LV_quiet),
     _logFileVerbosity(LV_quiet),
+    _optimizeVertexCache(false),
+    _generateLODs(false),
     _sceneRoot(nullptr),
     _skeleton(nullptr)
 {
@@ -27,6 +29,8 @@ SLImporter::SLImporter()
 SLImporter::SLImporter(SLLogVerbosity consoleVerb)
   : _logConsoleVerbosity(consoleVerb),
     _logFileVerbosity(LV_quiet),
+    _optimizeVertexCache(false),
+    _generateLODs(false),
     _sceneRoot(nullptr),
     _skeleton(nullptr)
 {
@@ -39,6 +43,8 @@ SLImporter::SLImporter(const SLstring& logFile,
                        SLLogVerbosity  logFileVerb)
   : _logConsoleVerbosity(logConsoleVerb),
     _logFileVerbosity(logFileVerb),
+    _optimizeVertexCache(false),
+    _generateLODs(false),
     _sceneRoot(nullptr),
     _skeleton(nullptr)
 {
@@ -18,6 +18,7 @@
 #include <SLAnimation.h>
 #include <SLEnums.h>
 #include <SLMesh.h>
+#include <SLNodeLOD.h>
 
 class SLNode;
 class SLMaterial;
@@ -74,6 +75,12 @@ public:
 
     void logConsoleVerbosity(SLLogVerbosity verb) { _logConsoleVerbosity = verb; }
     void logFileVerbosity(SLLogVerbosity verb) { _logFileVerbosity = verb; }
+    void optimizeVertexCache(SLbool optimize) { _optimizeVertexCache = optimize; }
+    void generateLODs(SLbool generate, const SLNodeLODSettings& settings = SLNodeLODSettings())
+    {
+        _generateLODs = generate;
+        _lodSettings  = settings;
+    }
 
     virtual SLNode* load(SLAnimManager&     aniMan,
                          SLAssetManager*    assetMgr,
@@ -121,10 +128,13 @@ public:
     SLVAnimation&   nodeAnimations() { return _nodeAnimations; }
 
 protected:
-    std::ofstream  _log;                 //!< log stream
-    SLstring       _logFile;             //!< name of the log file
-    SLLogVerbosity _logConsoleVerbosity; //!< verbosity level of log output to the console
-    SLLogVerbosity _logFileVerbosity;    //!< verbosity level of log output to the file
+    std::ofstream     _log;                 //!< log stream
+    SLstring          _logFile;             //!< name of the log file
+    SLLogVerbosity    _logConsoleVerbosity; //!< verbosity level of log output to the console
+    SLLogVerbosity    _logFileVerbosity;    //!< verbosity level of log output to the file
+    SLbool            _optimizeVertexCache; //!< flag to optimize the meshes with SLMeshOptimizer
+    SLbool            _generateLODs;        //!< flag to replace big meshes by generated LOD groups
+    SLNodeLODSettings _lodSettings;         //!< settings of the LOD generation
 
     // the imported data for easy access after importing it
     SLNode*         _sceneRoot;      //!< the root node of the scene
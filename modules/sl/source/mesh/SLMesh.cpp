@@ -17,14 +17,52 @@
 #include <SLAssetManager.h>
 #include <Profiler.h>
 
+#include <climits>
+#include <cstring>
+#include <set>
+#include <thread>
+
 using std::set;
 
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Weverything"
-#include <igl/remove_duplicate_vertices.h>
-#include <igl/per_face_normals.h>
-#include <igl/unique_edge_map.h>
-#pragma clang diagnostic pop
+//-----------------------------------------------------------------------------
+/*!
+ * Calls func(begin, end) for equal ranges of [0, num) on up to
+ * Utils::maxThreads() threads. Small ranges are processed on the calling
+ * thread only.
+ */
+static void parallelFor(SLuint                                    num,
+                        const std::function<void(SLuint, SLuint)>& func)
+{
+    const SLuint minNumPerThread = 4096;
+    SLuint       numThreads      = std::min(Utils::maxThreads(),
+                                 std::max(1u, num / minNumPerThread));
+    if (numThreads <= 1)
+    {
+        func(0, num);
+        return;
+    }
+
+    SLuint         chunk = (num + numThreads - 1) / numThreads;
+    vector<thread> threads;
+    for (SLuint t = 1; t < numThreads; ++t)
+        threads.emplace_back(func,
+                             std::min(num, t * chunk),
+                             std::min(num, (t + 1) * chunk));
+    func(0, std::min(num, chunk));
+    for (auto& thread : threads)
+        thread.join();
+}
+//-----------------------------------------------------------------------------
+//! Mixes the bits of a 64 bit key for the open addressing hash tables
+static inline SLuint64 hashKey(SLuint64 key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
 
 //-----------------------------------------------------------------------------
 /*!
@@ -51,6 +89,7 @@ SLMesh::SLMesh(SLAssetManager* assetMgr, const SLstring& name) : SLObject(name)
     _isVolume               = true;    // is used for RT to decide inside/outside
     _accelStruct            = nullptr; // no initial acceleration structure
     _accelStructIsOutOfDate = true;
+    _isMinMaxOSFrozen       = false;
     _isSelected             = false;
     _edgeAngleDEG           = 30.0f;
     _edgeWidth              = 2.0f;
@@ -67,12 +106,37 @@ SLMesh::SLMesh(SLAssetManager* assetMgr, const SLstring& name) : SLObject(name)
  * The destructor should be called by the owner of the mesh. If an asset manager
  * was passed in the constructor it will do it after scene destruction.
  * The material (SLMaterial) that the mesh uses will not be deallocated.
+ * Nodes that still use the mesh get their mesh pointer reset.
  */
 SLMesh::~SLMesh()
 {
+    vector<SLNode*> nodes;
+    nodes.swap(_nodes);
+    for (auto* node : nodes)
+        node->removeMesh(this);
+
     deleteData();
 }
 //-----------------------------------------------------------------------------
+//! Adds a node to the nodes that use this mesh. Called by SLNode::addMesh.
+void SLMesh::addNode(SLNode* node)
+{
+    if (std::find(_nodes.begin(), _nodes.end(), node) == _nodes.end())
+        _nodes.push_back(node);
+}
+//-----------------------------------------------------------------------------
+//! Removes a node from the nodes that use this mesh
+void SLMesh::removeNode(SLNode* node)
+{
+    auto it = std::find(_nodes.begin(), _nodes.end(), node);
+    if (it != _nodes.end())
+    {
+        // The order of the nodes doesn't matter
+        *it = _nodes.back();
+        _nodes.pop_back();
+    }
+}
+//-----------------------------------------------------------------------------
 //! SLMesh::deleteData deletes all mesh data and vbo's
 void SLMesh::deleteData()
 {
@@ -293,8 +357,6 @@ void SLMesh::init(SLNode* node)
     if (msg.length() > 0)
         SL_EXIT_MSG((msg + "in SLMesh::init: " + _name).c_str());
 
-    if (N.empty()) calcNormals();
-
     // Set default materials if no materials are assigned
     // If colors are available use diffuse color attribute shader
     // otherwise use the default gray material
@@ -306,9 +368,17 @@ void SLMesh::init(SLNode* node)
             mat(SLMaterialDefaultGray::instance());
     }
 
-    // build tangents for bump mapping
-    if (mat()->needsTangents() && !UV[0].empty() && T.empty())
-        calcTangents();
+    // build normals and tangents for bump mapping with the same adjacency
+    SLbool needsTangents = mat()->needsTangents() && !UV[0].empty() && T.empty();
+    if (_primitive == PT_triangles && (N.empty() || needsTangents))
+    {
+        SLVuint offsets, triangles;
+        calcVertexTriangleAdjacency(offsets, triangles);
+        if (N.empty()) calcNormals(offsets, triangles);
+        if (needsTangents) calcTangents(offsets, triangles);
+    }
+    else if (N.empty())
+        calcNormals();
 
     _isSelected = false;
 }
@@ -560,6 +630,63 @@ void SLMesh::draw(SLSceneView* sv, SLNode* node)
         stateGL->blend(true);
 }
 //-----------------------------------------------------------------------------
+/*!
+SLMesh::drawInstanced draws the mesh once for every passed world matrix with a
+single instanced draw call. It is called by SLSceneView::draw3DGLNodes for
+multiple visible nodes that share this mesh. Only the scene view drawing bits
+are applied because all node specific drawing (wire frame, normals, edges,
+voxels, selection) is done in SLMesh::draw. The material program must declare
+the attribute a_instanceMatrix (see SLGLProgram::usesInstancing) that replaces
+the per node u_mMatrix.
+*/
+void SLMesh::drawInstanced(SLSceneView*   sv,
+                           const SLMat4f* wms,
+                           SLuint         numInstances)
+{
+    SLGLState* stateGL = SLGLState::instance();
+
+    if (P.empty() || (I16.empty() && I32.empty()) || !numInstances)
+        return;
+
+    SLGLPrimitiveType primitiveType = _primitive;
+
+    // Set polygon mode & face culling of the scene view
+    if (sv->drawBit(SL_DB_MESHWIRED))
+    {
+#ifdef SL_GLES
+        primitiveType = PT_lineLoop; // There is no polygon line or point mode on ES2!
+#else
+        stateGL->polygonLine(true);
+#endif
+    }
+    else
+        stateGL->polygonLine(false);
+
+    stateGL->cullFace(!sv->drawBit(SL_DB_CULLOFF));
+
+    if (!_vao.vaoID())
+        generateVAO(_vao);
+
+    // Apply mesh material if exists & differs from current
+    _mat->activate(sv->camera(), &sv->s()->lights());
+
+    // The model matrices come per instance, so u_mMatrix is the identity
+    static const SLMat4f identity;
+    SLGLProgram*         sp = _mat->program();
+    sp->uniformMatrix4fv("u_mMatrix", 1, (const SLfloat*)&identity);
+    sp->uniformMatrix4fv("u_vMatrix", 1, (SLfloat*)&stateGL->viewMatrix);
+    sp->uniformMatrix4fv("u_pMatrix", 1, (SLfloat*)&stateGL->projectionMatrix);
+
+    SLint locTM = sp->getUniformLocation("u_tMatrix");
+    if (locTM >= 0)
+    {
+        stateGL->textureMatrix = _mat->textures(TT_diffuse)[0]->tm();
+        sp->uniformMatrix4fv(locTM, 1, (SLfloat*)&stateGL->textureMatrix);
+    }
+
+    _vao.drawElementsInstanced(primitiveType, wms, numInstances);
+}
+//-----------------------------------------------------------------------------
 //! Handles the rectangle section of mesh vertices (partial selection)
 /*
  There are two different selection modes: Full or partial mesh selection.
@@ -747,95 +874,175 @@ void SLMesh::generateVAO(SLGLVertexArray& vao)
  as a sphere there will be no hard edges. The indices of those hard edges are
  stored in the vector IE16 or IE32. For rendering these indices are appended
  behind the indices for the triangle drawing. This is because the index the
- same vertices of the same VAO. See SLMesh::generateVAO for the details.
+ same vertices of the same VAO. See SLMesh::generateVAO for the details.\n
+ Vertices closer than epsilon are welded with a hash table of their quantized
+ positions. The edges of the welded triangles are then collected in a second
+ hash table with their first two faces. Border and non-manifold edges are
+ always hard edges.
  */
 void SLMesh::computeHardEdgesIndices(float angleDEG,
                                      float epsilon)
 {
-#ifndef SL_EMSCRIPTEN
-    // dihedral angle considered to sharp
-    float angleRAD = angleDEG * Utils::DEG2RAD;
-
     if (_primitive != PT_triangles)
         return;
 
-    Eigen::MatrixXf V;     // Input vertices for igl
-    Eigen::MatrixXi F;     // Input faces (=triangle) indices for igl
-    Eigen::MatrixXf newV;  // new vertices after duplicate removal
-    Eigen::MatrixXi newF;  // new face indices after duplicate removal
-    Eigen::MatrixXi edges; // all edges
-    Eigen::MatrixXi edgeMap;
-    Eigen::MatrixXi uniqueEdges;
-    Eigen::MatrixXf faceN; // face normals
-    Eigen::VectorXi SVI;   // new to old index mapping
-    Eigen::VectorXi SVJ;   // old to new index mapping
+    const SLuint  numV     = (SLuint)_finalP->size();
+    const SLuint  numT     = numI() / 3;
+    const SLfloat cosAngle = cos(angleDEG * Utils::DEG2RAD);
 
-    vector<vector<int>> uE2E;
-
-    // fill input matrices
-    V.resize((Eigen::Index)_finalP->size(), 3);
-    for (int i = 0; i < _finalP->size(); i++)
-        V.row(i) << finalP(i).x, finalP(i).y, finalP(i).z;
-
-    if (!I16.empty())
-    {
-        F.resize((Eigen::Index)I16.size() / 3, 3);
-        for (int j = 0, i = 0; i < I16.size(); j++, i += 3)
-            F.row(j) << I16[i], I16[i + 1], I16[i + 2];
-    }
-    if (!I32.empty())
+    // Quantize the positions to multiples of epsilon
+    vector<SLint64> quantized(3 * (size_t)numV);
+    parallelFor(numV, [&](SLuint begin, SLuint end)
+                {
+                    for (SLuint v = begin; v < end; ++v)
+                    {
+                        const SLVec3f& p = (*_finalP)[v];
+                        for (SLuint c = 0; c < 3; ++c)
+                        {
+                            SLint64& q = quantized[3 * (size_t)v + c];
+                            if (epsilon > 0.0f)
+                                q = (SLint64)std::llround(p.comp[c] / epsilon);
+                            else
+                            {
+                                SLfloat f = p.comp[c] + 0.0f; // maps -0 to +0
+                                SLuint  bits;
+                                memcpy(&bits, &f, sizeof(bits));
+                                q = bits;
+                            }
+                        }
+                    }
+                });
+
+    // Weld the vertices with equal quantized positions
+    SLVuint weldedOf(numV);
     {
-        F.resize((Eigen::Index)I32.size() / 3, 3);
-        for (int j = 0, i = 0; i < I32.size(); j++, i += 3)
-            F.row(j) << I32[i], I32[i + 1], I32[i + 2];
+        SLuint  mask = Utils::nextPowerOf2(2 * numV + 1) - 1;
+        SLVuint table(mask + 1, UINT_MAX);
+        for (SLuint v = 0; v < numV; ++v)
+        {
+            const SLint64* q = &quantized[3 * (size_t)v];
+            SLuint64       h = hashKey((SLuint64)q[0] * 73856093ull ^
+                                 (SLuint64)q[1] * 19349663ull ^
+                                 (SLuint64)q[2] * 83492791ull);
+            SLuint         slot = (SLuint)h & mask;
+            while (table[slot] != UINT_MAX &&
+                   memcmp(&quantized[3 * (size_t)table[slot]], q, 3 * sizeof(SLint64)) != 0)
+                slot = (slot + 1) & mask;
+            if (table[slot] == UINT_MAX)
+                table[slot] = v;
+            weldedOf[v] = table[slot];
+        }
     }
 
-    // extract sharp edges
-    igl::remove_duplicate_vertices(V, F, epsilon, newV, SVI, SVJ, newF);
-    igl::per_face_normals(newV, newF, faceN);
-    igl::unique_edge_map(newF, edges, uniqueEdges, edgeMap, uE2E);
+    // Normalized face normals
+    SLVVec3f faceN(numT);
+    auto     calcFaceNormals = [&](const auto& I)
+    {
+        parallelFor(numT, [&](SLuint begin, SLuint end)
+                    {
+                        for (SLuint t = begin; t < end; ++t)
+                        {
+                            const SLVec3f& A = (*_finalP)[I[3 * t]];
+                            const SLVec3f& B = (*_finalP)[I[3 * t + 1]];
+                            const SLVec3f& C = (*_finalP)[I[3 * t + 2]];
+                            faceN[t].cross(B - A, C - A);
+                            SLfloat len = faceN[t].length();
+                            if (len > 0.0f) faceN[t] /= len;
+                        }
+                    });
+    };
+
+    // Edge hash table with the first two faces of every edge
+    const SLuint NO_FACE     = UINT_MAX;
+    const SLuint NONMANIFOLD = UINT_MAX - 1;
+    const SLuint EMITTED     = UINT_MAX - 2;
+    struct SLEdgeEntry
+    {
+        SLuint64 key;
+        SLuint   f0, f1;
+    };
+    SLuint              edgeMask = Utils::nextPowerOf2(3 * numT) - 1;
+    vector<SLEdgeEntry> edges(edgeMask + 1, {UINT64_MAX, NO_FACE, NO_FACE});
 
-    for (int u = 0; u < uE2E.size(); u++)
+    auto findEdge = [&](SLuint a, SLuint b) -> SLEdgeEntry&
+    {
+        SLuint64 key  = a < b ? ((SLuint64)a << 32) | b : ((SLuint64)b << 32) | a;
+        SLuint   slot = (SLuint)hashKey(key) & edgeMask;
+        while (edges[slot].key != UINT64_MAX && edges[slot].key != key)
+            slot = (slot + 1) & edgeMask;
+        edges[slot].key = key;
+        return edges[slot];
+    };
+
+    auto collectHardEdges = [&](const auto& I, auto& IE)
     {
-        bool sharp = false;
-        if (uE2E[u].size() == 1) // edges at the border (with only one triangle)
-            sharp = true;
+        calcFaceNormals(I);
+
+        // Triangles with welded corners have no valid edges
+        auto isDegenerated = [&](SLuint t)
+        {
+            SLuint a = weldedOf[I[3 * t]];
+            SLuint b = weldedOf[I[3 * t + 1]];
+            SLuint c = weldedOf[I[3 * t + 2]];
+            return a == b || b == c || c == a;
+        };
 
-        // if more than one edge is passing here, compute dihedral angles
-        for (int i = 0; i < uE2E[u].size(); i++)
+        for (SLuint t = 0; t < numT; ++t)
         {
-            for (int j = i + 1; j < uE2E[u].size(); j++)
+            if (isDegenerated(t)) continue;
+
+            for (SLuint c = 0; c < 3; ++c)
             {
-                // E[faceId + |F| * c] opposite of vertex F[faceId][c]
-                // ei = fi + |F| * c -> ei % |F| = fi % |F| = fi; fi is the face adjacent to ei
-                // ej = fj + |F| * c -> ej % |F| = fj % |F| = fj; fj is the face adjacent to ej
-                const int                  ei  = uE2E[u][i]; // edge i
-                const int                  fi  = ei % newF.rows();
-                const int                  ej  = uE2E[u][j]; // edge j
-                const int                  fj  = ej % newF.rows();
-                Eigen::Matrix<float, 1, 3> ni  = faceN.row(fi);
-                Eigen::Matrix<float, 1, 3> nj  = faceN.row(fj);
-                Eigen::Matrix<float, 1, 3> ev  = (newV.row(edges(ei, 1)) - newV.row(edges(ei, 0))).normalized();
-                float                      dij = Utils::PI - atan2((ni.cross(nj)).dot(ev), ni.dot(nj));
-                sharp                          = std::abs(dij - Utils::PI) > angleRAD;
+                SLuint       a    = weldedOf[I[3 * t + c]];
+                SLuint       b    = weldedOf[I[3 * t + (c + 1) % 3]];
+                SLEdgeEntry& edge = findEdge(a, b);
+                if (edge.f0 == NO_FACE)
+                    edge.f0 = t;
+                else if (edge.f1 == NO_FACE)
+                    edge.f1 = t;
+                else
+                    edge.f1 = NONMANIFOLD;
             }
         }
 
-        if (sharp)
+        // Emit the hard edges in the order of their first triangle
+        for (SLuint t = 0; t < numT; ++t)
         {
-            if (!I16.empty())
-            {
-                IE16.push_back(SVI[uniqueEdges(u, 0)]);
-                IE16.push_back(SVI[uniqueEdges(u, 1)]);
-            }
-            else if (!I32.empty())
+            if (isDegenerated(t)) continue;
+
+            for (SLuint c = 0; c < 3; ++c)
             {
-                IE32.push_back(SVI[uniqueEdges(u, 0)]);
-                IE32.push_back(SVI[uniqueEdges(u, 1)]);
+                SLuint       i0   = I[3 * t + c];
+                SLuint       i1   = I[3 * t + (c + 1) % 3];
+                SLEdgeEntry& edge = findEdge(weldedOf[i0], weldedOf[i1]);
+                if (edge.f1 == EMITTED) continue;
+
+                SLbool isHard;
+                if (edge.f1 == NO_FACE || edge.f1 == NONMANIFOLD)
+                    isHard = true;
+                else
+                {
+                    const SLVec3f& n0 = faceN[edge.f0];
+                    const SLVec3f& n1 = faceN[edge.f1];
+                    isHard            = n0 != SLVec3f::ZERO &&
+                             n1 != SLVec3f::ZERO &&
+                             n0.dot(n1) < cosAngle;
+                }
+
+                if (isHard)
+                {
+                    IE.push_back(I[3 * t + c]);
+                    IE.push_back(I[3 * t + (c + 1) % 3]);
+                    edge.f1 = EMITTED;
+                }
             }
         }
-    }
-#endif
+    };
+
+    if (!I16.empty())
+        collectHardEdges(I16, IE16);
+    else if (!I32.empty())
+        collectHardEdges(I32, IE32);
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -869,6 +1076,45 @@ SLbool SLMesh::hit(SLRay* ray, SLNode* node)
 }
 //-----------------------------------------------------------------------------
 /*!
+SLMesh::hitAny does the any hit ray-mesh intersection test for shadow rays. It
+returns true as soon as a triangle blocks the ray within its length (the
+distance to the light). The closest hit is not searched. Meshes with a
+transparent material do not block the ray completely: For them the closest
+hit is searched with SLMesh::hit and false is returned, so that the shadow
+test can still evaluate the transparency at the closest hit.
+*/
+SLbool SLMesh::hitAny(SLRay* ray, SLNode* node)
+{
+    // point & line objects block if their center is before the light
+    if (_primitive != PT_triangles)
+    {
+        SLVec3f OC    = node->aabb()->centerWS() - ray->origin;
+        SLfloat distC = OC.length();
+        if (distC >= ray->length)
+            return false;
+        ray->hitNode = node;
+        ray->hitMesh = this;
+        ray->length  = distC;
+        return true;
+    }
+
+    if (_mat && _mat->hasAlpha())
+    {
+        hit(ray, node);
+        return false;
+    }
+
+    if (_accelStruct)
+        return _accelStruct->intersectAny(ray, node);
+
+    for (SLuint t = 0; t < numI(); t += 3)
+        if (hitTriangleOS(ray, node, t))
+            return true;
+
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*!
 SLMesh::updateStats updates the parent node statistics.
 */
 void SLMesh::addStats(SLNodeStats& stats)
@@ -890,6 +1136,16 @@ void SLMesh::addStats(SLNodeStats& stats)
 
     stats.numMeshes++;
     if (_primitive == PT_triangles) stats.numTriangles += numI() / 3;
+    if (_optStats.isOptimized)
+    {
+        SLuint numT = numI() / 3;
+        stats.numMeshesOptimized++;
+        stats.numTrianglesOptimized += numT;
+        stats.numCacheMissesBefore += _optStats.acmrBefore * (SLfloat)numT;
+        stats.numCacheMissesAfter += _optStats.acmrAfter * (SLfloat)numT;
+        stats.numBytesBeforeOpt += _optStats.numBytesBefore;
+        stats.numBytesAfterOpt += _optStats.numBytesAfter;
+    }
     if (_primitive == PT_lines) stats.numLines += numI() / 2;
 
     if (_accelStruct)
@@ -1030,9 +1286,23 @@ void SLMesh::calcCenterRad(SLVec3f& center, SLfloat& radius)
 //-----------------------------------------------------------------------------
 /*!
 SLMesh::buildAABB builds the passed axis-aligned bounding box in OS and updates
-the min & max points in WS with the passed WM of the node.
+the min & max points in WS with the passed WM of the node. If the min & max
+points are frozen (see freezeMinMaxOS) they are only read, so that buildAABB
+can be called from multiple threads for nodes that share this mesh.
 */
 void SLMesh::buildAABB(SLAABBox& aabb, const SLMat4f& wmNode)
+{
+    if (!_isMinMaxOSFrozen)
+        buildMinMaxOS();
+
+    // Apply world matrix
+    aabb.fromOStoWS(minP, maxP, wmNode);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::buildMinMaxOS updates the min & max points in OS for buildAABB.
+*/
+void SLMesh::buildMinMaxOS()
 {
     // Update acceleration struct and calculate min max
     if (_skeleton)
@@ -1047,8 +1317,17 @@ void SLMesh::buildAABB(SLAABBox& aabb, const SLMat4f& wmNode)
         if (_accelStructIsOutOfDate)
             updateAccelStruct();
     }
-    // Apply world matrix
-    aabb.fromOStoWS(minP, maxP, wmNode);
+}
+//-----------------------------------------------------------------------------
+/*!
+SLMesh::freezeMinMaxOS updates the min & max points once and freezes them until
+it is called with false. Used by SLNode::updateAABBRecParallel.
+*/
+void SLMesh::freezeMinMaxOS(SLbool freeze)
+{
+    if (freeze && !_isMinMaxOSFrozen)
+        buildMinMaxOS();
+    _isMinMaxOSFrozen = freeze;
 }
 //-----------------------------------------------------------------------------
 /*! SLMesh::updateAccelStruct rebuilds the acceleration structure if the dirty
@@ -1077,6 +1356,39 @@ void SLMesh::updateAccelStruct()
     }
 }
 //-----------------------------------------------------------------------------
+//! SLMesh::calcVertexTriangleAdjacency builds the triangles of every vertex
+/*! The triangle indices of vertex v are stored in triangles between
+offsets[v] and offsets[v+1]. The adjacency is built with a counting sort
+with only two allocations and can be shared by calcNormals and calcTangents.
+*/
+void SLMesh::calcVertexTriangleAdjacency(SLVuint& offsets,
+                                         SLVuint& triangles) const
+{
+    SLuint numV = (SLuint)P.size();
+    offsets.assign(numV + 1, 0);
+    triangles.resize(numI());
+
+    auto build = [&](const auto& I)
+    {
+        for (auto i : I)
+            offsets[i + 1]++;
+        for (SLuint v = 0; v < numV; ++v)
+            offsets[v + 1] += offsets[v];
+        for (SLuint i = 0; i < (SLuint)I.size(); ++i)
+            triangles[offsets[I[i]]++] = i / 3;
+
+        // The offsets got shifted by one vertex while filling
+        for (SLuint v = numV; v > 0; --v)
+            offsets[v] = offsets[v - 1];
+        offsets[0] = 0;
+    };
+
+    if (!I16.empty())
+        build(I16);
+    else
+        build(I32);
+}
+//-----------------------------------------------------------------------------
 //! SLMesh::calcNormals recalculates vertex normals for triangle meshes.
 /*! SLMesh::calcNormals recalculates the normals only from the vertices.
 This algorithms doesn't know anything about smoothgroups. It just loops over
@@ -1094,55 +1406,62 @@ void SLMesh::calcNormals()
     if (_primitive != PT_triangles)
         return;
 
-    // Create vector and fill with zero vectors
-    N.resize(P.size());
-    std::fill(N.begin(), N.end(), SLVec3f::ZERO);
-
-    if (!I16.empty())
-    {
-        // Loop over all triangles
-        for (SLulong i = 0; i < I16.size(); i += 3)
-        {
-            // Calculate the face's normal
-            SLVec3f e1, e2, n;
+    SLVuint offsets, triangles;
+    calcVertexTriangleAdjacency(offsets, triangles);
+    calcNormals(offsets, triangles);
+}
+//-----------------------------------------------------------------------------
+/*! The face normals are calculated in parallel first. Every vertex normal is
+then gathered from the face normals of its triangles, so that no two threads
+write to the same normal.
+*/
+void SLMesh::calcNormals(const SLVuint& offsets, const SLVuint& triangles)
+{
+    N.clear();
 
-            // Calculate edges of triangle
-            e1.sub(P[I16[i + 1]], P[I16[i + 2]]); // e1 = B - C
-            e2.sub(P[I16[i + 1]], P[I16[i]]);     // e2 = B - A
+    if (_primitive != PT_triangles)
+        return;
 
-            // Build normal with cross product but do NOT normalize it.
-            n.cross(e1, e2); // n = e1 x e2
+    SLuint   numT = numI() / 3;
+    SLVVec3f faceN(numT);
 
-            // Add this normal to its vertices normals
-            N[I16[i]] += n;
-            N[I16[i + 1]] += n;
-            N[I16[i + 2]] += n;
-        }
-    }
-    else
+    auto calcFaceNormals = [&](const auto& I)
     {
-        for (SLulong i = 0; i < I32.size(); i += 3)
-        {
-            // Calculate the face's normal
-            SLVec3f e1, e2, n;
-
-            // Calculate edges of triangle
-            e1.sub(P[I32[i + 1]], P[I32[i + 2]]); // e1 = B - C
-            e2.sub(P[I32[i + 1]], P[I32[i]]);     // e2 = B - A
-
-            // Build normal with cross product but do NOT normalize it.
-            n.cross(e1, e2); // n = e1 x e2
+        parallelFor(numT, [&](SLuint begin, SLuint end)
+                    {
+                        for (SLuint t = begin; t < end; ++t)
+                        {
+                            SLuint i = 3 * t;
+
+                            // Calculate edges of triangle
+                            SLVec3f e1, e2;
+                            e1.sub(P[I[i + 1]], P[I[i + 2]]); // e1 = B - C
+                            e2.sub(P[I[i + 1]], P[I[i]]);     // e2 = B - A
+
+                            // Build normal with cross product but do NOT normalize it.
+                            faceN[t].cross(e1, e2); // n = e1 x e2
+                        }
+                    });
+    };
 
-            // Add this normal to its vertices normals
-            N[I32[i]] += n;
-            N[I32[i + 1]] += n;
-            N[I32[i + 2]] += n;
-        }
-    }
+    if (!I16.empty())
+        calcFaceNormals(I16);
+    else
+        calcFaceNormals(I32);
 
-    // normalize vertex normals
-    for (SLulong i = 0; i < P.size(); ++i)
-        N[i].normalize();
+    // Sum up and normalize the face normals of each vertex
+    N.resize(P.size());
+    parallelFor((SLuint)P.size(), [&](SLuint begin, SLuint end)
+                {
+                    for (SLuint v = begin; v < end; ++v)
+                    {
+                        SLVec3f n = SLVec3f::ZERO;
+                        for (SLuint a = offsets[v]; a < offsets[v + 1]; ++a)
+                            n += faceN[triangles[a]];
+                        n.normalize();
+                        N[v] = n;
+                    }
+                });
 }
 //-----------------------------------------------------------------------------
 //! SLMesh::calcTangents computes the tangents per vertex for triangle meshes.
@@ -1151,6 +1470,19 @@ for GLSL normal map bump mapping. The code and mathematical derivation is in
 detail explained in: http://www.terathon.com/code/tangent.html
 */
 void SLMesh::calcTangents()
+{
+    if (_primitive != PT_triangles)
+        return;
+
+    SLVuint offsets, triangles;
+    calcVertexTriangleAdjacency(offsets, triangles);
+    calcTangents(offsets, triangles);
+}
+//-----------------------------------------------------------------------------
+/*! The tangent directions are calculated per triangle in parallel and then
+gathered per vertex like in calcNormals.
+*/
+void SLMesh::calcTangents(const SLVuint& offsets, const SLVuint& triangles)
 {
     if (!P.empty() &&
         !N.empty() && !UV[0].empty() &&
@@ -1162,78 +1494,74 @@ void SLMesh::calcTangents()
         if (_primitive != PT_triangles)
             return;
 
-        // allocate tangents
-        T.resize(P.size());
-
-        // allocate temp arrays for tangents
-        SLVVec3f T1;
-        T1.resize(P.size());
-        fill(T1.begin(), T1.end(), SLVec3f::ZERO);
-        SLVVec3f T2;
-        T2.resize(P.size());
-        fill(T2.begin(), T2.end(), SLVec3f::ZERO);
+        SLuint   numT = numI() / 3; // NO. of triangles
+        SLVVec3f sdirs(numT);
+        SLVVec3f tdirs(numT);
 
-        SLuint iVA, iVB, iVC;
-        SLuint numT = numI() / 3; // NO. of triangles
-
-        for (SLuint t = 0; t < numT; ++t)
+        auto calcDirections = [&](const auto& I)
         {
-            SLuint i = t * 3; // vertex index
+            parallelFor(numT, [&](SLuint begin, SLuint end)
+                        {
+                            for (SLuint t = begin; t < end; ++t)
+                            {
+                                // Get the 3 vertex indices
+                                SLuint iVA = I[3 * t];
+                                SLuint iVB = I[3 * t + 1];
+                                SLuint iVC = I[3 * t + 2];
+
+                                float x1 = P[iVB].x - P[iVA].x;
+                                float x2 = P[iVC].x - P[iVA].x;
+                                float y1 = P[iVB].y - P[iVA].y;
+                                float y2 = P[iVC].y - P[iVA].y;
+                                float z1 = P[iVB].z - P[iVA].z;
+                                float z2 = P[iVC].z - P[iVA].z;
+
+                                float s1 = UV[0][iVB].x - UV[0][iVA].x;
+                                float s2 = UV[0][iVC].x - UV[0][iVA].x;
+                                float t1 = UV[0][iVB].y - UV[0][iVA].y;
+                                float t2 = UV[0][iVC].y - UV[0][iVA].y;
+
+                                float r = 1.0F / (s1 * t2 - s2 * t1);
+                                sdirs[t].set((t2 * x1 - t1 * x2) * r,
+                                             (t2 * y1 - t1 * y2) * r,
+                                             (t2 * z1 - t1 * z2) * r);
+                                tdirs[t].set((s1 * x2 - s2 * x1) * r,
+                                             (s1 * y2 - s2 * y1) * r,
+                                             (s1 * z2 - s2 * z1) * r);
+                            }
+                        });
+        };
 
-            // Get the 3 vertex indices
-            if (!I16.empty())
-            {
-                iVA = I16[i];
-                iVB = I16[i + 1];
-                iVC = I16[i + 2];
-            }
-            else
-            {
-                iVA = I32[i];
-                iVB = I32[i + 1];
-                iVC = I32[i + 2];
-            }
+        if (!I16.empty())
+            calcDirections(I16);
+        else
+            calcDirections(I32);
 
-            float x1 = P[iVB].x - P[iVA].x;
-            float x2 = P[iVC].x - P[iVA].x;
-            float y1 = P[iVB].y - P[iVA].y;
-            float y2 = P[iVC].y - P[iVA].y;
-            float z1 = P[iVB].z - P[iVA].z;
-            float z2 = P[iVC].z - P[iVA].z;
-
-            float s1 = UV[0][iVB].x - UV[0][iVA].x;
-            float s2 = UV[0][iVC].x - UV[0][iVA].x;
-            float t1 = UV[0][iVB].y - UV[0][iVA].y;
-            float t2 = UV[0][iVC].y - UV[0][iVA].y;
-
-            float   r = 1.0F / (s1 * t2 - s2 * t1);
-            SLVec3f sdir((t2 * x1 - t1 * x2) * r,
-                         (t2 * y1 - t1 * y2) * r,
-                         (t2 * z1 - t1 * z2) * r);
-            SLVec3f tdir((s1 * x2 - s2 * x1) * r,
-                         (s1 * y2 - s2 * y1) * r,
-                         (s1 * z2 - s2 * z1) * r);
-
-            T1[iVA] += sdir;
-            T1[iVB] += sdir;
-            T1[iVC] += sdir;
-
-            T2[iVA] += tdir;
-            T2[iVB] += tdir;
-            T2[iVC] += tdir;
-        }
+        // allocate tangents
+        T.resize(P.size());
 
-        for (SLulong i = 0; i < P.size(); ++i)
-        {
-            // Gram-Schmidt orthogonalization
-            T[i] = T1[i] - N[i] * N[i].dot(T1[i]);
-            T[i].normalize();
-
-            // Calculate temp. bi-tangent and store its handedness in T.w
-            SLVec3f bitangent;
-            bitangent.cross(N[i], T1[i]);
-            T[i].w = (bitangent.dot(T2[i]) < 0.0f) ? -1.0f : 1.0f;
-        }
+        parallelFor((SLuint)P.size(), [&](SLuint begin, SLuint end)
+                    {
+                        for (SLuint i = begin; i < end; ++i)
+                        {
+                            SLVec3f T1 = SLVec3f::ZERO;
+                            SLVec3f T2 = SLVec3f::ZERO;
+                            for (SLuint a = offsets[i]; a < offsets[i + 1]; ++a)
+                            {
+                                T1 += sdirs[triangles[a]];
+                                T2 += tdirs[triangles[a]];
+                            }
+
+                            // Gram-Schmidt orthogonalization
+                            T[i] = T1 - N[i] * N[i].dot(T1);
+                            T[i].normalize();
+
+                            // Calculate temp. bi-tangent and store its handedness in T.w
+                            SLVec3f bitangent;
+                            bitangent.cross(N[i], T1);
+                            T[i].w = (bitangent.dot(T2) < 0.0f) ? -1.0f : 1.0f;
+                        }
+                    });
     }
 }
 //-----------------------------------------------------------------------------
@@ -118,6 +118,21 @@ called skinning and is done in CPU in the method transformSkin. The final
 transformed vertices and normals are stored in _finalP and _finalN.
 */
 
+//-----------------------------------------------------------------------------
+//! Statistics of the vertex cache and overdraw optimization of a mesh
+/*! The values are set by SLMeshOptimizer::optimize and are summed up in
+SLMesh::addStats. The ACMR (average cache miss ratio) is the no. of
+post-transform vertex cache misses per triangle.
+*/
+struct SLMeshOptStats
+{
+    SLbool  isOptimized    = false; //!< Flag if the mesh was optimized
+    SLfloat acmrBefore     = 0.0f;  //!< ACMR before the optimization
+    SLfloat acmrAfter      = 0.0f;  //!< ACMR after the optimization
+    SLuint  numBytesBefore = 0;     //!< NO. of vertex and index bytes before
+    SLuint  numBytesAfter  = 0;     //!< NO. of vertex and index bytes after
+};
+//-----------------------------------------------------------------------------
 class SLMesh : public SLObject
 #ifdef SL_HAS_OPTIX
   , public SLOptixAccelStruct
@@ -131,13 +146,19 @@ public:
 
     virtual void init(SLNode* node);
     virtual void draw(SLSceneView* sv, SLNode* node);
+    void         drawInstanced(SLSceneView*   sv,
+                               const SLMat4f* wms,
+                               SLuint         numInstances);
     void         drawIntoDepthBuffer(SLSceneView* sv,
                                      SLNode*      node,
                                      SLMaterial*  depthMat);
     void         addStats(SLNodeStats& stats);
     virtual void buildAABB(SLAABBox& aabb, const SLMat4f& wmNode);
+    virtual void buildMinMaxOS();
+    void         freezeMinMaxOS(SLbool freeze);
     void         updateAccelStruct();
     SLbool       hit(SLRay* ray, SLNode* node);
+    SLbool       hitAny(SLRay* ray, SLNode* node);
     virtual void preShade(SLRay* ray);
 
     virtual void deleteData();
@@ -147,12 +168,17 @@ public:
     static void  calcTex3DMatrix(SLNode* node);
     virtual void calcMinMax();
     virtual void calcNormals();
+    void         calcTangents();
+    void         calcVertexTriangleAdjacency(SLVuint& offsets,
+                                             SLVuint& triangles) const;
     void         calcCenterRad(SLVec3f& center, SLfloat& radius);
     SLbool       hitTriangleOS(SLRay* ray, SLNode* node, SLuint iT);
     virtual void generateVAO(SLGLVertexArray& vao);
     void         computeHardEdgesIndices(float angleRAD, float epsilon);
     void         transformSkin(const std::function<void(SLMesh*)>& cbInformNodes);
     void         deselectPartialSelection();
+    void         addNode(SLNode* node);
+    void         removeNode(SLNode* node);
 
 #ifdef SL_HAS_OPTIX
     void                allocAndUploadData();
@@ -178,6 +204,10 @@ public:
     SLVec3f               finalP(SLuint i) { return _finalP->operator[](i); }
     SLVec3f               finalN(SLuint i) { return _finalN->operator[](i); }
     SLbool                accelStructIsOutOfDate() { return _accelStructIsOutOfDate; }
+    const SLMeshOptStats& optStats() const { return _optStats; }
+
+    //! Returns the nodes that use this mesh (mesh to nodes index)
+    const vector<SLNode*>& nodes() const { return _nodes; }
 
     // Setters
     void mat(SLMaterial* m) { _mat = m; }
@@ -189,6 +219,7 @@ public:
     void edgeAngleDEG(SLfloat ea) { _edgeAngleDEG = ea; }
     void edgeColor(const SLCol4f& ec) { _edgeColor = ec; }
     void vertexPosEpsilon(SLfloat eps) { _vertexPosEpsilon = eps; }
+    void optStats(const SLMeshOptStats& os) { _optStats = os; }
 
     // vertex attributes
     SLVVec3f  P;        //!< Vector for vertex positions                   layout (location = 0)
@@ -212,7 +243,8 @@ public:
     SLVec3f maxP; //!< max. vertex in OS
 
 private:
-    void calcTangents();
+    void calcNormals(const SLVuint& offsets, const SLVuint& triangles);
+    void calcTangents(const SLVuint& offsets, const SLVuint& triangles);
     void drawSelectedVertices();
     void handleRectangleSelection(SLSceneView* sv,
                                   SLGLState*   stateGL,
@@ -248,6 +280,9 @@ protected:
     SLVMat4f        _jointMatrices;          //!< Joint matrix vector for this mesh
     SLVVec3f*       _finalP;                 //!< Pointer to final vertex position vector
     SLVVec3f*       _finalN;                 //!< pointer to final vertex normal vector
+    SLMeshOptStats  _optStats;               //!< Vertex cache optimization statistics
+    vector<SLNode*> _nodes;                  //!< Nodes that use this mesh (see SLNode::addMesh)
+    SLbool          _isMinMaxOSFrozen;       //!< Flag if minP & maxP are frozen (see freezeMinMaxOS)
 };
 //-----------------------------------------------------------------------------
 typedef vector<SLMesh*> SLVMesh;
@@ -0,0 +1,390 @@
+//#############################################################################
+//  File:      SLMeshOptimizer.cpp
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <SLMeshOptimizer.h>
+#include <algorithm>
+#include <climits>
+
+//-----------------------------------------------------------------------------
+//! FIFO model of a post-transform vertex cache
+class SLVertexCacheFIFO
+{
+public:
+    SLVertexCacheFIFO(SLuint numVertices, SLuint cacheSize)
+      : _cacheSize(cacheSize),
+        _time(cacheSize + 1),
+        _timeOf(numVertices, 0) {}
+
+    //! Returns 1 if the vertex v was not in the cache and adds it
+    SLuint miss(SLuint v)
+    {
+        if (_time - _timeOf[v] <= _cacheSize) return 0;
+        _timeOf[v] = _time++;
+        return 1;
+    }
+
+    //! Empties the cache
+    void reset() { _time += _cacheSize + 1; }
+
+private:
+    SLuint  _cacheSize; //!< No. of vertices in the cache
+    SLuint  _time;      //!< Time stamp incremented on every miss
+    SLVuint _timeOf;    //!< Time stamp of the last miss per vertex
+};
+//-----------------------------------------------------------------------------
+/*!
+ * Simulates a FIFO vertex cache and returns the average no. of cache misses
+ * per triangle (ACMR). The best possible value is about 0.5 for regular
+ * triangle grids and the worst is 3.
+ */
+SLfloat SLMeshOptimizer::calcACMR(const SLVuint& indices,
+                                  SLuint         numVertices,
+                                  SLuint         cacheSize)
+{
+    if (indices.size() < 3) return 0.0f;
+
+    SLVertexCacheFIFO cache(numVertices, cacheSize);
+    SLuint            numMisses = 0;
+    for (auto i : indices)
+        numMisses += cache.miss(i);
+    return (SLfloat)numMisses / (SLfloat)(indices.size() / 3);
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Reorders the triangles for the post-transform vertex cache with the Tipsify
+ * algorithm: The triangles around a fanning vertex are emitted and the next
+ * fanning vertex is chosen among the vertices of the emitted triangles that
+ * will still be in the cache after their remaining triangles are emitted.
+ * If there is no such vertex, the algorithm restarts at a vertex from the
+ * dead-end stack or at the next vertex with remaining triangles.
+ * @param indices Triangle indices to reorder in place
+ * @param numVertices No. of vertices
+ * @param cacheSize No. of vertices in the cache
+ * @param clusters Resulting start triangles of the clusters between restarts
+ */
+void SLMeshOptimizer::optimizeVertexCache(SLVuint& indices,
+                                          SLuint   numVertices,
+                                          SLuint   cacheSize,
+                                          SLVuint& clusters)
+{
+    SLuint numT = (SLuint)indices.size() / 3;
+    clusters.clear();
+    if (numT == 0) return;
+
+    // Triangle adjacency and no. of live triangles per vertex
+    SLVuint live(numVertices, 0);
+    for (auto i : indices)
+        live[i]++;
+    SLVuint offsets(numVertices + 1, 0);
+    for (SLuint v = 0; v < numVertices; ++v)
+        offsets[v + 1] = offsets[v] + live[v];
+    SLVuint adjacency(indices.size());
+    SLVuint fill(offsets.begin(), offsets.end() - 1);
+    for (SLuint i = 0; i < indices.size(); ++i)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    SLVuint cacheTime(numVertices, 0);
+    SLVbool emitted(numT, false);
+    SLVuint deadEnd;
+    SLVuint candidates;
+    SLVuint result;
+    deadEnd.reserve(indices.size());
+    result.reserve(indices.size());
+
+    SLuint time   = cacheSize + 1;
+    SLuint cursor = 0;
+    SLint  fan    = (SLint)indices[0];
+    clusters.push_back(0);
+
+    while (fan >= 0)
+    {
+        // Emit all remaining triangles around the fanning vertex
+        candidates.clear();
+        for (SLuint a = offsets[fan]; a < offsets[fan + 1]; ++a)
+        {
+            SLuint t = adjacency[a];
+            if (emitted[t]) continue;
+
+            for (SLuint c = 0; c < 3; ++c)
+            {
+                SLuint v = indices[3 * t + c];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // Prefer the oldest candidate that stays in the cache
+        SLint next         = -1;
+        SLint bestPriority = -1;
+        for (auto v : candidates)
+        {
+            if (live[v] == 0) continue;
+
+            SLint priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                priority = (SLint)(time - cacheTime[v]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                next         = (SLint)v;
+            }
+        }
+
+        // Dead end: Restart at a recent vertex or at the next vertex left
+        if (next == -1)
+        {
+            while (!deadEnd.empty() && next == -1)
+            {
+                SLuint v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) next = (SLint)v;
+            }
+            while (next == -1 && cursor < numVertices)
+            {
+                if (live[cursor] > 0) next = (SLint)cursor;
+                cursor++;
+            }
+            if (next != -1)
+                clusters.push_back((SLuint)result.size() / 3);
+        }
+
+        fan = next;
+    }
+
+    indices.swap(result);
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Reorders the triangle clusters from the outside to the inside to reduce
+ * the overdraw. First the clusters of the vertex cache optimization are split
+ * further wherever the ACMR of the cluster so far is below the ACMR of the
+ * whole cluster times the threshold. Then the clusters are sorted by the
+ * distance of their centroid to the mesh centroid along the cluster normal.
+ * @param indices Triangle indices optimized by optimizeVertexCache
+ * @param positions Vertex positions
+ * @param clusters Start triangles of the clusters (get refined)
+ * @param cacheSize No. of vertices in the cache
+ * @param threshold Allowed ACMR degradation (e.g. 1.05 for 5%)
+ */
+void SLMeshOptimizer::optimizeOverdraw(SLVuint&        indices,
+                                       const SLVVec3f& positions,
+                                       SLVuint&        clusters,
+                                       SLuint          cacheSize,
+                                       SLfloat         threshold)
+{
+    SLuint numT = (SLuint)indices.size() / 3;
+    if (numT == 0 || clusters.empty()) return;
+
+    // Split the hard clusters where the cache efficiency allows it
+    SLVertexCacheFIFO cache((SLuint)positions.size(), cacheSize);
+    SLVuint           softClusters;
+    for (SLuint c = 0; c < clusters.size(); ++c)
+    {
+        SLuint begin = clusters[c];
+        SLuint end   = c + 1 < clusters.size() ? clusters[c + 1] : numT;
+
+        cache.reset();
+        SLuint numMisses = 0;
+        for (SLuint i = 3 * begin; i < 3 * end; ++i)
+            numMisses += cache.miss(indices[i]);
+        SLfloat maxACMR = (SLfloat)numMisses / (SLfloat)(end - begin) * threshold;
+
+        cache.reset();
+        numMisses = 0;
+        softClusters.push_back(begin);
+        SLuint start = begin;
+        for (SLuint t = begin; t < end; ++t)
+        {
+            for (SLuint i = 3 * t; i < 3 * t + 3; ++i)
+                numMisses += cache.miss(indices[i]);
+
+            if (t + 1 < end && (SLfloat)numMisses / (SLfloat)(t + 1 - start) <= maxACMR)
+            {
+                softClusters.push_back(t + 1);
+                start     = t + 1;
+                numMisses = 0;
+                cache.reset();
+            }
+        }
+    }
+    clusters.swap(softClusters);
+
+    // Area weighted centroid and normal per cluster
+    SLuint   numC = (SLuint)clusters.size();
+    SLVVec3f centroids(numC);
+    SLVVec3f normals(numC);
+    SLVec3f  meshCentroid;
+    SLfloat  meshArea = 0.0f;
+    for (SLuint c = 0; c < numC; ++c)
+    {
+        SLuint  end  = c + 1 < numC ? clusters[c + 1] : numT;
+        SLfloat area = 0.0f;
+        for (SLuint t = clusters[c]; t < end; ++t)
+        {
+            const SLVec3f& p0 = positions[indices[3 * t]];
+            const SLVec3f& p1 = positions[indices[3 * t + 1]];
+            const SLVec3f& p2 = positions[indices[3 * t + 2]];
+            SLVec3f        n;
+            n.cross(p1 - p0, p2 - p0);
+            SLfloat a = n.length() * 0.5f;
+            centroids[c] += (p0 + p1 + p2) * (a / 3.0f);
+            normals[c] += n;
+            area += a;
+        }
+        meshCentroid += centroids[c];
+        meshArea += area;
+        if (area > 0.0f) centroids[c] /= area;
+        normals[c].normalize();
+    }
+    if (meshArea > 0.0f) meshCentroid /= meshArea;
+
+    SLVfloat sortKey(numC);
+    for (SLuint c = 0; c < numC; ++c)
+        sortKey[c] = (centroids[c] - meshCentroid).dot(normals[c]);
+
+    SLVuint order(numC);
+    for (SLuint c = 0; c < numC; ++c) order[c] = c;
+    std::stable_sort(order.begin(),
+                     order.end(),
+                     [&sortKey](SLuint a, SLuint b)
+                     { return sortKey[a] > sortKey[b]; });
+
+    SLVuint result;
+    result.reserve(indices.size());
+    for (auto c : order)
+    {
+        SLuint end = c + 1 < numC ? clusters[c + 1] : numT;
+        result.insert(result.end(),
+                      indices.begin() + 3 * clusters[c],
+                      indices.begin() + 3 * end);
+    }
+    indices.swap(result);
+}
+//-----------------------------------------------------------------------------
+//! Permutes a vertex attribute vector into the order of newToOld
+template<typename T>
+static void reorderAttribute(vector<T>& attribute, const SLVuint& newToOld)
+{
+    if (attribute.empty()) return;
+
+    vector<T> reordered;
+    reordered.reserve(newToOld.size());
+    for (auto i : newToOld)
+        reordered.push_back(std::move(attribute[i]));
+    attribute.swap(reordered);
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Reorders the vertices of the mesh in the order of their first usage in the
+ * indices and removes the unused ones. The indices get remapped accordingly.
+ * Derived index vectors such as the hard edges and the selection get cleared.
+ */
+void SLMeshOptimizer::optimizeVertexFetch(SLMesh* mesh, SLVuint& indices)
+{
+    SLVuint oldToNew(mesh->P.size(), UINT_MAX);
+    SLVuint newToOld;
+    newToOld.reserve(mesh->P.size());
+    for (auto& i : indices)
+    {
+        if (oldToNew[i] == UINT_MAX)
+        {
+            oldToNew[i] = (SLuint)newToOld.size();
+            newToOld.push_back(i);
+        }
+        i = oldToNew[i];
+    }
+
+    reorderAttribute(mesh->P, newToOld);
+    reorderAttribute(mesh->N, newToOld);
+    reorderAttribute(mesh->UV[0], newToOld);
+    reorderAttribute(mesh->UV[1], newToOld);
+    reorderAttribute(mesh->C, newToOld);
+    reorderAttribute(mesh->T, newToOld);
+    reorderAttribute(mesh->Ji, newToOld);
+    reorderAttribute(mesh->Jw, newToOld);
+
+    mesh->skinnedP.clear();
+    mesh->skinnedN.clear();
+    mesh->IS32.clear();
+    mesh->IE16.clear();
+    mesh->IE32.clear();
+}
+//-----------------------------------------------------------------------------
+//! Returns the no. of bytes of the vertex attributes and indices of a mesh
+SLuint SLMeshOptimizer::numBytes(SLMesh* mesh)
+{
+    size_t bytes = mesh->P.size() * sizeof(SLVec3f) +
+                   mesh->N.size() * sizeof(SLVec3f) +
+                   mesh->UV[0].size() * sizeof(SLVec2f) +
+                   mesh->UV[1].size() * sizeof(SLVec2f) +
+                   mesh->C.size() * sizeof(SLCol4f) +
+                   mesh->T.size() * sizeof(SLVec4f) +
+                   mesh->I16.size() * sizeof(SLushort) +
+                   mesh->I32.size() * sizeof(SLuint);
+    for (auto& ji : mesh->Ji) bytes += ji.size() * sizeof(SLuchar);
+    for (auto& jw : mesh->Jw) bytes += jw.size() * sizeof(SLfloat);
+    return (SLuint)bytes;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Optimizes a triangle mesh for the vertex cache, overdraw and vertex fetch
+ * and converts the indices to 16 bit if possible. The statistics before and
+ * after are stored in the mesh (see SLMesh::optStats). Meshes with other
+ * primitives are left untouched. The optimization must be done before the
+ * mesh is initialized and uploaded to the GPU.
+ * @param mesh Triangle mesh to optimize
+ * @param cacheSize No. of vertices in the simulated vertex cache
+ * @param overdrawThreshold Allowed ACMR degradation for the overdraw sorting
+ */
+void SLMeshOptimizer::optimize(SLMesh* mesh,
+                               SLuint  cacheSize,
+                               SLfloat overdrawThreshold)
+{
+    assert(mesh && "No mesh passed");
+
+    if (mesh->primitive() != PT_triangles || mesh->numI() < 3)
+        return;
+
+    SLVuint indices;
+    if (!mesh->I16.empty())
+        indices.assign(mesh->I16.begin(), mesh->I16.end());
+    else
+        indices = mesh->I32;
+
+    SLMeshOptStats stats;
+    stats.acmrBefore     = calcACMR(indices, (SLuint)mesh->P.size(), cacheSize);
+    stats.numBytesBefore = numBytes(mesh);
+
+    SLVuint clusters;
+    optimizeVertexCache(indices, (SLuint)mesh->P.size(), cacheSize, clusters);
+    optimizeOverdraw(indices, mesh->P, clusters, cacheSize, overdrawThreshold);
+    optimizeVertexFetch(mesh, indices);
+    stats.acmrAfter = calcACMR(indices, (SLuint)mesh->P.size(), cacheSize);
+
+    if (mesh->P.size() < 65536)
+    {
+        mesh->I16.assign(indices.begin(), indices.end());
+        mesh->I32.clear();
+        mesh->I32.shrink_to_fit();
+    }
+    else
+    {
+        mesh->I32.swap(indices);
+        mesh->I16.clear();
+    }
+
+    stats.isOptimized   = true;
+    stats.numBytesAfter = numBytes(mesh);
+    mesh->optStats(stats);
+}
+//-----------------------------------------------------------------------------
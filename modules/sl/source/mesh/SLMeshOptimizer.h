@@ -0,0 +1,58 @@
+//#############################################################################
+//  File:      SLMeshOptimizer.h
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLMESHOPTIMIZER_H
+#define SLMESHOPTIMIZER_H
+
+#include <SL.h>
+#include <SLMesh.h>
+
+//-----------------------------------------------------------------------------
+//! Vertex cache, overdraw and vertex fetch optimization of triangle meshes
+/*!
+SLMeshOptimizer::optimize reorders the triangles and vertices of a triangle
+mesh for a faster rendering without changing its appearance:
+\n 1) The triangles are reordered for the post-transform vertex cache with the
+Tipsify algorithm of Sander, Nehab and Barczak (Fast Triangle Reordering for
+Vertex Locality and Reduced Overdraw, SIGGRAPH 2007).
+\n 2) The triangle clusters found by Tipsify are sorted from the outside to the
+inside, so that front facing triangles tend to be drawn first and cover the
+ones behind them. Clusters are only split where the vertex cache efficiency
+stays within the overdraw threshold.
+\n 3) The vertices are reordered in the order of their first usage in the index
+buffer and unused vertices are removed.
+\n 4) 32 bit indices are converted to 16 bit if there are less than 65536
+vertices.
+\n The ACMR (average cache miss ratio) and memory usage before and after are
+stored in the meshes SLMeshOptStats and are summed up in SLNodeStats. The
+optimization can be applied to all imported meshes with
+SLImporter::optimizeVertexCache.
+*/
+class SLMeshOptimizer
+{
+public:
+    static void    optimize(SLMesh* mesh,
+                            SLuint  cacheSize         = 16,
+                            SLfloat overdrawThreshold = 1.05f);
+    static SLfloat calcACMR(const SLVuint& indices,
+                            SLuint         numVertices,
+                            SLuint         cacheSize = 16);
+    static void    optimizeVertexCache(SLVuint& indices,
+                                       SLuint   numVertices,
+                                       SLuint   cacheSize,
+                                       SLVuint& clusters);
+    static void    optimizeOverdraw(SLVuint&        indices,
+                                    const SLVVec3f& positions,
+                                    SLVuint&        clusters,
+                                    SLuint          cacheSize,
+                                    SLfloat         threshold);
+    static void    optimizeVertexFetch(SLMesh* mesh, SLVuint& indices);
+    static SLuint  numBytes(SLMesh* mesh);
+};
+//-----------------------------------------------------------------------------
+#endif // SLMESHOPTIMIZER_H
@@ -0,0 +1,753 @@
+//#############################################################################
+//  File:      SLMeshSimplifier.cpp
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#include <SLMeshSimplifier.h>
+#include <SLAssetManager.h>
+#include <Utils.h>
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <numeric>
+#include <unordered_map>
+
+using std::unordered_map;
+
+//-----------------------------------------------------------------------------
+//! Weight of the perpendicular planes that keep open borders in place
+static const SLdouble BORDER_WEIGHT = 10.0;
+//! Magic number and version of the LOD cache files
+static const SLuint LOD_CACHE_MAGIC   = 0x444F4C53; // "SLOD"
+static const SLuint LOD_CACHE_VERSION = 1;
+//-----------------------------------------------------------------------------
+//! Returns a key for the undirected edge between the positions a and b
+static inline SLuint64 edgeKey(SLuint a, SLuint b)
+{
+    return a < b ? ((SLuint64)a << 32) | b : ((SLuint64)b << 32) | a;
+}
+//-----------------------------------------------------------------------------
+//! FNV-1a hash of a memory block
+static void hashBytes(SLuint64& hash, const void* data, size_t size)
+{
+    const SLuchar* bytes = (const SLuchar*)data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+//-----------------------------------------------------------------------------
+void SLMeshSimplifier::SLQuadric::addPlane(const SLVec3d& n,
+                                           SLdouble       d,
+                                           SLdouble       weight)
+{
+    a00 += weight * n.x * n.x;
+    a01 += weight * n.x * n.y;
+    a02 += weight * n.x * n.z;
+    a11 += weight * n.y * n.y;
+    a12 += weight * n.y * n.z;
+    a22 += weight * n.z * n.z;
+    b0 += weight * n.x * d;
+    b1 += weight * n.y * d;
+    b2 += weight * n.z * d;
+    c += weight * d * d;
+    w += weight;
+}
+//-----------------------------------------------------------------------------
+void SLMeshSimplifier::SLQuadric::add(const SLQuadric& q)
+{
+    a00 += q.a00;
+    a01 += q.a01;
+    a02 += q.a02;
+    a11 += q.a11;
+    a12 += q.a12;
+    a22 += q.a22;
+    b0 += q.b0;
+    b1 += q.b1;
+    b2 += q.b2;
+    c += q.c;
+    w += q.w;
+}
+//-----------------------------------------------------------------------------
+//! Returns the weighted mean squared distance of p to the planes of the quadric
+SLdouble SLMeshSimplifier::SLQuadric::error(const SLVec3f& p) const
+{
+    if (w <= 0.0) return 0.0;
+
+    SLdouble x = p.x, y = p.y, z = p.z;
+    SLdouble e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z +
+                 a11 * y * y + 2 * a12 * y * z + a22 * z * z +
+                 2 * (b0 * x + b1 * y + b2 * z) + c;
+    return std::max(0.0, e / w);
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Constructor that welds the vertices and computes the position quadrics of
+ * the passed triangle mesh. The mesh is not modified.
+ * @param mesh Triangle mesh with 16 or 32 bit indices
+ */
+SLMeshSimplifier::SLMeshSimplifier(SLMesh* mesh) : _mesh(mesh),
+                                                   _meshSize(0.0f)
+{
+    assert(mesh && "No mesh passed");
+    assert(mesh->primitive() == PT_triangles && "Only triangle meshes can be simplified");
+
+    weldVertices();
+    computeQuadrics();
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Welds all vertices with bit identical attributes and groups the welded
+ * vertices by their position. Vertices at the same position with different
+ * attributes (seams) become wedges of the same position. Triangles that are
+ * degenerated on position level are dropped.
+ */
+void SLMeshSimplifier::weldVertices()
+{
+    SLMesh* m    = _mesh;
+    SLuint  numV = (SLuint)m->P.size();
+
+    unordered_map<SLstring, SLuint> vertexOfKey;
+    unordered_map<SLstring, SLuint> posOfKey;
+    vertexOfKey.reserve(numV);
+    posOfKey.reserve(numV);
+
+    SLVuint weldedOf(numV);
+    _posOf.resize(numV);
+    _pos.clear();
+
+    SLVec3f minP(FLT_MAX, FLT_MAX, FLT_MAX);
+    SLVec3f maxP(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for (SLuint v = 0; v < numV; ++v)
+    {
+        // Add zero to map -0 onto +0
+        SLfloat p[3] = {m->P[v].x + 0.0f, m->P[v].y + 0.0f, m->P[v].z + 0.0f};
+        SLVec3f pos(p[0], p[1], p[2]);
+        minP.setMin(pos);
+        maxP.setMax(pos);
+
+        SLstring key((const char*)p, sizeof(p));
+        auto     posIt = posOfKey.emplace(key, (SLuint)_pos.size());
+        if (posIt.second)
+            _pos.push_back(pos);
+
+        if (!m->N.empty()) key.append((const char*)&m->N[v], sizeof(SLVec3f));
+        if (!m->UV[0].empty()) key.append((const char*)&m->UV[0][v], sizeof(SLVec2f));
+        if (!m->UV[1].empty()) key.append((const char*)&m->UV[1][v], sizeof(SLVec2f));
+        if (!m->C.empty()) key.append((const char*)&m->C[v], sizeof(SLCol4f));
+        if (!m->T.empty()) key.append((const char*)&m->T[v], sizeof(SLVec4f));
+        if (!m->Ji.empty())
+        {
+            key.push_back((char)m->Ji[v].size());
+            key.append((const char*)m->Ji[v].data(), m->Ji[v].size());
+            key.append((const char*)m->Jw[v].data(), m->Jw[v].size() * sizeof(SLfloat));
+        }
+
+        auto vertIt = vertexOfKey.emplace(key, v);
+        weldedOf[v] = vertIt.first->second;
+        _posOf[v]   = posIt.first->second;
+    }
+
+    _meshSize = numV ? (maxP - minP).length() : 0.0f;
+
+    SLuint numI = m->numI();
+    _indices.clear();
+    _indices.reserve(numI);
+    for (SLuint i = 0; i + 2 < numI; i += 3)
+    {
+        SLuint tri[3];
+        for (SLuint k = 0; k < 3; ++k)
+            tri[k] = weldedOf[m->I16.empty() ? m->I32[i + k] : m->I16[i + k]];
+
+        if (_posOf[tri[0]] != _posOf[tri[1]] &&
+            _posOf[tri[1]] != _posOf[tri[2]] &&
+            _posOf[tri[2]] != _posOf[tri[0]])
+            _indices.insert(_indices.end(), tri, tri + 3);
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Accumulates the area weighted triangle planes into the quadric of every
+ * position. For open border edges an additional plane perpendicular to the
+ * triangle is added, so that borders do not shrink.
+ */
+void SLMeshSimplifier::computeQuadrics()
+{
+    _quadrics.assign(_pos.size(), SLQuadric());
+
+    // Count the triangles per edge and remember the triangle of single ones
+    unordered_map<SLuint64, SLuint> edgeTris;
+    unordered_map<SLuint64, SLuint> edgeCount;
+    edgeTris.reserve(_indices.size());
+    edgeCount.reserve(_indices.size());
+
+    for (SLuint t = 0; t < (SLuint)_indices.size() / 3; ++t)
+    {
+        SLuint  p[3] = {_posOf[_indices[3 * t]],
+                        _posOf[_indices[3 * t + 1]],
+                        _posOf[_indices[3 * t + 2]]};
+        SLVec3d p0(_pos[p[0]].x, _pos[p[0]].y, _pos[p[0]].z);
+        SLVec3d p1(_pos[p[1]].x, _pos[p[1]].y, _pos[p[1]].z);
+        SLVec3d p2(_pos[p[2]].x, _pos[p[2]].y, _pos[p[2]].z);
+        SLVec3d n;
+        n.cross(p1 - p0, p2 - p0);
+        SLdouble len = n.length();
+        if (len > 0.0)
+        {
+            n /= len;
+            for (SLuint k = 0; k < 3; ++k)
+                _quadrics[p[k]].addPlane(n, -n.dot(p0), len * 0.5);
+        }
+
+        for (SLuint k = 0; k < 3; ++k)
+        {
+            SLuint64 key = edgeKey(p[k], p[(k + 1) % 3]);
+            edgeTris[key] = t;
+            edgeCount[key]++;
+        }
+    }
+
+    for (auto& edge : edgeCount)
+    {
+        if (edge.second != 1) continue;
+
+        SLuint   t = edgeTris[edge.first];
+        SLuint   p[3] = {_posOf[_indices[3 * t]],
+                       _posOf[_indices[3 * t + 1]],
+                       _posOf[_indices[3 * t + 2]]};
+        SLVec3d  p0(_pos[p[0]].x, _pos[p[0]].y, _pos[p[0]].z);
+        SLVec3d  p1(_pos[p[1]].x, _pos[p[1]].y, _pos[p[1]].z);
+        SLVec3d  p2(_pos[p[2]].x, _pos[p[2]].y, _pos[p[2]].z);
+        SLVec3d  faceN;
+        faceN.cross(p1 - p0, p2 - p0);
+        SLuint   a = (SLuint)(edge.first >> 32);
+        SLuint   b = (SLuint)(edge.first & 0xFFFFFFFF);
+        SLVec3d  pa(_pos[a].x, _pos[a].y, _pos[a].z);
+        SLVec3d  pb(_pos[b].x, _pos[b].y, _pos[b].z);
+        SLVec3d  e = pb - pa;
+        SLVec3d  n;
+        n.cross(e, faceN);
+        SLdouble len = n.length();
+        if (len <= 0.0) continue;
+        n /= len;
+
+        SLdouble weight = e.dot(e) * BORDER_WEIGHT;
+        _quadrics[a].addPlane(n, -n.dot(pa), weight);
+        _quadrics[b].addPlane(n, -n.dot(pa), weight);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns the joint with the highest weight of vertex v or -1 if unskinned
+SLint SLMeshSimplifier::dominantJoint(SLuint v) const
+{
+    if (_mesh->Ji.empty() || _mesh->Ji[v].empty())
+        return -1;
+
+    const SLVuchar& ji   = _mesh->Ji[v];
+    const SLVfloat& jw   = _mesh->Jw[v];
+    SLuint          best = 0;
+    for (SLuint i = 1; i < ji.size() && i < jw.size(); ++i)
+        if (jw[i] > jw[best]) best = i;
+    return ji[best];
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Returns true if moving position v0 onto v1 would flip or degenerate one of
+ * the remaining triangles around v0.
+ */
+SLbool SLMeshSimplifier::hasFlips(SLuint         v0,
+                                  SLuint         v1,
+                                  const SLVuint& indices,
+                                  const SLVuint& posTriOffsets,
+                                  const SLVuint& posTris) const
+{
+    for (SLuint i = posTriOffsets[v0]; i < posTriOffsets[v0 + 1]; ++i)
+    {
+        SLuint t    = posTris[i];
+        SLuint p[3] = {_posOf[indices[3 * t]],
+                       _posOf[indices[3 * t + 1]],
+                       _posOf[indices[3 * t + 2]]};
+
+        // Triangles at the collapsed edge disappear
+        if (p[0] == v1 || p[1] == v1 || p[2] == v1) continue;
+
+        SLVec3f before, after;
+        SLVec3f q[3] = {_pos[p[0]], _pos[p[1]], _pos[p[2]]};
+        before.cross(q[1] - q[0], q[2] - q[0]);
+        for (SLuint k = 0; k < 3; ++k)
+            if (p[k] == v0) q[k] = _pos[v1];
+        after.cross(q[1] - q[0], q[2] - q[0]);
+
+        if (before.dot(after) <= 0.0f)
+            return true;
+    }
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Simplifies the mesh until it has targetNumTriangles triangles or until the
+ * next collapse would exceed maxError. The simplification starts always from
+ * the full mesh, so it can be called repeatedly for multiple levels.
+ * Every pass collects the allowed collapses, sorts them by their quadric
+ * error and applies them, as long as they do not touch the neighborhood of
+ * an already collapsed vertex in the same pass.
+ * @param targetNumTriangles Number of triangles to reach
+ * @param maxError Max. error relative to the mesh size (AABB diagonal)
+ * @param indices Resulting triangle indices into the vertices of the mesh
+ * @return Max. collapse error relative to the mesh size
+ */
+SLfloat SLMeshSimplifier::simplify(SLuint   targetNumTriangles,
+                                   SLfloat  maxError,
+                                   SLVuint& indices)
+{
+    // Edge with its first two triangles and their vertices at the positions a < b
+    struct SLEdge
+    {
+        SLuint count = 0;
+        SLuint wa[2] = {0, 0};
+        SLuint wb[2] = {0, 0};
+    };
+
+    const SLuint   noWedge     = UINT_MAX;
+    const SLuint   numPos      = (SLuint)_pos.size();
+    const SLuint   numV        = (SLuint)_posOf.size();
+    const SLdouble maxErrorSqr = (SLdouble)maxError * _meshSize * maxError * _meshSize;
+
+    vector<SLQuadric> quadrics = _quadrics;
+    SLdouble          maxCost  = 0.0;
+    indices                    = _indices;
+
+    while (indices.size() / 3 > targetNumTriangles)
+    {
+        SLuint numTris = (SLuint)indices.size() / 3;
+
+        // Build the triangle lists of all positions
+        SLVuint posTriOffsets(numPos + 1, 0);
+        SLVuint posTris(indices.size());
+        for (auto i : indices)
+            posTriOffsets[_posOf[i] + 1]++;
+        for (SLuint p = 0; p < numPos; ++p)
+            posTriOffsets[p + 1] += posTriOffsets[p];
+        SLVuint fill(posTriOffsets.begin(), posTriOffsets.end() - 1);
+        for (SLuint i = 0; i < indices.size(); ++i)
+            posTris[fill[_posOf[indices[i]]]++] = i / 3;
+
+        // Collect the edges with their wedges
+        unordered_map<SLuint64, SLEdge> edges;
+        edges.reserve(indices.size());
+        for (SLuint t = 0; t < numTris; ++t)
+        {
+            for (SLuint k = 0; k < 3; ++k)
+            {
+                SLuint i0 = indices[3 * t + k];
+                SLuint i1 = indices[3 * t + (k + 1) % 3];
+                if (_posOf[i0] > _posOf[i1]) std::swap(i0, i1);
+
+                SLEdge& edge = edges[edgeKey(_posOf[i0], _posOf[i1])];
+                if (edge.count < 2)
+                {
+                    edge.wa[edge.count] = i0;
+                    edge.wb[edge.count] = i1;
+                }
+                edge.count++;
+            }
+        }
+
+        // Classify the positions
+        SLVuint  wedge0(numPos, noWedge), wedge1(numPos, noWedge);
+        SLVuint  numBorders(numPos, 0), numSeams(numPos, 0);
+        SLVuchar kinds(numPos, VK_manifold);
+        for (auto i : indices)
+        {
+            SLuint p = _posOf[i];
+            if (wedge0[p] == noWedge || wedge0[p] == i)
+                wedge0[p] = i;
+            else if (wedge1[p] == noWedge || wedge1[p] == i)
+                wedge1[p] = i;
+            else
+                kinds[p] = VK_locked;
+        }
+        for (auto& it : edges)
+        {
+            SLuint         a    = (SLuint)(it.first >> 32);
+            SLuint         b    = (SLuint)(it.first & 0xFFFFFFFF);
+            const SLEdge& edge = it.second;
+            if (edge.count == 1)
+            {
+                numBorders[a]++;
+                numBorders[b]++;
+            }
+            else if (edge.count == 2)
+            {
+                if (edge.wa[0] != edge.wa[1] || edge.wb[0] != edge.wb[1])
+                {
+                    numSeams[a]++;
+                    numSeams[b]++;
+                }
+            }
+            else
+                kinds[a] = kinds[b] = VK_locked;
+        }
+        for (SLuint p = 0; p < numPos; ++p)
+        {
+            if (kinds[p] == VK_locked) continue;
+            SLbool oneWedge = wedge1[p] == noWedge;
+            if (oneWedge && numBorders[p] == 0 && numSeams[p] == 0)
+                kinds[p] = VK_manifold;
+            else if (oneWedge && numBorders[p] == 2 && numSeams[p] == 0)
+                kinds[p] = VK_border;
+            else if (!oneWedge && numBorders[p] == 0 && numSeams[p] == 2)
+                kinds[p] = VK_seam;
+            else
+                kinds[p] = VK_locked;
+        }
+
+        // Collect the allowed collapses in both directions of every edge
+        vector<SLCollapse> collapses;
+        collapses.reserve(edges.size());
+        for (auto& it : edges)
+        {
+            const SLEdge& edge = it.second;
+            for (SLuint dir = 0; dir < 2; ++dir)
+            {
+                SLuint        v0 = dir ? (SLuint)(it.first & 0xFFFFFFFF) : (SLuint)(it.first >> 32);
+                SLuint        v1 = dir ? (SLuint)(it.first >> 32) : (SLuint)(it.first & 0xFFFFFFFF);
+                const SLuint* w0 = dir ? edge.wb : edge.wa;
+                const SLuint* w1 = dir ? edge.wa : edge.wb;
+
+                SLbool allowed;
+                switch (kinds[v0])
+                {
+                    case VK_manifold: allowed = edge.count == 2; break;
+                    case VK_border: allowed = edge.count == 1; break;
+                    case VK_seam: allowed = edge.count == 2 && w0[0] != w0[1] && w1[0] != w1[1]; break;
+                    default: allowed = false;
+                }
+                if (!allowed) continue;
+
+                if (!_mesh->Ji.empty())
+                {
+                    if (dominantJoint(w0[0]) != dominantJoint(w1[0])) continue;
+                    if (edge.count == 2 && dominantJoint(w0[1]) != dominantJoint(w1[1])) continue;
+                }
+
+                SLCollapse collapse;
+                collapse.v0    = v0;
+                collapse.v1    = v1;
+                collapse.error = (SLfloat)quadrics[v0].error(_pos[v1]);
+                collapses.push_back(collapse);
+            }
+        }
+        std::sort(collapses.begin(),
+                  collapses.end(),
+                  [](const SLCollapse& a, const SLCollapse& b)
+                  { return a.error < b.error; });
+
+        // Apply the cheapest collapses with disjoint neighborhoods
+        SLVbool locked(numPos, false);
+        SLVuint remap(numV);
+        std::iota(remap.begin(), remap.end(), 0);
+        SLuint numRemoved   = 0;
+        SLuint numToRemove  = numTris - targetNumTriangles;
+        SLuint numCollapsed = 0;
+
+        for (auto& c : collapses)
+        {
+            if (c.error > maxErrorSqr || numRemoved >= numToRemove) break;
+            if (locked[c.v0] || locked[c.v1]) continue;
+            if (hasFlips(c.v0, c.v1, indices, posTriOffsets, posTris)) continue;
+
+            const SLEdge& edge = edges[edgeKey(c.v0, c.v1)];
+            SLbool        v0IsA = c.v0 < c.v1;
+            const SLuint* w0    = v0IsA ? edge.wa : edge.wb;
+            const SLuint* w1    = v0IsA ? edge.wb : edge.wa;
+            remap[w0[0]]        = w1[0];
+            if (edge.count == 2) remap[w0[1]] = w1[1];
+
+            quadrics[c.v1].add(quadrics[c.v0]);
+            for (SLuint i = posTriOffsets[c.v0]; i < posTriOffsets[c.v0 + 1]; ++i)
+                for (SLuint k = 0; k < 3; ++k)
+                    locked[_posOf[indices[3 * posTris[i] + k]]] = true;
+
+            maxCost = std::max(maxCost, (SLdouble)c.error);
+            numRemoved += edge.count;
+            numCollapsed++;
+        }
+
+        if (numCollapsed == 0) break;
+
+        // Remap the indices and remove the collapsed triangles
+        SLuint numKept = 0;
+        for (SLuint t = 0; t < numTris; ++t)
+        {
+            SLuint i0 = remap[indices[3 * t]];
+            SLuint i1 = remap[indices[3 * t + 1]];
+            SLuint i2 = remap[indices[3 * t + 2]];
+            if (_posOf[i0] != _posOf[i1] &&
+                _posOf[i1] != _posOf[i2] &&
+                _posOf[i2] != _posOf[i0])
+            {
+                indices[numKept++] = i0;
+                indices[numKept++] = i1;
+                indices[numKept++] = i2;
+            }
+        }
+        indices.resize(numKept);
+    }
+
+    return _meshSize > 0.0f ? (SLfloat)sqrt(maxCost) / _meshSize : 0.0f;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Creates a new mesh with only the vertices referenced by the indices of a
+ * previous simplify call. The material and skeleton are shared with the
+ * source mesh. 16 bit indices are used whenever possible.
+ */
+SLMesh* SLMeshSimplifier::createMesh(SLAssetManager* assetMgr,
+                                     const SLVuint&  indices,
+                                     const SLstring& name) const
+{
+    SLMesh* src  = _mesh;
+    SLMesh* mesh = new SLMesh(assetMgr, name);
+
+    SLVuint newIndexOf(src->P.size(), UINT_MAX);
+    SLVuint oldIndices;
+    for (auto i : indices)
+    {
+        if (newIndexOf[i] == UINT_MAX)
+        {
+            newIndexOf[i] = (SLuint)oldIndices.size();
+            oldIndices.push_back(i);
+        }
+    }
+
+    for (auto i : oldIndices)
+    {
+        mesh->P.push_back(src->P[i]);
+        if (!src->N.empty()) mesh->N.push_back(src->N[i]);
+        if (!src->UV[0].empty()) mesh->UV[0].push_back(src->UV[0][i]);
+        if (!src->UV[1].empty()) mesh->UV[1].push_back(src->UV[1][i]);
+        if (!src->C.empty()) mesh->C.push_back(src->C[i]);
+        if (!src->T.empty()) mesh->T.push_back(src->T[i]);
+        if (!src->Ji.empty()) mesh->Ji.push_back(src->Ji[i]);
+        if (!src->Jw.empty()) mesh->Jw.push_back(src->Jw[i]);
+    }
+
+    if (oldIndices.size() < 65536)
+    {
+        mesh->I16.reserve(indices.size());
+        for (auto i : indices)
+            mesh->I16.push_back((SLushort)newIndexOf[i]);
+    }
+    else
+    {
+        mesh->I32.reserve(indices.size());
+        for (auto i : indices)
+            mesh->I32.push_back(newIndexOf[i]);
+    }
+
+    mesh->primitive(PT_triangles);
+    mesh->mat(src->mat());
+    mesh->matOut(src->matOut());
+    mesh->skeleton(const_cast<SLAnimSkeleton*>(src->skeleton()));
+    return mesh;
+}
+//-----------------------------------------------------------------------------
+/*! Returns a hash over all vertex attributes and indices of the mesh. The
+ * simplified levels carry the attributes of the source vertices, so a cached
+ * level is only valid for a mesh with the same attribute contents.
+ */
+SLuint64 SLMeshSimplifier::hash() const
+{
+    SLMesh*  m        = _mesh;
+    SLuint64 hash     = 14695981039346656037ull;
+    SLuint   sizes[8] = {(SLuint)m->P.size(),
+                       (SLuint)m->N.size(),
+                       (SLuint)m->UV[0].size(),
+                       (SLuint)m->UV[1].size(),
+                       (SLuint)m->C.size(),
+                       (SLuint)m->T.size(),
+                       (SLuint)m->Ji.size(),
+                       (SLuint)m->Jw.size()};
+    hashBytes(hash, sizes, sizeof(sizes));
+    hashBytes(hash, m->P.data(), m->P.size() * sizeof(SLVec3f));
+    hashBytes(hash, m->N.data(), m->N.size() * sizeof(SLVec3f));
+    hashBytes(hash, m->UV[0].data(), m->UV[0].size() * sizeof(SLVec2f));
+    hashBytes(hash, m->UV[1].data(), m->UV[1].size() * sizeof(SLVec2f));
+    hashBytes(hash, m->C.data(), m->C.size() * sizeof(SLCol4f));
+    hashBytes(hash, m->T.data(), m->T.size() * sizeof(SLVec4f));
+    for (auto& ids : m->Ji)
+    {
+        SLuint numIds = (SLuint)ids.size();
+        hashBytes(hash, &numIds, sizeof(numIds));
+        hashBytes(hash, ids.data(), ids.size() * sizeof(SLuchar));
+    }
+    for (auto& weights : m->Jw)
+    {
+        SLuint numWeights = (SLuint)weights.size();
+        hashBytes(hash, &numWeights, sizeof(numWeights));
+        hashBytes(hash, weights.data(), weights.size() * sizeof(SLfloat));
+    }
+    hashBytes(hash, m->I16.data(), m->I16.size() * sizeof(SLushort));
+    hashBytes(hash, m->I32.data(), m->I32.size() * sizeof(SLuint));
+    return hash;
+}
+//-----------------------------------------------------------------------------
+/*! Reads the levels of a LOD cache file if it matches the hash. A truncated
+ * or corrupt file or an index that is not < numVertices returns false, so
+ * that the levels get simplified again.
+ */
+static SLbool readLODCache(const SLstring&  filename,
+                           SLuint64         hash,
+                           SLuint           numVertices,
+                           vector<SLVuint>& levels,
+                           SLVfloat&        errors)
+{
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    SLuint64 fileSize = (SLuint64)file.tellg();
+    file.seekg(0);
+
+    SLuint   magic = 0, version = 0, numLevels = 0;
+    SLuint64 fileHash = 0;
+    file.read((char*)&magic, sizeof(magic));
+    file.read((char*)&version, sizeof(version));
+    file.read((char*)&fileHash, sizeof(fileHash));
+    file.read((char*)&numLevels, sizeof(numLevels));
+    if (!file || magic != LOD_CACHE_MAGIC || version != LOD_CACHE_VERSION || fileHash != hash)
+        return false;
+
+    // Every level has at least an error and an index count
+    SLuint64 remaining = fileSize - (SLuint64)file.tellg();
+    if ((SLuint64)numLevels * (sizeof(SLfloat) + sizeof(SLuint)) > remaining)
+        return false;
+
+    levels.resize(numLevels);
+    errors.resize(numLevels);
+    for (SLuint l = 0; l < numLevels; ++l)
+    {
+        SLuint numI = 0;
+        file.read((char*)&errors[l], sizeof(SLfloat));
+        file.read((char*)&numI, sizeof(numI));
+        if (!file) return false;
+
+        remaining = fileSize - (SLuint64)file.tellg();
+        if (numI % 3 != 0 || (SLuint64)numI * sizeof(SLuint) > remaining)
+            return false;
+
+        levels[l].resize(numI);
+        file.read((char*)levels[l].data(), numI * sizeof(SLuint));
+        if (!file) return false;
+
+        for (auto i : levels[l])
+            if (i >= numVertices) return false;
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+//! Writes the levels into a LOD cache file
+static void writeLODCache(const SLstring&        filename,
+                          SLuint64               hash,
+                          const vector<SLVuint>& levels,
+                          const SLVfloat&        errors)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        SL_LOG("SLMeshSimplifier: Could not write LOD cache file: %s", filename.c_str());
+        return;
+    }
+
+    SLuint numLevels = (SLuint)levels.size();
+    file.write((const char*)&LOD_CACHE_MAGIC, sizeof(LOD_CACHE_MAGIC));
+    file.write((const char*)&LOD_CACHE_VERSION, sizeof(LOD_CACHE_VERSION));
+    file.write((const char*)&hash, sizeof(hash));
+    file.write((const char*)&numLevels, sizeof(numLevels));
+    for (SLuint l = 0; l < numLevels; ++l)
+    {
+        SLuint numI = (SLuint)levels[l].size();
+        file.write((const char*)&errors[l], sizeof(SLfloat));
+        file.write((const char*)&numI, sizeof(numI));
+        file.write((const char*)levels[l].data(), numI * sizeof(SLuint));
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Creates a chain of simplified meshes with decreasing triangle counts. The
+ * chain stops early if a level can not be reduced significantly within the
+ * max. error. If a cache directory is passed, the simplified indices are
+ * stored in a file named after the mesh and its hash, so that the LODs can be
+ * created offline or only at the first load.
+ * @param assetMgr Asset manager that owns the new meshes
+ * @param mesh Source triangle mesh
+ * @param triangleRatios Target triangle ratio of every level (decreasing)
+ * @param maxError Max. error relative to the mesh size
+ * @param cacheDir Directory of the LOD cache files or empty for no caching
+ * @param errors Resulting error of every level relative to the mesh size
+ * @return Vector with the simplified meshes
+ */
+SLVMesh SLMeshSimplifier::createLODChain(SLAssetManager* assetMgr,
+                                         SLMesh*         mesh,
+                                         const SLVfloat& triangleRatios,
+                                         SLfloat         maxError,
+                                         const SLstring& cacheDir,
+                                         SLVfloat&       errors)
+{
+    SLMeshSimplifier simplifier(mesh);
+
+    SLuint64 hash = simplifier.hash();
+    hashBytes(hash, triangleRatios.data(), triangleRatios.size() * sizeof(SLfloat));
+    hashBytes(hash, &maxError, sizeof(maxError));
+
+    SLstring cacheFile;
+    if (!cacheDir.empty())
+    {
+        SLstring name = mesh->name();
+        for (auto& c : name)
+            if (!isalnum((unsigned char)c)) c = '_';
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+        cacheFile = Utils::unifySlashes(cacheDir) + name + "_" + hex + ".sllod";
+    }
+
+    vector<SLVuint> levels;
+    errors.clear();
+
+    if (cacheFile.empty() || !readLODCache(cacheFile, hash, (SLuint)mesh->P.size(), levels, errors))
+    {
+        levels.clear();
+        errors.clear();
+
+        SLuint lastNumTris = simplifier.numTriangles();
+        for (auto ratio : triangleRatios)
+        {
+            SLuint  target = std::max(1u, (SLuint)(ratio * simplifier.numTriangles()));
+            SLVuint indices;
+            SLfloat error  = simplifier.simplify(target, maxError, indices);
+            SLuint  numTris = (SLuint)indices.size() / 3;
+
+            // Stop if the error limit prevents a significant reduction
+            if (numTris == 0 || numTris > lastNumTris * 0.9f) break;
+
+            levels.push_back(indices);
+            errors.push_back(error);
+            lastNumTris = numTris;
+        }
+
+        if (!cacheFile.empty())
+            writeLODCache(cacheFile, hash, levels, errors);
+    }
+
+    SLVMesh meshes;
+    for (SLuint l = 0; l < levels.size(); ++l)
+        meshes.push_back(simplifier.createMesh(assetMgr,
+                                               levels[l],
+                                               mesh->name() + "-LOD" + std::to_string(l + 1)));
+    return meshes;
+}
+//-----------------------------------------------------------------------------
@@ -0,0 +1,109 @@
+//#############################################################################
+//  File:      SLMeshSimplifier.h
+//  Date:      October 2026
+//  Codestyle: https://github.com/cpvrlab/SLProject/wiki/SLProject-Coding-Style
+//  License:   This software is provided under the GNU General Public License
+//             Please visit: http://opensource.org/licenses/GPL-3.0
+//#############################################################################
+
+#ifndef SLMESHSIMPLIFIER_H
+#define SLMESHSIMPLIFIER_H
+
+#include <SL.h>
+#include <SLMesh.h>
+
+class SLAssetManager;
+
+//-----------------------------------------------------------------------------
+//! Quadric error metric (QEM) mesh simplifier for triangle meshes
+/*!
+The simplifier reduces the number of triangles of an SLMesh by edge collapses
+ordered by the quadric error metric of Garland and Heckbert. A vertex is always
+collapsed onto one of its neighbors (half edge collapse), so no new vertices
+are created and all vertex attributes (normals, texture coordinates, colors,
+tangents and joint weights) remain exact.
+\n
+Vertices with identical attributes are welded first. Vertices at the same
+position but with different attributes (UV or normal seams) are kept apart:
+a seam vertex can only be collapsed along the seam, a border vertex only along
+the border, and vertices at non-manifold edges or seam junctions are locked.
+For skinned meshes only vertices with the same dominant joint get collapsed.
+Collapses that would flip a triangle are rejected.
+\n
+The simplified index vectors reference the vertices of the source mesh. With
+createMesh they are turned into a new compacted mesh. createLODChain creates
+multiple levels at once and caches them in a binary file, so that they can be
+generated offline or only once at the first load.
+*/
+class SLMeshSimplifier
+{
+public:
+    explicit SLMeshSimplifier(SLMesh* mesh);
+
+    SLfloat simplify(SLuint   targetNumTriangles,
+                     SLfloat  maxError,
+                     SLVuint& indices);
+    SLMesh* createMesh(SLAssetManager* assetMgr,
+                       const SLVuint&  indices,
+                       const SLstring& name) const;
+
+    static SLVMesh createLODChain(SLAssetManager* assetMgr,
+                                  SLMesh*         mesh,
+                                  const SLVfloat& triangleRatios,
+                                  SLfloat         maxError,
+                                  const SLstring& cacheDir,
+                                  SLVfloat&       errors);
+
+    // Getters
+    SLuint         numTriangles() const { return (SLuint)_indices.size() / 3; }
+    SLfloat        meshSize() const { return _meshSize; }
+    SLMesh*        mesh() const { return _mesh; }
+    SLuint64       hash() const;
+    const SLVuint& indices() const { return _indices; }
+
+private:
+    //! Symmetric 4x4 quadric with the sum of its weights
+    struct SLQuadric
+    {
+        SLdouble a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+        SLdouble b0 = 0, b1 = 0, b2 = 0, c = 0, w = 0;
+
+        void     addPlane(const SLVec3d& n, SLdouble d, SLdouble weight);
+        void     add(const SLQuadric& q);
+        SLdouble error(const SLVec3f& p) const;
+    };
+
+    //! Collapse restrictions of a position
+    enum SLVertexKind
+    {
+        VK_manifold = 0, //!< Single attribute set inside the mesh
+        VK_border,       //!< Single attribute set on an open border
+        VK_seam,         //!< Two attribute sets along a UV or normal seam
+        VK_locked        //!< Corners, seam junctions and non-manifold vertices
+    };
+
+    //! Edge collapse candidate from position v0 onto position v1
+    struct SLCollapse
+    {
+        SLuint  v0, v1;
+        SLfloat error;
+    };
+
+    void   weldVertices();
+    void   computeQuadrics();
+    SLint  dominantJoint(SLuint v) const;
+    SLbool hasFlips(SLuint         v0,
+                    SLuint         v1,
+                    const SLVuint& indices,
+                    const SLVuint& posTriOffsets,
+                    const SLVuint& posTris) const;
+
+    SLMesh*           _mesh;     //!< Source mesh
+    SLfloat           _meshSize; //!< Diagonal of the mesh AABB
+    SLVuint           _indices;  //!< Welded triangle indices of the source mesh
+    SLVuint           _posOf;    //!< Position index of every vertex
+    SLVVec3f          _pos;      //!< Unique positions
+    vector<SLQuadric> _quadrics; //!< Quadric per position
+};
+//-----------------------------------------------------------------------------
+#endif // SLMESHSIMPLIFIER_H
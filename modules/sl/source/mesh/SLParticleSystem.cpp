@@ -851,18 +851,16 @@ void SLParticleSystem::deleteDataGpu()
     SLMesh::deleteDataGpu();
 }
 //-----------------------------------------------------------------------------
-/*! SLParticleSystem::buildAABB builds the passed axis-aligned bounding box in
- OS and updates the min & max points in WS with the passed WM of the node.
+/*! SLParticleSystem::buildMinMaxOS updates the min & max points in OS that
+ SLMesh::buildAABB transforms with the passed WM of the node to WS.
  Take into account features like acceleration, gravity, shape, velocity.
- SLMesh::buildAABB builds the passed axis-aligned bounding box in OS and updates
- the min& max points in WS with the passed WM of the node.
  Todo: Can ben enhance furthermore the acceleration doesn't work wll for the moments
  The negative value for the acceleration are not take into account and also
  acceleration which goes against the velocity. To adapt the acceleration to
  exactly the same as the gravity not enough time to do it. Need to adapt more
  accurately when direction speed is negative (for shape override example with Cone)
 */
-void SLParticleSystem::buildAABB(SLAABBox& aabb, const SLMat4f& wmNode)
+void SLParticleSystem::buildMinMaxOS()
 {
     // Radius of particle
     float rW = _radiusW * _scale;
@@ -1115,8 +1113,5 @@ void SLParticleSystem::buildAABB(SLAABBox& aabb, const SLMat4f& wmNode)
     maxP.x += maxP.x > minP.x ? rW : -rW; // Add size of particle
     maxP.y += maxP.y > minP.y ? rH : -rH; // Add size of particle
     maxP.z += maxP.z > minP.z ? rW : -rW; // Add size of particle
-
-    // Apply world matrix
-    aabb.fromOStoWS(minP, maxP, wmNode);
 }
 //-----------------------------------------------------------------------------
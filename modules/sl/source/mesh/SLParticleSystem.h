@@ -45,7 +45,7 @@ public:
     void draw(SLSceneView* sv, SLNode* node);
     void deleteData();
     void deleteDataGpu();
-    void buildAABB(SLAABBox& aabb, const SLMat4f& wmNode);
+    void buildMinMaxOS();
     void generate();
     void generateBernsteinPAlpha();
     void generateBernsteinPSize();
@@ -1682,3 +1682,34 @@ void SLCamera::passToUniforms(SLGLProgram* program)
     program->uniform4fv("u_camFogColor", 1, (SLfloat*)&_fogColor);
 }
 //-----------------------------------------------------------------------------
+//! Pass camera parameters to the shared uniform block (see SLGLFrameUniforms)
+void SLCamera::passToFrameUniforms(SLGLFrameUniforms& u)
+{
+    u.camProjType  = _projType;
+    u.camStereoEye = _stereoEye;
+
+    // The std140 columns of a mat3 are 16 bytes apart
+    const SLfloat* m = (const SLfloat*)&_stereoColorFilter;
+    for (SLint c = 0; c < 3; ++c)
+        u.camStereoColors[c].set(m[3 * c], m[3 * c + 1], m[3 * c + 2], 0.0f);
+
+    // Pass fog parameters
+    if (_fogColorIsBack)
+        _fogColor = _background.avgColor();
+    _fogStart = _clipNear;
+    _fogEnd   = _clipFar;
+
+    u.camFogIsOn    = _fogIsOn;
+    u.camFogMode    = _fogMode;
+    u.camFogDensity = _fogDensity;
+    u.camFogStart   = _fogStart;
+    u.camFogEnd     = _fogEnd;
+    u.camFogColor   = _fogColor;
+    u.camClipNear   = _clipNear;
+    u.camClipFar    = _clipFar;
+    u.camBkgdWidth  = _background.rect().width;
+    u.camBkgdHeight = _background.rect().height;
+    u.camBkgdLeft   = _background.rect().x;
+    u.camBkgdBottom = _background.rect().y;
+}
+//-----------------------------------------------------------------------------
@@ -25,6 +25,7 @@ class SLDeviceRotation;
 class SLDeviceLocation;
 
 class SLCameraAnimation;
+struct SLGLFrameUniforms;
 
 //-----------------------------------------------------------------------------
 //! Active or visible camera node class
@@ -83,6 +84,7 @@ public:
     SLVec3f trackballVec(SLint x, SLint y) const;
     SLbool  isInFrustum(SLAABBox* aabb);
     void    passToUniforms(SLGLProgram* program);
+    void    passToFrameUniforms(SLGLFrameUniforms& u);
 
     // Apply projection, viewport and view transformations
     void setViewport(SLSceneView* sv, SLEyeType eye);
@@ -222,7 +222,7 @@ SLfloat SLLightDirect::shadowTest(SLRay*         ray,       // ray of hit point
 {
     // define shadow ray and shoot
     SLRay shadowRay(lightDist, L, ray);
-    root3D->hitRec(&shadowRay);
+    root3D->hitAnyRec(&shadowRay);
 
     if (shadowRay.length < lightDist)
     {
@@ -251,7 +251,7 @@ SLfloat SLLightDirect::shadowTestMC(SLRay*         ray,       // ray of hit poin
 {
     // define shadow ray and shoot
     SLRay shadowRay(lightDist, L, ray);
-    root3D->hitRec(&shadowRay);
+    root3D->hitAnyRec(&shadowRay);
 
     if (shadowRay.length < lightDist)
     {
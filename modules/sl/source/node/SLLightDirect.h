@@ -59,6 +59,7 @@ public:
 
     void    init(SLScene* s);
     bool    hitRec(SLRay* ray) override;
+    bool    hitAnyRec(SLRay* ray) override { return false; }
     void    statsRec(SLNodeStats& stats) override;
     void    drawMesh(SLSceneView* sv) override;
     SLfloat shadowTest(SLRay*         ray,
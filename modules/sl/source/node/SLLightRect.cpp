@@ -142,7 +142,7 @@ SLfloat SLLightRect::shadowTest(SLRay*         ray,       // ray of hit point
         // define shadow ray
         SLRay shadowRay(lightDist, L, ray);
 
-        root3D->hitRec(&shadowRay);
+        root3D->hitAnyRec(&shadowRay);
 
         return (shadowRay.length < lightDist) ? 0.0f : 1.0f;
     }
@@ -151,23 +151,13 @@ SLfloat SLLightRect::shadowTest(SLRay*         ray,       // ray of hit point
         SLfloat dw = (SLfloat)_width / (SLfloat)_samples.x;  // width of a sample cell
         SLfloat dl = (SLfloat)_height / (SLfloat)_samples.y; // length of a sample cell
         SLint   x = 0, y = 0, hx = _samples.x / 2, hy = _samples.y / 2;
-        SLint   samples = _samples.x * _samples.y;
-        SLVbool isSampled;
+        SLint   samples                    = _samples.x * _samples.y;
         SLbool  importantPointsAreLighting = true;
         SLfloat lighted                    = 0.0f; // return value
         SLfloat invSamples                 = 1.0f / (SLfloat)(samples);
         SLVec3f SP; // vector hit point to sample point in world coords
 
-        isSampled.resize((SLuint)samples);
-
-        for (y = 0; y < _samples.y; ++y)
-        {
-            for (x = 0; x < _samples.x; ++x)
-            {
-                SLint iSP              = y * _samples.x + x;
-                isSampled[(SLuint)iSP] = false;
-            }
-        }
+        const SLMat4f& wm = updateAndGetWM(); // light to world matrix
 
         /*
         Important sample points (X) on a 7 by 5 rectangular light.
@@ -193,15 +183,12 @@ SLfloat SLLightRect::shadowTest(SLRay*         ray,       // ray of hit point
         {
             for (x = -hx; x <= hx; x += hx)
             {
-                SLint iSP              = (y + hy) * _samples.x + x + hx;
-                isSampled[(SLuint)iSP] = true;
-
-                SP.set(updateAndGetWM().multVec(SLVec3f(x * dw, y * dl, 0)) - ray->hitPoint);
+                SP.set(wm.multVec(SLVec3f(x * dw, y * dl, 0)) - ray->hitPoint);
                 SLfloat SPDist = SP.length();
                 SP.normalize();
                 SLRay shadowRay(SPDist, SP, ray);
 
-                root3D->hitRec(&shadowRay);
+                root3D->hitAnyRec(&shadowRay);
 
                 if (shadowRay.length >= SPDist - FLT_EPSILON)
                     lighted += invSamples; // sum up the light
@@ -218,15 +205,17 @@ SLfloat SLLightRect::shadowTest(SLRay*         ray,       // ray of hit point
             {
                 for (x = -hx; x <= hx; ++x)
                 {
-                    SLint iSP = (y + hy) * _samples.x + x + hx;
-                    if (!isSampled[(SLuint)iSP])
+                    // Skip the important sample points tested above
+                    SLbool isImportant = (x == -hx || x == 0 || x == hx) &&
+                                         (y == -hy || y == 0 || y == hy);
+                    if (!isImportant)
                     {
-                        SP.set(updateAndGetWM().multVec(SLVec3f(x * dw, y * dl, 0)) - ray->hitPoint);
+                        SP.set(wm.multVec(SLVec3f(x * dw, y * dl, 0)) - ray->hitPoint);
                         SLfloat SPDist = SP.length();
                         SP.normalize();
                         SLRay shadowRay(SPDist, SP, ray);
 
-                        root3D->hitRec(&shadowRay);
+                        root3D->hitAnyRec(&shadowRay);
 
                         // sum up the light
                         if (shadowRay.length >= SPDist - FLT_EPSILON)
@@ -263,7 +252,7 @@ SLfloat SLLightRect::shadowTestMC(SLRay*         ray,       // ray of hit point
     spWS.normalize();
     SLRay shadowRay(spDistWS, spWS, ray);
 
-    root3D->hitRec(&shadowRay);
+    root3D->hitAnyRec(&shadowRay);
 
     return (shadowRay.length < spDistWS) ? 0.0f : 1.0f;
 }
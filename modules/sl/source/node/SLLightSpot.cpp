@@ -235,7 +235,7 @@ SLfloat SLLightSpot::shadowTest(SLRay*         ray,       // ray of hit point
     {
         // define shadow ray and shoot
         SLRay shadowRay(lightDist, L, ray);
-        root3D->hitRec(&shadowRay);
+        root3D->hitAnyRec(&shadowRay);
 
         if (shadowRay.length < lightDist && shadowRay.hitMesh)
         {
@@ -290,7 +290,7 @@ SLfloat SLLightSpot::shadowTest(SLRay*         ray,       // ray of hit point
 
                 SLRay shadowRay(lightDist, LDisc, ray);
 
-                root3D->hitRec(&shadowRay);
+                root3D->hitAnyRec(&shadowRay);
 
                 if (shadowRay.length < lightDist)
                     outerCircleIsLighting = false;
@@ -328,7 +328,7 @@ SLfloat SLLightSpot::shadowTestMC(SLRay*         ray,       // ray of hit point
     {
         // define shadow ray and shoot
         SLRay shadowRay(lightDist, L, ray);
-        root3D->hitRec(&shadowRay);
+        root3D->hitAnyRec(&shadowRay);
 
         if (shadowRay.length < lightDist)
         {
@@ -383,7 +383,7 @@ SLfloat SLLightSpot::shadowTestMC(SLRay*         ray,       // ray of hit point
 
                 SLRay shadowRay(lightDist, LDisc, ray);
 
-                root3D->hitRec(&shadowRay);
+                root3D->hitAnyRec(&shadowRay);
 
                 if (shadowRay.length < lightDist)
                     outerCircleIsLighting = false;
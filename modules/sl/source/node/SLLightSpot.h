@@ -55,6 +55,7 @@ public:
 
     void    init(SLScene* s);
     bool    hitRec(SLRay* ray) override;
+    bool    hitAnyRec(SLRay* ray) override { return false; }
     void    statsRec(SLNodeStats& stats) override;
     void    drawMesh(SLSceneView* sv) override;
     void    createShadowMap(float   lightClipNear = 0.1f,
@@ -18,6 +18,10 @@
 #include <SLEntities.h>
 #include <SLSceneView.h>
 #include <Profiler.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using std::cout;
 using std::endl;
@@ -26,7 +30,7 @@ unsigned int SLNode::instanceIndex = 0;
 
 //-----------------------------------------------------------------------------
 // Static updateRec counter
-SLuint SLNode::numWMUpdates = 0;
+std::atomic<SLuint> SLNode::numWMUpdates(0);
 //-----------------------------------------------------------------------------
 /*!
 Default constructor just setting the name.
@@ -132,11 +136,15 @@ SLNode::~SLNode()
         delete child;
     _children.clear();
 
+    if (_mesh)
+        _mesh->removeNode(this);
+
     delete _animation;
 }
 //-----------------------------------------------------------------------------
 /*!
-Simply adds a mesh to its mesh pointer vector of the node.
+Simply adds a mesh to its mesh pointer vector of the node. The node is also
+added to the nodes of the mesh (see SLMesh::nodes).
 */
 void SLNode::addMesh(SLMesh* mesh)
 {
@@ -146,7 +154,11 @@ void SLNode::addMesh(SLMesh* mesh)
     if (_name == "Node" && mesh->name() != "Mesh")
         _name = mesh->name() + "-Node";
 
+    if (_mesh && _mesh != mesh)
+        _mesh->removeNode(this);
+
     _mesh = mesh;
+    mesh->addNode(this);
 
     _isAABBUpToDate = false;
     mesh->init(this);
@@ -168,6 +180,7 @@ bool SLNode::removeMesh()
 {
     if (_mesh)
     {
+        _mesh->removeNode(this);
         _mesh = nullptr;
         return true;
     }
@@ -179,6 +192,7 @@ bool SLNode::removeMesh(SLMesh* mesh)
 {
     if (_mesh == mesh && mesh != nullptr)
     {
+        _mesh->removeNode(this);
         _mesh = nullptr;
         return true;
     }
@@ -550,6 +564,58 @@ bool SLNode::hitRec(SLRay* ray)
     return meshWasHit;
 }
 //-----------------------------------------------------------------------------
+/*!
+Any hit intersection for shadow rays. In contrast to SLNode::hitRec the
+traversal stops at the first mesh that blocks the ray between its origin and
+ray->length (the distance to the light) and no closest hit is searched.
+Returns true if the ray is blocked. Transparent meshes shorten the ray length
+but do not stop the traversal (see SLMesh::hitAny), so the caller must still
+check ray->isShaded() for the partial shadow of transparent materials.
+*/
+bool SLNode::hitAnyRec(SLRay* ray)
+{
+    assert(ray != nullptr);
+
+    // Do not test hidden nodes
+    if (_drawBits.get(SL_DB_HIDDEN))
+        return false;
+
+    // Check first AABB for intersection within the ray length
+    if (!_aabb.isHitInWS(ray))
+        return false;
+
+    if (_mesh == nullptr)
+    {
+        // Cameras are hit like in SLNode::hitRec
+        if (dynamic_cast<SLCamera*>(this) && ray->sv->camera() != this)
+        {
+            SLVec3f OC = _aabb.centerWS() - ray->origin;
+            if (OC.length() < ray->length)
+            {
+                ray->hitNode = this;
+                ray->hitMesh = nullptr;
+                ray->length  = OC.length();
+                return true;
+            }
+        }
+    }
+    else
+    {
+        // transform ray to object space
+        ray->originOS.set(updateAndGetWMI().multVec(ray->origin));
+        ray->setDirOS(_wmI.mat3() * ray->dir);
+
+        if (_mesh->hitAny(ray, this))
+            return true;
+    }
+
+    for (auto* child : _children)
+        if (child->hitAnyRec(ray))
+            return true;
+
+    return false;
+}
+//-----------------------------------------------------------------------------
 /*!
  Returns a deep copy of the node and its children recursively. The meshes do
  not get copied.
@@ -755,6 +821,231 @@ SLAABBox& SLNode::updateAABBRec(SLbool updateAlsoAABBinOS)
     return _aabb;
 }
 //-----------------------------------------------------------------------------
+/*! Updates the world matrices of all nodes with an out of date AABB
+ * recursively and adds their meshes to the passed vector.
+ */
+void SLNode::updateWMRec(SLVMesh& meshes)
+{
+    updateAndGetWM();
+
+    if (_mesh)
+        meshes.push_back(_mesh);
+
+    for (auto* child : _children)
+        if (!child->_isAABBUpToDate)
+            child->updateWMRec(meshes);
+}
+//-----------------------------------------------------------------------------
+//! Persistent worker threads of SLNode::updateAABBRecParallel
+/*! The threads are started on demand and then wait on a condition variable for
+ * the next frame, so that the parallel update doesn't spawn and join threads
+ * every frame. run calls func(t) with t = 1..numWorkers on the workers and
+ * returns immediately. wait blocks until all of them have returned. A pool
+ * must only be used by one thread at a time.
+ */
+class SLNodeUpdateWorkers
+{
+public:
+    ~SLNodeUpdateWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wakeUp.notify_all();
+        for (auto& thread : _threads)
+            thread.join();
+    }
+
+    void run(SLuint numWorkers, const function<void(SLuint)>& func)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (_threads.size() < numWorkers)
+            _threads.emplace_back(&SLNodeUpdateWorkers::loop,
+                                  this,
+                                  (SLuint)_threads.size() + 1,
+                                  _generation);
+        _func       = func;
+        _numActive  = numWorkers;
+        _numRunning = numWorkers;
+        _generation++;
+        _wakeUp.notify_all();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [&]() { return _numRunning == 0; });
+    }
+
+private:
+    void loop(SLuint t, SLuint generation)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _wakeUp.wait(lock, [&]() { return _stop || _generation != generation; });
+            if (_stop)
+                return;
+            generation = _generation;
+
+            // Workers above the requested number sleep this frame
+            if (t > _numActive)
+                continue;
+
+            lock.unlock();
+            _func(t);
+            lock.lock();
+
+            if (--_numRunning == 0)
+                _done.notify_all();
+        }
+    }
+
+    vector<thread>          _threads;        //!< Worker threads started so far
+    std::mutex              _mutex;          //!< Mutex for all members below
+    std::condition_variable _wakeUp;         //!< Wakes the workers for a new run
+    std::condition_variable _done;           //!< Signals the end of the last worker
+    function<void(SLuint)>  _func;           //!< Function of the current run
+    SLuint                  _numActive  = 0; //!< NO. of workers of the current run
+    SLuint                  _numRunning = 0; //!< NO. of workers not finished yet
+    SLuint                  _generation = 0; //!< Incremented for every run
+    SLbool                  _stop       = false;
+};
+//-----------------------------------------------------------------------------
+/*! Updates the world matrices and AABBs like updateAABBRec but distributes the
+ * out of date subtrees over up to Utils::maxThreads() threads:
+ * 1) The top levels are expanded on the calling thread until there are enough
+ *    out of date subtrees. Their world matrices are updated on the way down, so
+ *    that no two threads update the same parent.
+ * 2) The world matrices of the subtrees are updated in parallel and the meshes
+ *    of their nodes are collected. The worker threads are kept alive in a
+ *    pool over all frames and wait for step 3 before they continue with
+ *    step 4.
+ * 3) The min & max points of these meshes get frozen. Many nodes can share a
+ *    mesh, so that the mesh must only be read in the next step.
+ * 4) The AABBs of the subtrees are updated in parallel.
+ * 5) The AABBs of the top levels are merged by updateAABBRec on the calling
+ *    thread.
+ * Small scene graphs with only a few out of date subtrees are updated with
+ * updateAABBRec only. The onUpdate callbacks (see updateRec) are never
+ * called from this function.
+ */
+SLAABBox& SLNode::updateAABBRecParallel(SLbool updateAlsoAABBinOS)
+{
+    PROFILE_FUNCTION();
+
+    if (_isAABBUpToDate)
+        return _aabb;
+
+    const SLuint maxThreads    = Utils::maxThreads();
+    const size_t minNumJobs    = 64;
+    const size_t targetNumJobs = std::max(minNumJobs, (size_t)maxThreads * 16);
+    const SLint  maxLevels     = 8;
+
+    // 1) Expand the top levels until we have enough subtrees
+    vector<SLNode*> jobs = {this};
+    for (SLint level = 0; level < maxLevels && jobs.size() < targetNumJobs; ++level)
+    {
+        vector<SLNode*> nextJobs;
+        for (auto* node : jobs)
+        {
+            node->updateAndGetWM();
+            for (auto* child : node->_children)
+                if (!child->_isAABBUpToDate)
+                    nextJobs.push_back(child);
+        }
+        if (nextJobs.empty())
+            break;
+        jobs.swap(nextJobs);
+    }
+
+    if (maxThreads < 2 || jobs.size() < minNumJobs)
+        return updateAABBRec(updateAlsoAABBinOS);
+
+    // Calls func(job, threadIndex) for all jobs in batches of 8
+    const size_t batchSize = 8;
+    auto         doJobs    = [&](atomic<size_t>&                        nextJob,
+                                 const function<void(SLNode*, SLuint)>& func,
+                                 SLuint                                 t)
+    {
+        for (size_t b = nextJob.fetch_add(batchSize);
+             b < jobs.size();
+             b = nextJob.fetch_add(batchSize))
+        {
+            size_t e = std::min(jobs.size(), b + batchSize);
+            for (size_t j = b; j < e; ++j)
+                func(jobs[j], t);
+        }
+    };
+
+    // The world matrix pass collects the meshes per thread
+    SLuint          numThreads = std::min(maxThreads, (SLuint)(jobs.size() / 8));
+    vector<SLVMesh> meshesPerThread(numThreads);
+    atomic<size_t>  nextWMJob(0);
+    auto            updateWM = [&](SLNode* node, SLuint t)
+    { node->updateWMRec(meshesPerThread[t]); };
+
+    // The AABB pass may only read the frozen meshes
+    atomic<size_t> nextAABBJob(0);
+    auto           updateAABB = [&](SLNode* node, SLuint)
+    { node->updateAABBRec(updateAlsoAABBinOS); };
+
+    // The same worker threads do both passes. Between the passes they wait
+    // until the calling thread has frozen the meshes in step 3.
+    std::mutex              mutex;
+    std::condition_variable condition;
+    SLuint                  numWMDone    = 0;
+    SLbool                  meshesFrozen = false;
+
+    auto worker = [&](SLuint t)
+    {
+        doJobs(nextWMJob, updateWM, t);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            numWMDone++;
+            condition.notify_all();
+            condition.wait(lock, [&]() { return meshesFrozen; });
+        }
+        doJobs(nextAABBJob, updateAABB, t);
+    };
+
+    // 2) Update the world matrices and collect the meshes
+    static SLNodeUpdateWorkers workers;
+    workers.run(numThreads - 1, worker);
+
+    doJobs(nextWMJob, updateWM, 0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [&]() { return numWMDone == numThreads - 1; });
+    }
+
+    // 3) Freeze the min & max points of every mesh once
+    SLVMesh meshes;
+    for (auto& threadMeshes : meshesPerThread)
+        meshes.insert(meshes.end(), threadMeshes.begin(), threadMeshes.end());
+    std::sort(meshes.begin(), meshes.end());
+    meshes.erase(std::unique(meshes.begin(), meshes.end()), meshes.end());
+    for (auto* mesh : meshes)
+        mesh->freezeMinMaxOS(true);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        meshesFrozen = true;
+    }
+    condition.notify_all();
+
+    // 4) Update the AABBs of the subtrees
+    doJobs(nextAABBJob, updateAABB, 0);
+    workers.wait();
+
+    for (auto* mesh : meshes)
+        mesh->freezeMinMaxOS(false);
+
+    // 5) Merge the top levels
+    return updateAABBRec(updateAlsoAABBinOS);
+}
+//-----------------------------------------------------------------------------
 /*! Prints the node name with the names of the meshes recursively
  */
 void SLNode::dumpRec()
@@ -15,6 +15,7 @@
 #include <SLEventHandler.h>
 #include <SLMesh.h>
 #include <SLQuat4.h>
+#include <atomic>
 #include <deque>
 
 using std::deque;
@@ -51,6 +52,13 @@ struct SLNodeStats
     SLuint  numVoxMaxTria;   //!< Max. no. of triangles per voxel
     SLuint  numAnimations;   //!< NO. of animations
 
+    SLuint  numMeshesOptimized;    //!< NO. of meshes optimized by SLMeshOptimizer
+    SLuint  numTrianglesOptimized; //!< NO. of triangles in optimized meshes
+    SLfloat numCacheMissesBefore;  //!< NO. of vertex cache misses before optimization
+    SLfloat numCacheMissesAfter;   //!< NO. of vertex cache misses after optimization
+    SLuint  numBytesBeforeOpt;     //!< NO. of mesh bytes before optimization
+    SLuint  numBytesAfterOpt;      //!< NO. of mesh bytes after optimization
+
     //! Resets all counters to zero
     void clear()
     {
@@ -67,8 +75,21 @@ struct SLNodeStats
         numVoxEmpty   = 0.0f;
         numVoxMaxTria = 0;
         numAnimations = 0;
+
+        numMeshesOptimized    = 0;
+        numTrianglesOptimized = 0;
+        numCacheMissesBefore  = 0.0f;
+        numCacheMissesAfter   = 0.0f;
+        numBytesBeforeOpt     = 0;
+        numBytesAfterOpt      = 0;
     }
 
+    //! Returns the avg. cache miss ratio of the optimized meshes before the optimization
+    SLfloat acmrBefore() const { return numTrianglesOptimized ? numCacheMissesBefore / (SLfloat)numTrianglesOptimized : 0.0f; }
+
+    //! Returns the avg. cache miss ratio of the optimized meshes after the optimization
+    SLfloat acmrAfter() const { return numTrianglesOptimized ? numCacheMissesAfter / (SLfloat)numTrianglesOptimized : 0.0f; }
+
     //! Prints all statistic informations on the std out stream.
     void print() const
     {
@@ -88,6 +109,11 @@ struct SLNodeStats
         SL_LOG("Leaf Nodes     : %d", numNodesLeaf);
         SL_LOG("Meshes         : %d", numMeshes);
         SL_LOG("Triangles      : %d", numTriangles);
+        SL_LOG("Optim. Meshes  : %d", numMeshesOptimized);
+        SL_LOG("ACMR before    : %4.2f", acmrBefore());
+        SL_LOG("ACMR after     : %4.2f", acmrAfter());
+        SL_LOG("MB before Opt. : %f", (SLfloat)numBytesBeforeOpt / 1000000.0f);
+        SL_LOG("MB after Opt.  : %f", (SLfloat)numBytesAfterOpt / 1000000.0f);
         SL_LOG("Lights         : %d\n", numLights);
     }
 };
@@ -131,7 +157,12 @@ struct SLNodeStats
  * which the scene can be viewed (see also SLSceneView). The SLLightSpot
  * and SLLightRect are derived from SLNode and represent light sources in the
  * scene. Cameras and lights can be placed in the scene because of their
- * inheritance of SLNode.\n
+ * inheritance of SLNode.\n\n
+ *
+ * For large scene graphs the world matrices and AABBs are updated with
+ * SLNode::updateAABBRecParallel. The out of date subtrees below the top levels
+ * are distributed over multiple threads and the top levels are merged on the
+ * calling thread.\n
  */
 class SLNode
   : public SLObject
@@ -153,9 +184,11 @@ public:
     virtual void      cullChildren3D(SLSceneView* sv);
     virtual void      cull2DRec(SLSceneView* sv);
     virtual bool      hitRec(SLRay* ray);
+    virtual bool      hitAnyRec(SLRay* ray);
     virtual void      statsRec(SLNodeStats& stats);
     virtual SLNode*   copyRec();
     virtual SLAABBox& updateAABBRec(SLbool updateAlsoAABBinOS);
+    SLAABBox&         updateAABBRecParallel(SLbool updateAlsoAABBinOS);
     virtual void      dumpRec();
     void              setDrawBitsRec(SLuint bit, SLbool state);
     void              setPrimitiveTypeRec(SLGLPrimitiveType primitiveType);
@@ -285,6 +318,8 @@ public:
     const SLMat4f&        initialOM() { return _initialOM; }
     const SLMat4f&        updateAndGetWM() const;
     const SLMat4f&        updateAndGetWMI() const;
+    const SLMat4f&        wm() const { return _wm; }
+    SLbool                isWMUpToDate() const { return _isWMUpToDate; }
     SLDrawBits*           drawBits() { return &_drawBits; }
     SLbool                drawBit(SLuint bit) { return _drawBits.get(bit); }
     SLAABBox*             aabb() { return &_aabb; }
@@ -304,7 +339,7 @@ public:
     SLfloat               minLodCoverage() { return _minLodCoverage; }
     SLubyte               levelForSM() { return _levelForSM; }
 
-    static SLuint numWMUpdates; //!< NO. of calls to updateWMRec per frame
+    static std::atomic<SLuint> numWMUpdates; //!< NO. of calls to updateWM per frame
 
     static unsigned int instanceIndex; //!< ???
 
@@ -316,6 +351,7 @@ public:
 
 private:
     void updateWM() const;
+    void updateWMRec(SLVMesh& meshes);
     template<typename T>
     void findChildrenHelper(const SLstring& name,
                             deque<T*>&      list,
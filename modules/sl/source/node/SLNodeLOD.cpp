@@ -9,6 +9,7 @@
 
 #include <SLSceneView.h>
 #include <SLNodeLOD.h>
+#include <SLMeshSimplifier.h>
 
 //-----------------------------------------------------------------------------
 //! Adds an LOD node with forced decreasing min LOD coverage
@@ -46,6 +47,103 @@ void SLNodeLOD::addChildLOD(SLNode* childToAdd,
     childToAdd->drawBits()->set(SL_DB_HIDDEN, true);
 }
 //-----------------------------------------------------------------------------
+/*!
+ * Generates the simplified levels of a mesh with SLMeshSimplifier and adds
+ * them together with the original mesh as LOD children. A level is used as
+ * long as the error of the next coarser level would exceed the max. pixel
+ * error. A level with the relative error e covers about sqrt(coverage) *
+ * viewportSize pixels, so its error in pixels is e * sqrt(coverage) *
+ * viewportSize. The min. coverage of a level is therefore the coverage at
+ * which the next level reaches the max. pixel error.
+ * @param assetMgr Asset manager that owns the generated meshes
+ * @param mesh Triangle mesh with the full resolution
+ * @param settings Simplification and error settings
+ * @return Number of LOD children added (0 if the mesh can not be simplified)
+ */
+SLuint SLNodeLOD::addChildrenLOD(SLAssetManager*          assetMgr,
+                                 SLMesh*                  mesh,
+                                 const SLNodeLODSettings& settings)
+{
+    SLVfloat errors;
+    SLVMesh  lodMeshes = SLMeshSimplifier::createLODChain(assetMgr,
+                                                         mesh,
+                                                         settings.triangleRatios,
+                                                         settings.maxError,
+                                                         settings.cacheDir,
+                                                         errors);
+    if (lodMeshes.empty())
+        return 0;
+
+    lodMeshes.insert(lodMeshes.begin(), mesh);
+    const SLfloat minCoverage  = 0.00001f;
+    SLfloat       lastCoverage = 1.0f;
+
+    for (SLuint i = 0; i < lodMeshes.size(); ++i)
+    {
+        SLfloat coverage = minCoverage;
+        if (i + 1 < lodMeshes.size())
+        {
+            SLfloat nextErrorPx = errors[i] * settings.viewportSize;
+            if (nextErrorPx > 0.0f)
+            {
+                SLfloat side = settings.maxPixelError / nextErrorPx;
+                coverage     = side * side;
+            }
+            coverage = std::min(coverage, lastCoverage * 0.9f);
+            coverage = std::max(coverage, minCoverage * (SLfloat)(lodMeshes.size() - i));
+        }
+
+        // The level 0 node gets a suffix as well, so that findChild with
+        // the name of the original node doesn't return a level node.
+        SLstring levelName = i == 0 ? mesh->name() + "-LOD0" : lodMeshes[i]->name();
+        addChildLOD(new SLNode(lodMeshes[i], levelName), coverage);
+        lastCoverage = coverage;
+    }
+
+    return (SLuint)lodMeshes.size();
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Replaces the mesh of all nodes in the subtree that have a triangle mesh
+ * with at least settings.minNumTriangles by a child LOD group node with
+ * generated levels. Existing LOD groups are not changed.
+ * @param node Root node of the subtree
+ * @param assetMgr Asset manager that owns the generated meshes
+ * @param settings Simplification and error settings
+ * @return Number of LOD group nodes created
+ */
+SLuint SLNodeLOD::addLODsRec(SLNode*                  node,
+                             SLAssetManager*          assetMgr,
+                             const SLNodeLODSettings& settings)
+{
+    if (dynamic_cast<SLNodeLOD*>(node))
+        return 0;
+
+    // Copy the children because a LOD group gets added to them
+    SLVNode children     = node->children();
+    SLuint  numLODGroups = 0;
+    for (auto* child : children)
+        numLODGroups += addLODsRec(child, assetMgr, settings);
+
+    SLMesh* mesh = node->mesh();
+    if (mesh &&
+        mesh->primitive() == PT_triangles &&
+        mesh->numI() / 3 >= settings.minNumTriangles)
+    {
+        SLNodeLOD* lodGroup = new SLNodeLOD(node->name() + "-LOD");
+        if (lodGroup->addChildrenLOD(assetMgr, mesh, settings))
+        {
+            node->removeMesh();
+            node->addChild(lodGroup);
+            numLODGroups++;
+        }
+        else
+            delete lodGroup;
+    }
+
+    return numLODGroups;
+}
+//-----------------------------------------------------------------------------
 //! Culls the LOD children by evaluating the the screen space coverage
 void SLNodeLOD::cullChildren3D(SLSceneView* sv)
 {
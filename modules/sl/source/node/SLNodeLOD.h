@@ -12,6 +12,19 @@
 
 #include <SLNode.h>
 
+class SLAssetManager;
+
+//-----------------------------------------------------------------------------
+//! Settings for the automatic LOD generation of SLNodeLOD
+struct SLNodeLODSettings
+{
+    SLVfloat triangleRatios  = {0.5f, 0.25f, 0.1f}; //!< Triangle ratio of each generated level
+    SLfloat  maxError        = 0.05f;               //!< Max. geometric error relative to the mesh size
+    SLfloat  maxPixelError   = 1.0f;                //!< Max. visible error in pixels
+    SLfloat  viewportSize    = 1080.0f;             //!< Viewport size in pixels for the error estimation
+    SLuint   minNumTriangles = 1000;                //!< Meshes with less triangles get no LODs
+    SLstring cacheDir;                              //!< Directory of the LOD cache files (empty: no cache)
+};
 //-----------------------------------------------------------------------------
 //! Level of detail (LOD) group node based on screen space coverage
 /*! An LOD group node can be used to improve the rendering performance for a
@@ -19,10 +32,15 @@
  details mesh doesn't need to be detailed in full resolution if the mesh is
  displayed far away from the camera because you can see all triangles anyway.
  We therefore need to create multiple levels of details with lower no. of
- triangles and vertices. You have to create these lower resolution version of
- an original mesh in an external program such as Blender that has multiple
+ triangles and vertices. These lower resolution versions of an original mesh
+ can be created in an external program such as Blender that has multiple
  decimation algorithms for this purpose.\n
- See the method addChildLOD for more information how to add the levels.
+ See the method addChildLOD for more information how to add the levels.\n
+ Alternatively the levels can be generated at load time with the quadric
+ error simplifier SLMeshSimplifier: addChildrenLOD creates the levels for
+ a single mesh and addLODsRec replaces all big meshes in a scene graph by LOD
+ groups. The coverage limits are then derived from the geometric error of
+ the levels so that the visible error stays below a pixel limit.
  */
 class SLNodeLOD : public SLNode
 {
@@ -32,7 +50,14 @@ public:
     void         addChildLOD(SLNode* child,
                              SLfloat minLodLimit,
                              SLubyte levelForSM = 0);
+    SLuint       addChildrenLOD(SLAssetManager*          assetMgr,
+                                SLMesh*                  mesh,
+                                const SLNodeLODSettings& settings);
     virtual void cullChildren3D(SLSceneView* sv);
+
+    static SLuint addLODsRec(SLNode*                  node,
+                             SLAssetManager*          assetMgr,
+                             const SLNodeLODSettings& settings);
 };
 //-----------------------------------------------------------------------------
 #endif
\ No newline at end of file
@@ -41,6 +41,7 @@ public:
     void      statsRec(SLNodeStats& stats) override;
     SLAABBox& updateAABBRec(SLbool updateAlsoAABBinOS) override;
     SLbool    hitRec(SLRay* ray) override { return false; }
+    SLbool    hitAnyRec(SLRay* ray) override { return false; }
     void      drawMesh(SLSceneView* sv) override { drawText(sv); };
     void      preShade(SLRay* ray) { ; }
 
@@ -22,11 +22,48 @@ extern SLfloat rnd01();
 SLPathtracer::SLPathtracer()
 {
     name("PathTracer");
-    _calcDirect   = true;
-    _calcIndirect = true;
+    _calcDirect         = true;
+    _calcIndirect       = true;
+    _doDenoise          = false;
+    _doDenoiseCompare   = false;
+    _denoiseIterations  = 5;
+    _denoiseColorSigma  = 1.0f;
+    _denoiseNormalSigma = 0.3f;
+    _denoiseDepthSigma  = 0.05f;
+    _denoiseAlbedoSigma = 0.1f;
+    _denoiserMS         = 0.0f;
     gamma(2.2f);
 }
 //-----------------------------------------------------------------------------
+//! Appends the gamma corrected RGB bytes of a linear color buffer
+static void colorsToBytes(const SLVVec3f& colors,
+                          SLfloat         oneOverGamma,
+                          SLVuchar&       bytes)
+{
+    bytes.resize(colors.size() * 3);
+    for (SLuint i = 0; i < colors.size(); ++i)
+    {
+        SLCol4f c(colors[i].x, colors[i].y, colors[i].z);
+        c.clampMinMax(0.0f, 1.0f);
+        c.gammaCorrect(oneOverGamma);
+        bytes[i * 3 + 0] = (SLuchar)(c.r * 255.0f + 0.5f);
+        bytes[i * 3 + 1] = (SLuchar)(c.g * 255.0f + 0.5f);
+        bytes[i * 3 + 2] = (SLuchar)(c.b * 255.0f + 0.5f);
+    }
+}
+//-----------------------------------------------------------------------------
+//! Returns the root mean square error of two RGB byte images in [0,1]
+static SLfloat rmse(const SLVuchar& a, const SLVuchar& b)
+{
+    double sum = 0.0;
+    for (SLuint i = 0; i < a.size(); ++i)
+    {
+        double d = ((double)a[i] - (double)b[i]) / 255.0;
+        sum += d * d;
+    }
+    return a.empty() ? 0.0f : (SLfloat)sqrt(sum / (double)a.size());
+}
+//-----------------------------------------------------------------------------
 /*!
 Main render function. The Path Tracing algorithm starts from here
 */
@@ -60,6 +97,28 @@ SLbool SLPathtracer::render(SLSceneView* sv)
                                      std::placeholders::_2,
                                      std::placeholders::_3);
 
+    // Feature buffers for the denoiser
+    SLuint numPixels = _images[0]->width() * _images[0]->height();
+    if (_doDenoise)
+    {
+        _colorBuffer.assign(numPixels, SLVec3f::ZERO);
+        _albedoBuffer.assign(numPixels, SLVec3f::ZERO);
+        _normalBuffer.assign(numPixels, SLVec3f::ZERO);
+        _depthBuffer.assign(numPixels, 0.0f);
+    }
+    else
+    {
+        _colorBuffer.clear();
+        _albedoBuffer.clear();
+        _normalBuffer.clear();
+        _depthBuffer.clear();
+    }
+    _denoiserMS = 0.0f;
+
+    _snapshots.clear();
+    SLfloat denoiseSec   = 0.0f; // total time of denoising
+    double  tLastDenoise = 0.0;  // time of the last denoising
+
     // Do multi-threading only in release config
     SL_LOG("\n\nRendering with %d samples", _aaSamples);
     SL_LOG("\nCurrent Sample:       ");
@@ -78,11 +137,42 @@ SLbool SLPathtracer::render(SLSceneView* sv)
         for (auto& thread : threads)
             thread.join();
 
+        // Denoise after the last pass, for the comparison snapshots at 1, 2,
+        // 4, ... samples and otherwise not more often than the window gets
+        // updated.
+        if (_doDenoise)
+        {
+            SLbool isLast     = currentSample == _aaSamples;
+            SLbool isSnapshot = _doDenoiseCompare &&
+                                (currentSample & (currentSample - 1)) == 0 &&
+                                currentSample * 4 <= _aaSamples;
+
+            if (isLast || isSnapshot || GlobalTimer::timeS() - tLastDenoise > 0.5)
+            {
+                double  tDenoise = GlobalTimer::timeS();
+                SLfloat ptSec    = (SLfloat)(tDenoise - t1) - denoiseSec;
+                denoise(currentSample);
+                tLastDenoise = GlobalTimer::timeS();
+                _denoiserMS  = (SLfloat)(tLastDenoise - tDenoise) * 1000.0f;
+                denoiseSec += (SLfloat)(tLastDenoise - tDenoise);
+
+                if (isSnapshot)
+                    addDenoiseSnapshot(currentSample, ptSec);
+
+                renderUIBeforeUpdate();
+                _sv->onWndUpdate();
+            }
+        }
+
         _progressPC = (SLint)((SLfloat)currentSample / (SLfloat)_aaSamples * 100.0f);
     }
 
+    if (!_snapshots.empty())
+        logDenoiseComparison();
+
     _renderSec = GlobalTimer::timeS() - (SLfloat)t1;
     _raysPerMS.set((float)SLRay::totalNumRays() / _renderSec / 1000.0f);
+    PROFILE_COUNTER("Rays per ms", _raysPerMS.average());
     _progressPC = 100;
 
     SL_LOG("\nTime to render image: %6.3fsec", _renderSec);
@@ -117,7 +207,7 @@ void SLPathtracer::renderSlices(const bool isMainThread,
         _nextLine += 4;
         _mutex.unlock();
 
-        for (SLint x = minX; x < minX + 4; ++x)
+        for (SLint x = minX; x < minX + 4 && x < (SLint)_images[0]->width(); ++x)
         {
             for (SLuint y = 0; y < _images[0]->height(); ++y)
             {
@@ -133,6 +223,9 @@ void SLPathtracer::renderSlices(const bool isMainThread,
                 color += trace(&primaryRay, false);
                 ///////////////////////////////////
 
+                if (!_colorBuffer.empty())
+                    updateFeatures(x, (SLint)y, currentSample, &primaryRay, color);
+
                 // weight old and new color for continuous rendering
                 SLCol4f oldColor;
                 if (currentSample > 1)
@@ -163,13 +256,14 @@ void SLPathtracer::renderSlices(const bool isMainThread,
 
                 color.gammaCorrect(_oneOverGamma);
 
-                // image to render
-                _images[0]->setPixeliRGB(x,
-                                         (SLint)y,
-                                         CVVec4f(color.r,
-                                                 color.g,
-                                                 color.b,
-                                                 color.a));
+                // image to render (the denoiser writes it if enabled)
+                if (_colorBuffer.empty())
+                    _images[0]->setPixeliRGB(x,
+                                             (SLint)y,
+                                             CVVec4f(color.r,
+                                                     color.g,
+                                                     color.b,
+                                                     color.a));
             }
 
             // update image after 500 ms
@@ -187,6 +281,249 @@ void SLPathtracer::renderSlices(const bool isMainThread,
 }
 //-----------------------------------------------------------------------------
 /*!
+Updates the running averages of the denoiser feature buffers at pixel x, y
+with the color and the first hit of the primary ray of the current sample.
+The albedo is the object color that trace() selects at the first hit: The
+emissive color of lights, otherwise the diffuse color (multiplied with the
+texture color of textured materials), the specular or the transmissive color.
+The absorption of participating media is not part of the albedo.
+*/
+void SLPathtracer::updateFeatures(SLint          x,
+                                  SLint          y,
+                                  SLint          currentSample,
+                                  SLRay*         primaryRay,
+                                  const SLCol4f& color)
+{
+    SLVec3f albedo = SLVec3f::ZERO;
+    SLVec3f normal = SLVec3f::ZERO;
+    SLfloat depth  = 0.0f;
+
+    if (primaryRay->length < FLT_MAX && primaryRay->hitMesh)
+    {
+        SLMaterial* mat = primaryRay->hitMesh->mat();
+        SLCol4f     c   = SLCol4f::BLACK;
+
+        if (mat->emissive().maxXYZ() > 0)
+            c = mat->emissive();
+        else if (primaryRay->hitMatIsDiffuse())
+        {
+            c = mat->diffuse();
+            if (mat->numTextures() > 0)
+                c &= primaryRay->hitTexColor;
+        }
+        else if (primaryRay->hitMatIsReflective())
+            c = mat->specular();
+        else if (primaryRay->hitMatIsTransparent())
+            c = mat->transmissive();
+
+        c.clampMinMax(0.0f, 1.0f);
+        albedo.set(c.r, c.g, c.b);
+        normal = primaryRay->hitNormal.normalized();
+        depth  = primaryRay->length;
+    }
+
+    SLuint  i = (SLuint)(y * (SLint)_images[0]->width() + x);
+    SLfloat f = 1.0f / (SLfloat)currentSample;
+    _colorBuffer[i] += (SLVec3f(color.r, color.g, color.b) - _colorBuffer[i]) * f;
+    _albedoBuffer[i] += (albedo - _albedoBuffer[i]) * f;
+    _normalBuffer[i] += (normal - _normalBuffer[i]) * f;
+    _depthBuffer[i] += (depth - _depthBuffer[i]) * f;
+}
+//-----------------------------------------------------------------------------
+/*!
+Stores the raw and the denoised image after numSamples samples for the
+comparison that is logged at the end of the rendering with doDenoiseCompare.
+*/
+void SLPathtracer::addDenoiseSnapshot(SLint numSamples, SLfloat renderSec)
+{
+    SLPTSnapshot snap;
+    snap.samples    = numSamples;
+    snap.renderSec  = renderSec;
+    snap.denoiserMS = _denoiserMS;
+    colorsToBytes(_colorBuffer, _oneOverGamma, snap.raw);
+    colorsToBytes(_denoiseOut, _oneOverGamma, snap.denoised);
+    _snapshots.push_back(snap);
+}
+//-----------------------------------------------------------------------------
+/*!
+Logs the path tracing time, the denoising time and the RMSE of the raw and
+the denoised snapshots against the final raw image as reference.
+*/
+void SLPathtracer::logDenoiseComparison()
+{
+    SLVuchar reference;
+    colorsToBytes(_colorBuffer, _oneOverGamma, reference);
+
+    SL_LOG("\nDenoiser comparison against the raw image with %d samples:", _aaSamples);
+    SL_LOG("Samples  PT-Time [s]  Denoise [ms]  RMSE raw  RMSE denoised");
+    for (auto& snap : _snapshots)
+        SL_LOG("%7d  %11.3f  %12.1f  %8.4f  %13.4f",
+               snap.samples,
+               snap.renderSec,
+               snap.denoiserMS,
+               rmse(snap.raw, reference),
+               rmse(snap.denoised, reference));
+
+    _snapshots.clear();
+}
+//-----------------------------------------------------------------------------
+/*!
+Denoises the averaged colors of numSamples samples with the edge-avoiding
+a-trous wavelet filter and writes the result into the render image. The
+lighting (color / albedo) gets filtered with _denoiseIterations iterations of a
+5x5 B3 spline kernel with a tap distance of 1, 2, 4, ... pixels. After the
+filtering the lighting gets multiplied by the albedo again. The final linear
+colors are kept in _denoiseOut.
+*/
+void SLPathtracer::denoise(SLint numSamples)
+{
+    PROFILE_FUNCTION();
+
+    SLuint w         = _images[0]->width();
+    SLuint h         = _images[0]->height();
+    SLuint numPixels = w * h;
+
+    // Demodulate the albedo
+    _denoiseIn.resize(numPixels);
+    _denoiseOut.resize(numPixels);
+    for (SLuint i = 0; i < numPixels; ++i)
+    {
+        const SLVec3f& a = _albedoBuffer[i];
+        const SLVec3f& c = _colorBuffer[i];
+        _denoiseIn[i].set(a.x > 0.01f ? c.x / a.x : c.x,
+                          a.y > 0.01f ? c.y / a.y : c.y,
+                          a.z > 0.01f ? c.z / a.z : c.z);
+    }
+
+    for (SLint it = 0; it < _denoiseIterations; ++it)
+    {
+        _denoiseStep   = 1 << it;
+        _denoiseSigmaC = _denoiseColorSigma / (SLfloat)(1 << it) / sqrt((SLfloat)numSamples);
+
+        vector<thread> threads; // vector for additional threads
+        _nextLine = 0;
+
+        // Start additional threads on the denoiseSlices function
+        for (SLuint t = 1; t <= Utils::maxThreads() - 1; t++)
+            threads.emplace_back(&SLPathtracer::denoiseSlices, this, false, t);
+
+        // Do the same work in the main thread
+        denoiseSlices(true, 0);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        _denoiseIn.swap(_denoiseOut);
+    }
+
+    // Remodulate the albedo and write the render image
+    for (SLuint y = 0; y < h; ++y)
+    {
+        for (SLuint x = 0; x < w; ++x)
+        {
+            SLuint         i = y * w + x;
+            const SLVec3f& a = _albedoBuffer[i];
+            const SLVec3f& l = _denoiseIn[i];
+            _denoiseOut[i].set(a.x > 0.01f ? l.x * a.x : l.x,
+                               a.y > 0.01f ? l.y * a.y : l.y,
+                               a.z > 0.01f ? l.z * a.z : l.z);
+
+            SLCol4f color(_denoiseOut[i].x, _denoiseOut[i].y, _denoiseOut[i].z);
+            color.clampMinMax(0.0f, 1.0f);
+            color.gammaCorrect(_oneOverGamma);
+            _images[0]->setPixeliRGB((SLint)x,
+                                     (SLint)y,
+                                     CVVec4f(color.r,
+                                             color.g,
+                                             color.b,
+                                             color.a));
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Filters slices of 4 rows of one a-trous iteration from _denoiseIn into
+_denoiseOut. Every tap of the 5x5 kernel with the distance _denoiseStep gets
+weighted by the edge stopping functions of the lighting, the normal, the
+relative depth and the albedo. All of them have the same Gaussian form
+exp(-d^2/sigma^2) of the feature distance d. As in Dammertz et al. only the
+color sigma shrinks with the iterations, the sigmas of the normal, depth and
+albedo stay constant. This method can be called as a function by multiple
+threads like renderSlices.
+*/
+void SLPathtracer::denoiseSlices(const bool isMainThread, SLuint threadNum)
+{
+    if (!isMainThread)
+    {
+        PROFILE_THREAD(string("PT-Denoiser-") + std::to_string(threadNum));
+    }
+
+    PROFILE_FUNCTION();
+
+    static const SLfloat kernel[5] = {1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+
+    SLint   w     = (SLint)_images[0]->width();
+    SLint   h     = (SLint)_images[0]->height();
+    SLint   step  = _denoiseStep;
+    SLfloat sigC2 = std::max(_denoiseSigmaC * _denoiseSigmaC, FLT_EPSILON);
+    SLfloat sigN2 = _denoiseNormalSigma * _denoiseNormalSigma;
+    SLfloat sigA2 = _denoiseAlbedoSigma * _denoiseAlbedoSigma;
+    SLfloat sigZ2 = _denoiseDepthSigma * _denoiseDepthSigma;
+
+    while (_nextLine < h)
+    {
+        // The next section must be protected
+        _mutex.lock();
+        SLint minY = _nextLine;
+        _nextLine += 4;
+        _mutex.unlock();
+
+        for (SLint y = minY; y < minY + 4 && y < h; ++y)
+        {
+            for (SLint x = 0; x < w; ++x)
+            {
+                SLint          p  = y * w + x;
+                const SLVec3f& cP = _denoiseIn[p];
+                const SLVec3f& nP = _normalBuffer[p];
+                const SLVec3f& aP = _albedoBuffer[p];
+                SLfloat        zP = _depthBuffer[p];
+                SLfloat        zS = 1.0f / std::max(zP, FLT_EPSILON);
+                SLVec3f        sum(SLVec3f::ZERO);
+                SLfloat        sumW = 0.0f;
+
+                for (SLint ky = -2; ky <= 2; ++ky)
+                {
+                    SLint qy = y + ky * step;
+                    if (qy < 0 || qy >= h) continue;
+
+                    for (SLint kx = -2; kx <= 2; ++kx)
+                    {
+                        SLint qx = x + kx * step;
+                        if (qx < 0 || qx >= w) continue;
+
+                        SLint   q  = qy * w + qx;
+                        SLVec3f dC = _denoiseIn[q] - cP;
+                        SLVec3f dN = _normalBuffer[q] - nP;
+                        SLVec3f dA = _albedoBuffer[q] - aP;
+                        SLfloat dZ = (_depthBuffer[q] - zP) * zS;
+
+                        SLfloat weight = kernel[kx + 2] * kernel[ky + 2] *
+                                         exp(-dC.dot(dC) / sigC2 -
+                                             dN.dot(dN) / sigN2 -
+                                             dA.dot(dA) / sigA2 -
+                                             dZ * dZ / sigZ2);
+                        sum += _denoiseIn[q] * weight;
+                        sumW += weight;
+                    }
+                }
+
+                _denoiseOut[p] = sumW > 0.0f ? sum / sumW : cP;
+            }
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
 Recursively traces ray in scene.
 */
 SLCol4f SLPathtracer::trace(SLRay* ray, SLbool em)
@@ -11,8 +11,32 @@
 
 #include <SLRaytracer.h>
 
+//-----------------------------------------------------------------------------
+//! Image snapshot at a sample count for the denoiser comparison
+struct SLPTSnapshot
+{
+    SLint    samples;    //!< NO. of samples per pixel
+    SLfloat  renderSec;  //!< Path tracing time without denoising
+    SLfloat  denoiserMS; //!< Denoising time
+    SLVuchar raw;        //!< Gamma corrected RGB bytes of the raw image
+    SLVuchar denoised;   //!< Gamma corrected RGB bytes of the denoised image
+};
+typedef vector<SLPTSnapshot> SLVPTSnapshot;
 //-----------------------------------------------------------------------------
 //! Classic Monte Carlo Pathtracing algorithm for real global illumination
+/*!
+With doDenoise an edge-avoiding a-trous wavelet filter (Dammertz et al. 2010)
+runs multi-threaded on the CPU after the progressive passes. The filter is
+guided by the albedo, normal and depth of the first hit, which are averaged
+per pixel in feature buffers during the passes. The lighting gets demodulated
+by the albedo before the filtering, so that textures stay sharp. The color
+edge stopping sigma shrinks with the square root of the sample count, so that
+the filter fades out when the image converges.
+\n With doDenoiseCompare the raw and denoised images at 1, 2, 4, ... samples
+are kept and compared at the end of a denoised rendering against the final
+raw image. The RMSE and the times only get logged; no reference results are
+stored with the code. This is only meant for tuning the denoiser.
+*/
 class SLPathtracer : public SLRaytracer
 {
 public:
@@ -28,17 +52,55 @@ public:
     SLCol4f shade(SLRay* ray, SLCol4f* mat);
     void    saveImage();
 
+    // denoiser functions
+    void denoise(SLint numSamples);
+    void denoiseSlices(bool isMainThread, SLuint threadNum);
+
     // Setters
     void calcDirect(SLbool di) { _calcDirect = di; }
     void calcIndirect(SLbool ii) { _calcIndirect = ii; }
+    void doDenoise(SLbool denoise) { _doDenoise = denoise; }
+    void doDenoiseCompare(SLbool compare) { _doDenoiseCompare = compare; }
+    void denoiseIterations(SLint iterations) { _denoiseIterations = iterations; }
 
     // Getters
-    SLbool calcDirect() const { return _calcDirect; }
-    SLbool calcIndirect() const { return _calcIndirect; }
+    SLbool  calcDirect() const { return _calcDirect; }
+    SLbool  calcIndirect() const { return _calcIndirect; }
+    SLbool  doDenoise() const { return _doDenoise; }
+    SLbool  doDenoiseCompare() const { return _doDenoiseCompare; }
+    SLint   denoiseIterations() const { return _denoiseIterations; }
+    SLfloat denoiserMS() const { return _denoiserMS; }
 
 private:
+    void updateFeatures(SLint          x,
+                        SLint          y,
+                        SLint          currentSample,
+                        SLRay*         primaryRay,
+                        const SLCol4f& color);
+    void addDenoiseSnapshot(SLint numSamples, SLfloat renderSec);
+    void logDenoiseComparison();
+
     SLbool _calcDirect;   //!< flag to calculate direct illumination
     SLbool _calcIndirect; //!< flag to calculate indirect illumination
+
+    // variables for the denoiser
+    SLbool        _doDenoise;          //!< flag to denoise after the passes
+    SLbool        _doDenoiseCompare;   //!< flag to log the denoiser comparison
+    SLint         _denoiseIterations;  //!< NO. of a-trous iterations
+    SLfloat       _denoiseColorSigma;  //!< color edge stopping sigma at 1 sample
+    SLfloat       _denoiseNormalSigma; //!< normal edge stopping sigma
+    SLfloat       _denoiseDepthSigma;  //!< relative depth edge stopping sigma
+    SLfloat       _denoiseAlbedoSigma; //!< albedo edge stopping sigma
+    SLfloat       _denoiserMS;         //!< Denoiser time of the last pass in ms
+    SLint         _denoiseStep;        //!< Tap distance of the current iteration
+    SLfloat       _denoiseSigmaC;      //!< Color sigma of the current iteration
+    SLVVec3f      _colorBuffer;        //!< Averaged linear color per pixel
+    SLVVec3f      _albedoBuffer;       //!< Averaged albedo of the first hit
+    SLVVec3f      _normalBuffer;       //!< Averaged normal of the first hit
+    SLVfloat      _depthBuffer;        //!< Averaged depth of the first hit
+    SLVVec3f      _denoiseIn;          //!< Input of the current iteration
+    SLVVec3f      _denoiseOut;         //!< Output of the current iteration
+    SLVPTSnapshot _snapshots;          //!< Snapshots for the comparison
 };
 //-----------------------------------------------------------------------------
 #endif
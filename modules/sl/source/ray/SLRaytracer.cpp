@@ -6,6 +6,7 @@
 //             Please visit: http://opensource.org/licenses/GPL-3.0
 //#############################################################################
 
+#include <cstring>
 #include <functional>
 using namespace std::placeholders;
 
@@ -14,6 +15,7 @@ using namespace std::placeholders;
 #include <SLRaytracer.h>
 #include <SLSceneView.h>
 #include <SLSkybox.h>
+#include <SLAnimSkeleton.h>
 #include <GlobalTimer.h>
 #include <Profiler.h>
 
@@ -30,9 +32,16 @@ SLRaytracer::SLRaytracer()
     _maxDepth         = 5;
     _aaThreshold      = 0.3f; // = 10% color difference
     _aaSamples        = 3;
+    _aaMaxError       = 0.01f;
+    _aaRayBudget      = 2.0f;
     _resolutionFactor = 0.5f;
+    _doIncremental    = false;
+    _numTracedPixels  = 0;
+    _frameNo          = 0;
     gamma(1.0f);
     _raysPerMS.init(60, 0.0f);
+    _isIncrementalValid = false;
+    _isCameraMoved      = false;
 
     // set texture properties
     _min_filter   = GL_NEAREST;
@@ -106,6 +115,7 @@ SLbool SLRaytracer::renderClassic(SLSceneView* sv)
 
     _renderSec = GlobalTimer::timeS() - tStart;
     _raysPerMS.set(SLRay::totalNumRays() / _renderSec / 1000.0f);
+    PROFILE_COUNTER("Rays per ms", _raysPerMS.average());
     _progressPC = 100;
 
     if (_doContinuous)
@@ -136,51 +146,108 @@ SLbool SLRaytracer::renderDistrib(SLSceneView* sv)
     // Measure time
     float t1 = GlobalTimer::timeS();
 
+    // Incremental RT needs continuous rendering with single primary rays
+    SLbool doIncremental = _doIncremental &&
+                           _doContinuous &&
+                           _cam->lensSamples()->samples() == 1;
+    SLuint numPixels     = _images[0]->width() * _images[0]->height();
+
     // Bind render functions to be called multi-threaded
-    auto sampleAAPixelsFunction = bind(&SLRaytracer::sampleAAPixels, this, _1, _2);
-    auto renderSlicesFunction   = _cam->lensSamples()->samples() == 1
-                                    ? bind(&SLRaytracer::renderSlices, this, _1, _2)
-                                    : bind(&SLRaytracer::renderSlicesMS, this, _1, _2);
+    auto renderSlicesFunction = _cam->lensSamples()->samples() == 1
+                                  ? bind(&SLRaytracer::renderSlices, this, _1, _2)
+                                  : bind(&SLRaytracer::renderSlicesMS, this, _1, _2);
 
-    // Do multi-threading only in release config
-    // Render image without anti-aliasing
-    vector<thread> threads1; // vector for additional threads
-    _nextLine = 0;           // reset _nextLine=0 be for multithreading starts
+    if (doIncremental && prepareIncremental())
+    {
+        PROFILE_SCOPE("IncrementalPixels");
 
-    // Start additional threads on the renderSlices function
-    for (SLuint t = 1; t <= Utils::maxThreads() - 1; t++)
-        threads1.emplace_back(renderSlicesFunction, false, t);
+        // Trace only the pixels that got dirty since the last frame
+        vector<thread> threads1; // vector for additional threads
+        _nextLine = 0;           // reset _nextLine=0 be for multithreading starts
 
-    // Do the same work in the main thread
-    renderSlicesFunction(true, 0);
+        // Start additional threads on the renderPixels function
+        for (SLuint t = 1; t <= Utils::maxThreads() - 1; t++)
+            threads1.emplace_back(&SLRaytracer::renderPixels, this, false, t);
 
-    // Wait for the other threads to finish
-    for (auto& thread : threads1)
-        thread.join();
+        // Do the same work in the main thread
+        renderPixels(true, 0);
 
-    // Do anti-aliasing w. contrast compare in a 2nd. pass
-    if (_aaSamples > 1 && _cam->lensSamples()->samples() == 1)
+        // Wait for the other threads to finish
+        for (auto& thread : threads1)
+            thread.join();
+
+        _numTracedPixels = (SLuint)_tracePixels.size();
+    }
+    else
     {
-        PROFILE_SCOPE("AntiAliasing");
+        if (doIncremental)
+        {
+            _pixelHits.assign(numPixels, SLRTPixelHit());
+            _pixelIsDirty.assign(numPixels, 1);
+        }
+        else if (!_pixelHits.empty())
+        {
+            // Free the caches if the incremental mode got switched off
+            _pixelHits.clear();
+            _prevPixelHits.clear();
+            _prevImage.clear();
+            _pixelIsDirty.clear();
+            _nodeStates.clear();
+        }
 
-        getAAPixels();           // Fills in the AA pixels by contrast
-        vector<thread> threads2; // vector for additional threads
+        // Do multi-threading only in release config
+        // Render image without anti-aliasing
+        vector<thread> threads1; // vector for additional threads
         _nextLine = 0;           // reset _nextLine=0 be for multithreading starts
 
-        // Start additional threads on the sampleAAPixelFunction function
+        // Start additional threads on the renderSlices function
         for (SLuint t = 1; t <= Utils::maxThreads() - 1; t++)
-            threads2.emplace_back(sampleAAPixelsFunction, false, t);
+            threads1.emplace_back(renderSlicesFunction, false, t);
 
         // Do the same work in the main thread
-        sampleAAPixelsFunction(true, 0);
+        renderSlicesFunction(true, 0);
 
         // Wait for the other threads to finish
-        for (auto& thread : threads2)
+        for (auto& thread : threads1)
             thread.join();
+
+        _numTracedPixels = numPixels;
+    }
+
+    // Do anti-aliasing w. contrast compare in a 2nd. pass
+    if (_aaSamples > 1 && _cam->lensSamples()->samples() == 1)
+    {
+        PROFILE_SCOPE("AntiAliasing");
+
+        getAAPixels(); // Fills in the AA pixels by contrast
+
+        // Subsample only dirty pixels, the others keep their cached color
+        if (doIncremental)
+        {
+            SLuint w       = _images[0]->width();
+            auto   isClean = [&](const SLRTAAPixel& p)
+            { return !_pixelIsDirty[p.y * w + p.x]; };
+            _aaPixels.erase(std::remove_if(_aaPixels.begin(),
+                                           _aaPixels.end(),
+                                           isClean),
+                            _aaPixels.end());
+        }
+
+        refineAAPixels(doIncremental);
+
+        if (doIncremental)
+        {
+            SLuint w = _images[0]->width();
+            for (auto& p : _aaPixels)
+                _pixelHits[p.y * w + p.x].isAntiAliased = true;
+        }
     }
 
+    _isIncrementalValid = doIncremental;
+
     _renderSec = GlobalTimer::timeS() - t1;
     _raysPerMS.set((float)SLRay::totalNumRays() / _renderSec / 1000.0f);
+    PROFILE_COUNTER("Rays per ms", _raysPerMS.average());
     _progressPC = 100;
 
     if (_doContinuous)
@@ -244,6 +311,9 @@ void SLRaytracer::renderSlices(const bool isMainThread, SLuint threadNum)
                                                  color.a));
                 //_mutex.unlock();
 
+                if (!_pixelHits.empty())
+                    cachePixelHit(x, (SLuint)y, &primaryRay);
+
                 SLRay::avgDepth += SLRay::depthReached;
                 SLRay::maxDepthReached = std::max(SLRay::depthReached,
                                                   SLRay::maxDepthReached);
@@ -583,6 +653,7 @@ SLCol4f SLRaytracer::shade(SLRay* ray)
 /*!
 This method fills the pixels into the vector pix that need to be subsampled
 because the contrast to its left and/or above neighbor is above a threshold.
+These pixels are the start of the adaptive sampling in refineAAPixels.
 */
 void SLRaytracer::getAAPixels()
 {
@@ -640,10 +711,18 @@ void SLRaytracer::getAAPixels()
     SLRay::subsampledPixels = (SLuint)_aaPixels.size();
 }
 //-----------------------------------------------------------------------------
+//! Returns the Rec. 709 luminance of a color
+static inline SLfloat luminance(const SLCol4f& c)
+{
+    return 0.2126f * c.r + 0.7152f * c.g + 0.0722f * c.b;
+}
+//-----------------------------------------------------------------------------
 /*!
-SLRaytracer::sampleAAPixels does the subsampling of the pixels that need to be
-antialiased. See also getAAPixels. This routine can be called by multiple
-threads.
+SLRaytracer::sampleAAPixels shoots the next batch of _aaSamples samples for
+every active pixel of the adaptive anti-aliasing (see refineAAPixels). The
+sub pixel positions are taken out of the concentric disc pattern _aaPattern.
+The disc is scaled to enclose the pixel square, so that also the pixel
+corners get sampled. This routine can be called by multiple threads.
 The _nextLine index is used and incremented by every thread. So it should be
 locked or an atomic index. I prefer not protecting it because it's faster.
 If the increment is not done properly some pixels may get ray traced twice.
@@ -661,7 +740,12 @@ void SLRaytracer::sampleAAPixels(const bool isMainThread, SLuint threadNum)
     assert(_aaSamples % 2 == 1 && "subSample: maskSize must be uneven");
     double t1 = 0, t2;
 
-    while (_nextLine < (SLint)_aaPixels.size())
+    SLuint  maxSamples = (SLuint)(_aaSamples * _aaSamples);
+    SLuint  numX       = _aaPattern.samplesX();
+    SLuint  numY       = _aaPattern.samplesY();
+    SLfloat discScale  = 0.5f * sqrt(2.0f); // disc radius to enclose the pixel
+
+    while (_nextLine < (SLint)_aaActive.size())
     {
         // The next section must be protected
         // Making _nextLine an atomic was not sufficient.
@@ -670,65 +754,688 @@ void SLRaytracer::sampleAAPixels(const bool isMainThread, SLuint threadNum)
         _nextLine += 4;
         _mutex.unlock();
 
-        for (SLuint i = mini; i < mini + 4 && i < _aaPixels.size(); ++i)
+        for (SLuint i = mini; i < mini + 4 && i < _aaActive.size(); ++i)
         {
-            SLuint  x   = _aaPixels[i].x;
-            SLuint  y   = _aaPixels[i].y;
-            CVVec4f c4f = _images[0]->getPixeli((SLint)x, (SLint)y);
-            SLCol4f centerColor(c4f[0], c4f[1], c4f[2], c4f[3]);
-            SLint   centerIndex = _aaSamples >> 1;
-            SLfloat f           = 1.0f / (SLfloat)_aaSamples;
-            SLfloat xpos        = (SLfloat)x - (SLfloat)centerIndex * f;
-            SLfloat ypos        = (SLfloat)y - (SLfloat)centerIndex * f;
-            SLfloat samples     = (SLfloat)_aaSamples * (SLfloat)_aaSamples;
-            SLCol4f color(0, 0, 0);
+            SLuint       index    = _aaActive[i];
+            SLRTAAStats& stats    = _aaStats[index];
+            SLfloat      x        = (SLfloat)_aaPixels[index].x;
+            SLfloat      y        = (SLfloat)_aaPixels[index].y;
+            SLuint       numFirst = stats.num;
+            SLuint       numLast  = std::min(stats.num + (SLuint)_aaSamples, maxSamples);
+
+            for (; stats.num < numLast; ++stats.num)
+            {
+                // Sample k walks through the rings with a different angle on
+                // each ring, so that every batch spreads over the pixel.
+                SLuint  k    = stats.num - 1; // sample 0 is the pixel center
+                SLuint  iR   = k % numX;
+                SLuint  iPhi = (k / numX + iR * ((numY + 1) / 2)) % numY;
+                SLVec2f d    = _aaPattern.point(iR, iPhi);
+
+                SLRay primaryRay(_sv);
+                setPrimaryRay(x + d.x * discScale,
+                              y + d.y * discScale,
+                              &primaryRay);
+                SLCol4f color = trace(&primaryRay);
+                SLfloat lum   = luminance(color);
 
-            // Loop regularly over the float pixel
+                stats.sum += color;
+                stats.sumLum += lum;
+                stats.sumLum2 += lum * lum;
+            }
+            SLRay::subsampledRays += stats.num - numFirst;
+        }
 
-            for (SLint sy = 0; sy < _aaSamples; ++sy)
+        if (isMainThread && !_doContinuous)
+        {
+            t2 = GlobalTimer::timeS();
+            if (t2 - t1 > 0.5)
             {
-                for (SLint sx = 0; sx < _aaSamples; ++sx)
-                {
-                    if (sx == centerIndex && sy == centerIndex)
-                        color += centerColor; // don't shoot for center position
-                    else
-                    {
-                        SLRay primaryRay(_sv);
-                        setPrimaryRay(xpos + sx * f, ypos + sy * f, &primaryRay);
-                        color += trace(&primaryRay);
-                    }
-                }
-                ypos += f;
+                _progressPC = 50 + (SLint)((SLfloat)_nextLine / (SLfloat)_aaActive.size() * 50);
+                renderUIBeforeUpdate();
+                _sv->onWndUpdate();
+                t1 = GlobalTimer::timeS();
             }
-            SLRay::subsampledRays += (SLuint)samples;
-            color /= samples;
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Adaptive anti-aliasing of the pixels found by getAAPixels. Every AA pixel
+starts with its center sample of the first pass. In each iteration all active
+pixels get a batch of new samples by sampleAAPixels in parallel. A pixel stays
+active as long as the standard error of its mean luminance is above
+_aaMaxError and it has less than _aaSamples x _aaSamples samples. The 4
+neighbors of a noisy pixel get added as new AA pixels, so that thin features
+missed by the contrast test get refined as well. If the rays of an iteration
+exceed the ray budget (_aaRayBudget rays per image pixel) only the pixels with
+the highest error get sampled. With onlyDirty only pixels flagged in
+_pixelIsDirty of the incremental ray tracing get added.
+After the refinement _aaPixels holds all pixels that got subsampled.
+*/
+void SLRaytracer::refineAAPixels(SLbool onlyDirty)
+{
+    PROFILE_FUNCTION();
+
+    SLint  w          = (SLint)_images[0]->width();
+    SLint  h          = (SLint)_images[0]->height();
+    SLuint maxSamples = (SLuint)(_aaSamples * _aaSamples);
+    SLuint batch      = (SLuint)_aaSamples;
+    double raysLeft   = _aaRayBudget > 0.0f
+                          ? (double)_aaRayBudget * (double)w * (double)h
+                          : DBL_MAX;
+
+    if (_aaPattern.samplesX() != batch)
+        _aaPattern.samples(batch, batch);
+
+    // Returns the linear color of a pixel of the first pass
+    auto pixelColor = [&](SLint x, SLint y)
+    {
+        CVVec4f c4f = _images[0]->getPixeli(x, y);
+        SLCol4f c(c4f[0], c4f[1], c4f[2], c4f[3]);
+        c.gammaCorrect(_gamma);
+        return c;
+    };
+
+    // Adds a new AA pixel with its center sample to the list
+    auto addPixel = [&](SLint x, SLint y, SLfloat priority, SLVuint& list)
+    {
+        SLint i = y * w + x;
+        if (_aaIndex[i] >= 0 || (onlyDirty && !_pixelIsDirty[i]))
+            return;
+
+        SLRTAAStats stats;
+        stats.sum      = pixelColor(x, y);
+        stats.sumLum   = luminance(stats.sum);
+        stats.sumLum2  = stats.sumLum * stats.sumLum;
+        stats.num      = 1;
+        stats.priority = priority;
+
+        _aaIndex[i] = (SLint)_aaStats.size();
+        list.push_back((SLuint)_aaStats.size());
+        _aaStats.push_back(stats);
+        _aaPixels.push_back(SLRTAAPixel((SLushort)x, (SLushort)y));
+    };
+
+    // Start with the contrast pixels ordered by their max. contrast
+    SLVPixel seeds;
+    seeds.swap(_aaPixels);
+    _aaIndex.assign((size_t)(w * h), -1);
+    _aaStats.clear();
+    _aaActive.clear();
+
+    for (auto& p : seeds)
+    {
+        SLCol4f c        = pixelColor(p.x, p.y);
+        SLfloat contrast = 0.0f;
+        if (p.x > 0) contrast = std::max(contrast, c.diffRGB(pixelColor(p.x - 1, p.y)));
+        if (p.x < w - 1) contrast = std::max(contrast, c.diffRGB(pixelColor(p.x + 1, p.y)));
+        if (p.y > 0) contrast = std::max(contrast, c.diffRGB(pixelColor(p.x, p.y - 1)));
+        if (p.y < h - 1) contrast = std::max(contrast, c.diffRGB(pixelColor(p.x, p.y + 1)));
+        addPixel(p.x, p.y, contrast, _aaActive);
+    }
+
+    SLVuint next;
+    while (!_aaActive.empty() && raysLeft >= (double)batch)
+    {
+        // Keep only the pixels with the highest error within the ray budget
+        SLuint maxActive = (SLuint)(raysLeft / (double)batch);
+        if (_aaActive.size() > maxActive)
+        {
+            std::nth_element(_aaActive.begin(),
+                             _aaActive.begin() + maxActive,
+                             _aaActive.end(),
+                             [&](SLuint a, SLuint b)
+                             { return _aaStats[a].priority > _aaStats[b].priority; });
+            _aaActive.resize(maxActive);
+        }
+
+        for (auto index : _aaActive)
+            raysLeft -= (double)std::min(batch, maxSamples - _aaStats[index].num);
+
+        vector<thread> threads; // vector for additional threads
+        _nextLine = 0;          // reset _nextLine=0 be for multithreading starts
+
+        // Start additional threads on the sampleAAPixels function
+        for (SLuint t = 1; t <= Utils::maxThreads() - 1; t++)
+            threads.emplace_back(&SLRaytracer::sampleAAPixels, this, false, t);
+
+        // Do the same work in the main thread
+        sampleAAPixels(true, 0);
+
+        // Wait for the other threads to finish
+        for (auto& thread : threads)
+            thread.join();
+
+        // Select the pixels for the next iteration
+        next.clear();
+        for (auto index : _aaActive)
+        {
+            SLRTAAStats& stats = _aaStats[index];
+            SLfloat      n     = (SLfloat)stats.num;
+            SLfloat      var   = (stats.sumLum2 - stats.sumLum * stats.sumLum / n) / (n - 1.0f);
+            stats.priority     = sqrt(std::max(var, 0.0f) / n);
+
+            if (stats.priority <= _aaMaxError)
+                continue;
+
+            SLfloat priority = stats.priority;
+            if (stats.num < maxSamples)
+                next.push_back(index);
+
+            // Refine also the neighbors of noisy pixels
+            SLint x = _aaPixels[index].x;
+            SLint y = _aaPixels[index].y;
+            if (x > 0) addPixel(x - 1, y, priority, next);
+            if (x < w - 1) addPixel(x + 1, y, priority, next);
+            if (y > 0) addPixel(x, y - 1, priority, next);
+            if (y < h - 1) addPixel(x, y + 1, priority, next);
+        }
+        _aaActive.swap(next);
+    }
+
+    // Write the averaged colors of all subsampled pixels
+    for (SLuint i = 0; i < _aaPixels.size(); ++i)
+    {
+        if (_aaStats[i].num < 2) continue;
+
+        SLCol4f color = _aaStats[i].sum / (SLfloat)_aaStats[i].num;
+        color.gammaCorrect(_oneOverGamma);
+        _images[0]->setPixeliRGB((SLint)_aaPixels[i].x,
+                                 (SLint)_aaPixels[i].y,
+                                 CVVec4f(color.r,
+                                         color.g,
+                                         color.b,
+                                         color.a));
+    }
+
+    SLRay::subsampledPixels = (SLuint)_aaPixels.size();
+}
+//-----------------------------------------------------------------------------
+/*!
+SLRaytracer::renderPixels traces the dirty pixels in _tracePixels of an
+incremental frame (see prepareIncremental). This routine can be called by
+multiple threads.
+The _nextLine index is used as pixel index and incremented by every thread by
+64 pixels. Only pixels that changed since the last frame are traced, so there
+is no intermediate repaint of the image.
+*/
+void SLRaytracer::renderPixels(const bool isMainThread, SLuint threadNum)
+{
+    if (!isMainThread)
+    {
+        PROFILE_THREAD(string("RT-Worker-") + std::to_string(threadNum));
+    }
+
+    PROFILE_FUNCTION();
+
+    while (_nextLine < (SLint)_tracePixels.size())
+    {
+        // The next section must be protected
+        _mutex.lock();
+        SLuint mini = (SLuint)_nextLine;
+        _nextLine += 64;
+        _mutex.unlock();
+
+        for (SLuint i = mini; i < mini + 64 && i < _tracePixels.size(); ++i)
+        {
+            SLuint x = _tracePixels[i].x;
+            SLuint y = _tracePixels[i].y;
+
+            SLRay primaryRay(_sv);
+            setPrimaryRay((SLfloat)x, (SLfloat)y, &primaryRay);
+
+            ///////////////////////////////////
+            SLCol4f color = trace(&primaryRay);
+            ///////////////////////////////////
 
             color.gammaCorrect(_oneOverGamma);
 
-            //_mutex.lock();
             _images[0]->setPixeliRGB((SLint)x,
                                      (SLint)y,
                                      CVVec4f(color.r,
                                              color.g,
                                              color.b,
                                              color.a));
-            //_mutex.unlock();
+
+            cachePixelHit(x, y, &primaryRay);
+
+            SLRay::avgDepth += SLRay::depthReached;
+            SLRay::maxDepthReached = std::max(SLRay::depthReached,
+                                              SLRay::maxDepthReached);
         }
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+Prepares an incremental frame and returns false if a full frame must be traced.
+The states of all nodes with a mesh get compared with the last frame and the
+WS boxes of the moved, added, removed or hidden nodes are collected. A changed
+light, camera or image size makes the cached pixel hits invalid. Otherwise
+checkPixels marks the pixels to trace, which get dilated by one pixel, so that
+the anti-aliasing at the border of changed regions gets updated as well.
+*/
+SLbool SLRaytracer::prepareIncremental()
+{
+    PROFILE_FUNCTION();
 
-        if (isMainThread && !_doContinuous)
+    SLuint w         = _images[0]->width();
+    SLuint h         = _images[0]->height();
+    SLuint numPixels = w * h;
+
+    // Collect the boxes of all changed nodes incl. the removed ones
+    _frameNo++;
+    _changedBoxes.clear();
+    SLNode* root = _sv->s()->root3D();
+    if (root) updateNodeStates(root, false);
+
+    for (auto it = _nodeStates.begin(); it != _nodeStates.end();)
+    {
+        if (it->second.frameNo != _frameNo)
         {
-            t2 = GlobalTimer::timeS();
-            if (t2 - t1 > 0.5)
+            if (!it->second.isHidden)
+                _changedBoxes.push_back(it->second.aabb);
+            it = _nodeStates.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    SLbool lightsChanged = updateLightStates();
+
+    SLRTView view;
+    view.cam     = _cam;
+    view.EYE     = _EYE;
+    view.LA      = _LA;
+    view.LU      = _LU;
+    view.LR      = _LR;
+    view.BL      = _BL;
+    view.pxSize  = _pxSize;
+    view.isOrtho = _cam->projType() == P_monoOrthographic;
+    view.width   = w;
+    view.height  = h;
+
+    SLbool isValid = _isIncrementalValid &&
+                     !lightsChanged &&
+                     _pixelHits.size() == numPixels &&
+                     _prevView.cam == view.cam &&
+                     _prevView.isOrtho == view.isOrtho &&
+                     _prevView.width == w &&
+                     _prevView.height == h;
+
+    if (!isValid)
+    {
+        _prevView = view;
+        return false;
+    }
+
+    _isCameraMoved = _prevView.EYE != view.EYE ||
+                     _prevView.LA != view.LA ||
+                     _prevView.LU != view.LU ||
+                     _prevView.BL != view.BL ||
+                     _prevView.pxSize != view.pxSize;
+
+    // Keep the last image and hits for the reprojection
+    if (_isCameraMoved)
+    {
+        _prevImage.assign(_images[0]->data(),
+                          _images[0]->data() + _images[0]->bytesPerImage());
+        _prevPixelHits.swap(_pixelHits);
+        _pixelHits.assign(numPixels, SLRTPixelHit());
+    }
+
+    // Mark the dirty pixels multi-threaded
+    _pixelIsDirty.assign(numPixels, 0);
+    vector<thread> threads; // vector for additional threads
+    _nextLine = 0;          // reset _nextLine=0 be for multithreading starts
+
+    for (SLuint t = 1; t <= Utils::maxThreads() - 1; t++)
+        threads.emplace_back(&SLRaytracer::checkPixels, this, false, t);
+
+    checkPixels(true, 0);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    _prevView = view;
+
+    // Dilate the dirty pixels by one pixel
+    _tracePixels.clear();
+    for (SLuint y = 0; y < h; ++y)
+    {
+        for (SLuint x = 0; x < w; ++x)
+        {
+            SLbool isDirty = false;
+            for (SLuint ny = y > 0 ? y - 1 : 0; ny <= y + 1 && ny < h && !isDirty; ++ny)
+                for (SLuint nx = x > 0 ? x - 1 : 0; nx <= x + 1 && nx < w && !isDirty; ++nx)
+                    isDirty = _pixelIsDirty[ny * w + nx] != 0;
+
+            if (isDirty)
+                _tracePixels.push_back(SLRTAAPixel((SLushort)x, (SLushort)y));
+        }
+    }
+
+    for (auto& p : _tracePixels)
+        _pixelIsDirty[p.y * w + p.x] = 1;
+
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+SLRaytracer::checkPixels marks the pixels of an incremental frame that must be
+traced (see prepareIncremental). It works on slices of 4 rows like renderSlices
+and can be called by multiple threads.
+With a static camera a pixel is dirty if its cached primary ray segment or one
+of its shadow ray segments hits the box of a changed node. After a camera
+movement the primary ray gets intersected again and its hit point gets
+reprojected into the last view. The color of the last frame is reused if the
+same triangle got hit within one pixel footprint and if its color was view
+independent and not subsampled.
+*/
+void SLRaytracer::checkPixels(const bool isMainThread, SLuint threadNum)
+{
+    if (!isMainThread)
+    {
+        PROFILE_THREAD(string("RT-Worker-") + std::to_string(threadNum));
+    }
+
+    PROFILE_FUNCTION();
+
+    SLNode*  root    = _sv->s()->root3D();
+    SLint    w       = (SLint)_images[0]->width();
+    SLint    h       = (SLint)_images[0]->height();
+    SLuchar* data    = _images[0]->data();
+    SLint    bpl     = (SLint)_images[0]->bytesPerLine();
+    SLint    bpp     = (SLint)_images[0]->bytesPerPixel();
+    SLbool   isOrtho = _prevView.isOrtho;
+
+    // Distance of the projection plane of the last view (see prepareImage)
+    SLfloat prevFocalDist = _prevView.BL.dot(_prevView.LA);
+
+    while (_nextLine < h)
+    {
+        // The next section must be protected
+        _mutex.lock();
+        SLint minY = _nextLine;
+        _nextLine += 4;
+        _mutex.unlock();
+
+        for (SLint y = minY; y < minY + 4 && y < h; ++y)
+        {
+            for (SLint x = 0; x < w; ++x)
             {
-                _progressPC = 50 + (SLint)((SLfloat)_nextLine / (SLfloat)_aaPixels.size() * 50);
-                renderUIBeforeUpdate();
-                _sv->onWndUpdate();
-                t1 = GlobalTimer::timeS();
+                SLint   i = y * w + x;
+                SLVec3f O, D; // primary ray origin & direction (see setPrimaryRay)
+
+                if (isOrtho)
+                {
+                    O = _BL + _pxSize * ((SLfloat)x * _LR + (SLfloat)y * _LU);
+                    D = _LA;
+                }
+                else
+                {
+                    O = _EYE;
+                    D = _BL + _pxSize * ((SLfloat)x * _LR + (SLfloat)y * _LU);
+                    D.normalize();
+                }
+
+                if (!_isCameraMoved)
+                {
+                    _pixelIsDirty[i] = pixelIsAffected(_pixelHits[i], O, D);
+                    continue;
+                }
+
+                // Intersect the primary ray of the new view
+                SLRay ray(O, D, (SLfloat)x, (SLfloat)y, SLCol4f::BLACK, _sv);
+                if (root) root->hitRec(&ray);
+
+                if (ray.length == FLT_MAX || !ray.hitMesh ||
+                    ray.hitMesh->primitive() != PT_triangles)
+                {
+                    _pixelIsDirty[i] = 1;
+                    continue;
+                }
+
+                // Reproject the hit point into the last view
+                SLVec3f P = O + ray.length * D;
+                SLVec3f d = P - (isOrtho ? _prevView.BL : _prevView.EYE);
+                SLfloat footprint = _prevView.pxSize;
+                if (!isOrtho)
+                {
+                    SLfloat z = d.dot(_prevView.LA);
+                    if (z <= 0.0f)
+                    {
+                        _pixelIsDirty[i] = 1;
+                        continue;
+                    }
+                    d         = d * (prevFocalDist / z) - _prevView.BL;
+                    footprint = _prevView.pxSize * z / prevFocalDist;
+                }
+                SLint u = (SLint)floor(d.dot(_prevView.LR) / _prevView.pxSize + 0.5f);
+                SLint v = (SLint)floor(d.dot(_prevView.LU) / _prevView.pxSize + 0.5f);
+
+                if (u < 0 || u >= w || v < 0 || v >= h)
+                {
+                    _pixelIsDirty[i] = 1;
+                    continue;
+                }
+
+                SLRTPixelHit hit = _prevPixelHits[v * w + u];
+                if (hit.node != ray.hitNode ||
+                    hit.triangle != ray.hitTriangle ||
+                    !hit.isViewIndep ||
+                    hit.isAntiAliased ||
+                    hit.hitPoint.distance(P) > footprint)
+                {
+                    _pixelIsDirty[i] = 1;
+                    continue;
+                }
+
+                hit.depth    = ray.length;
+                hit.hitPoint = P;
+                if (pixelIsAffected(hit, O, D))
+                {
+                    _pixelIsDirty[i] = 1;
+                    continue;
+                }
+
+                // Reuse the color of the last frame
+                memcpy(data + y * bpl + x * bpp,
+                       _prevImage.data() + v * bpl + u * bpp,
+                       (size_t)bpp);
+                _pixelHits[i] = hit;
             }
         }
     }
 }
 //-----------------------------------------------------------------------------
+//! Returns true if the ray segment from O in direction D up to maxT hits the box
+static SLbool segmentHitsBox(const SLVec3f& O,
+                             const SLVec3f& D,
+                             SLfloat        maxT,
+                             const SLVec3f& min,
+                             const SLVec3f& max)
+{
+    SLfloat tMin = 0.0f;
+    SLfloat tMax = maxT;
+
+    // Slab test on all 3 axes
+    for (SLint a = 0; a < 3; ++a)
+    {
+        if (std::abs(D.comp[a]) < FLT_EPSILON)
+        {
+            if (O.comp[a] < min.comp[a] || O.comp[a] > max.comp[a])
+                return false;
+        }
+        else
+        {
+            SLfloat invD = 1.0f / D.comp[a];
+            SLfloat t1   = (min.comp[a] - O.comp[a]) * invD;
+            SLfloat t2   = (max.comp[a] - O.comp[a]) * invD;
+            if (t1 > t2) std::swap(t1, t2);
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+            if (tMin > tMax) return false;
+        }
+    }
+    return true;
+}
+//-----------------------------------------------------------------------------
+/*!
+Returns true if the cached pixel hit is affected by a changed node. This is the
+case if the primary ray segment from O in direction D up to the hit or one of
+the shadow ray segments from the hit point to the lights hits a changed box.
+For soft shadows the boxes get enlarged by the radius of the light. Pixels
+with reflected or refracted rays are affected by any change.
+*/
+SLbool SLRaytracer::pixelIsAffected(const SLRTPixelHit& hit,
+                                    const SLVec3f&      O,
+                                    const SLVec3f&      D)
+{
+    if (_changedBoxes.empty()) return false;
+    if (hit.hasSecondary) return true;
+
+    for (auto& box : _changedBoxes)
+    {
+        if (segmentHitsBox(O, D, hit.node ? hit.depth : FLT_MAX, box.min, box.max))
+            return true;
+
+        if (!hit.node) continue;
+
+        for (auto& light : _lightStates)
+        {
+            if (!light.isOn) continue;
+
+            SLVec3f L;
+            SLfloat lightDist;
+            if (light.positionWS.w == 0.0f)
+            {
+                L         = -light.spotDirWS.normalized();
+                lightDist = FLT_MAX;
+            }
+            else
+            {
+                L.sub(light.positionWS.vec3(), hit.hitPoint);
+                lightDist = L.length();
+                L /= lightDist;
+            }
+
+            SLVec3f r(light.radiusWS, light.radiusWS, light.radiusWS);
+            if (segmentHitsBox(hit.hitPoint, L, lightDist, box.min - r, box.max + r))
+                return true;
+        }
+    }
+    return false;
+}
+//-----------------------------------------------------------------------------
+/*!
+Compares the state of the node and its children with the last frame. The old
+and new boxes of nodes with a moved, exchanged, hidden or skinned mesh get
+added to _changedBoxes.
+*/
+void SLRaytracer::updateNodeStates(SLNode* node, SLbool isHidden)
+{
+    isHidden = isHidden || node->drawBit(SL_DB_HIDDEN);
+
+    if (node->mesh())
+    {
+        SLRTNodeState& state = _nodeStates[node];
+        const SLMat4f& wm    = node->updateAndGetWM();
+        SLRTBox        aabb;
+        aabb.min = node->aabb()->minWS();
+        aabb.max = node->aabb()->maxWS();
+
+        SLbool isNew     = state.frameNo == 0;
+        SLbool isChanged = isNew ||
+                           state.mesh != node->mesh() ||
+                           state.isHidden != isHidden ||
+                           state.aabb.min != aabb.min ||
+                           state.aabb.max != aabb.max ||
+                           memcmp(state.wm.m(), wm.m(), 16 * sizeof(SLfloat)) != 0 ||
+                           (node->skeleton() && node->skeleton()->changed());
+
+        if (isChanged)
+        {
+            if (!isNew && !state.isHidden) _changedBoxes.push_back(state.aabb);
+            if (!isHidden) _changedBoxes.push_back(aabb);
+
+            state.wm       = wm;
+            state.mesh     = node->mesh();
+            state.aabb     = aabb;
+            state.isHidden = isHidden;
+        }
+        state.frameNo = _frameNo;
+    }
+
+    for (auto* child : node->children())
+        updateNodeStates(child, isHidden);
+}
+//-----------------------------------------------------------------------------
+/*!
+Updates the light states used for the shadow ray segments and returns true if
+a light got added, removed, moved, turned or switched on or off. Changes of the
+light colors are not detected.
+*/
+SLbool SLRaytracer::updateLightStates()
+{
+    SLVLight& lights    = _sv->s()->lights();
+    SLbool    isChanged = _lightStates.size() != lights.size();
+    _lightStates.resize(lights.size());
+
+    for (SLuint i = 0; i < lights.size(); ++i)
+    {
+        SLRTLightState state;
+        state.isOn     = lights[i] && lights[i]->isOn();
+        state.radiusWS = 0.0f;
+        if (state.isOn)
+        {
+            SLNode* lightNode = dynamic_cast<SLNode*>(lights[i]);
+            state.positionWS  = lights[i]->positionWS();
+            state.spotDirWS   = lights[i]->spotDirWS();
+            state.radiusWS    = lightNode ? lightNode->aabb()->radiusWS() : 0.0f;
+        }
+
+        SLRTLightState& last = _lightStates[i];
+        if (last.isOn != state.isOn ||
+            (state.isOn && (last.positionWS.vec3() != state.positionWS.vec3() ||
+                            last.positionWS.w != state.positionWS.w ||
+                            last.spotDirWS != state.spotDirWS)))
+            isChanged = true;
+
+        last = state;
+    }
+    return isChanged;
+}
+//-----------------------------------------------------------------------------
+/*!
+Stores the primary hit of a traced pixel for the next incremental frame. The
+color of a pixel is view independent if no secondary rays, no specular light
+and no fog contribute to it.
+*/
+void SLRaytracer::cachePixelHit(SLuint x, SLuint y, SLRay* ray)
+{
+    if (x >= _images[0]->width() || y >= _images[0]->height())
+        return;
+
+    SLRTPixelHit& hit = _pixelHits[y * _images[0]->width() + x];
+    hit               = SLRTPixelHit();
+
+    if (ray->length < FLT_MAX && ray->hitMesh && ray->hitMesh->primitive() == PT_triangles)
+    {
+        SLMaterial* mat  = ray->hitMesh->mat();
+        SLCol4f     spec = mat->specular();
+
+        hit.node         = ray->hitNode;
+        hit.triangle     = ray->hitTriangle;
+        hit.depth        = ray->length;
+        hit.hitPoint     = ray->origin + ray->length * ray->dir;
+        hit.hasSecondary = SLRay::maxDepth > 1 && (mat->kr() > 0.0f || mat->kt() > 0.0f);
+        hit.isViewIndep  = !hit.hasSecondary &&
+                          !_cam->fogIsOn() &&
+                          spec.r == 0.0f && spec.g == 0.0f && spec.b == 0.0f;
+    }
+}
+//-----------------------------------------------------------------------------
 /*!
 fogBlend: Blends the a fog color to the passed color according to to OpenGL fog
 calculation. See OpenGL docs for more information on fog properties.
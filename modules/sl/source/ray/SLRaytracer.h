@@ -13,13 +13,17 @@
 #include <SLGLTexture.h>
 #include <SLVec4.h>
 #include <SLLight.h>
+#include <SLRaySamples2D.h>
 #include <Averaged.h>
+#include <unordered_map>
 
 class SLScene;
 class SLSceneView;
 class SLRay;
 class SLMaterial;
 class SLCamera;
+class SLNode;
+class SLMesh;
 
 //-----------------------------------------------------------------------------
 //! Ray tracing state
@@ -44,12 +48,43 @@ struct SLRTAAPixel
 };
 typedef vector<SLRTAAPixel> SLVPixel;
 //-----------------------------------------------------------------------------
+//! Sample statistics of a pixel in the adaptive anti aliasing
+struct SLRTAAStats
+{
+    SLCol4f sum;      //!< Sum of the linear sample colors
+    SLfloat sumLum;   //!< Sum of the sample luminances
+    SLfloat sumLum2;  //!< Sum of the squared sample luminances
+    SLuint  num;      //!< NO. of samples incl. the center sample
+    SLfloat priority; //!< Standard error of the mean luminance or contrast
+};
+//-----------------------------------------------------------------------------
+//! Cached primary ray hit of a pixel for the incremental ray tracing
+struct SLRTPixelHit
+{
+    SLNode* node          = nullptr; //!< Hit node or nullptr for the background
+    SLint   triangle      = -1;      //!< Index of the hit triangle
+    SLfloat depth         = FLT_MAX; //!< Distance from the ray origin to the hit point
+    SLVec3f hitPoint;                //!< Hit point in world space
+    SLbool  hasSecondary  = false;   //!< Flag if reflected or refracted rays got traced
+    SLbool  isViewIndep   = false;   //!< Flag if the color doesn't depend on the view
+    SLbool  isAntiAliased = false;   //!< Flag if the pixel got subsampled
+};
+typedef vector<SLRTPixelHit> SLVRTPixelHit;
+//-----------------------------------------------------------------------------
 //! SLRaytracer hold all the methods for Whitted style Ray Tracing.
 /*!
 SLRaytracer implements the methods render, eyeToPixel, trace and shade for
 classic Whitted style Ray Tracing. This class is a friend class of SLScene and
 can access via the pointer _s all members of SLScene. The scene traversal for
 the ray intersection tests is done within the intersection method of all nodes.
+\n With doIncremental in continuous distributed ray tracing the primary hit
+of every pixel gets cached (see SLRTPixelHit). The next frame traces only the
+pixels whose primary or shadow ray segments hit the AABB of a node that got
+moved, added, removed or hidden since the last frame. If the camera moved the
+pixels are reprojected into the last frame and the color of view independent
+diffuse pixels is reused. Changes of the lights, the camera or the ray tracing
+settings force a full frame. Material changes are not detected and must be
+signaled with invalidateIncremental.
 */
 class SLRaytracer : public SLGLTexture
   , public SLEventHandler
@@ -66,11 +101,16 @@ public:
     SLCol4f trace(SLRay* ray);
     SLCol4f shade(SLRay* ray);
     void    sampleAAPixels(bool isMainThread, SLuint threadNum);
+    void    refineAAPixels(SLbool onlyDirty);
+    void    renderPixels(bool isMainThread, SLuint threadNum);
+    void    checkPixels(bool isMainThread, SLuint threadNum);
     void    renderUIBeforeUpdate();
 
     // additional ray tracer functions
     void         setPrimaryRay(SLfloat x, SLfloat y, SLRay* primaryRay);
     void         getAAPixels();
+    SLbool       prepareIncremental();
+    void         invalidateIncremental() { _isIncrementalValid = false; }
     SLCol4f      fogBlend(SLfloat z, SLCol4f color);
     virtual void printStats(SLfloat sec);
     virtual void initStats(SLint depth);
@@ -82,30 +122,57 @@ public:
     }
     void maxDepth(SLint depth)
     {
-        _maxDepth = depth;
+        _maxDepth           = depth;
+        _isIncrementalValid = false;
         state(rtReady);
     }
-    void resolutionFactor(SLfloat rf) { _resolutionFactor = rf; }
+    void resolutionFactor(SLfloat rf)
+    {
+        _resolutionFactor   = rf;
+        _isIncrementalValid = false;
+    }
     void doDistributed(SLbool distrib) { _doDistributed = distrib; }
     void doContinuous(SLbool cont)
     {
-        _doContinuous = cont;
+        _doContinuous       = cont;
+        _isIncrementalValid = false;
+        state(rtReady);
+    }
+    void doIncremental(SLbool incr)
+    {
+        _doIncremental      = incr;
+        _isIncrementalValid = false;
         state(rtReady);
     }
     void doFresnel(SLbool fresnel)
     {
-        _doFresnel = fresnel;
+        _doFresnel          = fresnel;
+        _isIncrementalValid = false;
         state(rtReady);
     }
     void aaSamples(SLint samples)
     {
-        _aaSamples = samples;
+        _aaSamples          = samples;
+        _isIncrementalValid = false;
+        state(rtReady);
+    }
+    void aaMaxError(SLfloat maxError)
+    {
+        _aaMaxError         = maxError;
+        _isIncrementalValid = false;
+        state(rtReady);
+    }
+    void aaRayBudget(SLfloat raysPerPixel)
+    {
+        _aaRayBudget        = raysPerPixel;
+        _isIncrementalValid = false;
         state(rtReady);
     }
     void gamma(SLfloat g)
     {
-        _gamma        = g;
-        _oneOverGamma = 1.0f / g;
+        _gamma              = g;
+        _oneOverGamma       = 1.0f / g;
+        _isIncrementalValid = false;
     }
 
     // Getters
@@ -113,17 +180,21 @@ public:
     SLint         maxDepth() const { return _maxDepth; }
     SLbool        doDistributed() const { return _doDistributed; }
     SLbool        doContinuous() const { return _doContinuous; }
+    SLbool        doIncremental() const { return _doIncremental; }
     SLbool        doFresnel() const { return _doFresnel; }
     SLint         aaSamples() const { return _aaSamples; }
     static SLuint numThreads() { return Utils::maxThreads(); }
     SLint         progressPC() const { return _progressPC; }
     SLfloat       aaThreshold() const { return _aaThreshold; }
+    SLfloat       aaMaxError() const { return _aaMaxError; }
+    SLfloat       aaRayBudget() const { return _aaRayBudget; }
     SLfloat       renderSec() const { return _renderSec; }
     SLfloat       gamma() const { return _gamma; }
     SLfloat       oneOverGamma() const { return _oneOverGamma; }
     SLfloat       resolutionFactor() const { return _resolutionFactor; }
     SLint         resolutionFactorPC() const { return (SLint)(_resolutionFactor * 100.0f + 0.00001f); }
     SLfloat       raysPerMS() { return _raysPerMS.average(); }
+    SLuint        numTracedPixels() const { return _numTracedPixels; }
 
     // Render target image
     virtual void prepareImage();
@@ -154,7 +225,78 @@ protected:
 
     // variables for distributed ray tracing
     SLfloat _aaThreshold; //!< threshold for anti aliasing
-    SLint   _aaSamples;   //!< SQRT of uneven num. of AA samples
+    SLint   _aaSamples;   //!< SQRT of uneven max. num. of AA samples
+    SLfloat _aaMaxError;  //!< max. standard error of the mean luminance of AA pixels
+    SLfloat _aaRayBudget; //!< max. NO. of AA rays per image pixel (0 = unlimited)
+
+    SLRaySamples2D      _aaPattern; //!< Concentric sample pattern for AA pixels
+    vector<SLRTAAStats> _aaStats;   //!< Sample statistics per AA pixel
+    SLVint              _aaIndex;   //!< Index into _aaPixels per image pixel or -1
+    SLVuint             _aaActive;  //!< Indices of the AA pixels to sample next
+
+    // variables for incremental ray tracing
+    SLbool _doIncremental;      //!< Flag for incremental continuous RT
+    SLbool _isIncrementalValid; //!< Flag if the cached pixel hits are valid
+    SLbool _isCameraMoved;      //!< Flag if the camera moved since the last frame
+    SLuint _numTracedPixels;    //!< NO. of pixels traced in the last frame
+    SLuint _frameNo;            //!< Incremental frame counter
+
+private:
+    //! World space box of a changed node
+    struct SLRTBox
+    {
+        SLVec3f min; //!< Minimum corner in WS
+        SLVec3f max; //!< Maximum corner in WS
+    };
+
+    //! Node state of the last frame for the change detection
+    struct SLRTNodeState
+    {
+        SLMat4f wm;          //!< World matrix
+        SLMesh* mesh;        //!< Mesh pointer
+        SLRTBox aabb;        //!< AABB in WS
+        SLbool  isHidden;    //!< Hidden flag incl. the hidden parents
+        SLuint  frameNo = 0; //!< Frame NO. of the last visit (0 for new nodes)
+    };
+
+    //! Light state of the last frame for the change detection and shadow segments
+    struct SLRTLightState
+    {
+        SLVec4f positionWS; //!< Light position in WS (w=0 for directional)
+        SLVec3f spotDirWS;  //!< Spot direction in WS
+        SLfloat radiusWS;   //!< Radius of the light nodes AABB in WS
+        SLbool  isOn;       //!< Flag if the light is on
+    };
+
+    //! Camera view of the last frame for the reprojection
+    struct SLRTView
+    {
+        SLCamera* cam;        //!< Camera pointer
+        SLVec3f   EYE;        //!< Camera position
+        SLVec3f   LA, LU, LR; //!< Camera lookat, lookup, lookright
+        SLVec3f   BL;         //!< Bottom left vector
+        SLfloat   pxSize;     //!< Pixel size
+        SLbool    isOrtho;    //!< Flag for orthographic projection
+        SLuint    width;      //!< Image width
+        SLuint    height;     //!< Image height
+    };
+
+    void   updateNodeStates(SLNode* node, SLbool isHidden);
+    SLbool updateLightStates();
+    SLbool pixelIsAffected(const SLRTPixelHit& hit,
+                           const SLVec3f&      O,
+                           const SLVec3f&      D);
+    void   cachePixelHit(SLuint x, SLuint y, SLRay* ray);
+
+    SLVRTPixelHit                              _pixelHits;     //!< Cached primary hits of all pixels
+    SLVRTPixelHit                              _prevPixelHits; //!< Cached primary hits of the last view
+    SLVuchar                                   _prevImage;     //!< Image bytes of the last view
+    SLVuchar                                   _pixelIsDirty;  //!< Flags for pixels to trace
+    SLVPixel                                   _tracePixels;   //!< Pixels to trace in this frame
+    vector<SLRTBox>                            _changedBoxes;  //!< WS boxes of changed nodes
+    vector<SLRTLightState>                     _lightStates;   //!< Light states of the last frame
+    std::unordered_map<SLNode*, SLRTNodeState> _nodeStates;    //!< Node states of the last frame
+    SLRTView                                   _prevView;      //!< Camera view of the last frame
 };
 //-----------------------------------------------------------------------------
 #endif
@@ -133,5 +133,29 @@ void writeBigEndian64(uint64_t number, std::ostream& stream)
     stream.write(buffer, 8);
 }
 //-----------------------------------------------------------------------------
+/*! Writes a 32-bit number in little-endian regardless of the host byte order
+ * @param number the number to be written
+ * @param stream the destination stream
+ */
+void writeLittleEndian32(uint32_t number, std::ostream& stream)
+{
+    char buffer[4];
+    for (int i = 0; i < 4; i++)
+        buffer[i] = (char)((number >> (8 * i)) & 0xFF);
+    stream.write(buffer, 4);
+}
+//-----------------------------------------------------------------------------
+/*! Writes a 64-bit number in little-endian regardless of the host byte order
+ * @param number the number to be written
+ * @param stream the destination stream
+ */
+void writeLittleEndian64(uint64_t number, std::ostream& stream)
+{
+    char buffer[8];
+    for (int i = 0; i < 8; i++)
+        buffer[i] = (char)((number >> (8 * i)) & 0xFF);
+    stream.write(buffer, 8);
+}
+//-----------------------------------------------------------------------------
 } // namespace ByteOrder
 //-----------------------------------------------------------------------------
\ No newline at end of file
@@ -33,6 +33,9 @@ void writeBigEndian16(uint16_t number, std::ostream& stream);
 void writeBigEndian32(uint32_t number, std::ostream& stream);
 void writeBigEndian64(uint64_t number, std::ostream& stream);
 //-----------------------------------------------------------------------------
+void writeLittleEndian32(uint32_t number, std::ostream& stream);
+void writeLittleEndian64(uint64_t number, std::ostream& stream);
+//-----------------------------------------------------------------------------
 } // namespace ByteOrder
 //-----------------------------------------------------------------------------
 
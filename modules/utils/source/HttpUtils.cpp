@@ -10,7 +10,13 @@
 #ifdef SL_BUILD_WITH_OPENSSL
 #    include <HttpUtils.h>
 #    include <iostream>
+#    include <fstream>
 #    include <cstring>
+#    include <cstdio>
+#    include <algorithm>
+#    include <map>
+#    include <mutex>
+#    include <thread>
 #    include <Utils.h>
 #    ifdef _WINDOWS
 #    else
@@ -68,13 +74,16 @@ int Socket::connectTo(string ip,
     else
     {
         Utils::log("Socket  ", "invalid address");
+        freeaddrinfo(res);
         return -1;
     }
 
     fd = (int)socket(res->ai_family, SOCK_STREAM, 0);
-    if (!fd)
+    if (fd < 0)
     {
         Utils::log("Socket  ", "Error creating socket");
+        fd = 0;
+        freeaddrinfo(res);
         return -1;
     }
 
@@ -106,7 +115,12 @@ int Socket::connectTo(string ip,
 int Socket::sendData(const char* data,
                      size_t      size)
 {
+    // Don't raise SIGPIPE if the server has closed a kept-alive connection
+#    ifdef MSG_NOSIGNAL
+    int len = (int)send(fd, data, (int)size, MSG_NOSIGNAL);
+#    else
     int len = (int)send(fd, data, (int)size, 0);
+#    endif
     if (len < 0)
         return -1;
     return 0;
@@ -121,6 +135,9 @@ int Socket::sendData(const char* data,
  */
 void Socket::disconnect()
 {
+    // No socket was created yet (e.g. the address lookup failed)
+    if (fd <= 0)
+        return;
 
 #    ifdef _WINDOWS
     closesocket(fd);
@@ -184,6 +201,26 @@ int Socket::receive(function<int(char* data, int size)> dataCB, int max)
     return n;
 }
 //-----------------------------------------------------------------------------
+/*!
+ * Receives at most size bytes with one call to recv.
+ * @param data Buffer for the received bytes
+ * @param size Size of the buffer
+ * @return No. of bytes received, 0 if the peer closed the connection or -1
+ */
+int Socket::receiveData(char* data, int size)
+{
+    int len;
+    do
+    {
+        len = (int)recv(fd, data, size, 0);
+#    ifndef _WINDOWS
+    } while (len == -1 && errno == EINTR);
+#    else
+    } while (false);
+#    endif
+    return len;
+}
+//-----------------------------------------------------------------------------
 /*!
  *
  * @param ip
@@ -295,6 +332,23 @@ int SecureSocket::receive(function<int(char* data, int size)> dataCB,
     return n;
 }
 //-----------------------------------------------------------------------------
+/*!
+ * Receives and decrypts at most size bytes with one call to SSL_read.
+ * @param data Buffer for the received bytes
+ * @param size Size of the buffer
+ * @return No. of bytes received, 0 if the peer closed the connection or -1
+ */
+int SecureSocket::receiveData(char* data, int size)
+{
+    int len = SSL_read(ssl, data, size);
+    if (len <= 0)
+    {
+        int err = SSL_get_error(ssl, len);
+        return err == SSL_ERROR_ZERO_RETURN ? 0 : -1;
+    }
+    return len;
+}
+//-----------------------------------------------------------------------------
 /*!
  *
  * @param dataCB
@@ -302,9 +356,13 @@ int SecureSocket::receive(function<int(char* data, int size)> dataCB,
  */
 void SecureSocket::disconnect()
 {
-    SSL_shutdown(ssl);
-    SSL_free(ssl);
-    ssl = nullptr;
+    if (ssl)
+    {
+        SSL_shutdown(ssl);
+        SSL_free(ssl);
+        ssl = nullptr;
+    }
+    Socket::disconnect();
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -492,14 +550,17 @@ static string base64(const string data)
  * @param host
  * @param path
  * @param useTLS
+ * @param port Port given in the url or 0 if the url has no port
  */
 static void parseURL(string  url,
                      string& host,
                      string& path,
-                     bool&   useTLS)
+                     bool&   useTLS,
+                     int&    port)
 {
     host   = "";
     useTLS = false;
+    port   = 0;
 
     string dir = "/";
     string tmp;
@@ -526,6 +587,113 @@ static void parseURL(string  url,
         path = "/";
         host = url.substr(offset);
     }
+
+    size_t colon = host.rfind(':');
+    if (colon != string::npos && colon + 1 < host.size() &&
+        host.find_first_not_of("0123456789", colon + 1) == string::npos)
+    {
+        port = stoi(host.substr(colon + 1));
+        host = host.substr(0, colon);
+    }
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Parses the links of a html directory listing as generated by apache,
+ * nginx or python's http.server. Query links (e.g. for sorting), absolute
+ * links and links to the parent directory are dropped. Directories end with
+ * a slash.
+ * @param html Content of the listing
+ * @return Relative links in the listing
+ */
+vector<string> HttpUtils::parseListing(const string& html)
+{
+    vector<string> listing;
+
+    size_t pos = 0;
+    size_t end = 0;
+    while (1)
+    {
+        pos = html.find("<", pos);
+        if (pos == string::npos)
+            break;
+        end = html.find(">", pos);
+        if (end == string::npos)
+            break;
+        end++;
+
+        string token = html.substr(pos + 1, end - pos - 2);
+        token        = Utils::trimString(token, " ");
+
+        if (token.compare(0, 2, "a ") == 0)
+        {
+            size_t href = token.find("href");
+            if (href != string::npos)
+            {
+                href           = token.find("\"", href);
+                size_t hrefend = token.find("\"", href + 1);
+                if (href != string::npos &&
+                    hrefend != string::npos &&
+                    token.find("?") == string::npos)
+                {
+                    token = token.substr(href + 1, hrefend - href - 1);
+                    if (token == "../" || token == "." || token.empty())
+                    {
+                        pos = end;
+                        continue;
+                    }
+                    listing.push_back(token);
+                }
+            }
+        }
+        pos = end;
+    }
+    return listing;
+}
+//-----------------------------------------------------------------------------
+//! Decodes percent encoded characters of an url path (e.g. %20 to space)
+string HttpUtils::urlDecode(const string& encoded)
+{
+    string decoded;
+    decoded.reserve(encoded.size());
+    for (size_t i = 0; i < encoded.size(); ++i)
+    {
+        if (encoded[i] == '%' && i + 2 < encoded.size() &&
+            isxdigit(encoded[i + 1]) && isxdigit(encoded[i + 2]))
+        {
+            decoded += (char)stoi(encoded.substr(i + 1, 2), nullptr, 16);
+            i += 2;
+        }
+        else
+            decoded += encoded[i];
+    }
+    return decoded;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Checks if a decoded relative path stays inside the directory it gets
+ * appended to. Paths that are empty, start with a slash, contain a
+ * backslash, a colon (drive letter on Windows) or a ".." segment are rejected.
+ * @param path Url decoded relative path
+ * @return True if the path can safely be appended to a local directory
+ */
+bool HttpUtils::isSafeRelativePath(const string& path)
+{
+    if (path.empty() || path[0] == '/' ||
+        path.find('\\') != string::npos ||
+        path.find(':') != string::npos)
+        return false;
+
+    size_t begin = 0;
+    while (begin <= path.size())
+    {
+        size_t end = path.find('/', begin);
+        if (end == string::npos)
+            end = path.size();
+        if (path.compare(begin, end - begin, "..") == 0)
+            return false;
+        begin = end + 1;
+    }
+    return true;
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -540,8 +708,9 @@ HttpUtils::GetRequest::GetRequest(string url,
 {
     string path;
     bool   isSecure;
+    int    urlPort;
 
-    parseURL(url, host, path, isSecure);
+    parseURL(url, host, path, isSecure, urlPort);
 
     DNSRequest dns(host);
     host = dns.getHostname();
@@ -567,6 +736,9 @@ HttpUtils::GetRequest::GetRequest(string url,
         s    = new Socket();
         port = 80;
     }
+
+    if (urlPort)
+        port = urlPort;
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -699,43 +871,7 @@ std::vector<string> HttpUtils::GetRequest::getListing()
         copy(&buf[0], &buf[size], back_inserter(content));
         return 0; });
 
-    string              c = string(content.data());
-    std::vector<string> listing;
-
-    size_t pos = 0;
-    size_t end = 0;
-    while (1)
-    {
-        pos = c.find("<", pos);
-        end = c.find(">", pos) + 1;
-        if (pos == string::npos || end == string::npos)
-            break;
-
-        string token = c.substr(pos + 1, end - pos - 2);
-        token        = Utils::trimString(token, " ");
-
-        if (string(token.begin(), token.begin() + 2) == "a ")
-        {
-            size_t href = token.find("href");
-            if (href != string::npos)
-            {
-                href           = token.find("\"", href);
-                size_t hrefend = token.find("\"", href + 1);
-                if (token.find("?") == string::npos)
-                {
-                    token = token.substr(href + 1, hrefend - href - 1);
-                    if (token == "../" || token == ".")
-                    {
-                        pos = end;
-                        continue;
-                    }
-                    listing.push_back(token);
-                }
-            }
-        }
-        pos = end;
-    }
-    return listing;
+    return parseListing(string(content.begin(), content.end()));
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -761,7 +897,7 @@ int HttpUtils::download(string                                               url
         return SERVER_NOT_REACHABLE;
     base = Utils::unifySlashes(base);
 
-    if (req.contentType == "text/html")
+    if (Utils::startsWithString(req.contentType, "text/html"))
     {
         if (url.back() != '/')
             url = url + "/";
@@ -774,14 +910,19 @@ int HttpUtils::download(string                                               url
         for (string str : listing)
         {
             if (str.at(0) != '/')
-                return download(url + str,
-                                processFile,
-                                writeChunk,
-                                processDir,
-                                user,
-                                pwd,
-                                base + str);
+            {
+                int ret = download(url + str,
+                                   processFile,
+                                   writeChunk,
+                                   processDir,
+                                   user,
+                                   pwd,
+                                   base + str);
+                if (ret != 0)
+                    return ret;
+            }
         }
+        return 0;
     }
     else
     {
@@ -914,5 +1055,657 @@ int HttpUtils::length(string url, string user, string pwd)
     return (int)req.contentLength;
 }
 //-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+/*!
+ * Creates a not yet connected keep-alive connection to the host of url.
+ * @param url  Url of the server (the path part is stored as basePath)
+ * @param user Username (optional) when site require http auth.
+ * @param pwd  Password (optional) when site require http auth.
+ */
+HttpUtils::Connection::Connection(string url,
+                                  string user,
+                                  string pwd)
+  : _isOpen(false),
+    _bufferPos(0),
+    _numRequests(0),
+    _numConnects(0)
+{
+    bool isSecure;
+    int  urlPort;
+    parseURL(url, _host, _basePath, isSecure, urlPort);
+
+    _port       = urlPort ? urlPort : (isSecure ? 443 : 80);
+    _hostHeader = urlPort ? _host + ":" + std::to_string(urlPort) : _host;
+    _socket     = isSecure ? new SecureSocket() : new Socket();
+
+    if (!user.empty())
+        _authorization = "Authorization: Basic " + base64(user + ":" + pwd) + "\r\n";
+}
+//-----------------------------------------------------------------------------
+HttpUtils::Connection::~Connection()
+{
+    close();
+    delete _socket;
+}
+//-----------------------------------------------------------------------------
+//! Closes the socket. The next request will reconnect.
+void HttpUtils::Connection::close()
+{
+    if (_isOpen)
+    {
+        _socket->disconnect();
+        _socket->reset();
+        _isOpen = false;
+    }
+    _buffer.clear();
+    _bufferPos = 0;
+}
+//-----------------------------------------------------------------------------
+//! Connects the socket to the server if it is not yet connected
+int HttpUtils::Connection::open()
+{
+    if (_isOpen)
+        return 0;
+
+    if (_socket->connectTo(_host, _port) < 0)
+    {
+        Utils::log("HttpUtils", "Could not connect to %s:%d", _host.c_str(), _port);
+        _socket->disconnect(); // No-op if no socket was created
+        _socket->reset();
+        return -1;
+    }
 
+    _isOpen = true;
+    _numConnects++;
+    return 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Sends a request and receives the response over the kept-alive connection.
+ * If the request fails on a connection that was reused, the connection
+ * gets reopened and the request is sent once more, because servers close
+ * idle keep-alive connections at any time.
+ * @param method       HTTP method (GET or HEAD)
+ * @param path         Absolute path of the resource on the server
+ * @param extraHeaders Additional header lines without line breaks (e.g. Range)
+ * @param response     Receives the status and headers of the response
+ * @param contentCB    Called for every received chunk of the content
+ * @return 0 on success, -1 on a network error or 1 if contentCB returned non zero
+ */
+int HttpUtils::Connection::request(const string&                       method,
+                                   const string&                       path,
+                                   const vector<string>&               extraHeaders,
+                                   Response&                           response,
+                                   function<int(char* data, int size)> contentCB)
+{
+    string requestStr = method + " " + path + " HTTP/1.1\r\n";
+    requestStr += "Host: " + _hostHeader + "\r\n";
+    requestStr += "Connection: keep-alive\r\n";
+    requestStr += _authorization;
+    for (const string& header : extraHeaders)
+        requestStr += header + "\r\n";
+    requestStr += "\r\n";
+
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        bool wasOpen = _isOpen;
+
+        if (open() < 0)
+            return -1;
+
+        response = Response();
+        if (sendRequest(requestStr) < 0 || readHeaders(response) < 0)
+        {
+            close();
+            if (wasOpen) continue; // Retry on a fresh connection
+            return -1;
+        }
+
+        _numRequests++;
+
+        // HEAD requests and 1xx, 204 and 304 responses have no content
+        bool hasContent = method != "HEAD" &&
+                          response.statusCode >= 200 &&
+                          response.statusCode != 204 &&
+                          response.statusCode != 304;
+
+        int ret = hasContent ? readBody(response, contentCB) : 0;
+
+        if (ret != 0 || !response.keepAlive)
+            close();
+
+        return ret;
+    }
+    return -1;
+}
+//-----------------------------------------------------------------------------
+//! Sends the request string completely
+int HttpUtils::Connection::sendRequest(const string& requestStr)
+{
+    return _socket->sendData(requestStr.c_str(), requestStr.length());
+}
+//-----------------------------------------------------------------------------
+//! Receives more bytes into the buffer. Returns the no. of received bytes.
+int HttpUtils::Connection::fillBuffer()
+{
+    if (_bufferPos == _buffer.size())
+    {
+        _buffer.clear();
+        _bufferPos = 0;
+    }
+
+    char buf[16384];
+    int  len = _socket->receiveData(buf, sizeof(buf));
+    if (len > 0)
+        _buffer.insert(_buffer.end(), buf, buf + len);
+    return len;
+}
+//-----------------------------------------------------------------------------
+//! Reads one line terminated by CRLF (without it) from the connection
+int HttpUtils::Connection::readLine(string& line)
+{
+    while (true)
+    {
+        auto begin = _buffer.begin() + (std::ptrdiff_t)_bufferPos;
+        auto lf    = std::find(begin, _buffer.end(), '\n');
+        if (lf != _buffer.end())
+        {
+            line = string(begin, lf);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            _bufferPos = (size_t)(lf - _buffer.begin()) + 1;
+            return 0;
+        }
+
+        if (fillBuffer() <= 0)
+            return -1;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Reads the status line and the headers of a response
+int HttpUtils::Connection::readHeaders(Response& response)
+{
+    string line;
+    if (readLine(line) < 0 || line.compare(0, 5, "HTTP/") != 0)
+        return -1;
+
+    // Status line, e.g. "HTTP/1.1 206 Partial Content"
+    size_t codePos = line.find(' ');
+    if (codePos == string::npos)
+        return -1;
+    response.statusCode = atoi(line.c_str() + codePos + 1);
+    size_t textPos      = line.find(' ', codePos + 1);
+    response.status     = textPos == string::npos ? "" : line.substr(textPos + 1);
+    response.keepAlive  = line.compare(0, 8, "HTTP/1.0") != 0;
+
+    while (true)
+    {
+        if (readLine(line) < 0)
+            return -1;
+        if (line.empty())
+            break;
+
+        response.headers += line + "\r\n";
+
+        size_t colon = line.find(':');
+        if (colon == string::npos)
+            continue;
+
+        string name  = Utils::toLowerString(line.substr(0, colon));
+        string value = Utils::trimString(line.substr(colon + 1), " \t");
+
+        if (name == "content-length")
+        {
+            char*     end    = nullptr;
+            errno            = 0;
+            long long length = strtoll(value.c_str(), &end, 10);
+            if (value.empty() || *end != '\0' || errno == ERANGE || length < 0)
+            {
+                Utils::log("HttpUtils", "Invalid Content-Length: %s", value.c_str());
+                return -1;
+            }
+            response.contentLength = (int64_t)length;
+        }
+        else if (name == "content-type")
+            response.contentType = value;
+        else if (name == "etag")
+            response.etag = value;
+        else if (name == "last-modified")
+            response.lastModified = value;
+        else if (name == "transfer-encoding")
+            response.isChunked = Utils::containsString(Utils::toLowerString(value), "chunked");
+        else if (name == "connection")
+        {
+            string lower = Utils::toLowerString(value);
+            if (lower == "close")
+                response.keepAlive = false;
+            else if (lower == "keep-alive")
+                response.keepAlive = true;
+        }
+    }
+    return 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Reads the response content and passes it chunk by chunk to contentCB.
+ * Without Content-Length and chunked encoding the content ends when the
+ * server closes the connection.
+ */
+int HttpUtils::Connection::readBody(Response&                           response,
+                                    function<int(char* data, int size)> contentCB)
+{
+    // Passes up to maxBytes (or everything for -1) of the content to contentCB
+    auto passBytes = [&](int64_t maxBytes) -> int
+    {
+        int64_t remaining = maxBytes;
+        while (remaining != 0)
+        {
+            if (_bufferPos == _buffer.size())
+            {
+                int len = fillBuffer();
+                if (len < 0) return -1;
+                if (len == 0) return maxBytes < 0 ? 0 : -1;
+            }
+
+            size_t available = _buffer.size() - _bufferPos;
+            size_t n         = remaining < 0 ? available : (size_t)std::min<int64_t>(remaining, (int64_t)available);
+
+            if (contentCB && contentCB(&_buffer[_bufferPos], (int)n) != 0)
+                return 1;
+
+            _bufferPos += n;
+            if (remaining > 0) remaining -= (int64_t)n;
+        }
+        return 0;
+    };
+
+    if (response.isChunked)
+    {
+        string line;
+        while (true)
+        {
+            if (readLine(line) < 0)
+                return -1;
+            int64_t chunkSize = std::strtoll(line.c_str(), nullptr, 16);
+            if (chunkSize == 0)
+                break;
+
+            int ret = passBytes(chunkSize);
+            if (ret != 0 || readLine(line) < 0)
+                return ret != 0 ? ret : -1;
+        }
+
+        // Skip optional trailers up to the empty line
+        do
+        {
+            if (readLine(line) < 0)
+                return -1;
+        } while (!line.empty());
+        return 0;
+    }
+
+    if (response.contentLength >= 0)
+        return passBytes(response.contentLength);
+
+    response.keepAlive = false;
+    return passBytes(-1);
+}
+//-----------------------------------------------------------------------------
+//! Returns the size of a local file or -1 if it doesn't exist
+static int64_t localFileSize(const string& pathFilename)
+{
+    std::ifstream fs(pathFilename, std::ios::binary | std::ios::ate);
+    if (!fs.is_open())
+        return -1;
+    return (int64_t)fs.tellg();
+}
+//-----------------------------------------------------------------------------
+//! Loads the manifest. Later lines override earlier lines of the same file.
+/*! Lines with a missing or invalid size are skipped.
+ */
+void HttpUtils::loadMirrorManifest(const string& manifestFile, MirrorManifest& manifest)
+{
+    std::ifstream fs(manifestFile);
+    string        line;
+    while (std::getline(fs, line))
+    {
+        vector<string> splits;
+        Utils::splitString(line, '\t', splits);
+        if (splits.size() < 2)
+            continue;
+
+        char*     end  = nullptr;
+        errno          = 0;
+        long long size = strtoll(splits[1].c_str(), &end, 10);
+        if (splits[1].empty() || *end != '\0' || errno == ERANGE)
+            continue;
+
+        MirrorEntry entry;
+        entry.size      = (int64_t)size;
+        entry.validator = splits.size() > 2 ? splits[2] : "";
+        if (entry.size < 0)
+            manifest.erase(splits[0]);
+        else
+            manifest[splits[0]] = entry;
+    }
+}
+//-----------------------------------------------------------------------------
+//! Writes the manifest without the history of overridden entries
+bool HttpUtils::saveMirrorManifest(const string& manifestFile, const MirrorManifest& manifest)
+{
+    std::ofstream fs(manifestFile, std::ios::trunc);
+    if (!fs.is_open())
+        return false;
+    for (auto& entry : manifest)
+        fs << entry.first << '\t' << entry.second.size << '\t' << entry.second.validator << '\n';
+    return fs.good();
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Mirrors all files listed below url into the directory dst. See HttpUtils.h
+ * for the detailed description of the parameters.
+ * The directory listings are first walked over one keep-alive connection.
+ * Then numThreads workers with their own keep-alive connection download the
+ * files concurrently. For every file a HEAD request gets the current size
+ * and ETag (or Last-Modified). Unchanged files are skipped, partial files are
+ * resumed with "Range" and "If-Range" and all others are downloaded into a
+ * .part file that is renamed when it is complete. Every finished or started
+ * file is appended to the .httpmirror manifest, so an interrupted run can be
+ * resumed.
+ */
+int HttpUtils::mirror(string                                                          url,
+                      string                                                          dst,
+                      string                                                          user,
+                      string                                                          pwd,
+                      int                                                             numThreads,
+                      function<int(size_t filesDone, size_t numFiles, int64_t bytes)> progress,
+                      MirrorStats*                                                    stats)
+{
+    struct MirrorFile
+    {
+        string remotePath; //!< Url path on the server (still url encoded)
+        string localPath;  //!< Relative path in dst (decoded)
+    };
+
+    MirrorStats localStats;
+    if (!stats) stats = &localStats;
+    *stats = MirrorStats();
+
+    dst = Utils::unifySlashes(dst);
+    if (!Utils::dirExists(dst) && !Utils::makeDirRecurse(dst))
+        return CANT_CREATE_DIR;
+
+    //////////////////////////////////////////////////////
+    // Collect all files over one keep-alive connection //
+    //////////////////////////////////////////////////////
+
+    vector<MirrorFile> files;
+    Connection         listConn(url, user, pwd);
+    string             rootPath = listConn.basePath();
+
+    Response response;
+    if (listConn.request("HEAD", rootPath, {}, response) < 0)
+        return SERVER_NOT_REACHABLE;
+
+    if (Utils::startsWithString(response.contentType, "text/html"))
+    {
+        if (rootPath.back() != '/')
+            rootPath += "/";
+
+        vector<string> dirsToList = {""};
+        while (!dirsToList.empty())
+        {
+            string relDir = dirsToList.back();
+            dirsToList.pop_back();
+
+            string html;
+            int    ret = listConn.request("GET",
+                                       rootPath + relDir,
+                                       {},
+                                       response,
+                                       [&html](char* data, int size) -> int
+                                       {
+                                           html.append(data, (size_t)size);
+                                           return 0;
+                                       });
+            if (ret < 0)
+                return SERVER_NOT_REACHABLE;
+            if (response.statusCode != 200)
+                continue;
+
+            if (!Utils::dirExists(dst + urlDecode(relDir)) &&
+                !Utils::makeDirRecurse(dst + urlDecode(relDir)))
+                return CANT_CREATE_DIR;
+
+            for (const string& entry : parseListing(html))
+            {
+                if (entry[0] == '/' || Utils::containsString(entry, "://"))
+                    continue;
+
+                // Don't let links like "a/../../x" or "..%2F" escape dst
+                if (!isSafeRelativePath(urlDecode(relDir + entry)))
+                {
+                    Utils::log("HttpUtils", "Skipped unsafe link: %s", entry.c_str());
+                    continue;
+                }
+
+                if (entry.back() == '/')
+                    dirsToList.push_back(relDir + entry);
+                else
+                    files.push_back({rootPath + relDir + entry,
+                                     urlDecode(relDir + entry)});
+            }
+        }
+    }
+    else if (response.statusCode == 200)
+    {
+        // The url points to a single file
+        string fileName = rootPath.substr(rootPath.rfind('/') + 1);
+        if (!isSafeRelativePath(urlDecode(fileName)))
+        {
+            Utils::log("HttpUtils", "Invalid file name: %s", fileName.c_str());
+            return CANT_CREATE_FILE;
+        }
+        files.push_back({rootPath, urlDecode(fileName)});
+    }
+    else
+    {
+        Utils::log("HttpUtils", "Mirror failed with HTTP status %d", response.statusCode);
+        return SERVER_NOT_REACHABLE;
+    }
+
+    stats->numFiles    = files.size();
+    stats->numConnects = listConn.numConnects();
+    listConn.close();
+
+    ///////////////////////////////////
+    // Download files with N workers //
+    ///////////////////////////////////
+
+    string         manifestFile = dst + ".httpmirror";
+    MirrorManifest manifest;
+    loadMirrorManifest(manifestFile, manifest);
+    std::ofstream manifestStream(manifestFile, std::ios::app);
+
+    std::mutex          mutex; // Guards manifest, stats & progress calls
+    std::atomic<size_t> nextFile{0};
+    std::atomic<bool>   interrupted{false};
+    std::atomic<int>    errorCode{0};
+    size_t              filesDone = 0;
+
+    // Appends a manifest line (size -1 removes the entry)
+    auto writeManifest = [&](const string& path, int64_t size, const string& validator)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (size < 0)
+            manifest.erase(path);
+        else
+            manifest[path] = {size, validator};
+        manifestStream << path << '\t' << size << '\t' << validator << '\n';
+        manifestStream.flush();
+    };
+
+    // Updates the statistics and calls the progress callback
+    auto reportProgress = [&](size_t* counter, int64_t bytes, bool fileDone)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (counter) (*counter)++;
+        stats->bytesDownloaded += bytes;
+        if (fileDone) filesDone++;
+        if (progress && progress(filesDone, files.size(), stats->bytesDownloaded) != 0)
+            interrupted = true;
+    };
+
+    auto mirrorFile = [&](Connection& conn, const MirrorFile& file) -> int
+    {
+        string localFile = dst + file.localPath;
+        string partFile  = localFile + ".part";
+
+        Response head;
+        if (conn.request("HEAD", file.remotePath, {}, head) < 0)
+            return CONNECTION_CLOSED;
+        if (head.statusCode != 200)
+        {
+            Utils::log("HttpUtils", "Mirror: HTTP %d for %s", head.statusCode, file.remotePath.c_str());
+            return CONNECTION_CLOSED;
+        }
+
+        string  validator  = head.etag.empty() ? head.lastModified : head.etag;
+        int64_t remoteSize = head.contentLength;
+
+        // Skip unchanged files
+        MirrorEntry stored;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto                        it = manifest.find(file.localPath);
+            if (it != manifest.end()) stored = it->second;
+        }
+        int64_t localSize = localFileSize(localFile);
+        if (localSize >= 0 && localSize == remoteSize &&
+            (stored.validator == validator ||
+             (stored.size < 0 && validator.empty())))
+        {
+            reportProgress(&stats->numSkipped, 0, true);
+            return 0;
+        }
+
+        // Resume a partial download if the file has not changed since
+        vector<string> rangeHeaders;
+        MirrorEntry    storedPart;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto                        it = manifest.find(file.localPath + ".part");
+            if (it != manifest.end()) storedPart = it->second;
+        }
+        int64_t partSize = localFileSize(partFile);
+        bool    isResume = partSize > 0 &&
+                        !validator.empty() &&
+                        storedPart.validator == validator &&
+                        (remoteSize < 0 || partSize < remoteSize);
+        if (isResume)
+        {
+            rangeHeaders.push_back("Range: bytes=" + std::to_string(partSize) + "-");
+            rangeHeaders.push_back("If-Range: " + validator);
+        }
+        else
+            writeManifest(file.localPath + ".part", 0, validator);
+
+        std::ofstream fs;
+        int64_t       received = 0;
+        Response      get;
+        bool          isOpen   = false;
+
+        int ret = conn.request("GET",
+                               file.remotePath,
+                               rangeHeaders,
+                               get,
+                               [&](char* data, int size) -> int
+                               {
+                                   if (!isOpen)
+                                   {
+                                       // Append only if the server accepted the range
+                                       bool append = get.statusCode == 206;
+                                       fs.open(partFile,
+                                               append ? std::ios::binary | std::ios::app
+                                                      : std::ios::binary | std::ios::trunc);
+                                       if (!fs.is_open())
+                                           return 1;
+                                       isOpen = true;
+                                   }
+                                   fs.write(data, size);
+                                   received += size;
+                                   if (received >= 1 << 20)
+                                   {
+                                       reportProgress(nullptr, received, false);
+                                       received = 0;
+                                   }
+                                   return interrupted ? 1 : 0;
+                               });
+        fs.close();
+        reportProgress(nullptr, received, false);
+
+        if (ret != 0)
+            return interrupted ? DOWNLOAD_INTERRUPTED : (isOpen ? CONNECTION_CLOSED : CANT_CREATE_FILE);
+        if (get.statusCode != 200 && get.statusCode != 206)
+            return CONNECTION_CLOSED;
+
+        // Empty files have no content callback
+        if (!isOpen)
+            std::ofstream(partFile, std::ios::binary | std::ios::trunc).close();
+
+        int64_t finalSize = localFileSize(partFile);
+        if (remoteSize >= 0 && finalSize != remoteSize)
+            return CONNECTION_CLOSED;
+
+        std::remove(localFile.c_str());
+        if (std::rename(partFile.c_str(), localFile.c_str()) != 0)
+            return CANT_CREATE_FILE;
+
+        writeManifest(file.localPath, finalSize, validator);
+        writeManifest(file.localPath + ".part", -1, "");
+        reportProgress(get.statusCode == 206 ? &stats->numResumed
+                                             : &stats->numDownloaded,
+                       0,
+                       true);
+        return 0;
+    };
+
+    auto worker = [&]()
+    {
+        Connection conn(url, user, pwd);
+        while (!interrupted)
+        {
+            size_t i = nextFile++;
+            if (i >= files.size())
+                break;
+
+            int ret = mirrorFile(conn, files[i]);
+            if (ret != 0 && ret != DOWNLOAD_INTERRUPTED)
+            {
+                Utils::log("HttpUtils", "Mirror failed for %s", files[i].remotePath.c_str());
+                errorCode = ret;
+                reportProgress(&stats->numFailed, 0, true);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        stats->numConnects += conn.numConnects();
+    };
+
+    numThreads = std::max(1, std::min(numThreads, (int)files.size()));
+    vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    // Rewrite the manifest without the history of overridden entries
+    manifestStream.close();
+    saveMirrorManifest(manifestFile, manifest);
+
+    if (interrupted)
+        return DOWNLOAD_INTERRUPTED;
+    return errorCode;
+}
+//-----------------------------------------------------------------------------
 #endif // SL_BUILD_WITH_OPENSSL
@@ -27,6 +27,8 @@
 #    include <openssl/err.h>
 #    include <functional>
 #    include <atomic>
+#    include <cstdint>
+#    include <map>
 
 using std::function;
 using std::string;
@@ -36,6 +38,7 @@ using std::vector;
 #    define CANT_CREATE_DIR 2
 #    define CANT_CREATE_FILE 3
 #    define CONNECTION_CLOSED 4
+#    define DOWNLOAD_INTERRUPTED 5
 
 //------------------------------------------------------------------------------
 //! Multiplatform socket helper
@@ -86,11 +89,13 @@ public:
     }
 
     Socket() { reset(); }
+    virtual ~Socket() {}
 
     virtual void reset();
     virtual int  connectTo(string ip, int port);
     virtual int  sendData(const char* data, size_t size);
     virtual int  receive(function<int(char* data, int size)> dataCB, int max = 0);
+    virtual int  receiveData(char* data, int size);
     virtual void disconnect();
     void         interrupt() { _interrupt = true; };
 
@@ -115,6 +120,7 @@ public:
     virtual int  connectTo(string ip, int port);
     virtual int  sendData(const char* data, size_t size);
     virtual int  receive(function<int(char* data, int size)> dataCB, int max = 0);
+    virtual int  receiveData(char* data, int size);
     virtual void disconnect();
 };
 //------------------------------------------------------------------------------
@@ -215,6 +221,125 @@ int download(string                                      url,
 
 //-- return content Length of the HttpGet request
 int length(string url, string user = "", string pwd = "");
+//------------------------------------------------------------------------------
+//! Status line and the relevant headers of a response received by Connection
+struct Response
+{
+    int     statusCode    = 0;     //!< HTTP status code (e.g. 200, 206, 404)
+    string  status;                //!< HTTP status text
+    string  headers;               //!< All response headers as received
+    string  contentType;           //!< Value of the Content-Type header
+    string  etag;                  //!< Value of the ETag header
+    string  lastModified;          //!< Value of the Last-Modified header
+    int64_t contentLength = -1;    //!< Value of Content-Length or -1 if unknown
+    bool    isChunked     = false; //!< Flag if Transfer-Encoding is chunked
+    bool    keepAlive     = true;  //!< Flag if the server keeps the connection open
+};
+//------------------------------------------------------------------------------
+//! Persistent HTTP/1.1 connection to one server for multiple requests
+/*! In contrast to GetRequest that opens a new socket for every request, a
+ * Connection keeps the socket open (keep-alive) and sends all requests to the
+ * host of the url passed to the constructor over it. If the server has closed
+ * the connection in the meantime it gets reopened transparently. Responses
+ * with Content-Length, chunked transfer encoding or connection close are
+ * supported. A Connection must only be used by one thread at a time.
+ */
+class Connection
+{
+public:
+    Connection(string url, string user = "", string pwd = "");
+    ~Connection();
+
+    int  request(const string&                       method,
+                 const string&                       path,
+                 const vector<string>&               extraHeaders,
+                 Response&                           response,
+                 function<int(char* data, int size)> contentCB = nullptr);
+    void close();
+
+    // Getters
+    const string& basePath() const { return _basePath; }
+    int           numRequests() const { return _numRequests; }
+    int           numConnects() const { return _numConnects; }
+
+private:
+    int open();
+    int sendRequest(const string& requestStr);
+    int readHeaders(Response& response);
+    int readBody(Response& response, function<int(char* data, int size)> contentCB);
+    int readLine(string& line);
+    int fillBuffer();
+
+    Socket*      _socket;        //!< Socket or SecureSocket for https
+    string       _host;          //!< Host name or ip to connect to
+    string       _hostHeader;    //!< Value of the Host header (incl. port)
+    string       _basePath;      //!< Path part of the url passed to the constructor
+    string       _authorization; //!< Authorization header line or empty
+    int          _port;          //!< Port to connect to
+    bool         _isOpen;        //!< Flag if the socket is connected
+    vector<char> _buffer;        //!< Received bytes not consumed yet
+    size_t       _bufferPos;     //!< Read position in _buffer
+    int          _numRequests;   //!< No. of requests sent over this connection
+    int          _numConnects;   //!< No. of (re)connects of this connection
+};
+//------------------------------------------------------------------------------
+//! Statistics of a HttpUtils::mirror call
+struct MirrorStats
+{
+    size_t  numFiles        = 0; //!< No. of files found in the remote listing
+    size_t  numDownloaded   = 0; //!< No. of files downloaded completely
+    size_t  numResumed      = 0; //!< No. of files resumed with a range request
+    size_t  numSkipped      = 0; //!< No. of unchanged files that were skipped
+    size_t  numFailed       = 0; //!< No. of files that could not be downloaded
+    int64_t bytesDownloaded = 0; //!< No. of content bytes received
+    int     numConnects     = 0; //!< No. of TCP connections opened in total
+};
+//------------------------------------------------------------------------------
+//! Mirrors a remote directory listing into a local directory
+/*! All files below url get downloaded with numThreads concurrent keep-alive
+ * connections into dst. Files whose size and validator (ETag or else
+ * Last-Modified) match the previous mirror run are skipped. Interrupted
+ * downloads are kept as <file>.part and resumed with HTTP range requests.
+ * The validators are stored in the file .httpmirror inside dst.
+ * The progress callback is called from the worker threads (but never
+ * concurrently) and the mirroring is interrupted if it returns non zero.
+ * @param url            url of the directory listing (or a single file)
+ * @param dst            Local destination directory
+ * @param user           Username (optional) when site require http auth.
+ * @param pwd            Password (optional) when site require http auth.
+ * @param numThreads     No. of files downloaded in parallel
+ * @param progress       Callback with the no. of finished files, the total no.
+ *                       of files and the total no. of received bytes.
+ * @param stats          Optional pointer to statistics of the run
+ * @return 0 on success or one of the error codes defined above
+ */
+int mirror(string                                                          url,
+           string                                                          dst,
+           string                                                          user       = "",
+           string                                                          pwd        = "",
+           int                                                             numThreads = 4,
+           function<int(size_t filesDone, size_t numFiles, int64_t bytes)> progress   = nullptr,
+           MirrorStats*                                                    stats      = nullptr);
+//------------------------------------------------------------------------------
+//! Size and validator of a mirrored file stored in the .httpmirror file
+struct MirrorEntry
+{
+    int64_t size = -1; //!< Size of the file or -1 for a removed entry
+    string  validator; //!< ETag or Last-Modified of the file
+};
+typedef std::map<string, MirrorEntry> MirrorManifest;
+//------------------------------------------------------------------------------
+//! Loads the .httpmirror manifest (lines: path, size and validator by tabs)
+void loadMirrorManifest(const string& manifestFile, MirrorManifest& manifest);
+//! Writes the .httpmirror manifest, returns false if it can't be written
+bool saveMirrorManifest(const string& manifestFile, const MirrorManifest& manifest);
+//------------------------------------------------------------------------------
+//! Returns the relative links of a html directory listing
+vector<string> parseListing(const string& html);
+//! Decodes percent encoded characters of an url path (e.g. %20 to space)
+string urlDecode(const string& encoded);
+//! Returns false if a decoded relative path could escape its base directory
+bool isSafeRelativePath(const string& path);
 
 }; // namespace HttpUtils
 //------------------------------------------------------------------------------
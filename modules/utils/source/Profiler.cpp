@@ -19,18 +19,34 @@
 /*!
  * Starts a profiling session by saving the session start timestamp so it
  * can later be subtracted from the individual result timestamps to get the
- * time points relative to the start of the session.
+ * time points relative to the start of the session. Records of a previous
+ * session that are still in the ring buffers are ignored. The Chrome trace file gets the same path as the
+ * trace file but with the extension .json.
  * @param filePath The path where the trace file should be written to
  */
 void Profiler::beginSession(std::string filePath)
 {
     _filePath = std::move(filePath);
 
-    auto startPoint = std::chrono::high_resolution_clock::now();
-    _sessionStart   = std::chrono::time_point_cast<std::chrono::microseconds>(startPoint).time_since_epoch().count();
+    size_t dotPos       = _filePath.find_last_of('.');
+    size_t slashPos     = _filePath.find_last_of("/\\");
+    bool   hasExtension = dotPos != std::string::npos &&
+                        (slashPos == std::string::npos || dotPos > slashPos);
+    _chromeTraceFilePath = (hasExtension ? _filePath.substr(0, dotPos) : _filePath) + ".json";
+
+    _sessionStart = timeNowUS();
 }
 //-----------------------------------------------------------------------------
-/*! Ends the profiling session and writes the result to a trace file.
+/*! Ends the profiling session and writes the result to the trace file for
+ * the SLProject trace viewer and to the Chrome trace file.
+ */
+void Profiler::endSession()
+{
+    writeTraceViewerFile(_filePath);
+    writeChromeTraceFile(_chromeTraceFilePath);
+}
+//-----------------------------------------------------------------------------
+/*! Writes the recorded scopes into a trace file for the SLProject trace viewer.
  * A trace file (.slt) has the following layout:
  * Number of scopes: int32
  *  Scope 1 name: (length: int32, name: non-null-terminated char array)
@@ -54,9 +70,14 @@ void Profiler::beginSession(std::string filePath)
  *  This means that the function has to check the endianness of the system
  *  and convert all integers to big endian if we're on a little-endian system.
  */
-void Profiler::endSession()
+void Profiler::writeTraceViewerFile(const std::string& filePath)
 {
-    std::ofstream fileStream(_filePath, std::ios::binary);
+    std::ofstream fileStream(filePath, std::ios::binary);
+
+    std::vector<ProfilingResult>  results;
+    std::vector<ProfilingCounter> counters;
+    std::vector<std::string>      threadNames;
+    collectResults(results, counters, threadNames);
 
     ////////////////////////////////////////
     // Collect scope names and thread IDs //
@@ -65,7 +86,7 @@ void Profiler::endSession()
     std::vector<const char*> scopeNames;
     std::vector<uint32_t>    threadIds;
 
-    for (ProfilingResult& result : _results)
+    for (ProfilingResult& result : results)
     {
         if (std::find(scopeNames.begin(), scopeNames.end(), result.name) == scopeNames.end())
             scopeNames.push_back(result.name);
@@ -99,18 +120,18 @@ void Profiler::endSession()
     for (uint32_t threadId : threadIds)
     {
         // Write thread name
-        writeString(_threadNames[threadId].c_str(), fileStream);
+        writeString(threadNames[threadId].c_str(), fileStream);
 
         // Count and write number of scopes in thread
         uint32_t numScopes = 0;
-        for (ProfilingResult& result : _results)
+        for (ProfilingResult& result : results)
         {
             if (result.threadId == threadId) numScopes++;
         }
         ByteOrder::writeBigEndian32(numScopes, fileStream);
 
         // Write results of thread
-        for (ProfilingResult& result : _results)
+        for (ProfilingResult& result : results)
         {
             if (result.threadId != threadId) continue;
 
@@ -128,42 +149,172 @@ void Profiler::endSession()
 }
 //-----------------------------------------------------------------------------
 /*!
- * Stores a result thread-safely in a vector so it can be written to a trace
- * file at the end of the session.
+ * Writes all recorded scopes and counters in the Chrome trace event format.
+ * Scopes are written as complete events ("ph":"X"), counters as counter
+ * events ("ph":"C") and the thread names as metadata events. The file can be
+ * opened in chrome://tracing or in the Perfetto UI (https://ui.perfetto.dev).
+ * @param filePath The path where the JSON file should be written to
+ */
+void Profiler::writeChromeTraceFile(const std::string& filePath)
+{
+    std::ofstream fileStream(filePath);
+
+    std::vector<ProfilingResult>  results;
+    std::vector<ProfilingCounter> counters;
+    std::vector<std::string>      threadNames;
+    collectResults(results, counters, threadNames);
+
+    // Writes a JSON string with escaped quotes, backslashes and control chars
+    auto writeJsonString = [&](const char* s)
+    {
+        fileStream << '"';
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+                fileStream << '\\' << *s;
+            else if ((unsigned char)*s < 0x20)
+                fileStream << ' ';
+            else
+                fileStream << *s;
+        }
+        fileStream << '"';
+    };
+
+    bool isFirst = true;
+    auto beginEvent = [&]()
+    {
+        fileStream << (isFirst ? "\n" : ",\n");
+        isFirst = false;
+    };
+
+    fileStream << "{\"traceEvents\":[";
+
+    for (uint32_t threadId = 0; threadId < threadNames.size(); threadId++)
+    {
+        beginEvent();
+        fileStream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadId;
+        fileStream << ",\"args\":{\"name\":";
+        writeJsonString(threadNames[threadId].c_str());
+        fileStream << "}}";
+    }
+
+    for (ProfilingResult& result : results)
+    {
+        beginEvent();
+        fileStream << "{\"name\":";
+        writeJsonString(result.name);
+        fileStream << ",\"cat\":\"scope\",\"ph\":\"X\",\"pid\":0,\"tid\":" << result.threadId;
+        fileStream << ",\"ts\":" << result.start - _sessionStart;
+        fileStream << ",\"dur\":" << result.end - result.start << "}";
+    }
+
+    for (ProfilingCounter& counter : counters)
+    {
+        beginEvent();
+        fileStream << "{\"name\":";
+        writeJsonString(counter.name);
+        fileStream << ",\"cat\":\"counter\",\"ph\":\"C\",\"pid\":0,\"tid\":" << counter.threadId;
+        fileStream << ",\"ts\":" << counter.time - _sessionStart;
+        fileStream << ",\"args\":{\"value\":" << counter.value << "}}";
+    }
+
+    fileStream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Copies the records of all thread ring buffers that were recorded after
+ * the session start and the thread names indexed by thread ID. The names are
+ * copied under the same lock, because profileThread can add thread buffers
+ * while the trace files are written. This should be called when the profiled
+ * threads are idle because the ring buffers can be overwritten while they are
+ * read.
+ */
+void Profiler::collectResults(std::vector<ProfilingResult>&  scopes,
+                              std::vector<ProfilingCounter>& counters,
+                              std::vector<std::string>&      threadNames)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (auto& threadBuffer : _threadBuffers)
+    {
+        threadBuffer->scopes.copyTo(scopes);
+        threadBuffer->counters.copyTo(counters);
+        threadNames.push_back(threadBuffer->name);
+    }
+
+    // Remove records from before the session start
+    scopes.erase(std::remove_if(scopes.begin(),
+                                scopes.end(),
+                                [&](const ProfilingResult& r)
+                                { return r.start < _sessionStart; }),
+                 scopes.end());
+    counters.erase(std::remove_if(counters.begin(),
+                                  counters.end(),
+                                  [&](const ProfilingCounter& c)
+                                  { return c.time < _sessionStart; }),
+                   counters.end());
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Stores a result without locking in the ring buffer of the calling thread
+ * so it can be written to a trace file at the end of the session.
  * @param result
  */
 void Profiler::recordResult(ProfilingResult result)
 {
-    _mutex.lock();
-    _results.push_back(result);
-    _mutex.unlock();
+    if (ProfilerTimer::threadBuffer)
+        ProfilerTimer::threadBuffer->scopes.push(result);
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Stores a sample of a counter (e.g. rays per ms, number of keyframes or
+ * uploaded GPU bytes) without locking in the ring buffer of the calling
+ * thread. Samples from threads without PROFILE_THREAD are ignored.
+ * @param name Name of the counter (must outlive the session)
+ * @param value Current value of the counter
+ */
+void Profiler::recordCounter(const char* name, double value)
+{
+    if (!isEnabled() || !ProfilerTimer::threadBuffer) return;
+
+    ProfilingCounter counter{name, timeNowUS(), value, ProfilerTimer::threadId};
+    ProfilerTimer::threadBuffer->counters.push(counter);
 }
 //-----------------------------------------------------------------------------
 /*!
  * Associates the thread in which the function was called with the name provided.
  * This function must be called at the start of every profiled thread.
- * It is sensibly also thread-safe.
+ * Threads with the same name share the same ring buffer. It is sensibly also
+ * thread-safe and the only function of the profiler that takes a lock.
  * @param name
  */
 void Profiler::profileThread(const std::string& name)
 {
-    _mutex.lock();
+    std::lock_guard<std::mutex> lock(_mutex);
 
-    for (uint32_t i = 0; i < _threadNames.size(); i++)
+    for (uint32_t i = 0; i < _threadBuffers.size(); i++)
     {
-        if (_threadNames[i] == name)
+        if (_threadBuffers[i]->name == name)
         {
-            ProfilerTimer::threadId = i;
-            _mutex.unlock();
+            ProfilerTimer::threadId     = i;
+            ProfilerTimer::threadBuffer = _threadBuffers[i].get();
             return;
         }
     }
 
-    uint32_t threadId = (uint32_t)_threadNames.size();
-    _threadNames.push_back(name);
-    ProfilerTimer::threadId = threadId;
-
-    _mutex.unlock();
+    uint32_t threadId = (uint32_t)_threadBuffers.size();
+    _threadBuffers.push_back(std::make_unique<ProfilerThreadBuffer>(name,
+                                                                    _scopeCapacity,
+                                                                    _counterCapacity));
+    ProfilerTimer::threadId     = threadId;
+    ProfilerTimer::threadBuffer = _threadBuffers.back().get();
+}
+//-----------------------------------------------------------------------------
+//! Returns the current time in microseconds since the clock's epoch
+uint64_t Profiler::timeNowUS()
+{
+    auto now = std::chrono::high_resolution_clock::now();
+    return std::chrono::time_point_cast<std::chrono::microseconds>(now).time_since_epoch().count();
 }
 //-----------------------------------------------------------------------------
 //! Writes the length (32-bit) and the string (non-null-terminated) itself to the file stream
@@ -173,8 +324,9 @@ void Profiler::writeString(const char* s, std::ofstream& stream)
     stream << s;
 }
 //-----------------------------------------------------------------------------
-thread_local uint32_t ProfilerTimer::threadId    = INVALID_THREAD_ID;
-thread_local uint32_t ProfilerTimer::threadDepth = 0;
+thread_local uint32_t              ProfilerTimer::threadId     = INVALID_THREAD_ID;
+thread_local uint32_t              ProfilerTimer::threadDepth  = 0;
+thread_local ProfilerThreadBuffer* ProfilerTimer::threadBuffer = nullptr;
 //-----------------------------------------------------------------------------
 /*!
  * Constructor for ProfilerTimer that saves the current time as the start
@@ -182,10 +334,17 @@ thread_local uint32_t ProfilerTimer::threadDepth = 0;
  * thread-local depth since we have just entered a scope.
  * PROFILE_THREAD must be called in the current thread before this function
  * or else the current thread can't be identified and the application exits.
+ * If the recording is disabled at runtime the timer does nothing.
  * @param name Name of the scope
  */
 ProfilerTimer::ProfilerTimer(const char* name)
 {
+    if (!Profiler::instance().isEnabled())
+    {
+        _running = false;
+        return;
+    }
+
     // If the thread ID is INVALID_THREAD_ID, PROFILE_THREAD hasn't been called
     // We don't know the current thread in this case, so we simply skip
     if (threadId == INVALID_THREAD_ID)
@@ -10,17 +10,22 @@
 #ifndef PROFILER_H
 #define PROFILER_H
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <map>
+#include <memory>
 #include <mutex>
 #include <fstream>
+#include <utility>
 
 //-----------------------------------------------------------------------------
 /* Set PROFILING to 1 to enable profiling or to 0 for disabling profiling
  * Just add PROFILE_FUNCTION(); at the beginning of a function that you want to
  * profile. See the Profiler class below on how to display the profiling data.
+ * With PROFILING set to 1 the recording can additionally be switched on and
+ * off at runtime with PROFILER_SET_ENABLED(enabled).
  */
 #define PROFILING 0
 //-----------------------------------------------------------------------------
@@ -29,6 +34,8 @@
 #    define PROFILE_SCOPE(name) ProfilerTimer profilerTimer##__LINE__(name)
 #    define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
 #    define PROFILE_THREAD(name) Profiler::instance().profileThread(name)
+#    define PROFILE_COUNTER(name, value) Profiler::instance().recordCounter(name, (double)(value))
+#    define PROFILER_SET_ENABLED(enabled) Profiler::instance().enabled(enabled)
 #    define PROFILER_TRACE_FILE_PATH Profiler::instance().filePath()
 #    define END_PROFILING_SESSION() Profiler::instance().endSession()
 #else
@@ -36,6 +43,8 @@
 #    define PROFILE_SCOPE(name)
 #    define PROFILE_FUNCTION()
 #    define PROFILE_THREAD(name)
+#    define PROFILE_COUNTER(name, value)
+#    define PROFILER_SET_ENABLED(enabled)
 #    define PROFILER_TRACE_FILE_PATH
 #    define END_PROFILING_SESSION()
 #endif
@@ -49,20 +58,95 @@ struct ProfilingResult
     uint32_t    threadId; //!< ID of the thread in which the scope was entered
 };
 //-----------------------------------------------------------------------------
+struct ProfilingCounter
+{
+    const char* name;     //!< Name of the counter (e.g. "Rays per ms")
+    uint64_t    time;     //!< Time in microseconds when the value was sampled
+    double      value;    //!< Sampled value of the counter
+    uint32_t    threadId; //!< ID of the thread in which the value was sampled
+};
+//-----------------------------------------------------------------------------
+//! Fixed size single-producer ring buffer for profiling records
+/*!
+ * Only the owning thread pushes records, so pushing is wait-free: the record
+ * is written into the next slot and the head index is published with release
+ * semantics. When the buffer is full the oldest records get overwritten, so
+ * the profiler always holds the most recent history of each thread without
+ * ever allocating or locking in the profiled code path.
+ */
+template<typename T>
+class ProfilerRingBuffer
+{
+public:
+    explicit ProfilerRingBuffer(size_t capacity)
+      : _records(capacity), _head(0) {}
+
+    void push(const T& record)
+    {
+        uint64_t head                    = _head.load(std::memory_order_relaxed);
+        _records[head % _records.size()] = record;
+        _head.store(head + 1, std::memory_order_release);
+    }
+
+    //! Copies the currently held records in chronological order into dest
+    void copyTo(std::vector<T>& dest) const
+    {
+        uint64_t head  = _head.load(std::memory_order_acquire);
+        uint64_t size  = _records.size();
+        uint64_t first = head > size ? head - size : 0;
+        for (uint64_t i = first; i < head; ++i)
+            dest.push_back(_records[i % size]);
+    }
+
+    void     clear() { _head.store(0, std::memory_order_release); }
+    uint64_t numPushed() const { return _head.load(std::memory_order_acquire); }
+    size_t   capacity() const { return _records.size(); }
+
+private:
+    std::vector<T>        _records; //!< Preallocated record slots
+    std::atomic<uint64_t> _head;    //!< Total number of records pushed
+};
+//-----------------------------------------------------------------------------
+//! Per thread storage of the profiler (one per distinct thread name)
+struct ProfilerThreadBuffer
+{
+    ProfilerThreadBuffer(std::string threadName,
+                         size_t      scopeCapacity,
+                         size_t      counterCapacity)
+      : name(std::move(threadName)),
+        scopes(scopeCapacity),
+        counters(counterCapacity) {}
+
+    std::string                          name;     //!< Thread name as passed to PROFILE_THREAD
+    ProfilerRingBuffer<ProfilingResult>  scopes;   //!< Ring buffer of finished scopes
+    ProfilerRingBuffer<ProfilingCounter> counters; //!< Ring buffer of counter samples
+};
+//-----------------------------------------------------------------------------
 //! Utility for profiling functions/scopes and writing the results to a file.
 /*!
  * To start the profiling, call BEGIN_PROFILING_SESSION(filePath) with the path
  * to the trace file. After that you can place "PROFILE_FUNCTION();" or
  * "PROFILE_SCOPE(name);" at the start of every function or scope you want to
- * measure.
+ * measure. Numeric values such as rays per second or uploaded bytes can be
+ * sampled with "PROFILE_COUNTER(name, value);". Scope and counter names must
+ * be string literals or otherwise outlive the session.
  * The profiler supports multithreading. To add a new thread, call
  * "PROFILE_THREAD(name)" at the start of the thread. Threads with the same
- * name will appear merged in the trace file. To end the session and write
+ * name will appear merged in the trace file and share one ring buffer, so
+ * they must not run at the same time. To end the session and write
  * the result to the trace file, call END_PROFILING_SESSION().
  *
+ * Every thread records into its own ring buffer without taking any lock, so
+ * the profiler can stay enabled in multithreaded code like the raytracer or
+ * the SLAM threads. Only the last scopeCapacity scopes and counterCapacity
+ * counter samples per thread are kept. The recording can be paused and
+ * resumed at runtime with PROFILER_SET_ENABLED(enabled).
+ *
  * The resulting trace gets written into the data folder of SLProject and can
  * be opened using the trace viewer located at /externals/trace-viewer/trace-viewer.jar.
  * Note that a Java Runtime Environment is required to launch this JAR archive.
+ * In addition a Chrome trace event file (.json) with the same base name is
+ * written that can be opened in chrome://tracing or https://ui.perfetto.dev.
  */
 class Profiler
 {
@@ -75,20 +159,45 @@ public:
 
     void        beginSession(std::string filePath);
     std::string filePath() { return _filePath; }
+    std::string chromeTraceFilePath() { return _chromeTraceFilePath; }
     void        endSession();
 
     void recordResult(ProfilingResult result);
+    void recordCounter(const char* name, double value);
     void profileThread(const std::string& name);
 
+    void writeTraceViewerFile(const std::string& filePath);
+    void writeChromeTraceFile(const std::string& filePath);
+
+    // Setters
+    void enabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+    void capacity(size_t scopeCapacity, size_t counterCapacity)
+    {
+        _scopeCapacity   = scopeCapacity;
+        _counterCapacity = counterCapacity;
+    }
+
+    // Getters
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    static uint64_t timeNowUS();
+
 private:
+    void collectResults(std::vector<ProfilingResult>&  scopes,
+                        std::vector<ProfilingCounter>& counters,
+                        std::vector<std::string>&      threadNames);
+
     static void writeString(const char* s, std::ofstream& stream);
 
 private:
-    std::string                  _filePath;         //!< Future path of the trace file
-    uint64_t                     _sessionStart = 0; //!< Start timestamp of the session in microseconds
-    std::vector<ProfilingResult> _results;          //!< List of profiling results (of all threads)
-    std::vector<std::string>     _threadNames;      //!< List of thread names (the thread ID is the index)
-    std::mutex                   _mutex;            //!< Mutex for accessing profiling results and thread names
+    std::string                                        _filePath;               //!< Future path of the trace file
+    std::string                                        _chromeTraceFilePath;    //!< Future path of the Chrome trace JSON file
+    uint64_t                                           _sessionStart = 0;       //!< Start timestamp of the session in microseconds
+    std::atomic<bool>                                  _enabled{true};          //!< Flag if scopes and counters are recorded
+    size_t                                             _scopeCapacity   = 65536; //!< Max. no. of scopes kept per thread
+    size_t                                             _counterCapacity = 16384; //!< Max. no. of counter samples kept per thread
+    std::vector<std::unique_ptr<ProfilerThreadBuffer>> _threadBuffers;          //!< Ring buffers per thread (the thread ID is the index)
+    std::mutex                                         _mutex;                  //!< Mutex for registering threads only
 };
 //-----------------------------------------------------------------------------
 //! A timer for profiling functions and scopes
@@ -107,9 +216,10 @@ public:
     ~ProfilerTimer();
 
 private:
-    static constexpr uint32_t    INVALID_THREAD_ID = -1;
-    static thread_local uint32_t threadId;
-    static thread_local uint32_t threadDepth;
+    static constexpr uint32_t                 INVALID_THREAD_ID = -1;
+    static thread_local uint32_t              threadId;
+    static thread_local uint32_t              threadDepth;
+    static thread_local ProfilerThreadBuffer* threadBuffer;
 
     const char*                                                 _name;
     uint32_t                                                    _depth;
@@ -10,8 +10,15 @@
 #include <cstring>
 #include <string>
 #include <iostream>
+#include <fstream>
 #include <functional>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <Utils.h>
+#include <ZipUtils.h>
 #include <minizip/unzip.h>
 #include <minizip/zip.h>
 
@@ -66,76 +73,362 @@ static bool zip_add_dir(zipFile zfile, string dirname)
     return true;
 }
 //-----------------------------------------------------------------------------
+//! File to be added to a zip archive with its deflated content
+struct ZipFileJob
+{
+    string            filePath;     //!< Path of the file on disk
+    string            zipName;      //!< Name of the entry in the zip archive
+    vector<char>      deflated;     //!< Raw deflated content
+    uLong             crc  = 0;     //!< CRC32 of the uncompressed content
+    ZPOS64_T          size = 0;     //!< Uncompressed size
+    bool              ok   = false; //!< Flag if reading & deflating succeeded
+    std::atomic<bool> done{false};  //!< Flag if the job is finished
+};
+//-----------------------------------------------------------------------------
 /*!
- *
- * @param zfile ???
- * @param fs ???
- * @param filename ???
- * @param zipPath ???
- * @return ???
+ * Reads a file and deflates it in memory into a raw deflate stream as it is
+ * stored in a zip archive. This runs on the worker threads of zip.
+ * @param job File job to process
  */
-static bool zip_add_file(zipFile        zfile,
-                         std::ifstream& fs,
-                         string         filename,
-                         string         zipPath = "")
+static void zip_deflate_file(ZipFileJob& job)
 {
-    size_t size = (size_t)Utils::getFileSize(fs);
+    std::ifstream fs(job.filePath, std::ios::binary | std::ios::ate);
+    if (!fs.is_open())
+        return;
+
+    vector<char> content((size_t)fs.tellg());
+    fs.seekg(0, std::ios::beg);
+    if (!content.empty() && !fs.read(content.data(), (std::streamsize)content.size()))
+        return;
+
+    job.size = content.size();
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs,
+                     Z_DEFAULT_COMPRESSION,
+                     Z_DEFLATED,
+                     -MAX_WBITS,
+                     8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+        return;
+
+    job.deflated.resize(deflateBound(&zs, (uLong)content.size()) + 64);
+
+    // Feed the input in blocks because zlib sizes are 32 bit
+    const size_t maxBlock = 1u << 30;
+    size_t       inPos    = 0;
+    size_t       outPos   = 0;
+    int          ret      = Z_OK;
+    while (ret != Z_STREAM_END)
+    {
+        size_t inBlock  = std::min(maxBlock, content.size() - inPos);
+        size_t outBlock = std::min(maxBlock, job.deflated.size() - outPos);
+        zs.next_in      = (Bytef*)content.data() + inPos;
+        zs.avail_in     = (uInt)inBlock;
+        zs.next_out     = (Bytef*)job.deflated.data() + outPos;
+        zs.avail_out    = (uInt)outBlock;
+
+        bool isLast = inPos + inBlock == content.size();
+        ret         = deflate(&zs, isLast ? Z_FINISH : Z_NO_FLUSH);
+        if (ret == Z_STREAM_ERROR || (ret == Z_BUF_ERROR && outBlock == 0))
+        {
+            deflateEnd(&zs);
+            return;
+        }
 
-    zipPath = Utils::unifySlashes(zipPath);
-    int ret = zipOpenNewFileInZip64(zfile,
-                                    (zipPath + filename).c_str(),
-                                    NULL,
-                                    NULL,
-                                    0,
-                                    NULL,
-                                    0,
-                                    NULL,
-                                    Z_DEFLATED,
-                                    Z_DEFAULT_COMPRESSION,
-                                    (size > 0xffffffff) ? 1 : 0);
+        inPos += inBlock - zs.avail_in;
+        outPos += outBlock - zs.avail_out;
+    }
 
+    for (size_t pos = 0; pos < content.size(); pos += maxBlock)
+        job.crc = crc32(job.crc,
+                        (const Bytef*)content.data() + pos,
+                        (uInt)std::min(maxBlock, content.size() - pos));
+
+    deflateEnd(&zs);
+    job.deflated.resize(outPos);
+    job.ok = true;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Writes an already deflated file into the zip archive in raw mode.
+ * @param zfile Open zip archive
+ * @param job Finished file job
+ * @return True on success
+ */
+static bool zip_add_deflated(zipFile zfile, ZipFileJob& job)
+{
+    int ret = zipOpenNewFileInZip2_64(zfile,
+                                      job.zipName.c_str(),
+                                      NULL,
+                                      NULL,
+                                      0,
+                                      NULL,
+                                      0,
+                                      NULL,
+                                      Z_DEFLATED,
+                                      Z_DEFAULT_COMPRESSION,
+                                      1,
+                                      (job.size > 0xffffffff) ? 1 : 0);
     if (ret != ZIP_OK)
-    {
-        zipClose(zfile, nullptr);
         return false;
-    }
 
-    char   buf[8192];
-    size_t n;
-    while ((n = fs.readsome(buf, sizeof(buf))) > 0)
+    size_t pos = 0;
+    while (pos < job.deflated.size())
     {
-        ret = zipWriteInFileInZip(zfile, buf, (unsigned int)n);
-        if (ret != ZIP_OK)
+        unsigned int n = (unsigned int)std::min(job.deflated.size() - pos, (size_t)(1u << 30));
+        if (zipWriteInFileInZip(zfile, job.deflated.data() + pos, n) != ZIP_OK)
         {
-            zipCloseFileInZip(zfile);
+            zipCloseFileInZipRaw64(zfile, job.size, job.crc);
             return false;
         }
+        pos += n;
     }
-    zipCloseFileInZip(zfile);
+
+    return zipCloseFileInZipRaw64(zfile, job.size, job.crc) == ZIP_OK;
+}
+//-----------------------------------------------------------------------------
+//! Location and name of an entry in a zip archive
+struct UnzipEntry
+{
+    string         dirname;          //!< Directory of the entry with trailing slash
+    string         filename;         //!< File name of the entry
+    unz64_file_pos pos;              //!< Position for unzGoToFilePos64
+    ZPOS64_T       compressedSize;   //!< Compressed size in bytes
+    ZPOS64_T       uncompressedSize; //!< Uncompressed size in bytes
+    bool           isDir;            //!< Flag if the entry is a directory
+};
+//-----------------------------------------------------------------------------
+//! Zip archive in memory for the minizip memory IO functions
+struct UnzipMemory
+{
+    const char* data;
+    ZPOS64_T    size;
+    ZPOS64_T    pos;
+};
+//-----------------------------------------------------------------------------
+static voidpf ZCALLBACK mem_open(voidpf opaque, const void* filename, int mode)
+{
+    // Every opened handle gets its own read position
+    UnzipMemory* mem = new UnzipMemory(*(const UnzipMemory*)opaque);
+    mem->pos         = 0;
+    return mem;
+}
+static uLong ZCALLBACK mem_read(voidpf opaque, voidpf stream, void* buf, uLong size)
+{
+    UnzipMemory* mem = (UnzipMemory*)stream;
+    uLong        n   = (uLong)std::min<ZPOS64_T>(size, mem->size - mem->pos);
+    memcpy(buf, mem->data + mem->pos, n);
+    mem->pos += n;
+    return n;
+}
+static uLong ZCALLBACK mem_write(voidpf opaque, voidpf stream, const void* buf, uLong size)
+{
+    return 0;
+}
+static ZPOS64_T ZCALLBACK mem_tell(voidpf opaque, voidpf stream)
+{
+    return ((UnzipMemory*)stream)->pos;
+}
+static long ZCALLBACK mem_seek(voidpf opaque, voidpf stream, ZPOS64_T offset, int origin)
+{
+    UnzipMemory* mem = (UnzipMemory*)stream;
+    ZPOS64_T     base;
+    switch (origin)
+    {
+        case ZLIB_FILEFUNC_SEEK_SET: base = 0; break;
+        case ZLIB_FILEFUNC_SEEK_CUR: base = mem->pos; break;
+        case ZLIB_FILEFUNC_SEEK_END: base = mem->size; break;
+        default: return -1;
+    }
+    if (base + offset > mem->size)
+        return -1;
+    mem->pos = base + offset;
+    return 0;
+}
+static int ZCALLBACK mem_close(voidpf opaque, voidpf stream)
+{
+    delete (UnzipMemory*)stream;
+    return 0;
+}
+static int ZCALLBACK mem_error(voidpf opaque, voidpf stream)
+{
+    return 0;
+}
+//-----------------------------------------------------------------------------
+/*!
+ * Opens a zip archive either from a file or, if memory is not null, from a
+ * zip archive in memory. Every thread must open its own handle.
+ */
+static unzFile unzip_open(const string& zipfile, UnzipMemory* memory)
+{
+    if (!memory)
+        return unzOpen64(zipfile.c_str());
+
+    zlib_filefunc64_def funcs;
+    funcs.zopen64_file = mem_open;
+    funcs.zread_file   = mem_read;
+    funcs.zwrite_file  = mem_write;
+    funcs.ztell64_file = mem_tell;
+    funcs.zseek64_file = mem_seek;
+    funcs.zclose_file  = mem_close;
+    funcs.zerror_file  = mem_error;
+    funcs.opaque       = memory;
+    return unzOpen2_64("", &funcs);
+}
+//-----------------------------------------------------------------------------
+//! Reads the central directory of a zip archive into a list of entries
+static bool unzip_list(unzFile uzfile, vector<UnzipEntry>& entries)
+{
+    char name[256];
+
+    if (unzGoToFirstFile(uzfile) != UNZ_OK)
+        return true; // empty archive
+
+    do
+    {
+        unz_file_info64 finfo;
+        if (unzGetCurrentFileInfo64(uzfile, &finfo, name, sizeof(name), NULL, 0, NULL, 0) != UNZ_OK)
+            return false;
+
+        UnzipEntry entry;
+        entry.dirname          = Utils::getDirName(Utils::trimRightString(name, "/"));
+        entry.filename         = Utils::getFileName(Utils::trimRightString(name, "/"));
+        entry.compressedSize   = finfo.compressed_size;
+        entry.uncompressedSize = finfo.uncompressed_size;
+        entry.isDir            = strlen(name) > 0 && name[strlen(name) - 1] == '/';
+        if (unzGetFilePos64(uzfile, &entry.pos) != UNZ_OK)
+            return false;
+        entries.push_back(entry);
+    } while (unzGoToNextFile(uzfile) == UNZ_OK);
+
     return true;
 }
 //-----------------------------------------------------------------------------
 /*!
- *
- * @param zfile ???
- * @param filepath ???
- * @param zipPath ???
- * @return ???
+ * Decompresses the file entries of a zip archive on numThreads threads.
+ * Every thread opens its own handle of the archive and takes the next entry
+ * (the largest first for a good load balance) and passes it to
+ * processEntry that reads the opened entry with unzReadCurrentFile.
+ * @param zipfile Path to the zip file (ignored if memory is not null)
+ * @param memory Zip archive in memory or null
+ * @param entries Entries to process (directories are skipped)
+ * @param numThreads No. of threads (0 for Utils::maxThreads())
+ * @param processEntry Called for every opened entry. Returns false on error.
+ * @return True if all entries were processed successfully
  */
-static bool zip_add_file(zipFile zfile,
-                         string  filepath,
-                         string  zipPath = "")
+static bool unzip_parallel(const string&                                     zipfile,
+                           UnzipMemory*                                      memory,
+                           vector<UnzipEntry>&                               entries,
+                           int                                               numThreads,
+                           function<bool(unzFile uzfile, UnzipEntry& entry)> processEntry)
 {
-    std::ifstream fs(filepath, std::ios::binary);
-    if (fs.fail())
+    vector<UnzipEntry*> files;
+    for (auto& entry : entries)
+        if (!entry.isDir)
+            files.push_back(&entry);
+
+    std::sort(files.begin(),
+              files.end(),
+              [](const UnzipEntry* a, const UnzipEntry* b)
+              { return a->compressedSize > b->compressedSize; });
+
+    if (numThreads <= 0)
+        numThreads = (int)Utils::maxThreads();
+    numThreads = std::max(1, std::min(numThreads, (int)files.size()));
+
+    std::atomic<size_t> nextFile{0};
+    std::atomic<bool>   ok{true};
+
+    auto worker = [&]()
     {
+        unzFile uzfile = unzip_open(zipfile, memory);
+        if (uzfile == NULL)
+        {
+            ok = false;
+            return;
+        }
+
+        size_t i;
+        while (ok && (i = nextFile++) < files.size())
+        {
+            UnzipEntry& entry = *files[i];
+            if (unzGoToFilePos64(uzfile, &entry.pos) != UNZ_OK ||
+                unzOpenCurrentFile(uzfile) != UNZ_OK)
+            {
+                ok = false;
+                break;
+            }
+
+            if (!processEntry(uzfile, entry))
+                ok = false;
+
+            if (unzCloseCurrentFile(uzfile) != UNZ_OK) // checks the CRC
+                ok = false;
+        }
+        unzClose(uzfile);
+    };
+
+    vector<std::thread> threads;
+    for (int t = 1; t < numThreads; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    return ok;
+}
+//-----------------------------------------------------------------------------
+//! Decompresses all entries of a zip archive from file or memory into buffers
+static bool unzip_to_memory(const string&                                                    zipfile,
+                            UnzipMemory*                                                     memory,
+                            function<void(string path, string filename, vector<char>& data)> processData,
+                            function<bool(string path, string filename)>                     filter,
+                            int                                                              numThreads)
+{
+    unzFile uzfile = unzip_open(zipfile, memory);
+    if (uzfile == NULL)
         return false;
-    }
 
-    return zip_add_file(zfile,
-                        fs,
-                        Utils::getFileName(filepath),
-                        zipPath);
+    vector<UnzipEntry> entries;
+    bool               listed = unzip_list(uzfile, entries);
+    unzClose(uzfile);
+    if (!listed)
+        return false;
+
+    if (filter)
+        entries.erase(std::remove_if(entries.begin(),
+                                     entries.end(),
+                                     [&](const UnzipEntry& e)
+                                     { return !e.isDir && !filter(e.dirname, e.filename); }),
+                      entries.end());
+
+    std::mutex mutex;
+
+    return unzip_parallel(
+      zipfile,
+      memory,
+      entries,
+      numThreads,
+      [&](unzFile uzfile, UnzipEntry& entry) -> bool
+      {
+          // Decompress directly into the final buffer
+          vector<char> data((size_t)entry.uncompressedSize);
+          size_t       pos = 0;
+          while (pos < data.size())
+          {
+              unsigned int n   = (unsigned int)std::min(data.size() - pos, (size_t)(1u << 30));
+              int          len = unzReadCurrentFile(uzfile, data.data() + pos, n);
+              if (len <= 0)
+                  return false;
+              pos += (size_t)len;
+          }
+
+          std::lock_guard<std::mutex> lock(mutex);
+          processData(entry.dirname, entry.filename, data);
+          return true;
+      });
 }
 //-----------------------------------------------------------------------------
 /*!
@@ -151,7 +444,7 @@ bool unzip(string                                         zipfile,
            function<bool(string path, string filename)>   processFile,
            function<bool(const char* data, size_t len)>   writeChunk,
            function<bool(string path)>                    processDir,
-           function<int(int currentFile, int totalFiles)> progress = nullptr)
+           function<int(int currentFile, int totalFiles)> progress)
 {
     unzFile uzfile;
     bool    ret = true;
@@ -247,12 +540,16 @@ bool unzip(string                                         zipfile,
 }
 //-----------------------------------------------------------------------------
 /*!
- *
- * @param path ???
- * @param zipname ???
- * @return ???
+ * Compresses a file or a folder recursively into a zip archive.
+ * The files are read and deflated on numThreads worker threads while the
+ * calling thread writes the finished files in their original order as raw
+ * entries into the archive. At most 2 * numThreads files are held in memory.
+ * @param path File or folder to compress
+ * @param zipname Path of the zip file (path + ".zip" if empty)
+ * @param numThreads No. of threads (0 for Utils::maxThreads())
+ * @return True on success
  */
-bool zip(string path, string zipname)
+bool zip(string path, string zipname, int numThreads)
 {
     path = Utils::trimRightString(path, "/");
 
@@ -262,100 +559,245 @@ bool zip(string path, string zipname)
     zipFile zfile = zipOpen64(zipname.c_str(), 0);
 
     if (zfile == nullptr)
-    {
-        zipClose(zfile, nullptr);
         return false;
-    }
 
-    bool   ret         = true;
-    string zipRootPath = Utils::getDirName(path);
+    // Collect the directories and files in the order of the file system
+    struct ZipItem
+    {
+        string dirName;
+        size_t fileJob;
+        bool   isDir;
+    };
+    vector<ZipItem>                     items;
+    vector<std::unique_ptr<ZipFileJob>> jobs;
+    string                              zipRootPath = Utils::getDirName(path);
 
     Utils::loopFileSystemRec(
       path,
-      [zfile,
-       &ret,
-       zipRootPath](string path,
-                    string baseName,
-                    int    depth) -> void
+      [&jobs, &items, zipRootPath](string path,
+                                   string baseName,
+                                   int    depth) -> void
       {
-          ret = ret && zip_add_file(zfile,
-                                    path + baseName,
-                                    path.erase(0,
-                                               zipRootPath.size()));
+          std::unique_ptr<ZipFileJob> job(new ZipFileJob);
+          job->filePath = path + baseName;
+          job->zipName  = Utils::unifySlashes(path.erase(0, zipRootPath.size())) + baseName;
+          items.push_back({"", jobs.size(), false});
+          jobs.push_back(std::move(job));
       },
-      [zfile, &ret, zipRootPath](string path,
-                                 string baseName,
-                                 int    depth) -> void
+      [&items, zipRootPath](string path,
+                            string baseName,
+                            int    depth) -> void
       {
-          ret = ret && zip_add_dir(zfile,
-                                   path.erase(0, zipRootPath.size()) + baseName);
+          items.push_back({path.erase(0, zipRootPath.size()) + baseName, 0, true});
       },
       0);
 
+    if (numThreads <= 0)
+        numThreads = (int)Utils::maxThreads();
+    numThreads = std::max(1, std::min(numThreads, (int)jobs.size()));
+
+    std::mutex              mutex;
+    std::condition_variable cv;
+    std::atomic<size_t>     nextJob{0};
+    std::atomic<bool>       abort{false};
+    size_t                  numWritten  = 0;
+    size_t                  maxInFlight = 2 * (size_t)numThreads;
+
+    auto worker = [&]()
+    {
+        while (!abort)
+        {
+            size_t i = nextJob++;
+            if (i >= jobs.size())
+                break;
+
+            // Limit the no. of deflated files waiting to be written
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return abort || i < numWritten + maxInFlight; });
+            }
+
+            zip_deflate_file(*jobs[i]);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs[i]->done = true;
+            cv.notify_all();
+        }
+    };
+
+    vector<std::thread> threads;
+    if (numThreads > 1)
+        for (int t = 0; t < numThreads; t++)
+            threads.emplace_back(worker);
+
+    bool ret = true;
+    for (ZipItem& item : items)
+    {
+        if (item.isDir)
+        {
+            ret = zip_add_dir(zfile, item.dirName);
+        }
+        else
+        {
+            ZipFileJob& job = *jobs[item.fileJob];
+            if (threads.empty())
+                zip_deflate_file(job);
+            else
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() { return job.done.load(); });
+            }
+
+            ret = job.ok && zip_add_deflated(zfile, job);
+            job.deflated = vector<char>();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            numWritten++;
+            cv.notify_all();
+        }
+
+        if (!ret)
+            break;
+    }
+
+    if (!ret)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        abort = true;
+        cv.notify_all();
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    zipClose(zfile, NULL);
+
     if (!ret)
     {
-        free(zfile);
         Utils::removeFile(zipname);
         return false;
     }
 
-    zipClose(zfile, NULL);
     return true;
 }
 //-----------------------------------------------------------------------------
 /*!
- Unzips a zip file
- @param path ???
- @param dest ???
+ Unzips a zip file. All directories are created first and then the file
+ entries are decompressed on numThreads threads.
+ @param path Path of the zip file
+ @param dest Destination folder
  @param override Overrides existing files on destination
  @param progress Progress function to call for progress visualization
+ @param numThreads No. of threads (0 for Utils::maxThreads())
  @return Returns true on success
  */
 bool unzip(string                                         path,
            string                                         dest,
            bool                                           override,
-           function<int(int currentFile, int totalFiles)> progress)
+           function<int(int currentFile, int totalFiles)> progress,
+           int                                            numThreads)
 {
-    std::ofstream fs;
-
     dest = Utils::unifySlashes(dest);
-    unzip(
+
+    unzFile uzfile = unzip_open(path, nullptr);
+    if (uzfile == NULL)
+        return false;
+
+    vector<UnzipEntry> entries;
+    bool               listed = unzip_list(uzfile, entries);
+    unzClose(uzfile);
+    if (!listed)
+        return false;
+
+    for (auto& entry : entries)
+    {
+        string dir = dest + entry.dirname + (entry.isDir ? entry.filename : "");
+        if (!Utils::dirExists(dir) && !Utils::makeDirRecurse(dir))
+            return false;
+    }
+
+    if (!override)
+        entries.erase(std::remove_if(entries.begin(),
+                                     entries.end(),
+                                     [&](const UnzipEntry& e)
+                                     { return Utils::fileExists(dest + e.dirname + e.filename); }),
+                      entries.end());
+
+    std::mutex mutex;
+    int        numProcessed = 0;
+    bool       interrupted  = false;
+
+    bool ret = unzip_parallel(
       path,
-      [&fs, &override, dest](string path, string filename) -> bool
+      nullptr,
+      entries,
+      numThreads,
+      [&](unzFile uzfile, UnzipEntry& entry) -> bool
       {
-          if (override || !Utils::fileExists(dest + path + filename))
+          if (progress)
           {
-              fs.open(dest + path + filename, std::ios::binary);
-              return true;
-          }
-          return false;
-      },
-      [&fs](const char* data, size_t len) -> bool
-      {
-          if (data != nullptr)
-          {
-              try
-              {
-                  fs.write(data, len);
-              }
-              catch (std::exception& e)
+              std::lock_guard<std::mutex> lock(mutex);
+              if (interrupted || progress(numProcessed++, (int)entries.size()))
               {
-                  std::cout << e.what() << std::endl;
+                  interrupted = true;
                   return false;
               }
           }
-          else
-              fs.close();
-          return true;
-      },
-      [dest](string path) -> bool
-      {
-          if (!Utils::dirExists(dest + path))
-              return Utils::makeDir(dest + path);
-          return true;
-      },
-      progress);
-    return true;
+
+          std::ofstream fs(dest + entry.dirname + entry.filename, std::ios::binary);
+          if (!fs.is_open())
+              return false;
+
+          char buf[65536];
+          int  n;
+          while ((n = unzReadCurrentFile(uzfile, buf, sizeof(buf))) > 0)
+              fs.write(buf, n);
+          return n == 0 && fs.good();
+      });
+
+    if (progress != nullptr && !interrupted)
+        progress((int)entries.size(), (int)entries.size());
+
+    return ret && !interrupted;
+}
+//-----------------------------------------------------------------------------
+/*!
+ Decompresses the entries of a zip file directly into memory buffers on
+ numThreads threads without writing anything to disk.
+ @param zipfile Path of the zip file
+ @param processData Called with the directory, the file name and the
+ decompressed content of each entry. The calls are serialized but not in the
+ order of the archive. The data may be moved away.
+ @param filter Optional filter to select the entries to decompress
+ @param numThreads No. of threads (0 for Utils::maxThreads())
+ @return Returns true on success
+ */
+bool unzipToMemory(string                                                           zipfile,
+                   function<void(string path, string filename, vector<char>& data)> processData,
+                   function<bool(string path, string filename)>                     filter,
+                   int                                                              numThreads)
+{
+    return unzip_to_memory(zipfile, nullptr, processData, filter, numThreads);
+}
+//-----------------------------------------------------------------------------
+/*!
+ Decompresses the entries of a zip archive that is already in memory (e.g.
+ downloaded) directly into memory buffers on numThreads threads.
+ @param zipData Pointer to the zip archive in memory
+ @param zipSize Size of the zip archive in bytes
+ @param processData See unzipToMemory above
+ @param filter Optional filter to select the entries to decompress
+ @param numThreads No. of threads (0 for Utils::maxThreads())
+ @return Returns true on success
+ */
+bool unzipToMemory(const char*                                                      zipData,
+                   size_t                                                           zipSize,
+                   function<void(string path, string filename, vector<char>& data)> processData,
+                   function<bool(string path, string filename)>                     filter,
+                   int                                                              numThreads)
+{
+    UnzipMemory memory{zipData, (ZPOS64_T)zipSize, 0};
+    return unzip_to_memory("", &memory, processData, filter, numThreads);
 }
 //-----------------------------------------------------------------------------
 }
@@ -11,12 +11,20 @@
 #define CPLVRLAB_ZIP_UTILS_H
 
 #include <string>
+#include <vector>
 #include <functional>
 
 //! ZipUtils provides compressing & decompressing files and folders
+/*! Besides the sequential streaming unzip with callbacks, entries can be
+ * decompressed on multiple threads either to disk or directly into memory
+ * buffers (from a zip file or from a zip archive already in memory) without
+ * writing them to disk. zip deflates the files on multiple threads and
+ * writes them in order into the archive.
+ * A numThreads of 0 means Utils::maxThreads().
+ */
 namespace ZipUtils
 {
-bool zip(string path, string zipname = "");
+bool zip(string path, string zipname = "", int numThreads = 0);
 
 bool unzip(string                                         zipfile,
            function<bool(string path, string filename)>   processFile,
@@ -25,8 +33,20 @@ bool unzip(string                                         zipfile,
            function<int(int currentFile, int totalFiles)> progress = nullptr);
 
 bool unzip(string                                         path,
-           string                                         dest     = "",
-           bool                                           override = true,
-           function<int(int currentFile, int totalFiles)> progress = nullptr);
+           string                                         dest       = "",
+           bool                                           override   = true,
+           function<int(int currentFile, int totalFiles)> progress   = nullptr,
+           int                                            numThreads = 0);
+
+bool unzipToMemory(string                                                           zipfile,
+                   function<void(string path, string filename, vector<char>& data)> processData,
+                   function<bool(string path, string filename)>                     filter     = nullptr,
+                   int                                                              numThreads = 0);
+
+bool unzipToMemory(const char*                                                      zipData,
+                   size_t                                                           zipSize,
+                   function<void(string path, string filename, vector<char>& data)> processData,
+                   function<bool(string path, string filename)>                     filter     = nullptr,
+                   int                                                              numThreads = 0);
 }
 #endif
@@ -8,11 +8,26 @@
 //#############################################################################
 
 #include <Utils.h>
+#include <HttpUtils.h>
 #include <ftplib.h>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <vector>
+#ifdef SL_BUILD_WITH_OPENSSL
+#    include <atomic>
+#    include <map>
+#    include <mutex>
+#    include <thread>
+#    include <cstring>
+#    ifndef _WINDOWS
+#        include <sys/socket.h>
+#        include <netinet/in.h>
+#        include <arpa/inet.h>
+#        include <poll.h>
+#        include <unistd.h>
+#    endif
+#endif
 
 using std::cout;
 using std::endl;
@@ -34,6 +49,360 @@ int ftpCallbackXfer(off64_t xfered, void* arg)
     return xfered ? 1 : 0;
 }
 //-----------------------------------------------------------------------------
+#ifdef SL_BUILD_WITH_OPENSSL
+int numErrors = 0;
+//-----------------------------------------------------------------------------
+void check(bool ok, const string& what)
+{
+    if (!ok)
+    {
+        cout << "*** ERROR: " << what << " ***" << endl;
+        numErrors++;
+    }
+}
+#    ifndef _WINDOWS
+//-----------------------------------------------------------------------------
+//! Minimal HTTP/1.1 file server on 127.0.0.1 for the mirror tests
+/*! Serves files from memory with an ETag, directory listings like python's
+ * http.server, keep-alive, HEAD and "Range: bytes=N-" with "If-Range". It
+ * counts the connections and requests, so that the tests can check the
+ * connection reuse of HttpUtils::Connection and HttpUtils::mirror.
+ */
+class TestHttpServer
+{
+public:
+    TestHttpServer()
+    {
+        _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int on    = 1;
+        setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = 0; // Let the OS choose a free port
+        bind(_listenFd, (sockaddr*)&addr, sizeof(addr));
+        listen(_listenFd, 16);
+
+        socklen_t len = sizeof(addr);
+        getsockname(_listenFd, (sockaddr*)&addr, &len);
+        _port = ntohs(addr.sin_port);
+
+        _acceptThread = std::thread(&TestHttpServer::acceptLoop, this);
+    }
+
+    ~TestHttpServer()
+    {
+        _stop = true;
+        _acceptThread.join();
+        for (auto& thread : _connThreads)
+            thread.join();
+        close(_listenFd);
+    }
+
+    //! Adds or changes a file. A changed content gets a new ETag.
+    void setFile(const string& path, const string& content)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _files[path] = content;
+        _etags[path] = "\"" + std::to_string(++_version) + "-" + std::to_string(content.size()) + "\"";
+    }
+
+    string url() const { return "http://127.0.0.1:" + std::to_string(_port) + "/"; }
+    int    numConnections() const { return _numConnections; }
+    int    numRequests() const { return _numRequests; }
+    int    numGets() const { return _numGets; }
+    int    numRangeGets() const { return _numRangeGets; }
+    int    maxActiveConnections() const { return _maxActive; }
+
+private:
+    void acceptLoop()
+    {
+        while (!_stop)
+        {
+            pollfd pfd{_listenFd, POLLIN, 0};
+            if (poll(&pfd, 1, 50) <= 0)
+                continue;
+
+            int fd = accept(_listenFd, nullptr, nullptr);
+            if (fd < 0)
+                continue;
+
+            // Don't block the destructor forever on a client that keeps the connection
+            timeval tv{5, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+            _numConnections++;
+            _connThreads.emplace_back(&TestHttpServer::serve, this, fd);
+        }
+    }
+
+    void serve(int fd)
+    {
+        int active = ++_active;
+        for (int m = _maxActive; active > m && !_maxActive.compare_exchange_weak(m, active);) {}
+
+        string buffer;
+        char   chunk[4096];
+        while (!_stop)
+        {
+            size_t headerEnd = buffer.find("\r\n\r\n");
+            if (headerEnd == string::npos)
+            {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) break;
+                buffer.append(chunk, (size_t)n);
+                continue;
+            }
+
+            string request = buffer.substr(0, headerEnd);
+            buffer.erase(0, headerEnd + 4);
+            if (!respond(fd, request))
+                break;
+        }
+
+        _active--;
+        close(fd);
+    }
+
+    //! Sends the response to one request. Returns false to close the connection.
+    bool respond(int fd, const string& request)
+    {
+        _numRequests++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // Some latency
+
+        vector<string> lines;
+        Utils::splitString(request, '\n', lines);
+        vector<string> parts;
+        Utils::splitString(Utils::trimString(lines[0], "\r"), ' ', parts);
+        string method = parts.size() > 0 ? parts[0] : "";
+        string path   = parts.size() > 1 ? HttpUtils::urlDecode(parts[1].substr(1)) : "";
+
+        string range, ifRange;
+        bool   keepAlive = true;
+        for (size_t i = 1; i < lines.size(); ++i)
+        {
+            string line  = Utils::trimString(lines[i], "\r");
+            size_t colon = line.find(':');
+            if (colon == string::npos) continue;
+            string name  = Utils::toLowerString(line.substr(0, colon));
+            string value = Utils::trimString(line.substr(colon + 1), " ");
+            if (name == "range") range = value;
+            if (name == "if-range") ifRange = value;
+            if (name == "connection" && Utils::toLowerString(value) == "close") keepAlive = false;
+        }
+
+        int    status = 200;
+        string type   = "application/octet-stream";
+        string body, etag, contentRange;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (path.empty() || path.back() == '/')
+            {
+                // Directory listing of all files and subdirectories below path
+                type = "text/html";
+                body = "<html><body><a href=\"../\">../</a>";
+                std::map<string, bool> entries;
+                for (auto& file : _files)
+                {
+                    if (file.first.compare(0, path.size(), path) != 0) continue;
+                    string rest  = file.first.substr(path.size());
+                    size_t slash = rest.find('/');
+                    entries[slash == string::npos ? rest : rest.substr(0, slash + 1)] = true;
+                }
+                for (auto& entry : entries)
+                {
+                    string href;
+                    for (char c : entry.first)
+                        href += c == ' ' ? string("%20") : string(1, c);
+                    body += "<a href=\"" + href + "\">" + entry.first + "</a>";
+                }
+                body += "</body></html>";
+            }
+            else if (_files.count(path))
+            {
+                body = _files[path];
+                etag = _etags[path];
+            }
+            else
+                status = 404;
+        }
+
+        // Only ranges of the current version are served, otherwise the full file
+        if (status == 200 && !range.empty() && !etag.empty() && (ifRange.empty() || ifRange == etag))
+        {
+            size_t from = (size_t)strtoull(range.c_str() + strlen("bytes="), nullptr, 10);
+            if (from < body.size())
+            {
+                status       = 206;
+                contentRange = "bytes " + std::to_string(from) + "-" + std::to_string(body.size() - 1) + "/" + std::to_string(body.size());
+                body         = body.substr(from);
+            }
+        }
+
+        if (method == "GET" && status != 404 && type != "text/html")
+        {
+            _numGets++;
+            if (status == 206) _numRangeGets++;
+        }
+
+        string header = "HTTP/1.1 " + std::to_string(status) + (status == 404 ? " Not Found" : status == 206 ? " Partial Content" : " OK") + "\r\n";
+        header += "Content-Type: " + type + "\r\n";
+        header += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        if (!etag.empty()) header += "ETag: " + etag + "\r\n";
+        if (!contentRange.empty()) header += "Content-Range: " + contentRange + "\r\n";
+        if (!keepAlive) header += "Connection: close\r\n";
+        header += "\r\n";
+
+        string response = header + (method == "HEAD" ? "" : body);
+        for (size_t sent = 0; sent < response.size();)
+        {
+            ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += (size_t)n;
+        }
+        return keepAlive;
+    }
+
+    int                      _listenFd;
+    int                      _port;
+    std::atomic<bool>        _stop{false};
+    std::thread              _acceptThread;
+    vector<std::thread>      _connThreads;
+    std::mutex               _mutex;
+    std::map<string, string> _files;
+    std::map<string, string> _etags;
+    int                      _version = 0;
+    std::atomic<int>         _numConnections{0};
+    std::atomic<int>         _numRequests{0};
+    std::atomic<int>         _numGets{0};
+    std::atomic<int>         _numRangeGets{0};
+    std::atomic<int>         _active{0};
+    std::atomic<int>         _maxActive{0};
+};
+//-----------------------------------------------------------------------------
+//! Returns the content of a file or "<missing>" if it doesn't exist
+string readFile(const string& pathFilename)
+{
+    std::ifstream fs(pathFilename, std::ios::binary);
+    if (!fs.is_open()) return "<missing>";
+    return string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+}
+//-----------------------------------------------------------------------------
+//! Removes a directory with all its files and subdirectories
+void removeDirRecurse(const string& dir)
+{
+    if (!Utils::dirExists(dir)) return;
+    for (const string& file : Utils::getFileNamesInDir(dir))
+        Utils::removeFile(file);
+    for (const string& subDir : Utils::getDirNamesInDir(dir))
+        removeDirRecurse(Utils::unifySlashes(subDir));
+    Utils::removeDir(dir);
+}
+//-----------------------------------------------------------------------------
+//! Tests the transfers of HttpUtils against a local TestHttpServer
+void testMirrorWithServer(const string& awd)
+{
+    TestHttpServer server;
+
+    // Files in the root, a subdirectory with an encoded name and a big file
+    std::map<string, string> files;
+    for (int i = 0; i < 20; i++)
+        files["file" + std::to_string(i) + ".txt"] = "Content of file " + std::to_string(i);
+    files["sub dir/b c.txt"] = "File with spaces";
+    files["sub dir/empty.txt"] = "";
+    string big(3 << 20, ' ');
+    for (size_t i = 0; i < big.size(); i++)
+        big[i] = (char)('a' + (i * 7 + i / 1000) % 26);
+    files["big.bin"] = big;
+    for (auto& file : files)
+        server.setFile(file.first, file.second);
+
+    string dst = awd + "utils_tests_mirror/";
+    removeDirRecurse(dst);
+
+    auto checkMirrored = [&](const string& what)
+    {
+        for (auto& file : files)
+            check(readFile(dst + file.first) == file.second, what + ": content of " + file.first);
+        check(!Utils::fileExists(dst + "big.bin.part"), what + ": .part file left");
+    };
+
+    // Keep-alive: Two requests over one connection
+    {
+        HttpUtils::Connection conn(server.url());
+        HttpUtils::Response   response;
+        string                content;
+        auto                  append = [&content](char* data, int size) -> int
+        {
+            content.append(data, (size_t)size);
+            return 0;
+        };
+        check(conn.request("GET", "/file1.txt", {}, response, append) == 0, "keep-alive: 1st request");
+        check(conn.request("GET", "/file2.txt", {}, response, append) == 0, "keep-alive: 2nd request");
+        check(content == files["file1.txt"] + files["file2.txt"], "keep-alive: content");
+        check(conn.numRequests() == 2 && conn.numConnects() == 1, "keep-alive: connection not reused");
+    }
+    check(server.numConnections() == 1, "keep-alive: server connections");
+
+    // Interrupted download: The progress callback stops the mirroring after 1MB
+    HttpUtils::MirrorStats stats;
+    int                    ret = HttpUtils::mirror(server.url(),
+                                dst,
+                                "",
+                                "",
+                                1,
+                                [](size_t, size_t, int64_t bytes)
+                                { return bytes >= (1 << 20) ? 1 : 0; },
+                                &stats);
+    check(ret == DOWNLOAD_INTERRUPTED, "interrupt: return value");
+    check(Utils::getFileSize(dst + "big.bin.part") >= (1 << 20), "interrupt: .part file missing");
+
+    // Resume: The rest of big.bin is requested with Range and If-Range
+    int rangeGetsBefore = server.numRangeGets();
+    ret                 = HttpUtils::mirror(server.url(), dst, "", "", 4, nullptr, &stats);
+    check(ret == 0, "resume: return value");
+    check(stats.numResumed == 1, "resume: no. of resumed files");
+    check(server.numRangeGets() == rangeGetsBefore + 1, "resume: no range request");
+    check(stats.numDownloaded + stats.numResumed + stats.numSkipped == files.size(), "resume: no. of files");
+    checkMirrored("resume");
+
+    // Skip unchanged: No file is downloaded again
+    int getsBefore = server.numGets();
+    ret            = HttpUtils::mirror(server.url(), dst, "", "", 4, nullptr, &stats);
+    check(ret == 0, "skip: return value");
+    check(stats.numSkipped == files.size(), "skip: no. of skipped files");
+    check(server.numGets() == getsBefore, "skip: unchanged file downloaded");
+
+    // A changed file gets downloaded again
+    files["file3.txt"] = "Changed content of file 3";
+    server.setFile("file3.txt", files["file3.txt"]);
+    ret = HttpUtils::mirror(server.url(), dst, "", "", 4, nullptr, &stats);
+    check(ret == 0 && stats.numDownloaded == 1, "changed: no. of downloaded files");
+    checkMirrored("changed");
+
+    // Concurrent mirroring into an empty directory with 4 keep-alive connections
+    removeDirRecurse(dst);
+    int connectionsBefore = server.numConnections();
+    ret                   = HttpUtils::mirror(server.url(), dst, "", "", 4, nullptr, &stats);
+    check(ret == 0, "concurrent: return value");
+    check(stats.numDownloaded == files.size(), "concurrent: no. of downloaded files");
+    check(stats.numConnects <= 5, "concurrent: connections not reused");
+    check(server.numConnections() - connectionsBefore == stats.numConnects, "concurrent: server connections");
+    check(server.maxActiveConnections() >= 2, "concurrent: no parallel connections");
+    checkMirrored("concurrent");
+
+    // A single file url as used for the asset downloads of the demo app
+    removeDirRecurse(dst);
+    ret = HttpUtils::mirror(server.url() + "big.bin", dst, "", "", 1, nullptr, &stats);
+    check(ret == 0 && stats.numDownloaded == 1, "single file: no. of downloaded files");
+    check(readFile(dst + "big.bin") == big, "single file: content");
+
+    removeDirRecurse(dst);
+}
+#    endif
+#endif
+//-----------------------------------------------------------------------------
 int main(int argc, char* argv[])
 {
     string cwd = Utils::getCurrentWorkingDir();
@@ -88,6 +457,67 @@ int main(int argc, char* argv[])
         ftp.Quit();
     }
 
+#ifdef SL_BUILD_WITH_OPENSSL
+    cout << endl << "HTTP mirror tests" << endl;
+    // Listing parsing: sort queries, parent links and absolute urls are dropped
+    string listing = "<html><body>"
+                     "<a href=\"?C=N;O=D\">Name</a>"
+                     "<a href=\"../\">Parent</a>"
+                     "<a href=\"images/\">images/</a>"
+                     "<a href=\"my%20file.txt\">my file.txt</a>"
+                     "</body></html>";
+    vector<string> links = HttpUtils::parseListing(listing);
+    check(links.size() == 2, "parseListing link count");
+    check(links.size() > 0 && links[0] == "images/", "parseListing directory");
+    check(links.size() > 1 && links[1] == "my%20file.txt", "parseListing file");
+    check(HttpUtils::urlDecode("my%20file.txt") == "my file.txt", "urlDecode");
+
+    // Traversal rejection after decoding
+    check(HttpUtils::isSafeRelativePath("images/a.png"), "safe path rejected");
+    check(HttpUtils::isSafeRelativePath("images/"), "safe directory rejected");
+    check(HttpUtils::isSafeRelativePath("a..b/c"), "dots in name rejected");
+    const vector<string> unsafeLinks = {"a/../../x", "%2e%2e/x", "..%2Fx", "..", "/etc/passwd", "a%5C..%5Cx", "c:/x", ""};
+    for (const string& link : unsafeLinks)
+        check(!HttpUtils::isSafeRelativePath(HttpUtils::urlDecode(link)), "unsafe path accepted: " + link);
+
+    // Manifest round-trip: later lines override, size -1 removes, bad sizes are skipped
+    string manifestFile = awd + "utils_tests.httpmirror";
+    {
+        std::ofstream fs(manifestFile, std::ios::trunc);
+        fs << "a.txt\t10\t\"etag1\"\n"
+           << "b.txt\t20\tMon, 01 Jan 2024\n"
+           << "a.txt\t11\t\"etag2\"\n"
+           << "b.txt\t-1\t\n"
+           << "c.txt\tabc\t\"x\"\n"
+           << "d.txt\t99999999999999999999999\t\"y\"\n";
+    }
+    HttpUtils::MirrorManifest manifest;
+    HttpUtils::loadMirrorManifest(manifestFile, manifest);
+    check(manifest.size() == 1, "manifest entry count");
+    check(manifest.count("a.txt") && manifest["a.txt"].size == 11, "manifest size override");
+    check(manifest.count("a.txt") && manifest["a.txt"].validator == "\"etag2\"", "manifest validator");
+
+    manifest["e f.txt"] = {1LL << 40, "W/\"big\""};
+    check(HttpUtils::saveMirrorManifest(manifestFile, manifest), "saveMirrorManifest");
+    HttpUtils::MirrorManifest reloaded;
+    HttpUtils::loadMirrorManifest(manifestFile, reloaded);
+    check(reloaded.size() == manifest.size(), "manifest round-trip count");
+    for (auto& entry : manifest)
+        check(reloaded.count(entry.first) &&
+                reloaded[entry.first].size == entry.second.size &&
+                reloaded[entry.first].validator == entry.second.validator,
+              "manifest round-trip of " + entry.first);
+    Utils::deleteFile(manifestFile);
+
+#    ifndef _WINDOWS
+    testMirrorWithServer(awd);
+#    endif
+
+    cout << (numErrors ? "HTTP mirror tests failed" : "HTTP mirror tests passed") << endl;
+    if (numErrors)
+        return 1;
+#endif
+
     return 0;
 }
 //-----------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 #include <limits>
 #include <cstdint>
 #include <algorithm>
+#include <thread>
 
 namespace fbow
 {
@@ -111,6 +112,154 @@ void Vocabulary::transform(const cv::Mat& features, int level, fBow& result, fBo
     }
 }
 
+void Vocabulary::transform(const std::vector<cv::Mat>& features, int level, std::vector<fBow>& result, std::vector<fBow2>& result2, int nthreads)
+{
+    result.assign(features.size(), fBow());
+    result2.assign(features.size(), fBow2());
+    for (const cv::Mat& f : features)
+    {
+        if (f.rows == 0) continue;
+        if (f.type() != _params._desc_type) throw std::runtime_error("Vocabulary::transform features are of different type than vocabulary");
+        if (f.cols * f.elemSize() != size_t(_params._desc_size)) throw std::runtime_error("Vocabulary::transform features are of different size than the vocabulary ones");
+    }
+
+    //the batched version is implemented for 256 bit binary descriptors (orb)
+    if (_params._desc_type != CV_8UC1 || _params._desc_size != 32)
+    {
+        for (size_t i = 0; i < features.size(); i++)
+            if (features[i].rows > 0) transform(features[i], level, result[i], result2[i]);
+        return;
+    }
+
+    //the images are processed in groups of about 16k descriptors, so the queries stay in the cache
+    const size_t groupSize = 16384;
+    size_t       begin = 0, numDesc = 0;
+    for (size_t i = 0; i < features.size(); i++)
+    {
+        numDesc += features[i].rows;
+        if (numDesc >= groupSize || i + 1 == features.size())
+        {
+            _transformBatch(features, begin, i + 1, level, result, result2, nthreads);
+            begin   = i + 1;
+            numDesc = 0;
+        }
+    }
+}
+
+void Vocabulary::_transformBatch(const std::vector<cv::Mat>& features, size_t imgBegin, size_t imgEnd, int level, std::vector<fBow>& result, std::vector<fBow2>& result2, int nthreads)
+{
+    struct Query
+    {
+        const uint64_t* feature;
+        uint32_t        block; //current block
+        uint32_t        image; //index into features
+        uint32_t        row;   //row in features[image]
+        uint32_t        node;  //path of the query in the tree (see _transform2)
+        uint32_t        best;  //index of the nearest node in the current block
+    };
+    std::vector<Query>    active, next;
+    std::vector<uint32_t> blockStart;
+    for (size_t i = imgBegin; i < imgEnd; i++)
+    {
+        for (int r = 0; r < features[i].rows; r++)
+            active.push_back({features[i].ptr<uint64_t>(r), 0, (uint32_t)i, (uint32_t)r, 0, 0});
+    }
+
+    const uint32_t storeLevel = (uint32_t)level;
+    const int      nbits      = (int)ceil(log2(_params._m_k));
+    for (uint32_t curLevel = 0; !active.empty(); curLevel++)
+    {
+        //group the queries by block (counting sort), so the features of a block are loaded only once per level
+        if (curLevel > 0)
+        {
+            blockStart.assign(_params._nblocks + 1, 0);
+            for (const Query& q : next) blockStart[q.block + 1]++;
+            for (size_t b = 1; b < blockStart.size(); b++) blockStart[b] += blockStart[b - 1];
+            active.resize(next.size());
+            for (const Query& q : next) active[blockStart[q.block]++] = q;
+        }
+
+        auto findNearest = [&](size_t begin, size_t end) {
+            Block    block   = getBlock(0);
+            uint32_t blockId = 0;
+            uint64_t feature[4];
+            for (size_t i = begin; i < end; i++)
+            {
+                Query& q = active[i];
+                if (q.block != blockId)
+                {
+                    blockId = q.block;
+                    setBlock(blockId, block);
+                }
+                //copied, because the rows of a cv::Mat need not be 8 byte aligned
+                memcpy(feature, q.feature, sizeof(feature));
+                uint32_t bestDist = std::numeric_limits<uint32_t>::max();
+                for (int n = 0; n < block.getN(); n++)
+                {
+                    uint32_t d = hamming256(feature, block.getFeature<uint64_t>(n));
+                    if (d < bestDist)
+                    {
+                        bestDist = d;
+                        q.best   = n;
+                    }
+                }
+            }
+        };
+
+        //threads are only worth their start up costs for many queries
+        size_t nt = std::max<size_t>(1, std::min<size_t>((size_t)std::max(nthreads, 1), active.size() / 2048));
+        if (nt > 1)
+        {
+            size_t                   chunk = (active.size() + nt - 1) / nt;
+            std::vector<std::thread> threads;
+            for (size_t t = 1; t < nt; t++)
+                threads.push_back(std::thread(findNearest, t * chunk, std::min(active.size(), (t + 1) * chunk)));
+            findNearest(0, chunk);
+            for (std::thread& th : threads) th.join();
+        }
+        else
+            findNearest(0, active.size());
+
+        //descend into the children or add the words
+        next.clear();
+        Block block = getBlock(0);
+        for (Query& q : active)
+        {
+            if (curLevel == storeLevel) result2[q.image][q.node].push_back(q.row);
+
+            setBlock(q.block, block);
+            block_node_info* bn_info = block.getBlockNodeInfo(q.best);
+            if (bn_info->isleaf())
+            {
+                result[q.image][bn_info->getId()] += bn_info->weight;
+                if (curLevel < storeLevel) result2[q.image][q.node].push_back(q.row);
+            }
+            else if (bn_info->getId() != 0)
+            {
+                q.block = bn_info->getId();
+                q.node  = (q.node << nbits) | q.best;
+                next.push_back(q);
+            }
+        }
+        if (next.empty()) break;
+    }
+
+    for (size_t i = imgBegin; i < imgEnd; i++)
+    {
+        //same order of the feature indices as in the single image version
+        for (auto& e : result2[i]) std::sort(e.second.begin(), e.second.end());
+
+        //normalize
+        double norm = 0;
+        for (auto e : result[i]) norm += e.second * e.second;
+        if (norm > 0.0)
+        {
+            double inv_norm = 1. / sqrt(norm);
+            for (auto& e : result[i]) e.second *= (float)inv_norm;
+        }
+    }
+}
+
 fBow Vocabulary::transform(const cv::Mat& features)
 {
     if (features.rows == 0) throw std::runtime_error("Vocabulary::transform No input data");
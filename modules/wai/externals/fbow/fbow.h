@@ -6,6 +6,7 @@
 #include <map>
 #include <memory>
 #include <bitset>
+#include <vector>
 
 #ifdef __APPLE__
 #    include <TargetConditionals.h> //defines TARGET_OS_IOS
@@ -14,11 +15,47 @@
 #if !defined(__ANDROID__) && !defined(TARGET_OS_IOS)
 #    include <immintrin.h>
 #endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#    include <arm_neon.h>
+#elif defined(_MSC_VER)
+#    include <intrin.h>
+#endif
 
 #include "cpu.h"
 namespace fbow
 {
 
+//number of set bits
+inline uint32_t popcount64(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    //compiles to the popcnt instruction if available (e.g. -march=native)
+    return (uint32_t)__builtin_popcountll(v);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+    return (uint32_t)__popcnt64(v);
+#else
+    return (uint32_t)std::bitset<64>(v).count();
+#endif
+}
+
+//hamming distance between two 256 bit descriptors (e.g. ORB) stored as four 64 bit words
+inline uint32_t hamming256(const uint64_t* a, const uint64_t* b)
+{
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512VL__)
+    __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b));
+    __m256i c = _mm256_popcnt_epi64(x);
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(c), _mm256_extracti128_si256(c, 1));
+    return (uint32_t)(_mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t x0 = veorq_u8(vld1q_u8((const uint8_t*)a), vld1q_u8((const uint8_t*)b));
+    uint8x16_t x1 = veorq_u8(vld1q_u8((const uint8_t*)(a + 2)), vld1q_u8((const uint8_t*)(b + 2)));
+    return (uint32_t)vaddlvq_u8(vcntq_u8(x0)) + (uint32_t)vaddlvq_u8(vcntq_u8(x1));
+#else
+    return popcount64(a[0] ^ b[0]) + popcount64(a[1] ^ b[1]) +
+           popcount64(a[2] ^ b[2]) + popcount64(a[3] ^ b[3]);
+#endif
+}
+
 //float initialized to zero.
 struct FBOW_API _float
 {
@@ -94,6 +131,7 @@ class FBOW_API Vocabulary
     // using Data_ptr = std::unique_ptr<char[], decltype(&AlignedFree)>;
 
     friend class VocabularyCreator;
+    friend class VocabularyTrainer;
 
 public:
     Vocabulary() : _data((char*)nullptr, &AlignedFree) {}
@@ -102,6 +140,10 @@ public:
     //transform the features stored as rows in the returned BagOfWords
     fBow transform(const cv::Mat& features);
     void transform(const cv::Mat& features, int level, fBow& result, fBow2& result2);
+    //transforms the features of many images at once with the same results as the function above.
+    //The features are passed through the tree level by level and grouped by block, so every block is
+    //read only once per level. The distance computations are split into nthreads threads.
+    void transform(const std::vector<cv::Mat>& features, int level, std::vector<fBow>& result, std::vector<fBow2>& result2, int nthreads = 1);
 
     //loads/saves from a file
     void readFromFile(const std::string& filepath);
@@ -128,6 +170,7 @@ public:
 
 private:
     void setParams(int aligment, int k, int desc_type, int desc_size, int nblocks, std::string desc_name);
+    void _transformBatch(const std::vector<cv::Mat>& features, size_t imgBegin, size_t imgEnd, int level, std::vector<fBow>& result, std::vector<fBow2>& result2, int nthreads);
     struct params
     {
         char     _desc_name_[50];             //descriptor name. May be empty
@@ -0,0 +1,483 @@
+#include "vocabulary_trainer.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace fbow
+{
+//signature of descriptor files
+static const uint64_t descFileSignature = 55824125;
+//number of descriptors read at once from a descriptor file
+static const size_t descFileChunkSize = 65536;
+
+uint32_t VocabularyTrainer::distance(const Desc256& a, const Desc256& b)
+{
+    return hamming256(a.w, b.w);
+}
+
+uint32_t VocabularyTrainer::nearestCenter(const Desc256& d, const Desc256* centers, uint32_t ncenters, uint32_t& dist)
+{
+    uint32_t best = 0;
+    dist          = std::numeric_limits<uint32_t>::max();
+    for (uint32_t c = 0; c < ncenters; c++)
+    {
+        uint32_t dc = distance(d, centers[c]);
+        if (dc < dist)
+        {
+            dist = dc;
+            best = c;
+        }
+    }
+    return best;
+}
+
+VocabularyTrainer::VocabularyTrainer(Params params)
+  : _params(params), _reservoirRng(params.seed)
+{
+    if (_params.nthreads == 0)
+        _params.nthreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void VocabularyTrainer::addPacked(const Desc256& d)
+{
+    _numSeen++;
+    if (_params.maxDescriptors == 0 || _desc.size() < _params.maxDescriptors)
+        _desc.push_back(d);
+    else
+    {
+        //reservoir sampling: every seen descriptor is kept with the same probability
+        std::uniform_int_distribution<size_t> dist(0, _numSeen - 1);
+        size_t                                j = dist(_reservoirRng);
+        if (j < _params.maxDescriptors)
+            _desc[j] = d;
+    }
+}
+
+void VocabularyTrainer::addDescriptors(const cv::Mat& descriptors)
+{
+    if (descriptors.empty())
+        return;
+    if (descriptors.type() != CV_8UC1 || descriptors.cols != (int)sizeof(Desc256))
+        throw std::runtime_error("VocabularyTrainer::addDescriptors descriptors must be CV_8UC1 with 32 columns");
+
+    Desc256 d;
+    for (int r = 0; r < descriptors.rows; r++)
+    {
+        std::memcpy(d.w, descriptors.ptr<uchar>(r), sizeof(Desc256));
+        addPacked(d);
+    }
+}
+
+size_t VocabularyTrainer::addDescriptorFile(const std::string& filepath)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) throw std::runtime_error("VocabularyTrainer::addDescriptorFile could not open:" + filepath);
+
+    uint64_t sig       = 0;
+    uint32_t descBytes = 0, reserved = 0;
+    file.read((char*)&sig, sizeof(sig));
+    file.read((char*)&descBytes, sizeof(descBytes));
+    file.read((char*)&reserved, sizeof(reserved));
+    if (!file || sig != descFileSignature || descBytes != sizeof(Desc256))
+        throw std::runtime_error("VocabularyTrainer::addDescriptorFile invalid descriptor file:" + filepath);
+
+    //read in chunks, so only the packed descriptors are kept in memory
+    std::vector<Desc256> chunk(descFileChunkSize);
+    size_t               nread = 0;
+    while (file)
+    {
+        file.read((char*)chunk.data(), chunk.size() * sizeof(Desc256));
+        size_t n = (size_t)file.gcount() / sizeof(Desc256);
+        for (size_t i = 0; i < n; i++)
+            addPacked(chunk[i]);
+        nread += n;
+    }
+    return nread;
+}
+
+void VocabularyTrainer::writeDescriptorFile(const std::string& filepath, const std::vector<cv::Mat>& descriptors, bool append)
+{
+    bool writeHeader = true;
+    if (append)
+    {
+        std::ifstream existing(filepath, std::ios::binary);
+        writeHeader = !existing || existing.peek() == std::ifstream::traits_type::eof();
+    }
+
+    std::ofstream file(filepath, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (!file) throw std::runtime_error("VocabularyTrainer::writeDescriptorFile could not open:" + filepath);
+
+    if (writeHeader)
+    {
+        uint32_t descBytes = sizeof(Desc256), reserved = 0;
+        file.write((const char*)&descFileSignature, sizeof(descFileSignature));
+        file.write((const char*)&descBytes, sizeof(descBytes));
+        file.write((const char*)&reserved, sizeof(reserved));
+    }
+
+    for (const cv::Mat& m : descriptors)
+    {
+        if (m.empty())
+            continue;
+        if (m.type() != CV_8UC1 || m.cols != (int)sizeof(Desc256))
+            throw std::runtime_error("VocabularyTrainer::writeDescriptorFile descriptors must be CV_8UC1 with 32 columns");
+        for (int r = 0; r < m.rows; r++)
+            file.write((const char*)m.ptr<uchar>(r), sizeof(Desc256));
+    }
+}
+
+void VocabularyTrainer::parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t, uint32_t)>& func)
+{
+    uint32_t n        = end - begin;
+    uint32_t nthreads = std::max(1u, std::min(_params.nthreads, n));
+    uint32_t chunk    = (n + nthreads - 1) / nthreads;
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 1; t < nthreads; t++)
+    {
+        uint32_t b = begin + t * chunk;
+        uint32_t e = std::min(end, b + chunk);
+        if (b < e)
+            threads.push_back(std::thread(func, t, b, e));
+    }
+    func(0, begin, std::min(end, begin + chunk));
+    for (std::thread& th : threads) th.join();
+}
+
+void VocabularyTrainer::seedCenters(uint32_t begin, uint32_t end, std::mt19937& rng, std::vector<Desc256>& centers, bool parallel)
+{
+    uint32_t              n = end - begin;
+    std::vector<uint32_t> minDist(n, std::numeric_limits<uint32_t>::max());
+
+    centers.clear();
+    std::uniform_int_distribution<uint32_t> first(begin, end - 1);
+    centers.push_back(_desc[_indices[first(rng)]]);
+
+    //k-means++: every further center is drawn with a probability proportional to the squared distance to the closest center
+    uint32_t              nchunks = parallel ? _params.nthreads : 1;
+    uint32_t              chunk   = (n + nchunks - 1) / nchunks;
+    std::vector<uint64_t> chunkSums(nchunks);
+    while (centers.size() < _params.k)
+    {
+        const Desc256& last   = centers.back();
+        auto           update = [&](uint32_t, uint32_t b, uint32_t e) {
+            uint64_t sum = 0;
+            for (uint32_t i = b; i < e; i++)
+            {
+                uint32_t d = distance(_desc[_indices[i]], last);
+                uint32_t& m = minDist[i - begin];
+                if (d < m) m = d;
+                sum += (uint64_t)m * m;
+            }
+            chunkSums[(b - begin) / chunk] = sum;
+        };
+        std::fill(chunkSums.begin(), chunkSums.end(), 0);
+        if (parallel)
+            parallelFor(begin, end, update);
+        else
+            update(0, begin, end);
+
+        uint64_t total = std::accumulate(chunkSums.begin(), chunkSums.end(), (uint64_t)0);
+        if (total == 0) break; //all remaining descriptors are equal to a center
+
+        std::uniform_int_distribution<uint64_t> pick(0, total - 1);
+        uint64_t                                r = pick(rng);
+        uint32_t                                c = 0;
+        while (r >= chunkSums[c])
+            r -= chunkSums[c++];
+
+        uint32_t i   = c * chunk;
+        uint32_t iend = std::min(n, i + chunk);
+        for (; i < iend - 1; i++)
+        {
+            uint64_t d2 = (uint64_t)minDist[i] * minDist[i];
+            if (r < d2) break;
+            r -= d2;
+        }
+        centers.push_back(_desc[_indices[begin + i]]);
+    }
+}
+
+uint32_t VocabularyTrainer::assign(uint32_t begin, uint32_t end, const std::vector<Desc256>& centers, std::vector<uint32_t>& assignment, bool parallel)
+{
+    std::atomic<uint32_t> changed(0);
+    auto                  func = [&](uint32_t, uint32_t b, uint32_t e) {
+        uint32_t nchanged = 0, dist;
+        for (uint32_t i = b; i < e; i++)
+        {
+            uint32_t c = nearestCenter(_desc[_indices[i]], centers.data(), (uint32_t)centers.size(), dist);
+            if (assignment[i - begin] != c)
+            {
+                assignment[i - begin] = c;
+                nchanged++;
+            }
+        }
+        changed += nchanged;
+    };
+    if (parallel)
+        parallelFor(begin, end, func);
+    else
+        func(0, begin, end);
+    return changed;
+}
+
+void VocabularyTrainer::updateCenters(uint32_t begin, uint32_t end, const std::vector<uint32_t>& assignment, std::vector<Desc256>& centers, std::vector<uint32_t>& counts)
+{
+    //k-majority: a bit of a center is set if it is set in at least half of the cluster members
+    const uint32_t                     k     = (uint32_t)centers.size();
+    bool                               par   = end - begin >= _params.bigNodeSize;
+    uint32_t                           nbins = par ? _params.nthreads : 1;
+    std::vector<std::vector<uint32_t>> bitCounts(nbins, std::vector<uint32_t>(k * 256, 0));
+    std::vector<std::vector<uint32_t>> sizes(nbins, std::vector<uint32_t>(k, 0));
+
+    auto func = [&](uint32_t t, uint32_t b, uint32_t e) {
+        std::vector<uint32_t>& bits = bitCounts[t];
+        std::vector<uint32_t>& size = sizes[t];
+        for (uint32_t i = b; i < e; i++)
+        {
+            uint32_t       c   = assignment[i - begin];
+            const Desc256& d   = _desc[_indices[i]];
+            uint32_t*      cnt = &bits[c * 256];
+            size[c]++;
+            for (int w = 0; w < 4; w++)
+            {
+                uint64_t v = d.w[w];
+                for (int bit = 0; bit < 64; bit++)
+                    cnt[w * 64 + bit] += (uint32_t)((v >> bit) & 1);
+            }
+        }
+    };
+    if (par)
+        parallelFor(begin, end, func);
+    else
+        func(0, begin, end);
+
+    counts.assign(k, 0);
+    for (uint32_t c = 0; c < k; c++)
+    {
+        for (uint32_t t = 0; t < nbins; t++) counts[c] += sizes[t][c];
+        if (counts[c] == 0) continue; //keep the old center of an empty cluster
+
+        const uint32_t half = counts[c] / 2 + counts[c] % 2;
+        Desc256        center;
+        for (int w = 0; w < 4; w++)
+        {
+            uint64_t v = 0;
+            for (int bit = 0; bit < 64; bit++)
+            {
+                uint32_t sum = 0;
+                for (uint32_t t = 0; t < nbins; t++) sum += bitCounts[t][c * 256 + w * 64 + bit];
+                if (sum >= half) v |= (uint64_t)1 << bit;
+            }
+            center.w[w] = v;
+        }
+        centers[c] = center;
+    }
+}
+
+void VocabularyTrainer::clusterNode(uint32_t nodeId, bool parallel, std::vector<uint32_t>& toSplit)
+{
+    uint32_t begin, end;
+    int      level;
+    {
+        std::unique_lock<std::mutex> lock(_nodesMutex);
+        begin = _nodes[nodeId].begin;
+        end   = _nodes[nodeId].end;
+        level = _nodes[nodeId].level;
+    }
+    const uint32_t n = end - begin;
+
+    std::vector<Node> children;
+    bool              splitChildren = false;
+    if (n <= _params.k)
+    {
+        //trivial case, every descriptor is a leaf
+        for (uint32_t i = begin; i < end; i++)
+        {
+            Node child;
+            child.center = _desc[_indices[i]];
+            child.begin  = i;
+            child.end    = i + 1;
+            child.level  = level + 1;
+            children.push_back(child);
+        }
+    }
+    else
+    {
+        //the generator depends only on the range of the node, which does not depend on the thread scheduling
+        std::seed_seq seq{_params.seed, begin, end, (uint32_t)level};
+        std::mt19937  rng(seq);
+
+        std::vector<Desc256> centers;
+        seedCenters(begin, end, rng, centers, parallel);
+
+        std::vector<uint32_t> assignment(n, std::numeric_limits<uint32_t>::max()), counts;
+        assign(begin, end, centers, assignment, parallel);
+        for (int iter = 0; iter < _params.maxIters; iter++)
+        {
+            updateCenters(begin, end, assignment, centers, counts);
+            if (assign(begin, end, centers, assignment, parallel) == 0)
+                break;
+        }
+
+        //sort the range of the node by cluster, so every child owns a contiguous range again
+        counts.assign(centers.size(), 0);
+        for (uint32_t a : assignment) counts[a]++;
+        std::vector<uint32_t> offsets(centers.size() + 1, 0);
+        for (size_t c = 0; c < centers.size(); c++) offsets[c + 1] = offsets[c] + counts[c];
+        std::vector<uint32_t> sorted(n);
+        std::vector<uint32_t> pos(offsets.begin(), offsets.end() - 1);
+        for (uint32_t i = 0; i < n; i++)
+            sorted[pos[assignment[i]]++] = _indices[begin + i];
+        std::copy(sorted.begin(), sorted.end(), _indices.begin() + begin);
+
+        for (size_t c = 0; c < centers.size(); c++)
+        {
+            if (counts[c] == 0) continue;
+            Node child;
+            child.center = centers[c];
+            child.begin  = begin + offsets[c];
+            child.end    = begin + offsets[c + 1];
+            child.level  = level + 1;
+            children.push_back(child);
+        }
+        splitChildren = level < _params.L - 1;
+    }
+
+    std::unique_lock<std::mutex> lock(_nodesMutex);
+    for (const Node& child : children)
+    {
+        uint32_t childId = (uint32_t)_nodes.size();
+        _nodes.push_back(child);
+        _nodes[nodeId].children.push_back(childId);
+        if (splitChildren && child.end - child.begin > 1)
+            toSplit.push_back(childId);
+    }
+    if (_params.verbose) std::cerr << "Cluster created :" << nodeId << " " << level << " (" << n << " descriptors)" << std::endl;
+}
+
+void VocabularyTrainer::workerLoop()
+{
+    std::vector<uint32_t> toSplit;
+    while (true)
+    {
+        uint32_t nodeId;
+        {
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            _queueCond.wait(lock, [this] { return !_queue.empty() || _numPending == 0; });
+            if (_queue.empty()) return;
+            nodeId = _queue.back();
+            _queue.pop_back();
+        }
+
+        toSplit.clear();
+        clusterNode(nodeId, false, toSplit);
+
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        _queue.insert(_queue.end(), toSplit.begin(), toSplit.end());
+        _numPending += (uint32_t)toSplit.size();
+        _numPending--;
+        lock.unlock();
+        _queueCond.notify_all();
+    }
+}
+
+void VocabularyTrainer::train(Vocabulary& Voc, const std::string& desc_name)
+{
+    if (_params.k < 2 || _params.L < 1)
+        throw std::runtime_error("VocabularyTrainer::train k must be at least 2 and L at least 1");
+    if (_desc.size() <= _params.k)
+        throw std::runtime_error("VocabularyTrainer::train not enough descriptors");
+    if (_desc.size() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("VocabularyTrainer::train too many descriptors (use Params::maxDescriptors)");
+
+    _indices.resize(_desc.size());
+    std::iota(_indices.begin(), _indices.end(), 0);
+    _nodes.clear();
+    Node root;
+    root.begin = 0;
+    root.end   = (uint32_t)_desc.size();
+    _nodes.push_back(root);
+
+    //big nodes (the upper levels) one after the other with parallel distance computations
+    std::vector<uint32_t> bigNodes(1, 0), toSplit;
+    _queue.clear();
+    while (!bigNodes.empty())
+    {
+        uint32_t nodeId = bigNodes.back();
+        bigNodes.pop_back();
+
+        toSplit.clear();
+        clusterNode(nodeId, _params.nthreads > 1, toSplit);
+        for (uint32_t child : toSplit)
+        {
+            if (_nodes[child].end - _nodes[child].begin >= _params.bigNodeSize)
+                bigNodes.push_back(child);
+            else
+                _queue.push_back(child);
+        }
+    }
+
+    //all other nodes are independent and fanned out to the worker threads
+    _numPending = (uint32_t)_queue.size();
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < _params.nthreads; t++)
+        threads.push_back(std::thread(&VocabularyTrainer::workerLoop, this));
+    for (std::thread& th : threads) th.join();
+
+    convertIntoVoc(Voc, desc_name);
+}
+
+void VocabularyTrainer::convertIntoVoc(Vocabulary& Voc, const std::string& desc_name)
+{
+    //breadth first order, so the root gets block 0 and the ids do not depend on the thread scheduling
+    std::vector<uint32_t> order(1, 0);
+    std::vector<uint32_t> blockIds(_nodes.size(), 0);
+    uint32_t              nblocks = 0, nwords = 0;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        Node& node = _nodes[order[i]];
+        if (node.isLeaf())
+            node.wordId = nwords++;
+        else
+        {
+            blockIds[order[i]] = nblocks++;
+            order.insert(order.end(), node.children.begin(), node.children.end());
+        }
+    }
+
+    Voc.clear();
+    Voc.setParams(8, (int)_params.k, CV_8UC1, (int)sizeof(Desc256), (int)nblocks, desc_name);
+    for (uint32_t nodeId : order)
+    {
+        const Node& node = _nodes[nodeId];
+        if (node.isLeaf()) continue;
+
+        auto binfo = Voc.getBlock(blockIds[nodeId]);
+        binfo.setN((uint16_t)node.children.size());
+        binfo.setParentId(blockIds[nodeId]);
+        bool areAllChildrenLeaf = true;
+        for (size_t c = 0; c < node.children.size(); c++)
+        {
+            const Node& child = _nodes[node.children[c]];
+            std::memcpy(binfo.getFeature<char>((int)c), child.center.w, sizeof(Desc256));
+            if (child.isLeaf())
+                binfo.getBlockNodeInfo((int)c)->setLeaf(child.wordId, 1.f);
+            else
+            {
+                binfo.getBlockNodeInfo((int)c)->setNonLeaf(blockIds[node.children[c]]);
+                areAllChildrenLeaf = false;
+            }
+        }
+        if (areAllChildrenLeaf) binfo.setLeaf(true);
+    }
+
+    if (_params.verbose) std::cerr << "Vocabulary with " << nblocks << " blocks and " << nwords << " words" << std::endl;
+}
+}
@@ -0,0 +1,113 @@
+#ifndef _FBOW_VOCABULARYTRAINER_H
+#define _FBOW_VOCABULARYTRAINER_H
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <random>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <opencv2/core/core.hpp>
+#include "fbow_exports.h"
+#include "fbow.h"
+namespace fbow
+{
+/**Parallel trainer for vocabularies of 256 bit binary descriptors (ORB).
+ *
+ * In contrast to VocabularyCreator the descriptors are kept packed as four 64 bit
+ * words in one contiguous array and every tree node works on a contiguous range of
+ * an index array, so no cv::Mat headers are created in the inner loops.
+ * The clusters of a node are seeded with k-means++ and refined with k-majority.
+ * Nodes with many descriptors are processed one after the other, with the distance
+ * computations distributed over all threads. All smaller nodes are fanned out to a
+ * pool of worker threads. Every node draws its random numbers from its own generator
+ * seeded with std::seed_seq{Params::seed, begin, end, level}, i.e. with the descriptor
+ * range and the tree level of the node, so the result does not depend on the thread
+ * scheduling.
+ *
+ * Descriptors can be added from cv::Mat or streamed from descriptor files
+ * (see writeDescriptorFile). With Params::maxDescriptors the descriptors are
+ * subsampled with reservoir sampling while they are added, which bounds the memory
+ * for very large image sets.
+ */
+class FBOW_API VocabularyTrainer
+{
+public:
+    struct Params
+    {
+        Params() {}
+        uint32_t k              = 10;    //branching factor
+        int      L              = 6;     //depth of the tree
+        uint32_t nthreads       = 0;     //number of threads (0: hardware concurrency)
+        int      maxIters       = 11;    //max. k-majority iterations per node
+        uint32_t seed           = 0;     //seed of the random generators
+        size_t   maxDescriptors = 0;     //max. descriptors kept for training (0: all)
+        uint32_t bigNodeSize    = 50000; //nodes with at least this many descriptors are clustered with all threads
+        bool     verbose        = false;
+    };
+
+    //packed 256 bit descriptor
+    struct Desc256
+    {
+        uint64_t w[4];
+    };
+
+    explicit VocabularyTrainer(Params params = Params());
+
+    //adds the rows of a CV_8UC1 matrix with 32 columns
+    void addDescriptors(const cv::Mat& descriptors);
+    //streams the descriptors of a file written with writeDescriptorFile. Returns the number of descriptors read
+    size_t addDescriptorFile(const std::string& filepath);
+    //writes descriptors to a file that can be streamed with addDescriptorFile. If append is true, they are added to an existing file
+    static void writeDescriptorFile(const std::string& filepath, const std::vector<cv::Mat>& descriptors, bool append = false);
+
+    //number of descriptors kept for training
+    size_t size() const { return _desc.size(); }
+    //number of descriptors seen by addDescriptors and addDescriptorFile
+    size_t numSeen() const { return _numSeen; }
+
+    //trains the vocabulary. Voc can be saved with saveToFile and loaded with readFromFile
+    void train(Vocabulary& Voc, const std::string& desc_name = "orb");
+
+    //hamming distance between two packed descriptors
+    static uint32_t distance(const Desc256& a, const Desc256& b);
+    //index of the center closest to d
+    static uint32_t nearestCenter(const Desc256& d, const Desc256* centers, uint32_t ncenters, uint32_t& dist);
+
+private:
+    struct Node
+    {
+        Desc256               center{};
+        uint32_t              begin = 0, end = 0; //range of the node in _indices
+        int                   level = 0;          //depth of the node (root: 0)
+        uint32_t              wordId = 0;         //word id if leaf
+        std::vector<uint32_t> children;
+        bool                  isLeaf() const { return children.empty(); }
+    };
+
+    void     addPacked(const Desc256& d);
+    void     clusterNode(uint32_t nodeId, bool parallel, std::vector<uint32_t>& toSplit);
+    void     seedCenters(uint32_t begin, uint32_t end, std::mt19937& rng, std::vector<Desc256>& centers, bool parallel);
+    uint32_t assign(uint32_t begin, uint32_t end, const std::vector<Desc256>& centers, std::vector<uint32_t>& assignment, bool parallel);
+    void     updateCenters(uint32_t begin, uint32_t end, const std::vector<uint32_t>& assignment, std::vector<Desc256>& centers, std::vector<uint32_t>& counts);
+    void     parallelFor(uint32_t begin, uint32_t end, const std::function<void(uint32_t, uint32_t, uint32_t)>& func);
+    void     workerLoop();
+    void     convertIntoVoc(Vocabulary& Voc, const std::string& desc_name);
+
+    Params                _params;
+    std::vector<Desc256>  _desc;    //packed descriptors
+    std::vector<uint32_t> _indices; //descriptor indices, every node owns a contiguous range
+    size_t                _numSeen = 0;
+    std::mt19937_64       _reservoirRng;
+
+    std::vector<Node> _nodes;
+    std::mutex        _nodesMutex;
+
+    //work queue of the worker threads
+    std::vector<uint32_t>   _queue;
+    std::mutex              _queueMutex;
+    std::condition_variable _queueCond;
+    uint32_t                _numPending = 0; //queued and running nodes
+};
+}
+#endif
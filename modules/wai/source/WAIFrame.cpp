@@ -324,7 +324,13 @@ void WAIFrame::ComputeBoW()
         // that make a total of 100 words. More words means more variance between keyframe and less
         // preselected keyframe but that will make also the relocalization less invariant to changes
 
-        mVocabulary->transform(mDescriptors, mBowVec, mFeatVec);
+        // The batched transform groups the descriptors by tree node per level and
+        // splits the distance search over threads if the frame has many features
+        std::vector<WAIBowVector>  bows;
+        std::vector<WAIFeatVector> feats;
+        mVocabulary->transform(std::vector<cv::Mat>{mDescriptors}, bows, feats);
+        mBowVec  = std::move(bows[0]);
+        mFeatVec = std::move(feats[0]);
     }
 }
 //-----------------------------------------------------------------------------
@@ -112,8 +112,9 @@ WAIKeyFrame::WAIKeyFrame(const cv::Mat&                   Tcw,
     //set camera position
     SetPose(Tcw);
 
-    //compute mBowVec and mFeatVec
-    ComputeBoW(vocabulary);
+    //compute mBowVec and mFeatVec (without vocabulary the caller computes them with the batched ComputeBoW)
+    if (vocabulary)
+        ComputeBoW(vocabulary);
 
     //assign features to grid
     AssignFeaturesToGrid();
@@ -198,7 +199,9 @@ void WAIKeyFrame::ComputeBoW(WAIOrbVocabulary* vocabulary)
 {
     PROFILE_SCOPE("WAI::WAIKeyFrame::ComputeBoW");
 
-    if (mBowVec.data.empty() || mFeatVec.data.empty())
+    //a keyframe created from a frame reuses the vectors of the frame
+    bool reuseFrameBoW = mBowVec.isFill && mFeatVec.isFill;
+    if (!reuseFrameBoW && (mBowVec.data.empty() || mFeatVec.data.empty()))
     {
         //vector<cv::Mat> vCurrentDesc = ORB_SLAM2::Converter::toDescriptorVector(mDescriptors);
         // Feature vector associate features with nodes in the 4th level (from leaves up)
@@ -214,6 +217,40 @@ void WAIKeyFrame::ComputeBoW(WAIOrbVocabulary* vocabulary)
     }
 }
 //-----------------------------------------------------------------------------
+/*! Computes mBowVec and mFeatVec of many keyframes at once (e.g. after loading
+a map) with the batched and parallel vocabulary transform. Keyframes that
+already have a feature vector are skipped and bow vectors set with SetBowVector
+are kept.
+ */
+void WAIKeyFrame::ComputeBoW(const std::vector<WAIKeyFrame*>& keyFrames,
+                             WAIOrbVocabulary*                vocabulary)
+{
+    PROFILE_SCOPE("WAI::WAIKeyFrame::ComputeBoW(batch)");
+
+    std::vector<WAIKeyFrame*> todo;
+    std::vector<cv::Mat>      descriptors;
+    for (WAIKeyFrame* kf : keyFrames)
+    {
+        if (kf->mFeatVec.isFill || !kf->mFeatVec.data.empty())
+            continue;
+        todo.push_back(kf);
+        descriptors.push_back(kf->mDescriptors);
+    }
+    if (todo.empty())
+        return;
+
+    std::vector<WAIBowVector>  bows;
+    std::vector<WAIFeatVector> feats;
+    vocabulary->transform(descriptors, bows, feats);
+
+    for (size_t i = 0; i < todo.size(); i++)
+    {
+        if (todo[i]->mBowVec.data.empty())
+            todo[i]->mBowVec = std::move(bows[i]);
+        todo[i]->mFeatVec = std::move(feats[i]);
+    }
+}
+//-----------------------------------------------------------------------------
 void WAIKeyFrame::SetPose(const cv::Mat& Tcw)
 {
     PROFILE_SCOPE("WAI::WAIKeyFrame::SetPose");
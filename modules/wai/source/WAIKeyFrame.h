@@ -95,8 +95,9 @@ public:
     cv::Mat GetTranslation();
 
     // Bag of Words Representation
-    void ComputeBoW(WAIOrbVocabulary* vocabulary);
-    void SetBowVector(WAIBowVector& bow);
+    void        ComputeBoW(WAIOrbVocabulary* vocabulary);
+    static void ComputeBoW(const std::vector<WAIKeyFrame*>& keyFrames, WAIOrbVocabulary* vocabulary);
+    void        SetBowVector(WAIBowVector& bow);
 
     // Covisibility graph functions
     void                      AddConnection(WAIKeyFrame* pKF, int weight);
@@ -30,6 +30,7 @@
 
 #include <WAIMap.h>
 #include <Utils.h>
+#include <Profiler.h>
 
 using namespace cv;
 
@@ -53,6 +54,7 @@ void WAIMap::AddKeyFrame(WAIKeyFrame* pKF)
     mspKeyFrames.insert(pKF);
     if (pKF->mnId > mnMaxKFid)
         mnMaxKFid = pKF->mnId;
+    PROFILE_COUNTER("Keyframes", mspKeyFrames.size());
     //mKfDB->add(pKF);
 }
 //-----------------------------------------------------------------------------
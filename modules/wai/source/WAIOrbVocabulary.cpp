@@ -8,8 +8,10 @@
 //             Please visit: http://opensource.org/licenses/GPL-3.0
 //#############################################################################
 
+#include <thread>
 #include <orb_slam/Converter.h>
 #include <WAIOrbVocabulary.h>
+#include <HighResTimer.h>
 #include <Utils.h>
 
 WAIOrbVocabulary::WAIOrbVocabulary(int layer)
@@ -91,13 +93,71 @@ void WAIOrbVocabulary::transform(const cv::Mat& descriptors, WAIBowVector& bow,
     if (descriptors.rows == 0)
         return;
 
+    HighResTimer t;
 #if USE_FBOW
     _vocabulary->transform(descriptors, _layer, bow.data, feat.data);
 #else
     vector<cv::Mat> vCurrentDesc = ORB_SLAM2::Converter::toDescriptorVector(descriptors);
     _vocabulary->transform(vCurrentDesc, bow.data, feat.data, _vocabulary->getDepthLevels() - _layer);
 #endif
+    addTransformTime(t.elapsedTimeInMilliSec(), 1);
 }
+//-----------------------------------------------------------------------------
+/*! The fbow vocabulary passes the descriptors of all frames through the tree
+level by level, grouped by tree node, and computes the distances in parallel.
+The results are the same as with the single frame version.
+ */
+void WAIOrbVocabulary::transform(const std::vector<cv::Mat>&   descriptors,
+                                 std::vector<WAIBowVector>&  bows,
+                                 std::vector<WAIFeatVector>& feats,
+                                 int                         nthreads)
+{
+    bows.assign(descriptors.size(), WAIBowVector());
+    feats.assign(descriptors.size(), WAIFeatVector());
+    if (descriptors.empty())
+        return;
+
+    HighResTimer t;
+#if USE_FBOW
+    if (nthreads <= 0)
+        nthreads = (int)std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<fbow::fBow>  bowData;
+    std::vector<fbow::fBow2> featData;
+    _vocabulary->transform(descriptors, _layer, bowData, featData, nthreads);
+    for (size_t i = 0; i < descriptors.size(); i++)
+    {
+        bows[i].data  = std::move(bowData[i]);
+        feats[i].data = std::move(featData[i]);
+    }
+#else
+    for (size_t i = 0; i < descriptors.size(); i++)
+    {
+        if (descriptors[i].rows == 0) continue;
+        vector<cv::Mat> vCurrentDesc = ORB_SLAM2::Converter::toDescriptorVector(descriptors[i]);
+        _vocabulary->transform(vCurrentDesc, bows[i].data, feats[i].data, _vocabulary->getDepthLevels() - _layer);
+    }
+#endif
+    for (size_t i = 0; i < descriptors.size(); i++)
+    {
+        bows[i].isFill  = true;
+        feats[i].isFill = true;
+    }
+    addTransformTime(t.elapsedTimeInMilliSec(), descriptors.size());
+}
+//-----------------------------------------------------------------------------
+void WAIOrbVocabulary::addTransformTime(float ms, size_t numFrames)
+{
+    std::lock_guard<std::mutex> lock(_transformTimeMutex);
+    _transformTimeMS.set(ms / (float)numFrames);
+}
+//-----------------------------------------------------------------------------
+float WAIOrbVocabulary::transformTimeMS()
+{
+    std::lock_guard<std::mutex> lock(_transformTimeMutex);
+    return _transformTimeMS.average();
+}
+//-----------------------------------------------------------------------------
 
 double WAIOrbVocabulary::score(WAIBowVector& bow1, WAIBowVector& bow2)
 {
@@ -120,18 +180,20 @@ size_t WAIOrbVocabulary::size()
 void WAIOrbVocabulary::create(std::vector<cv::Mat> &features, int k, int l)
 {
 #if USE_FBOW
-    fbow::VocabularyCreator vc;
-    fbow::VocabularyCreator::Params p;
-    p.k        = k;
-    p.L        = l;
-    p.nthreads = 100;
-    p.maxIters = 11;
-    p.verbose  = true;
+    fbow::VocabularyTrainer::Params p;
+    p.k       = k;
+    p.L       = l;
+    p.verbose = true;
+
+    fbow::VocabularyTrainer trainer(p);
+    for (const cv::Mat& f : features)
+        trainer.addDescriptors(f);
 
     std::cout << "Creating a " << p.k << "^" << p.L << " vocabulary..." << std::endl;
+    delete _vocabulary;
     _vocabulary = new fbow::Vocabulary();
 
-    vc.create(*_vocabulary, features, "slamvoc", p);
+    trainer.train(*_vocabulary, "slamvoc");
     std::cout << "... done!" << std::endl;
 #else
     const DBoW2::WeightingType weight = DBoW2::TF_IDF;
@@ -155,6 +217,34 @@ void WAIOrbVocabulary::create(std::vector<cv::Mat> &features, int k, int l)
 #endif
 }
 
+void WAIOrbVocabulary::createFromDescriptorFiles(const std::vector<std::string>& descriptorFiles,
+                                                 int                             k,
+                                                 int                             l,
+                                                 size_t                          maxDescriptors)
+{
+#if USE_FBOW
+    fbow::VocabularyTrainer::Params p;
+    p.k              = k;
+    p.L              = l;
+    p.maxDescriptors = maxDescriptors;
+    p.verbose        = true;
+
+    // the files are streamed, only the (subsampled) packed descriptors are kept in memory
+    fbow::VocabularyTrainer trainer(p);
+    for (const std::string& file : descriptorFiles)
+        trainer.addDescriptorFile(file);
+
+    std::cout << "Creating a " << p.k << "^" << p.L << " vocabulary from " << trainer.size() << " of " << trainer.numSeen() << " descriptors..." << std::endl;
+    delete _vocabulary;
+    _vocabulary = new fbow::Vocabulary();
+
+    trainer.train(*_vocabulary, "slamvoc");
+    std::cout << "... done!" << std::endl;
+#else
+    throw std::runtime_error("WAIOrbVocabulary::createFromDescriptorFiles: only supported with fbow");
+#endif
+}
+
 void WAIOrbVocabulary::save(std::string path)
 {
 #if USE_FBOW
@@ -13,11 +13,14 @@
 #define USE_FBOW 1
 
 #include <string>
+#include <mutex>
 #include <WAIHelper.h>
+#include <Averaged.h>
 
 #if USE_FBOW
 #    include <fbow.h>
 #    include <vocabulary_creator.h>
+#    include <vocabulary_trainer.h>
 #else
 #    include <orb_slam/ORBVocabulary.h>
 #endif
@@ -56,6 +59,9 @@ public:
     ~WAIOrbVocabulary();
     void loadFromFile(std::string strVocFile);
     void create(std::vector<cv::Mat> &features, int k, int l);
+    //! create a vocabulary from descriptor files written with fbow::VocabularyTrainer::writeDescriptorFile
+    //! (maxDescriptors > 0: descriptors are subsampled to this number while streaming)
+    void createFromDescriptorFiles(const std::vector<std::string>& descriptorFiles, int k, int l, size_t maxDescriptors = 0);
 
 #if USE_FBOW
     fbow::Vocabulary* _vocabulary = nullptr;
@@ -63,13 +69,21 @@ public:
     ORB_SLAM2::ORBVocabulary* _vocabulary = nullptr;
 #endif
     void   transform(const cv::Mat& descriptors, WAIBowVector& bow, WAIFeatVector& feat);
+    //! transform the descriptors of many frames at once (nthreads = 0: hardware concurrency)
+    void   transform(const std::vector<cv::Mat>& descriptors, std::vector<WAIBowVector>& bows, std::vector<WAIFeatVector>& feats, int nthreads = 0);
+    //! averaged transform time per frame in milliseconds
+    float  transformTimeMS();
     double score(WAIBowVector& bow1, WAIBowVector& bow2);
     size_t size();
     void   save(std::string path);
     void   setLayer(int layer) { _layer = layer; }
 
 private:
-    int _layer;
+    void addTransformTime(float ms, size_t numFrames);
+
+    int             _layer;
+    Utils::AvgFloat _transformTimeMS{60, 0.0f}; //!< averaged transform time per frame
+    std::mutex      _transformTimeMutex;       //!< transform is called from tracking and local mapping
 };
 
 #endif // !WAI_ORBVOCABULARY_H
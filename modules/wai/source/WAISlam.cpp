@@ -1,5 +1,6 @@
 #include <WAISlam.h>
 #include <AverageTiming.h>
+#include <HighResTimer.h>
 #include <Utils.h>
 
 #define MIN_FRAMES 0
@@ -161,6 +162,8 @@ void WAISlam::changeIntrinsic(cv::Mat intrinsic, cv::Mat distortion)
 //-----------------------------------------------------------------------------
 void WAISlam::createFrame(WAIFrame& frame, cv::Mat& imageGray)
 {
+    HighResTimer t;
+
     switch (getTrackingState())
     {
         case WAITrackingState::Initializing:
@@ -191,6 +194,9 @@ void WAISlam::createFrame(WAIFrame& frame, cv::Mat& imageGray)
                              _voc,
                              _params.retainImg);
     }
+
+    std::unique_lock<std::mutex> lock(_lastFrameMutex);
+    _stageTimings.extractionMS = t.elapsedTimeInMilliSec();
 }
 //-----------------------------------------------------------------------------
 /* Separate Pose update thread */
@@ -292,6 +298,10 @@ void WAISlam::updatePose(WAIFrame& frame)
 {
     std::unique_lock<std::mutex> guard(_mutexStates);
 
+    HighResTimer t;
+    float        localMappingMS = 0.0f;
+    float        loopClosingMS  = 0.0f;
+
     switch (_state)
     {
         case WAITrackingState::Initializing:
@@ -318,8 +328,10 @@ void WAISlam::updatePose(WAIFrame& frame)
                     _initialized         = true;
                     if (_params.serial)
                     {
+                        HighResTimer tMapping;
                         _localMapping->RunOnce();
                         _localMapping->RunOnce();
+                        localMappingMS = tMapping.elapsedTimeInMilliSec();
                     }
                 }
             }
@@ -358,8 +370,12 @@ void WAISlam::updatePose(WAIFrame& frame)
                         _lastKeyFrameFrameId);
                 if (_params.serial)
                 {
+                    HighResTimer tStage;
                     _localMapping->RunOnce();
+                    localMappingMS = tStage.elapsedTimeInMilliSec();
+                    tStage.start();
                     _loopClosing->RunOnce();
+                    loopClosingMS = tStage.elapsedTimeInMilliSec();
                 }
                 _infoMatchedInliners = inliers;
             }
@@ -389,7 +405,10 @@ void WAISlam::updatePose(WAIFrame& frame)
     }
 
     std::unique_lock<std::mutex> lock(_lastFrameMutex);
-    _lastFrame = WAIFrame(frame);
+    _lastFrame                   = WAIFrame(frame);
+    _stageTimings.localMappingMS = localMappingMS;
+    _stageTimings.loopClosingMS  = loopClosingMS;
+    _stageTimings.trackingMS     = t.elapsedTimeInMilliSec() - localMappingMS - loopClosingMS;
 }
 //-----------------------------------------------------------------------------
 void WAISlam::updatePoseKFIntegration(WAIFrame& frame)
@@ -636,6 +655,12 @@ int WAISlam::getLoopCloseCount()
     return _globalMap->getNumLoopClosings();
 }
 //-----------------------------------------------------------------------------
+WAISlam::StageTimings WAISlam::getLastStageTimings()
+{
+    std::unique_lock<std::mutex> lock(_lastFrameMutex);
+    return _stageTimings;
+}
+//-----------------------------------------------------------------------------
 int WAISlam::getKeyFramesInLoopCloseQueueCount()
 {
     return _loopClosing->numOfKfsInQueue();
@@ -55,6 +55,16 @@ public:
         bool minAccScoreFilter = false;
     };
 
+    // Durations of the processing stages of the last frame in ms.
+    // Local mapping and loop closing are only measured in serial mode (otherwise they run in their own threads).
+    struct StageTimings
+    {
+        float extractionMS   = 0.0f;
+        float trackingMS     = 0.0f;
+        float localMappingMS = 0.0f;
+        float loopClosingMS  = 0.0f;
+    };
+
     WAISlam(const cv::Mat&          intrinsic,
             const cv::Mat&          distortion,
             WAIOrbVocabulary*       voc,
@@ -167,6 +177,8 @@ public:
 
     int getKeyFramesInLoopCloseQueueCount();
 
+    StageTimings getLastStageTimings();
+
 protected:
     void updateState(WAITrackingState state);
 
@@ -200,6 +212,7 @@ protected:
     std::thread*         _poseUpdateThread;
     std::queue<WAIFrame> _framesQueue;
     std::mutex           _frameQueueMutex;
+    StageTimings         _stageTimings; // guarded by _lastFrameMutex
 };
 //-----------------------------------------------------------------------------
 #endif
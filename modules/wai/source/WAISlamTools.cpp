@@ -163,8 +163,7 @@ bool WAISlamTools::initialize(WAIInitializerData&  iniData,
     WAIKeyFrame* pKFini = new WAIKeyFrame(iniData.initialFrame);
     WAIKeyFrame* pKFcur = new WAIKeyFrame(frame);
 
-    pKFini->ComputeBoW(voc);
-    pKFcur->ComputeBoW(voc);
+    WAIKeyFrame::ComputeBoW({pKFini, pKFcur}, voc);
 
     // Create MapPoints and associate to keyframes
     for (size_t i = 0; i < iniData.iniMatches.size(); i++)
@@ -353,8 +352,7 @@ bool WAISlamTools::oldInitialize(WAIFrame&         frame,
     WAIKeyFrame* pKFini = new WAIKeyFrame(iniData.initialFrame);
     WAIKeyFrame* pKFcur = new WAIKeyFrame(frame);
 
-    pKFini->ComputeBoW(voc);
-    pKFcur->ComputeBoW(voc);
+    WAIKeyFrame::ComputeBoW({pKFini, pKFcur}, voc);
 
     // Insert KFs in the map
     map->AddKeyFrame(pKFini);